@@ -0,0 +1,181 @@
+#pragma once
+
+// Host stand-in for the Arduino core used by the [env:native] build: String,
+// Serial, the time functions and (through freertos/FreeRTOS.h) the FreeRTOS
+// API, enough for the control modules (BehaviorEngine, PowercellSynthesizer,
+// ConfigManager, CanManager, Ipm1CanSystem, rings) to compile unmodified.
+// Time comes from HostClock; Serial writes to stdout and can be muted so
+// benchmarks are not dominated by console I/O.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+#include <thread>
+
+#include <freertos/FreeRTOS.h>
+
+#include "host_clock.h"
+
+using byte = uint8_t;
+using boolean = bool;
+
+constexpr int DEC = 10;
+constexpr int HEX = 16;
+constexpr int BIN = 2;
+
+inline unsigned long millis() { return static_cast<unsigned long>(HostClock::nowUs() / 1000); }
+inline unsigned long micros() { return static_cast<unsigned long>(HostClock::nowUs()); }
+inline void delay(unsigned long ms) { HostClock::sleepUs(static_cast<uint64_t>(ms) * 1000); }
+inline void delayMicroseconds(unsigned int us) { HostClock::sleepUs(us); }
+inline void yield() {}
+
+class String : public std::string {
+public:
+    String() = default;
+    String(const char* s) : std::string(s ? s : "") {}
+    String(const std::string& s) : std::string(s) {}
+    String(std::string&& s) : std::string(std::move(s)) {}
+    String(char c) : std::string(1, c) {}
+    String(int value, int base = DEC) : std::string(fromInteger(value, base)) {}
+    String(unsigned int value, int base = DEC) : std::string(fromUnsigned(value, base)) {}
+    String(long value, int base = DEC) : std::string(fromInteger(value, base)) {}
+    String(unsigned long value, int base = DEC) : std::string(fromUnsigned(value, base)) {}
+    String(float value, unsigned int decimals = 2) : std::string(fromDouble(value, decimals)) {}
+    String(double value, unsigned int decimals = 2) : std::string(fromDouble(value, decimals)) {}
+
+    bool isEmpty() const { return empty(); }
+    unsigned int length() const { return static_cast<unsigned int>(size()); }
+    bool equals(const String& other) const { return *this == other; }
+    bool startsWith(const String& prefix) const { return compare(0, prefix.size(), prefix) == 0; }
+    bool endsWith(const String& suffix) const {
+        return size() >= suffix.size() && compare(size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return toIndex(find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return toIndex(find(s, from)); }
+    int lastIndexOf(char c) const { return toIndex(rfind(c)); }
+    String substring(unsigned int from) const { return from < size() ? String(substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        return from < size() ? String(substr(from, to - from)) : String();
+    }
+    char charAt(unsigned int i) const { return i < size() ? (*this)[i] : '\0'; }
+    long toInt() const { return std::strtol(c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(c_str(), nullptr); }
+    void toLowerCase() { for (auto& c : *this) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c))); }
+    void toUpperCase() { for (auto& c : *this) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c))); }
+    void trim() {
+        const auto first = find_first_not_of(" \t\r\n");
+        if (first == npos) {
+            clear();
+            return;
+        }
+        *this = String(substr(first, find_last_not_of(" \t\r\n") - first + 1));
+    }
+    void replace(const String& from, const String& to) {
+        if (from.empty()) return;
+        for (size_type at = find(from); at != npos; at = find(from, at + to.size())) {
+            std::string::replace(at, from.size(), to);
+        }
+    }
+    bool concat(const String& s) {
+        append(s);
+        return true;
+    }
+
+    String& operator+=(const String& s) { append(s); return *this; }
+    String& operator+=(const char* s) { append(s ? s : ""); return *this; }
+    String& operator+=(char c) { push_back(c); return *this; }
+    String& operator+=(int v) { append(fromInteger(v, DEC)); return *this; }
+    String& operator+=(unsigned int v) { append(fromUnsigned(v, DEC)); return *this; }
+    String& operator+=(long v) { append(fromInteger(v, DEC)); return *this; }
+    String& operator+=(unsigned long v) { append(fromUnsigned(v, DEC)); return *this; }
+
+    // Print-style sink, so ArduinoJson can serialize into a String as it
+    // does on the device
+    size_t write(uint8_t c) {
+        push_back(static_cast<char>(c));
+        return 1;
+    }
+    size_t write(const uint8_t* data, size_t len) {
+        append(reinterpret_cast<const char*>(data), len);
+        return len;
+    }
+
+private:
+    static int toIndex(size_type at) { return at == npos ? -1 : static_cast<int>(at); }
+    static std::string fromUnsigned(unsigned long value, int base) {
+        char buf[72];
+        char* p = buf + sizeof(buf) - 1;
+        *p = '\0';
+        do {
+            const unsigned digit = static_cast<unsigned>(value % base);
+            *--p = static_cast<char>(digit < 10 ? '0' + digit : 'a' + digit - 10);
+            value /= base;
+        } while (value);
+        return p;
+    }
+    static std::string fromInteger(long value, int base) {
+        if (value < 0 && base == DEC) return "-" + fromUnsigned(static_cast<unsigned long>(-value), base);
+        return fromUnsigned(static_cast<unsigned long>(value), base);
+    }
+    static std::string fromDouble(double value, unsigned int decimals) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(decimals), value);
+        return buf;
+    }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, int b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, unsigned int b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, long b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, unsigned long b) { String r(a); r += b; return r; }
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    void setQuiet(bool quiet) { quiet_ = quiet; }
+    bool quiet() const { return quiet_; }
+
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (quiet_) return 0;
+        va_list args;
+        va_start(args, format);
+        const int written = std::vprintf(format, args);
+        va_end(args);
+        return written;
+    }
+    size_t print(const char* s) {
+        if (!quiet_) std::fputs(s, stdout);
+        return std::strlen(s);
+    }
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(char c) { if (!quiet_) std::putchar(c); return 1; }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(unsigned int v) { return print(String(v)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, static_cast<unsigned int>(decimals))); }
+    template <typename T>
+    size_t println(const T& v) { const size_t n = print(v); return n + print('\n'); }
+    size_t println() { return print('\n'); }
+    size_t write(uint8_t c) { return print(static_cast<char>(c)); }
+    void flush() { std::fflush(stdout); }
+    explicit operator bool() const { return true; }
+
+private:
+    bool quiet_ = false;
+};
+
+inline HostSerial Serial;
@@ -0,0 +1,178 @@
+#pragma once
+
+// In-memory filesystem for the native build, API-compatible with the subset
+// of the Arduino FS/LittleFS classes the firmware uses. Files are byte
+// vectors keyed by path; a File shares its node with the filesystem, so
+// writes are visible to later opens without an explicit flush. Counters
+// let benchmarks report storage traffic.
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct HostFsStats {
+    uint32_t opens = 0;
+    uint32_t renames = 0;
+    uint32_t removes = 0;
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+};
+
+class File {
+public:
+    File() = default;
+    File(std::shared_ptr<std::vector<uint8_t>> data, std::string path, bool writable, bool append,
+         HostFsStats* stats)
+        : data_(std::move(data)), path_(std::move(path)), writable_(writable), stats_(stats) {
+        pos_ = append ? data_->size() : 0;
+    }
+
+    explicit operator bool() const { return data_ != nullptr; }
+    const char* name() const { return path_.c_str(); }
+    const char* path() const { return path_.c_str(); }
+    size_t size() const { return data_ ? data_->size() : 0; }
+    size_t position() const { return pos_; }
+    int available() const { return data_ ? static_cast<int>(data_->size() - pos_) : 0; }
+    bool isDirectory() const { return false; }
+    void close() { data_.reset(); }
+    void flush() {}
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        if (!data_) return false;
+        const size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos_ : data_->size();
+        if (base + pos > data_->size()) return false;
+        pos_ = base + pos;
+        return true;
+    }
+
+    int read() {
+        if (!data_ || pos_ >= data_->size()) return -1;
+        count(1, 0);
+        return (*data_)[pos_++];
+    }
+    int peek() const { return (data_ && pos_ < data_->size()) ? (*data_)[pos_] : -1; }
+    size_t read(uint8_t* buf, size_t len) {
+        if (!data_) return 0;
+        const size_t n = std::min(len, data_->size() - pos_);
+        std::memcpy(buf, data_->data() + pos_, n);
+        pos_ += n;
+        count(n, 0);
+        return n;
+    }
+    size_t readBytes(char* buf, size_t len) { return read(reinterpret_cast<uint8_t*>(buf), len); }
+    String readString() {
+        if (!data_) return String();
+        String out(std::string(data_->begin() + pos_, data_->end()));
+        count(data_->size() - pos_, 0);
+        pos_ = data_->size();
+        return out;
+    }
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!data_ || !writable_) return 0;
+        if (pos_ + len > data_->size()) data_->resize(pos_ + len);
+        std::memcpy(data_->data() + pos_, buf, len);
+        pos_ += len;
+        count(0, len);
+        return len;
+    }
+    size_t print(const char* s) { return write(reinterpret_cast<const uint8_t*>(s), std::strlen(s)); }
+    size_t print(const String& s) { return write(reinterpret_cast<const uint8_t*>(s.data()), s.size()); }
+    size_t println(const char* s) { return print(s) + print("\n"); }
+
+private:
+    void count(size_t read_bytes, size_t written_bytes) {
+        if (!stats_) return;
+        stats_->bytes_read += read_bytes;
+        stats_->bytes_written += written_bytes;
+    }
+
+    std::shared_ptr<std::vector<uint8_t>> data_;
+    std::string path_;
+    size_t pos_ = 0;
+    bool writable_ = false;
+    HostFsStats* stats_ = nullptr;
+};
+
+class FS {
+public:
+    bool begin(bool /*format_on_fail*/ = false) { return true; }
+    void end() {}
+    bool format() {
+        files_.clear();
+        return true;
+    }
+
+    bool exists(const char* path) const { return files_.count(path) != 0; }
+    bool exists(const String& path) const { return exists(path.c_str()); }
+
+    File open(const char* path, const char* mode = FILE_READ, bool create = false) {
+        ++stats_.opens;
+        const bool write = mode[0] == 'w' || mode[0] == 'a';
+        auto it = files_.find(path);
+        if (it == files_.end()) {
+            if (!write && !create) return File();
+            it = files_.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+        } else if (mode[0] == 'w') {
+            // Truncate: readers holding the old node keep their snapshot
+            it->second = std::make_shared<std::vector<uint8_t>>();
+        }
+        return File(it->second, path, write, mode[0] == 'a', &stats_);
+    }
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+
+    bool remove(const char* path) {
+        ++stats_.removes;
+        return files_.erase(path) != 0;
+    }
+    bool remove(const String& path) { return remove(path.c_str()); }
+
+    bool rename(const char* from, const char* to) {
+        auto it = files_.find(from);
+        if (it == files_.end()) return false;
+        ++stats_.renames;
+        auto node = it->second;
+        files_.erase(it);
+        files_[to] = std::move(node);
+        return true;
+    }
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+
+    bool mkdir(const char*) { return true; }
+    bool rmdir(const char*) { return true; }
+
+    size_t totalBytes() const { return 1024 * 1024; }
+    size_t usedBytes() const {
+        size_t used = 0;
+        for (const auto& entry : files_) used += entry.second->size();
+        return used;
+    }
+
+    const HostFsStats& stats() const { return stats_; }
+    void resetStats() { stats_ = HostFsStats{}; }
+
+private:
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files_;
+    HostFsStats stats_;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "FS.h"
+
+// Single in-memory volume standing in for the LittleFS partition
+inline fs::FS LittleFS;
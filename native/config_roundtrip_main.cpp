@@ -0,0 +1,305 @@
+// ConfigManager save/load round trip for the [env:native_config] build.
+//
+//   pio run -e native_config && .pio/build/native_config/program
+//
+// Runs the real config_manager.cpp against the in-memory LittleFS. Each
+// storage section (system, theme, wifi, page index, one page, each image
+// asset) is edited on its own and saved; the test checks that exactly that
+// section's file was rewritten, then reloads the config from the JSON
+// section files and from the binary snapshot and compares every field
+// with what was saved. A last pass feeds toJson() back through
+// updateFromJson(). Exit status is non-zero on any mismatch.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "config_manager.h"
+#include "config_snapshot.h"
+#include "version_auto.h"
+
+namespace {
+
+constexpr const char* kSnapshotPath = "/cfg_snapshot.bin";
+
+// Every file ConfigManager may write, other than its temp file
+std::vector<std::string> storagePaths() {
+    std::vector<std::string> paths = {"/cfg_system.json", "/cfg_theme.json", "/cfg_wifi.json", "/cfg_pages.json",
+                                      "/cfg_img_header.bin", "/cfg_img_splash.bin", "/cfg_img_background.bin",
+                                      "/cfg_img_sleep.bin", "/cfg_img_logo_v1.bin", "/cfg_img_sleep_v1.bin"};
+    char path[24];
+    for (std::size_t i = 0; i < MAX_PAGES; ++i) {
+        std::snprintf(path, sizeof(path), "/cfg_page_%02u.json", static_cast<unsigned>(i));
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+std::string readFile(const std::string& path) {
+    if (!LittleFS.exists(path.c_str())) return "<missing>";
+    File file = LittleFS.open(path.c_str(), FILE_READ);
+    std::string bytes(file.size(), '\0');
+    file.read(reinterpret_cast<uint8_t*>(&bytes[0]), bytes.size());
+    file.close();
+    return bytes;
+}
+
+std::map<std::string, std::string> storageImage() {
+    std::map<std::string, std::string> image;
+    for (const std::string& path : storagePaths()) image[path] = readFile(path);
+    return image;
+}
+
+// Encoded-field CRC of the whole config, image assets included
+uint32_t fingerprint(const DeviceConfig& config) { return configSectionCrc(config); }
+
+// base64 body (stored decoded) and a non-canonical one (stored verbatim)
+std::string lvImage(int seed) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string image = "lvimg:rgb565:16x16:";
+    for (int i = 0; i < 683; ++i) image += kAlphabet[(i * 7 + seed) % 64];
+    return image + "=";
+}
+
+ButtonConfig sampleButton(int n) {
+    ButtonConfig button;
+    button.id = "btn_" + std::to_string(n);
+    button.label = "Button \"" + std::to_string(n) + "\"";
+    button.color = "#10A0F0";
+    button.pressed_color = "#0050A0";
+    button.text_color = "#FFEEDD";
+    button.row = 1;
+    button.col = static_cast<uint8_t>(n % 3);
+    button.col_span = 1;
+    button.momentary = n % 2 == 0;
+    button.font_size = 28;
+    button.font_name = "montserrat_28";
+    button.text_align = "top-left";
+    button.corner_radius = 6;
+    button.border_width = 2;
+    button.border_color = "#123456";
+    button.can.enabled = true;
+    button.can.pgn = 0xFF01;
+    button.can.priority = 6;
+    button.can.source_address = 0x63;
+    button.can.destination_address = 0xFF;
+    button.can.data = {0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, static_cast<uint8_t>(n)};
+    button.can.length = 8;
+    button.can_off = button.can;
+    button.can_off.data = {0x00, 0x01, 0x02};
+    button.can_off.length = 3;
+    button.mode = "output";
+    button.scene_id = "scene_" + std::to_string(n);
+    button.scene_action = "toggle";
+    button.scene_duration_ms = 1500;
+    button.scene_release_off = true;
+    button.output_behavior.output_id = "out_" + std::to_string(n);
+    button.output_behavior.action = "toggle";
+    button.output_behavior.behavior_type = "flash";
+    button.output_behavior.target_value = 75;
+    button.output_behavior.period_ms = 400;
+    button.output_behavior.duty_cycle = 30;
+    button.output_behavior.fade_time_ms = 250;
+    button.output_behavior.hold_duration_ms = 2000;
+    button.output_behavior.on_time_ms = 60;
+    button.output_behavior.off_time_ms = 90;
+    button.output_behavior.auto_off = true;
+    button.infinitybox_function = "left_turn";
+    button.flash_frequency = 300;
+    button.fade_time = 700;
+    button.on_time = 900;
+    return button;
+}
+
+PageConfig samplePage(int n) {
+    PageConfig page;
+    page.id = "page_" + std::to_string(n);
+    page.name = "Page " + std::to_string(n);
+    page.nav_text = "P" + std::to_string(n);
+    page.nav_color = "#00FF00";
+    page.nav_inactive_color = "#004400";
+    page.nav_text_color = "#000000";
+    page.nav_button_radius = 8;
+    page.bg_color = "#101010";
+    page.text_color = "#EEEEEE";
+    page.button_color = "#202020";
+    page.button_pressed_color = "#303030";
+    page.button_border_color = "#404040";
+    page.button_border_width = 3;
+    page.button_radius = 9;
+    page.rows = 3;
+    page.cols = 3;
+    for (int b = 0; b < 3; ++b) page.buttons.push_back(sampleButton(n * 10 + b));
+    return page;
+}
+
+struct Section {
+    const char* name;
+    std::vector<std::string> files;  // Files the edit must rewrite; all others stay untouched
+    std::function<void(DeviceConfig&)> edit;
+};
+
+std::vector<Section> sections() {
+    return {
+        {"system: header", {"/cfg_system.json"},
+         [](DeviceConfig& c) {
+             c.header.title = "Rig \\ Control";
+             c.header.subtitle = "Line\nTwo";
+             c.header.show_logo = false;
+             c.header.title_font = "montserrat_30";
+             c.header.title_align = "left";
+             c.header.logo_position = "inline-left";
+             c.header.logo_target_height = 48;
+             c.header.logo_preserve_aspect = false;
+             c.header.nav_spacing = 20;
+         }},
+        {"system: display", {"/cfg_system.json"},
+         [](DeviceConfig& c) {
+             c.display.brightness = 40;
+             c.display.sleep_enabled = true;
+             c.display.sleep_timeout_seconds = 300;
+         }},
+        {"system: ota", {"/cfg_system.json"}, [](DeviceConfig& c) { c.ota.enabled = false; c.ota.channel = "beta"; }},
+        {"system: can library", {"/cfg_system.json"},
+         [](DeviceConfig& c) {
+             CanMessage msg;
+             msg.id = "msg_lights";
+             msg.name = "Lights";
+             msg.pgn = 0xFF02;
+             msg.priority = 5;
+             msg.source_address = 0x21;
+             msg.destination_address = 0x22;
+             msg.data = {1, 2, 3, 4, 5, 6, 7, 8};
+             msg.description = "Headlights on";
+             c.can_library.push_back(msg);
+         }},
+        {"system: can monitor pgns", {"/cfg_system.json"},
+         [](DeviceConfig& c) {
+             CanMonitorPgn ccvs;
+             ccvs.pgn = 0xFEF1;
+             ccvs.name = "CCVS";
+             c.can_monitor_pgns.push_back(ccvs);
+         }},
+        {"system: fonts", {"/cfg_system.json"},
+         [](DeviceConfig& c) { c.available_fonts.back().display_name = "UNSCII 16 (renamed)"; }},
+        {"theme", {"/cfg_theme.json"},
+         [](DeviceConfig& c) {
+             c.theme.bg_color = "#000001";
+             c.theme.accent_color = "#00FFAA";
+             c.theme.nav_button_text_color = "#ABCDEF";
+             c.theme.nav_button_radius = 5;
+             c.theme.button_radius = 7;
+             c.theme.border_width = 1;
+             c.theme.header_border_width = 4;
+         }},
+        {"wifi", {"/cfg_wifi.json"},
+         [](DeviceConfig& c) {
+             c.wifi.ap.ssid = "Rig-AP";
+             c.wifi.ap.password = "secret123";
+             c.wifi.sta.enabled = true;
+             c.wifi.sta.ssid = "Shop";
+             c.wifi.sta.password = "p\"w";
+         }},
+        {"page index + new page", {"/cfg_pages.json", "/cfg_page_01.json"},
+         [](DeviceConfig& c) { c.pages.push_back(samplePage(1)); }},
+        {"page 0", {"/cfg_page_00.json"}, [](DeviceConfig& c) { c.pages[0] = samplePage(0); }},
+        {"page 1 button", {"/cfg_page_01.json"},
+         [](DeviceConfig& c) { c.pages[1].buttons[2].output_behavior.duty_cycle = 80; }},
+        {"image: header logo", {"/cfg_img_header.bin"}, [](DeviceConfig& c) { c.images.header_logo = lvImage(1); }},
+        {"image: splash logo", {"/cfg_img_splash.bin"},
+         [](DeviceConfig& c) { c.images.splash_logo = "data:image/png;base64,not canonical!"; }},
+        {"image: background", {"/cfg_img_background.bin"},
+         [](DeviceConfig& c) { c.images.background_image = lvImage(2); }},
+        {"image: sleep logo", {"/cfg_img_sleep.bin"}, [](DeviceConfig& c) { c.images.sleep_logo = lvImage(3); }},
+        {"image: header.logo_base64", {"/cfg_img_logo_v1.bin"},
+         [](DeviceConfig& c) { c.header.logo_base64 = lvImage(4); }},
+        {"image: display.sleep_icon_base64", {"/cfg_img_sleep_v1.bin"},
+         [](DeviceConfig& c) { c.display.sleep_icon_base64 = lvImage(5); }},
+        {"page index: drop page", {"/cfg_pages.json", "/cfg_page_01.json"},
+         [](DeviceConfig& c) { c.pages.pop_back(); }},
+        {"image: clear background", {"/cfg_img_background.bin"},
+         [](DeviceConfig& c) { c.images.background_image.clear(); }},
+    };
+}
+
+int g_failures = 0;
+
+void check(bool ok, const char* section, const char* what) {
+    std::printf("  %-34s %-40s %s\n", section, what, ok ? "ok" : "FAIL");
+    g_failures += ok ? 0 : 1;
+}
+
+}  // namespace
+
+int main() {
+    Serial.setQuiet(true);
+    ConfigManager& manager = ConfigManager::instance();
+    std::printf("ConfigManager round trip (in-memory LittleFS)\n");
+
+    LittleFS.format();
+    check(manager.begin(), "defaults", "begin on empty flash");
+
+    for (const Section& section : sections()) {
+        DeviceConfig expected = manager.getConfig();
+        section.edit(expected);
+        const auto before = storageImage();
+
+        manager.getConfig() = expected;
+        check(manager.save(), section.name, "save");
+
+        // Only the edited section's files change
+        const auto after = storageImage();
+        bool isolated = true;
+        for (const auto& file : after) {
+            bool edited = false;
+            for (const std::string& path : section.files) edited = edited || path == file.first;
+            if (edited != (before.at(file.first) != file.second)) {
+                std::printf("    %s %s\n", file.first.c_str(), edited ? "not rewritten" : "rewritten");
+                isolated = false;
+            }
+        }
+        check(isolated, section.name, "rewrites only its own files");
+
+        // Boot from the JSON sections (no snapshot), then from the snapshot
+        // the first boot compiles
+        LittleFS.remove(kSnapshotPath);
+        manager.getConfig() = DeviceConfig{};
+        check(manager.begin() && fingerprint(manager.getConfig()) == fingerprint(expected), section.name,
+              "load from JSON sections");
+        check(LittleFS.exists(kSnapshotPath), section.name, "snapshot rebuilt after JSON boot");
+
+        const std::string system = readFile("/cfg_system.json");
+        LittleFS.remove("/cfg_system.json");
+        {
+            File stub = LittleFS.open("/cfg_system.json", FILE_WRITE);
+            stub.print("{\"schema\":1}");
+            stub.close();
+        }
+        manager.getConfig() = DeviceConfig{};
+        check(manager.begin() && fingerprint(manager.getConfig()) == fingerprint(expected), section.name,
+              "load from snapshot (JSON unread)");
+        File restore = LittleFS.open("/cfg_system.json", FILE_WRITE);
+        restore.write(reinterpret_cast<const uint8_t*>(system.data()), system.size());
+        restore.close();
+        manager.begin();
+    }
+
+    // The /api/config document decodes back to the same config
+    const DeviceConfig saved = manager.getConfig();
+    DynamicJsonDocument doc(512 * 1024);
+    std::string error;
+    const bool parsed = !deserializeJson(doc, manager.toJson());
+    manager.getConfig() = DeviceConfig{};
+    check(parsed && manager.updateFromJson(doc.as<JsonVariantConst>(), error) &&
+              fingerprint(manager.getConfig()) == fingerprint(saved),
+          "full document", "toJson -> updateFromJson");
+
+    std::printf("%s\n", g_failures == 0 ? "PASS" : "FAIL");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,491 @@
+// BehaviorEngine cross-task stress test for the [env:native_stress] build.
+//
+//   pio run -e native_stress && .pio/build/native_stress/program [seconds]
+//
+// Four threads stand in for the firmware tasks that share the engine:
+//
+//   engine   The behavior task: sleeps until woken or the next deadline,
+//            then update() and takeDirtyCells() as the synthesizer does
+//   ui       LVGL button handlers: setBehavior / deactivateOutput /
+//            activateScene (with a duration) / deactivateScene, back to back
+//   api      AsyncTCP handlers: the same controls interleaved with reads of
+//            snapshot() and the live output state, as serializeOutputStates
+//   config   Configuration REST calls: re-adding outputs, replacing and
+//            removing scenes, adding patterns, resolving IDs
+//
+// The build runs under ThreadSanitizer, which fails the run on any data
+// race. The test itself fails if a reader sees the snapshot version go
+// backwards, if any turn-off is refused (only turn-ons may be, when the
+// queue is full), or if the engine is not idle once every output and scene
+// has been deactivated at the end. Command -> frame latency is measured from
+// the post to the engine task collecting the dirty cell.
+//
+// A second phase drives Ipm1EffectScheduler the way Ipm1CanSystem does:
+//
+//   fx       The effect task: ticks the scheduler every kTickMs under the
+//            effect lock
+//   ui, api  Starting, retriggering and cancelling timed, flash and fade
+//            effects on random circuits, each at least 1,000 per second
+//
+// It fails if fewer than 1,000 starts or cancels per second get through, if
+// any allocation happens once the threads are running, if the set of
+// active effects ever disagrees with the timer wheel, or if anything is
+// still pending after every circuit is cancelled.
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ipm1_effect_scheduler.h"
+#include "output_behavior_engine.h"
+
+using namespace BehavioralOutput;
+
+namespace {
+std::atomic<uint64_t> g_allocs{0};
+}  // namespace
+
+// Counting replacements for the global allocator; malloc/free underneath
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void* operator new(std::size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+namespace {
+
+constexpr uint8_t kCells = 16;
+constexpr uint8_t kOutputsPerCellUsed = 4;
+constexpr int kScenes = 8;
+
+struct LatencyHistogram {
+    std::vector<uint32_t> samples;
+
+    void add(uint32_t us) { samples.push_back(us); }
+    uint32_t percentile(double p) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    }
+};
+
+// Engine task wakeup: the firmware uses a task notification
+struct Wake {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool pending = false;
+
+    void notify() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending = true;
+        }
+        cv.notify_one();
+    }
+
+    void wait(uint32_t ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::milliseconds(ms), [this] { return pending; });
+        pending = false;
+    }
+};
+
+String outputId(int index) { return "out_" + String(index); }
+String sceneId(int index) { return "scene_" + String(index); }
+
+OutputChannel makeOutput(int index) {
+    OutputChannel output;
+    output.id = outputId(index);
+    output.name = output.id;
+    output.cellAddress = static_cast<uint8_t>(1 + index / kOutputsPerCellUsed);
+    output.outputNumber = static_cast<uint8_t>(1 + index % kOutputsPerCellUsed);
+    return output;
+}
+
+Scene makeScene(int index, std::mt19937& rng) {
+    static const char* const kActions[] = {"behavior", "on", "off", "dim"};
+    Scene scene;
+    scene.id = sceneId(index);
+    scene.name = scene.id;
+    scene.exclusive = index == 0;
+    scene.duration_ms = index % 3 == 0 ? 50 : 0;
+    for (int i = 0; i < 4; ++i) {
+        SceneOutput sceneOutput;
+        sceneOutput.outputId = outputId(static_cast<int>(rng() % (kCells * kOutputsPerCellUsed)));
+        sceneOutput.action = kActions[rng() % 4];
+        sceneOutput.behavior.type = BehaviorType::FLASH;
+        sceneOutput.behavior.period_ms = 20;
+        scene.outputs.push_back(sceneOutput);
+    }
+    return scene;
+}
+
+BehaviorConfig randomBehavior(std::mt19937& rng) {
+    static const BehaviorType kTypes[] = {BehaviorType::STEADY, BehaviorType::FLASH, BehaviorType::STROBE,
+                                          BehaviorType::PULSE, BehaviorType::HOLD_TIMED, BehaviorType::PATTERN};
+    BehaviorConfig behavior;
+    behavior.type = kTypes[rng() % 6];
+    behavior.period_ms = static_cast<uint16_t>(10 + rng() % 40);
+    behavior.onTime_ms = 5;
+    behavior.offTime_ms = 5;
+    behavior.duration_ms = behavior.type == BehaviorType::HOLD_TIMED ? 30 : 0;
+    behavior.patternName = "blink";
+    return behavior;
+}
+
+// One control call from the UI or REST mix; `off` tells whether it was a
+// turn-off, which must never be refused
+ControlResult randomControl(BehaviorEngine& engine, std::mt19937& rng, bool& off) {
+    const int output = static_cast<int>(rng() % (kCells * kOutputsPerCellUsed));
+    off = false;
+    switch (rng() % 5) {
+        case 0:
+        case 1:
+            return engine.setBehavior(outputId(output), randomBehavior(rng));
+        case 2:
+            off = true;
+            return rng() % 32 ? engine.deactivateOutput(outputId(output)) : engine.deactivateAllOutputs();
+        case 3:
+            return engine.activateScene(sceneId(static_cast<int>(rng() % kScenes)),
+                                        rng() % 2 ? static_cast<int32_t>(rng() % 100) : -1);
+        default:
+            off = true;
+            return engine.deactivateScene(sceneId(static_cast<int>(rng() % kScenes)));
+    }
+}
+
+void report(const char* subsystem, const char* metric, double value, const char* unit) {
+    std::printf("  %-10s %-34s %12.1f %s\n", subsystem, metric, value, unit);
+}
+
+// ─── Effect scheduler phase ────────────────────────────────────────────────
+
+bool stressEffects(uint32_t seconds) {
+    using Kind = Ipm1EffectScheduler::Kind;
+    Ipm1EffectScheduler effects;
+    std::mutex effect_lock;   // Ipm1CanSystem::lockEffects()
+
+    // Written by whichever thread holds the effect lock
+    std::array<uint8_t, Ipm1EffectScheduler::kSlots> outputs{};
+    uint32_t output_writes = 0;
+    uint32_t wheel_mismatches = 0;
+    uint32_t ticks = 0;
+    auto output = [&](std::size_t slot, uint16_t, uint16_t, uint8_t value) {
+        outputs[slot] = value;
+        ++output_writes;
+    };
+
+    std::atomic<bool> running{true};
+    std::atomic<int> started_threads{0};
+    std::atomic<uint32_t> starts{0};
+    std::atomic<uint32_t> retriggers{0};
+    std::atomic<uint32_t> cancels{0};
+
+    std::thread fx_thread([&]() {
+        started_threads.fetch_add(1);
+        auto next = std::chrono::steady_clock::now();
+        while (running.load()) {
+            next += std::chrono::milliseconds(Ipm1EffectScheduler::kTickMs);
+            std::this_thread::sleep_until(next);
+            std::lock_guard<std::mutex> lock(effect_lock);
+            effects.tick(millis(), output);
+            std::size_t active = 0;
+            for (std::size_t slot = 0; slot < Ipm1EffectScheduler::kSlots; ++slot) active += effects.active(slot);
+            if (active != effects.pending()) ++wheel_mismatches;
+            ++ticks;
+        }
+    });
+
+    // One start (or retrigger) and one cancel per millisecond
+    auto control_loop = [&](uint32_t seed) {
+        std::mt19937 rng(seed);
+        started_threads.fetch_add(1);
+        auto next = std::chrono::steady_clock::now();
+        while (running.load()) {
+            Ipm1EffectScheduler::Effect effect;
+            effect.mask = static_cast<uint16_t>(1u << (rng() % 10));
+            switch (rng() % 4) {
+                case 0:
+                    effect.kind = Kind::Timed;
+                    effect.duration_ms = 10 + rng() % 200;
+                    break;
+                case 1:
+                    effect.kind = Kind::Flash;
+                    effect.period_ms = 10 + rng() % 100;
+                    break;
+                case 2:
+                    effect.kind = Kind::Flash;
+                    effect.period_ms = 10 + rng() % 50;
+                    effect.duration_ms = 50 + rng() % 300;
+                    break;
+                default:
+                    effect.kind = Kind::Fade;
+                    effect.period_ms = (100 + rng() % 1000) / Ipm1EffectScheduler::kFadeSteps;
+                    effect.target_pwm = static_cast<uint8_t>(rng());
+                    break;
+            }
+            const std::size_t slot = rng() % Ipm1EffectScheduler::kSlots;
+            const std::size_t victim = rng() % Ipm1EffectScheduler::kSlots;
+            {
+                std::lock_guard<std::mutex> lock(effect_lock);
+                if (effects.active(slot)) retriggers.fetch_add(1);
+                effects.start(slot, effect, millis(), output);
+            }
+            starts.fetch_add(1);
+            {
+                std::lock_guard<std::mutex> lock(effect_lock);
+                effects.cancel(victim);
+            }
+            cancels.fetch_add(1);
+            next += std::chrono::microseconds(1000);
+            std::this_thread::sleep_until(next);
+        }
+    };
+
+    std::thread ui_thread(control_loop, 5);
+    std::thread api_thread(control_loop, 6);
+    while (started_threads.load() < 3) std::this_thread::yield();
+
+    // Thread start-up is the last allocation allowed
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const uint64_t allocs_before = g_allocs.load();
+    const auto start = std::chrono::steady_clock::now();
+    const uint32_t starts_before = starts.load();
+    const uint32_t cancels_before = cancels.load();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint32_t steady_starts = starts.load() - starts_before;
+    const uint32_t steady_cancels = cancels.load() - cancels_before;
+    const uint64_t steady_allocs = g_allocs.load() - allocs_before;
+
+    running.store(false);
+    ui_thread.join();
+    api_thread.join();
+    fx_thread.join();
+
+    for (std::size_t slot = 0; slot < Ipm1EffectScheduler::kSlots; ++slot) effects.cancel(slot);
+    const bool drained = effects.empty() && effects.pending() == 0;
+
+    std::printf("Effect scheduler stress: %us, ui + api threads against the effect task\n", seconds);
+    report("effects", "starts/s", steady_starts / elapsed_s, "");
+    report("effects", "cancels/s", steady_cancels / elapsed_s, "");
+    report("effects", "retriggers", retriggers.load(), "");
+    report("effects", "output writes", output_writes, "");
+    report("effects", "ticks", ticks, "");
+    report("effects", "active/wheel mismatches", wheel_mismatches, "");
+    report("effects", "allocations while running", static_cast<double>(steady_allocs), "");
+    report("effects", "pending after cancel-all", drained ? 0 : 1, "");
+
+    return steady_starts >= 1000 * elapsed_s && steady_cancels >= 1000 * elapsed_s && steady_allocs == 0 &&
+           wheel_mismatches == 0 && drained && ticks > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const uint32_t seconds = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 5;
+    Serial.setQuiet(true);
+
+    BehaviorEngine engine;
+    Wake wake;
+    engine.setWakeCallback([&wake]() { wake.notify(); });
+
+    std::mt19937 setup_rng(1);
+    for (int i = 0; i < kCells * kOutputsPerCellUsed; ++i) {
+        engine.addOutput(makeOutput(i));
+    }
+    Pattern blink;
+    blink.name = "blink";
+    blink.loop = true;
+    blink.loopCount = 0;
+    blink.steps = {{255, 10, false}, {0, 10, false}};
+    engine.addPattern(blink);
+    for (int i = 0; i < kScenes; ++i) {
+        engine.addScene(makeScene(i, setup_rng));
+    }
+
+    // Press then release with the queue full of turn-ons (before the engine
+    // task runs): the release must still get through and win
+    bool release_won = false;
+    {
+        BehaviorConfig steady;
+        int pressed = 0;
+        while (engine.setBehavior(outputId(pressed % (kCells * kOutputsPerCellUsed)), steady)) ++pressed;
+        const bool release_accepted = engine.deactivateOutput(outputId(0));
+        engine.update();
+        const auto current = engine.snapshot();
+        const OutputChannel* first = current->findOutput(outputId(0));
+        const OutputChannel* second = current->findOutput(outputId(1));
+        release_won = release_accepted && pressed >= 2 && first && second && !engine.isOutputActive(*first) &&
+                      engine.isOutputActive(*second);
+        engine.deactivateAllOutputs();
+        engine.update();
+    }
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> engine_running{true};
+    std::atomic<uint32_t> posted{0};
+    std::atomic<uint32_t> refused{0};
+    std::atomic<uint32_t> refused_offs{0};
+    std::atomic<uint32_t> snapshot_reads{0};
+    std::atomic<uint32_t> version_regressions{0};
+    std::atomic<uint32_t> config_changes{0};
+    std::atomic<uint32_t> scene_callbacks{0};
+    std::atomic<uint32_t> max_post_us{0};
+    LatencyHistogram latency;   // Engine thread only until joined
+    uint32_t engine_passes = 0;
+
+    engine.setSceneActivatedCallback([&](const Scene&) { scene_callbacks.fetch_add(1); });
+    engine.setSceneDeactivatedCallback([&](const Scene&) { scene_callbacks.fetch_add(1); });
+
+    std::thread engine_thread([&]() {
+        std::array<CellOutputs, kMaxCellAddress + 1> cells{};
+        while (engine_running.load()) {
+            engine.update();
+            const uint32_t dirty = engine.takeDirtyCells(cells);
+            const uint32_t now = micros();
+            for (uint8_t cell = 1; cell <= kMaxCellAddress; ++cell) {
+                if (dirty & (1u << cell)) latency.add(now - cells[cell].eventUs);
+            }
+            ++engine_passes;
+            const uint32_t wait_ms = engine.msUntilNextDeadline(millis());
+            if (wait_ms != 0) wake.wait(std::min<uint32_t>(wait_ms, 5));
+        }
+    });
+
+    auto control_loop = [&](uint32_t seed, bool read_state) {
+        std::mt19937 rng(seed);
+        uint32_t last_version = 0;
+        while (running.load()) {
+            const uint32_t start = micros();
+            bool off = false;
+            const ControlResult result = randomControl(engine, rng, off);
+            const uint32_t took = micros() - start;
+            uint32_t seen = max_post_us.load();
+            while (took > seen && !max_post_us.compare_exchange_weak(seen, took)) {
+            }
+            (result ? posted : refused).fetch_add(1);
+            // Config churn can briefly hide a scene being replaced; only a
+            // full queue counts against turn-offs
+            if (off && result.code == ControlResult::QueueFull) refused_offs.fetch_add(1);
+
+            if (read_state) {
+                const auto snapshot = engine.snapshot();
+                if (snapshot->version < last_version) version_regressions.fetch_add(1);
+                last_version = snapshot->version;
+                uint32_t active = 0;
+                for (const auto& [id, output] : snapshot->outputs) {
+                    active += engine.isOutputActive(output) + engine.outputState(output);
+                    active += engine.outputBehavior(output).type == BehaviorType::FLASH;
+                }
+                for (const auto& [id, scene] : snapshot->scenes) {
+                    active += engine.isSceneActive(scene) + static_cast<uint32_t>(scene.outputs.size());
+                }
+                (void)active;
+                snapshot_reads.fetch_add(1);
+            }
+            if (rng() % 64 == 0) std::this_thread::yield();
+        }
+    };
+
+    std::thread ui_thread(control_loop, 2, false);
+    std::thread api_thread(control_loop, 3, true);
+    std::thread config_thread([&]() {
+        std::mt19937 rng(4);
+        while (running.load()) {
+            switch (rng() % 5) {
+                case 0:
+                    engine.addOutput(makeOutput(static_cast<int>(rng() % (kCells * kOutputsPerCellUsed))));
+                    break;
+                case 1:
+                    engine.addScene(makeScene(static_cast<int>(rng() % kScenes), rng));
+                    break;
+                case 2: {
+                    const int scene = static_cast<int>(rng() % kScenes);
+                    engine.removeScene(sceneId(scene));
+                    engine.addScene(makeScene(scene, rng));
+                    break;
+                }
+                case 3:
+                    engine.addPattern(blink);
+                    break;
+                default:
+                    (void)engine.resolveOutput(outputId(static_cast<int>(rng() % (kCells * kOutputsPerCellUsed))));
+                    break;
+            }
+            config_changes.fetch_add(1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running.store(false);
+    ui_thread.join();
+    api_thread.join();
+    config_thread.join();
+
+    // Quiesce: everything off in one shot (turn-offs are never refused, even
+    // with the queue still full of turn-ons), then let the engine drain
+    const auto final_config = engine.snapshot();
+    for (const auto& [id, scene] : final_config->scenes) {
+        if (!engine.deactivateScene(id)) refused_offs.fetch_add(1);
+    }
+    if (!engine.deactivateAllOutputs()) refused_offs.fetch_add(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    engine_running.store(false);
+    wake.notify();
+    engine_thread.join();
+    engine.update();
+
+    uint32_t still_active = 0;
+    const auto final_state = engine.snapshot();
+    for (const auto& [id, output] : final_state->outputs) {
+        still_active += engine.isOutputActive(output) || engine.outputState(output);
+    }
+    for (const auto& [id, scene] : final_state->scenes) {
+        still_active += engine.isSceneActive(scene);
+    }
+    const bool idle = engine.msUntilNextDeadline(millis()) == BehaviorEngine::kNoDeadline;
+
+    std::printf("Engine stress: %us, ui + api + config threads against the engine task\n", seconds);
+    report("control", "commands posted", posted.load(), "");
+    report("control", "refused (queue full)", refused.load(), "");
+    report("control", "turn-offs refused", refused_offs.load(), "");
+    report("control", "release wins over a full queue", release_won ? 1 : 0, "");
+    report("control", "max time in a control call", max_post_us.load(), "us");
+    report("engine", "passes", engine_passes, "");
+    report("engine", "scene callbacks", scene_callbacks.load(), "");
+    report("engine", "frame latency p50", latency.percentile(0.50), "us");
+    report("engine", "frame latency p99", latency.percentile(0.99), "us");
+    report("engine", "frame latency max", latency.percentile(1.0), "us");
+    report("readers", "snapshot reads", snapshot_reads.load(), "");
+    report("readers", "snapshot version regressions", version_regressions.load(), "");
+    report("config", "configuration changes", config_changes.load(), "");
+    report("final", "outputs/scenes still active", still_active, "");
+    report("final", "deadlines pending", idle ? 0 : 1, "");
+
+    const bool engine_pass = version_regressions.load() == 0 && refused_offs.load() == 0 && release_won &&
+                             still_active == 0 && idle && posted.load() > 0;
+    const bool pass = stressEffects(seconds) && engine_pass;
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Host stand-in for esp_heap_caps.h: one heap, capabilities ignored
+constexpr uint32_t MALLOC_CAP_SPIRAM = 1u << 10;
+
+inline void* heap_caps_malloc(std::size_t size, uint32_t) { return std::malloc(size); }
+inline void* heap_caps_calloc(std::size_t count, std::size_t size, uint32_t) { return std::calloc(count, size); }
+inline void heap_caps_free(void* ptr) { std::free(ptr); }
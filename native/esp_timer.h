@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdint>
+
+#include "host_clock.h"
+
+// Host stand-in for esp_timer.h: the microsecond clock only
+inline int64_t esp_timer_get_time() { return static_cast<int64_t>(HostClock::nowUs()); }
@@ -0,0 +1,161 @@
+#pragma once
+
+// Host stand-in for the FreeRTOS API the firmware uses, for the
+// [env:native] build. Arduino-ESP32 pulls this in through Arduino.h, as
+// the real core does; freertos/task.h and freertos/semphr.h include it.
+//
+// Tasks are detached threads. Critical sections are a spinlock. Task
+// notifications and semaphores are a mutex and condition variable each.
+// Delays follow HostClock, so they advance a manual clock instead of
+// sleeping. Blocking waits (semaphore take, notify take) always use real
+// time, so code that blocks on them needs HostClock in real mode.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "host_clock.h"
+
+using TickType_t = uint32_t;
+using BaseType_t = int;
+using UBaseType_t = unsigned;
+constexpr BaseType_t pdFALSE = 0;
+constexpr BaseType_t pdTRUE = 1;
+constexpr BaseType_t pdPASS = pdTRUE;
+constexpr TickType_t portMAX_DELAY = 0xFFFFFFFF;
+
+// 1 kHz tick, as configured on the device
+constexpr TickType_t pdMS_TO_TICKS(uint32_t ms) { return ms; }
+
+// ─── Critical sections ─────────────────────────────────────────────────────
+
+struct portMUX_TYPE {
+    std::atomic_flag locked = ATOMIC_FLAG_INIT;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+inline void portENTER_CRITICAL(portMUX_TYPE* mux) {
+    while (mux->locked.test_and_set(std::memory_order_acquire)) {
+    }
+}
+inline void portEXIT_CRITICAL(portMUX_TYPE* mux) { mux->locked.clear(std::memory_order_release); }
+
+// ─── Blocking primitive ────────────────────────────────────────────────────
+
+namespace HostRtos {
+
+// Counting wait object: semaphores and the per-task notification value
+struct Waitable {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t count = 0;
+
+    // Waits up to `ticks` for a non-zero count; `clear` takes all of it
+    uint32_t take(TickType_t ticks, bool clear) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto ready = [this] { return count != 0; };
+        if (ticks == portMAX_DELAY) {
+            cv.wait(lock, ready);
+        } else if (!cv.wait_for(lock, std::chrono::milliseconds(ticks), ready)) {
+            return 0;
+        }
+        const uint32_t taken = clear ? count : 1;
+        count -= taken;
+        return taken;
+    }
+
+    void give(uint32_t max_count) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count < max_count) {
+                ++count;
+            }
+        }
+        cv.notify_one();
+    }
+};
+
+}  // namespace HostRtos
+
+// ─── Tasks ─────────────────────────────────────────────────────────────────
+
+struct tskTaskControlBlock {
+    HostRtos::Waitable notification;
+};
+using TaskHandle_t = tskTaskControlBlock*;
+
+namespace HostRtos {
+
+inline thread_local TaskHandle_t t_current = nullptr;
+
+// Threads not started through xTaskCreatePinnedToCore (main, bench
+// drivers) get a control block on first use
+inline TaskHandle_t currentTask() {
+    if (!t_current) {
+        t_current = new tskTaskControlBlock;
+    }
+    return t_current;
+}
+
+}  // namespace HostRtos
+
+inline BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char*, uint32_t, void* param, UBaseType_t,
+                                          TaskHandle_t* handle, int) {
+    TaskHandle_t tcb = new tskTaskControlBlock;
+    if (handle) *handle = tcb;
+    std::thread([task, param, tcb] {
+        HostRtos::t_current = tcb;
+        task(param);
+    }).detach();
+    return pdPASS;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return HostRtos::currentTask(); }
+inline TickType_t xTaskGetTickCount() { return static_cast<TickType_t>(HostClock::nowUs() / 1000); }
+inline void vTaskDelay(TickType_t ticks) { HostClock::sleepUs(static_cast<uint64_t>(ticks) * 1000); }
+
+inline void vTaskDelayUntil(TickType_t* previous_wake, TickType_t increment) {
+    const TickType_t wake = *previous_wake + increment;
+    const TickType_t now = xTaskGetTickCount();
+    if (static_cast<int32_t>(wake - now) > 0) {
+        vTaskDelay(wake - now);
+    }
+    *previous_wake = wake;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    task->notification.give(UINT32_MAX);
+    return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    return HostRtos::currentTask()->notification.take(ticks, clear_on_exit != pdFALSE);
+}
+
+// ─── Semaphores ────────────────────────────────────────────────────────────
+// Binary semaphores and (non-recursive, no priority inheritance) mutexes
+
+struct QueueDefinition {
+    HostRtos::Waitable waitable;
+};
+using SemaphoreHandle_t = QueueDefinition*;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new QueueDefinition; }
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+    SemaphoreHandle_t semaphore = new QueueDefinition;
+    semaphore->waitable.count = 1;
+    return semaphore;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    return semaphore->waitable.take(ticks, false) ? pdTRUE : pdFALSE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    semaphore->waitable.give(1);
+    return pdTRUE;
+}
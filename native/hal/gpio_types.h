@@ -0,0 +1,8 @@
+#pragma once
+
+// Host stand-in for hal/gpio_types.h: pin numbers only
+enum gpio_num_t : int {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_MAX = 49,
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+// Time source behind millis()/micros()/delay() on the native build.
+//
+// Real mode follows the host's steady clock from process start. Manual mode
+// freezes time until a benchmark or simulation advances it, so timer and
+// keepalive behaviour is deterministic and runs faster than real time.
+namespace HostClock {
+
+inline std::atomic<bool> g_manual{false};
+inline std::atomic<uint64_t> g_manual_us{0};
+
+inline uint64_t realUs() {
+    static const auto start = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+inline uint64_t nowUs() { return g_manual.load(std::memory_order_relaxed) ? g_manual_us.load() : realUs(); }
+
+// Manual mode starts at `start_us`
+inline void setManual(uint64_t start_us = 0) {
+    g_manual_us.store(start_us);
+    g_manual.store(true);
+}
+
+inline void setReal() { g_manual.store(false); }
+
+inline void advanceUs(uint64_t us) { g_manual_us.fetch_add(us); }
+
+inline void sleepUs(uint64_t us) {
+    if (g_manual.load(std::memory_order_relaxed)) {
+        advanceUs(us);
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(us));
+    }
+}
+
+}  // namespace HostClock
@@ -0,0 +1,421 @@
+// Headless soak test for the [env:native_soak] build.
+//
+//   pio run -e native_soak && .pio/build/native_soak/program [seconds] [options]
+//
+//     --load PCT       Background traffic, % of the bus (default 100)
+//     --replay FILE    Background traffic from a binary trace (recorder
+//                      spill or format=bin export) instead of filler frames
+//     --speed X        Replay speed, 0 = as fast as the bus takes it (default 1)
+//     --cmd-ms N       Mean interval between output commands per cell (default 100)
+//     --rx-stall MS    Block the RX task for MS once a second (flash write, UI)
+//     --errors RATE    Bus error rate, 0..0.99
+//
+// Drives 16 virtual cells (14 Powercells, 2 inMotion, plus 2 Mastercells
+// adding input traffic) through a model of the firmware's CAN path built
+// from its own parts: the PowercellShadow, Critical/Periodic TX lanes of
+// MpscRing<CanPath::TxRequest>, the TWAI TX queue and single transmit
+// buffer, and the driver RX queue drained by the RX task, decoded with
+// CanPath::decodePowercellStatusPgn. Sizes and timings come from
+// can_path_config.h, the header CanManager takes them from. Each command is timed from the shadow write to
+// the RX task decoding a status frame that shows the cell in the commanded
+// state. Time is simulated in kStepUs steps on the manual clock, so runs
+// are repeatable and a minute of saturated bus takes a second or two.
+//
+// Commands cover every output state, OUT4+OUT8 alone included. Exit status
+// is non-zero if any cell hit its LOC timeout, a command was dropped, a
+// Track frame identical to the status poll went out on the bus, or a
+// cell's final outputs disagree with the shadow (other than a cell the
+// shadow is holding back at that alias).
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "can_path_config.h"
+#include "can_replay.h"
+#include "ipm1_can_library.h"
+#include "mpsc_ring.h"
+#include "powercell_shadow.h"
+#include "virtual_can_bus.h"
+#include "virtual_powercell.h"
+
+namespace {
+
+constexpr uint64_t kStepUs = 50;
+constexpr uint64_t kKeepaliveUs = 1000000;
+constexpr uint64_t kRxTaskPeriodUs = 1000;        // can_rx_task wakes at most once per tick under load
+constexpr uint8_t kFirmwareNode = Ipm1Can::kSourceAddress;
+constexpr uint8_t kLoadNode = 0x01;
+constexpr uint8_t kCommandCells = 16;
+
+struct Options {
+    uint32_t seconds = 60;
+    uint32_t load_pct = 100;
+    const char* replay_path = nullptr;
+    double speed = 1.0;
+    uint32_t cmd_ms = 100;
+    uint32_t rx_stall_ms = 0;
+    double error_rate = 0.0;
+};
+
+uint32_t j1939Id(const CanFrameConfig& frame) {
+    return (static_cast<uint32_t>(frame.priority & 0x7) << 26) | ((frame.pgn & 0x3FFFF) << 8) | frame.source_address;
+}
+
+uint32_t statusPgn(const VirtualCanFrame& frame) { return (frame.id >> 8) & 0x3FFFF; }
+
+// The status poll, byte for byte (Ipm1Can::powercellPoll)
+bool isPollFrame(const VirtualCanFrame& frame) {
+    static const CanFrameConfig poll = Ipm1Can::powercellPoll(1);
+    const uint32_t pgn = statusPgn(frame);
+    return pgn > 0xFF00 && pgn <= 0xFF10 && std::equal(poll.data.begin(), poll.data.end(), frame.data);
+}
+
+struct LatencyHistogram {
+    std::vector<uint32_t> samples;
+
+    void add(uint64_t us) { samples.push_back(static_cast<uint32_t>(std::min<uint64_t>(us, UINT32_MAX))); }
+    uint32_t percentile(double p) {
+        if (samples.empty()) return 0;
+        std::sort(samples.begin(), samples.end());
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    }
+    double average() const {
+        double sum = 0;
+        for (uint32_t s : samples) sum += s;
+        return samples.empty() ? 0.0 : sum / samples.size();
+    }
+};
+
+// The firmware's CAN path, reduced to its queues and their limits
+struct FirmwareModel {
+    PowercellShadow shadow;
+    MpscRing<CanPath::TxRequest, CanPath::kTxLaneSize> critical;
+    MpscRing<CanPath::TxRequest, CanPath::kTxLaneSize> periodic;
+    std::deque<VirtualCanFrame> driver_tx;
+    std::deque<VirtualCanFrame> driver_rx;
+
+    std::array<uint16_t, kCommandCells + 1> reported{};
+    std::array<uint64_t, kCommandCells + 1> pending_since{};  // 0 = no command awaiting feedback
+    LatencyHistogram latency;
+
+    uint64_t commands = 0;
+    uint64_t alias_commands = 0;    // Left the desired state at OUT4+OUT8 alone
+    uint64_t tx_lane_drops = 0;
+    uint64_t rx_drops = 0;
+    uint64_t rx_frames = 0;
+    size_t rx_max_depth = 0;
+    uint64_t stall_until_us = 0;
+
+    void command(uint8_t cell, uint16_t mask, uint16_t outputs, uint64_t now_us) {
+        shadow.write(cell, mask, outputs, true, static_cast<uint32_t>(now_us));
+        ++commands;
+        // Timed from the first write the cell has not yet confirmed; a write
+        // that leaves the desired state where the cell already reports it
+        // has nothing to confirm, and neither does the poll alias, which
+        // the shadow holds back
+        if (PowercellShadow::aliasesPoll(shadow.desired(cell))) {
+            ++alias_commands;
+            pending_since[cell] = 0;
+        } else if (shadow.desired(cell) == reported[cell]) {
+            pending_since[cell] = 0;
+        } else if (!pending_since[cell]) {
+            pending_since[cell] = now_us;
+        }
+    }
+
+    // TX task: flush the coalesced shadow into the lanes, then refill the
+    // driver queue Critical first
+    void serviceTx(uint64_t now_us) {
+        if (shadow.pending() && shadow.holdUs(static_cast<uint32_t>(now_us), CanPath::kPowercellCoalesceUs) == 0) {
+            shadow.collect([&](uint8_t cell, uint16_t outputs, bool urgent) {
+                const CanFrameConfig track = Ipm1Can::powercellTrack(cell, outputs);
+                CanPath::TxRequest request;
+                request.identifier = j1939Id(track);
+                request.extended = true;
+                request.length = track.length;
+                request.enqueue_us = static_cast<uint32_t>(now_us);
+                std::copy(track.data.begin(), track.data.end(), request.data);
+                if ((urgent ? critical : periodic).push(request)) return true;
+                ++tx_lane_drops;
+                return false;
+            });
+        }
+        CanPath::TxRequest request;
+        while (driver_tx.size() < CanPath::kDriverTxQueueLen && (critical.pop(request) || periodic.pop(request))) {
+            VirtualCanFrame frame;
+            frame.id = request.identifier;
+            frame.extended = request.extended;
+            frame.dlc = request.length;
+            frame.node = kFirmwareNode;
+            std::memcpy(frame.data, request.data, sizeof(frame.data));
+            driver_tx.push_back(frame);
+        }
+    }
+
+    // TWAI: one frame in the transmit buffer at a time
+    void serviceDriver(VirtualCanBus& bus) {
+        if (!driver_tx.empty() && bus.pendingCount(kFirmwareNode) == 0) {
+            bus.transmit(driver_tx.front());
+            driver_tx.pop_front();
+        }
+    }
+
+    // Driver RX queue behind the planned hardware filter (status PGNs only)
+    void onFrame(const VirtualCanFrame& frame) {
+        uint8_t cell = 0;
+        uint8_t bank = 0;
+        if (frame.node == kFirmwareNode || !CanPath::decodePowercellStatusPgn(statusPgn(frame), cell, bank)) return;
+        if (driver_rx.size() >= CanPath::kDriverRxQueueLen) {
+            ++rx_drops;
+            return;
+        }
+        driver_rx.push_back(frame);
+        rx_max_depth = std::max(rx_max_depth, driver_rx.size());
+    }
+
+    void serviceRx(uint64_t now_us) {
+        if (now_us < stall_until_us) return;
+        while (!driver_rx.empty() && driver_rx.front().rx_us <= now_us) {
+            const VirtualCanFrame frame = driver_rx.front();
+            driver_rx.pop_front();
+            ++rx_frames;
+
+            uint8_t cell = 0;
+            uint8_t bank = 0;
+            CanPath::decodePowercellStatusPgn(statusPgn(frame), cell, bank);
+            if (cell > kCommandCells) continue;
+            for (uint8_t i = 0; i < 5; ++i) {
+                const uint16_t bit = static_cast<uint16_t>(1u << (bank - 1 + i));
+                reported[cell] = (frame.data[0] & (0x80 >> i)) ? (reported[cell] | bit) : (reported[cell] & ~bit);
+            }
+            if (pending_since[cell] && reported[cell] == shadow.desired(cell)) {
+                latency.add(now_us - pending_since[cell]);
+                pending_since[cell] = 0;
+            }
+        }
+    }
+};
+
+bool loadTrace(const char* host_path, const char* fs_path) {
+    std::ifstream in(host_path, std::ios::binary);
+    if (!in) return false;
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    fs::File file = LittleFS.open(fs_path, FILE_WRITE);
+    file.write(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    file.close();
+    return true;
+}
+
+void report(const char* subsystem, const char* metric, double value, const char* unit) {
+    std::printf("  %-10s %-34s %12.1f %s\n", subsystem, metric, value, unit);
+}
+
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "0";
+        if (std::strcmp(arg, "--load") == 0) {
+            options.load_pct = std::min<uint32_t>(static_cast<uint32_t>(std::atoi(value)), 100);
+            ++i;
+        } else if (std::strcmp(arg, "--replay") == 0) {
+            options.replay_path = value;
+            ++i;
+        } else if (std::strcmp(arg, "--speed") == 0) {
+            options.speed = std::atof(value);
+            ++i;
+        } else if (std::strcmp(arg, "--cmd-ms") == 0) {
+            options.cmd_ms = std::max(1, std::atoi(value));
+            ++i;
+        } else if (std::strcmp(arg, "--rx-stall") == 0) {
+            options.rx_stall_ms = static_cast<uint32_t>(std::atoi(value));
+            ++i;
+        } else if (std::strcmp(arg, "--errors") == 0) {
+            options.error_rate = std::atof(value);
+            ++i;
+        } else {
+            options.seconds = static_cast<uint32_t>(std::strtoul(arg, nullptr, 10));
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parseOptions(argc, argv);
+    Serial.setQuiet(true);
+    HostClock::setManual(1000000);
+
+    VirtualCanBus bus(250000, 7);
+    VirtualCanBus::Faults faults;
+    faults.error_rate = options.error_rate;
+    bus.setFaults(faults);
+
+    FirmwareModel firmware;
+    std::vector<std::unique_ptr<VirtualCell>> cells;
+    for (uint8_t address = 1; address <= kCommandCells; ++address) {
+        const auto kind = address > kCommandCells - 2 ? VirtualCellKind::InMotion : VirtualCellKind::Powercell;
+        cells.push_back(std::make_unique<VirtualCell>(kind, address));
+    }
+    for (uint8_t address = 1; address <= 2; ++address) {
+        cells.push_back(std::make_unique<VirtualCell>(VirtualCellKind::Mastercell, address));
+    }
+    uint64_t poll_alias_on_bus = 0;   // Track frames from the firmware that read as a poll
+    bus.addReceiver([&](const VirtualCanFrame& frame) {
+        if (frame.node == kFirmwareNode && isPollFrame(frame)) ++poll_alias_on_bus;
+        firmware.onFrame(frame);
+        for (auto& cell : cells) cell->onFrame(frame);
+    });
+
+    // Background traffic: lowest-priority filler at load_pct of the wire,
+    // or a recorded trace replayed onto it
+    CanTraceFileSource trace;
+    CanReplayPlayer player;
+    if (options.replay_path) {
+        if (!loadTrace(options.replay_path, "/soak_trace.bin") || !trace.open(LittleFS, "/soak_trace.bin")) {
+            std::fprintf(stderr, "soak: %s is not a readable trace file\n", options.replay_path);
+            return 2;
+        }
+        CanReplayOptions replay;
+        replay.speed_permille = static_cast<uint32_t>(options.speed * 1000.0 + 0.5);
+        replay.loop = true;
+        player.start(&trace, replay, HostClock::nowUs());
+    }
+    VirtualCanFrame filler;
+    filler.id = (7u << 26) | (0xFEF1u << 8) | kLoadNode;
+    filler.node = kLoadNode;
+    const uint64_t filler_interval_us =
+        options.load_pct ? bus.frameTimeUs(filler) * 100ull / options.load_pct : UINT64_MAX;
+    uint64_t next_filler_us = HostClock::nowUs();
+
+    std::mt19937 rng(42);
+    std::exponential_distribution<double> command_gap(1.0 / (options.cmd_ms * 1000.0));
+    std::array<uint64_t, kCommandCells + 1> next_command{};
+    std::array<uint64_t, kCommandCells + 1> next_keepalive{};
+    for (uint8_t cell = 1; cell <= kCommandCells; ++cell) {
+        next_command[cell] = HostClock::nowUs() + static_cast<uint64_t>(command_gap(rng));
+        next_keepalive[cell] = HostClock::nowUs() + kKeepaliveUs + cell * 1000u;
+    }
+
+    const uint64_t start_us = HostClock::nowUs();
+    const uint64_t end_us = start_us + static_cast<uint64_t>(options.seconds) * 1000000;
+    const uint64_t settle_us = end_us + 500000;  // Stop commanding, let feedback land
+    uint64_t next_rx_us = start_us;
+    uint64_t next_stall_us = start_us + 1000000;
+    uint64_t load_frames = 0;
+
+    for (uint64_t now = start_us; now < settle_us; now += kStepUs) {
+        HostClock::setManual(now);
+
+        for (uint8_t cell = 1; cell <= kCommandCells; ++cell) {
+            if (now < end_us && now >= next_command[cell]) {
+                const uint16_t bit = static_cast<uint16_t>(1u << (rng() % 10));
+                firmware.command(cell, bit, (rng() & 1) ? bit : 0, now);
+                next_command[cell] = now + 1 + static_cast<uint64_t>(command_gap(rng));
+            }
+            if (now >= next_keepalive[cell]) {
+                firmware.shadow.write(cell, 0, 0, false, static_cast<uint32_t>(now));
+                next_keepalive[cell] += kKeepaliveUs;
+            }
+        }
+        firmware.serviceTx(now);
+        firmware.serviceDriver(bus);
+
+        if (options.replay_path) {
+            player.service(now, [&](const CanTraceRecord& record) {
+                if (bus.pendingCount(kLoadNode) >= CanPath::kDriverTxQueueLen) return false;
+                VirtualCanFrame frame;
+                frame.id = record.identifier;
+                frame.extended = (record.flags & kCanTraceExtended) != 0;
+                frame.dlc = record.length;
+                frame.node = kLoadNode;
+                std::memcpy(frame.data, record.data, sizeof(frame.data));
+                bus.transmit(frame);
+                ++load_frames;
+                return true;
+            });
+        } else if (now >= next_filler_us && bus.pendingCount(kLoadNode) == 0) {
+            bus.transmit(filler);
+            ++load_frames;
+            next_filler_us = std::max(next_filler_us + filler_interval_us, now);
+        }
+
+        for (auto& cell : cells) cell->service(bus, now);
+        bus.service(now + kStepUs);
+
+        if (options.rx_stall_ms && now >= next_stall_us) {
+            firmware.stall_until_us = now + options.rx_stall_ms * 1000ull;
+            next_stall_us += 1000000;
+        }
+        if (now >= next_rx_us) {
+            firmware.serviceRx(now);
+            next_rx_us += kRxTaskPeriodUs;
+        }
+    }
+
+    // ─── Report ──────────────────────────────────────────────────────────────
+    const uint64_t window_us = settle_us - start_us;
+    const auto& bus_stats = bus.stats();
+    uint32_t loc = 0;
+    uint32_t mismatches = 0;
+    uint32_t unconfirmed = 0;
+    VirtualCellStats totals;
+    for (auto& cell : cells) {
+        const VirtualCellStats& s = cell->stats();
+        totals.tracks += s.tracks;
+        totals.status_sent += s.status_sent;
+        totals.status_shed += s.status_shed;
+        loc += s.loc_timeouts;
+        if (cell->kind() != VirtualCellKind::Mastercell) {
+            const uint16_t desired = firmware.shadow.desired(cell->address());
+            mismatches += cell->outputs() != desired && !PowercellShadow::aliasesPoll(desired);
+            unconfirmed += firmware.pending_since[cell->address()] != 0;
+        }
+    }
+
+    std::printf("Soak: %u cells, %us, %s background, command every ~%ums per cell\n", kCommandCells,
+                options.seconds, options.replay_path ? "replayed" : "filler", options.cmd_ms);
+    report("bus", "utilisation", 100.0 * bus.utilisation(window_us), "%");
+    report("bus", "frames", static_cast<double>(bus_stats.frames), "");
+    report("bus", "background frames", static_cast<double>(load_frames), "");
+    report("bus", "error frames", static_cast<double>(bus_stats.error_frames), "");
+    report("command", "commands", static_cast<double>(firmware.commands), "");
+    report("command", "feedback samples", static_cast<double>(firmware.latency.samples.size()), "");
+    report("command", "latency avg", firmware.latency.average(), "us");
+    report("command", "latency p50", firmware.latency.percentile(0.50), "us");
+    report("command", "latency p99", firmware.latency.percentile(0.99), "us");
+    report("command", "latency max", firmware.latency.percentile(1.0), "us");
+    report("command", "unconfirmed at end", unconfirmed, "");
+    report("command", "set OUT4+8 alone (poll alias)", static_cast<double>(firmware.alias_commands), "");
+    report("command", "flushes held at poll alias", firmware.shadow.pollAliasHeld(), "");
+    report("command", "poll-alias frames on bus", static_cast<double>(poll_alias_on_bus), "");
+    report("queues", "TX lane drops", static_cast<double>(firmware.tx_lane_drops), "");
+    report("queues", "RX driver queue drops", static_cast<double>(firmware.rx_drops), "");
+    report("queues", "RX driver queue max depth", static_cast<double>(firmware.rx_max_depth), "");
+    report("cells", "track frames applied", totals.tracks, "");
+    report("cells", "status frames sent", totals.status_sent, "");
+    report("cells", "status reports merged", totals.status_shed, "");
+    report("cells", "LOC timeouts", loc, "");
+    report("cells", "outputs != shadow", mismatches, "");
+    if (options.replay_path) {
+        report("replay", "max late", player.stats().max_late_us, "us");
+        report("replay", "loops", player.stats().loops, "");
+    }
+
+    const bool pass = loc == 0 && mismatches == 0 && firmware.tx_lane_drops == 0 && poll_alias_on_bus == 0;
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
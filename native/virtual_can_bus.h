@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "host_clock.h"
+
+// Simulated CAN segment for the native build.
+//
+// Transmitters queue frames; service() arbitrates them the way the wire
+// does (lowest identifier first, standard before extended on a tie) and
+// charges each one its worst-case stuffed length at the configured bit
+// rate, so utilisation and queueing delay behave like a real 250 kbit/s
+// J1939 bus. Faults are injectable: a fixed delivery latency plus uniform
+// jitter, and an error rate that destroys a frame on the wire (an error
+// frame is charged, then the frame is retransmitted, as TWAI does in
+// normal mode). Delivery is to every registered receiver, including the
+// sender (receivers filter on `node` when they need to).
+struct VirtualCanFrame {
+    uint32_t id = 0;
+    bool extended = true;
+    uint8_t dlc = 8;
+    uint8_t data[8] = {};
+    uint8_t node = 0;        // Transmitting simulated node
+    uint64_t queued_us = 0;  // Handed to the bus
+    uint64_t rx_us = 0;      // Delivered to receivers
+};
+
+class VirtualCanBus {
+public:
+    struct Faults {
+        uint32_t latency_us = 0;   // Added between end-of-frame and delivery
+        uint32_t jitter_us = 0;    // Uniform 0..jitter on top of latency
+        double error_rate = 0.0;   // Probability a transmission attempt is destroyed
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t error_frames = 0;
+        uint64_t busy_us = 0;
+        uint64_t max_queue_us = 0;  // Longest queued -> delivered
+        uint64_t total_queue_us = 0;
+    };
+
+    using Receiver = std::function<void(const VirtualCanFrame&)>;
+
+    explicit VirtualCanBus(uint32_t bitrate = 250000, uint32_t seed = 1) : bitrate_(bitrate), rng_(seed) {}
+
+    void setFaults(const Faults& faults) {
+        faults_ = faults;
+        faults_.error_rate = std::min(std::max(faults_.error_rate, 0.0), 0.99);  // 1.0 would never drain
+    }
+    void addReceiver(Receiver receiver) { receivers_.push_back(std::move(receiver)); }
+
+    void transmit(VirtualCanFrame frame) {
+        frame.queued_us = HostClock::nowUs();
+        pending_.push_back(frame);
+    }
+
+    // Drops a node's frames that have not reached the wire (its controller
+    // went bus-off); returns how many
+    size_t abort(uint8_t node) {
+        const auto end = std::remove_if(pending_.begin(), pending_.end(),
+                                        [node](const VirtualCanFrame& f) { return f.node == node; });
+        const size_t dropped = static_cast<size_t>(pending_.end() - end);
+        pending_.erase(end, pending_.end());
+        return dropped;
+    }
+
+    size_t pendingCount() const { return pending_.size(); }
+    size_t pendingCount(uint8_t node) const {
+        return static_cast<size_t>(std::count_if(pending_.begin(), pending_.end(),
+                                                 [node](const VirtualCanFrame& f) { return f.node == node; }));
+    }
+
+    // Puts pending frames on the wire; returns frames delivered. Each
+    // arbitration round is between the frames queued by the time the wire
+    // goes idle, so a late high-priority frame waits for the frame in
+    // flight but beats everything still queued. With the default bound the
+    // bus drains completely and its time runs ahead of the clock while it
+    // is saturated; time-stepped simulations pass the end of their step so
+    // only frames that start by then are sent.
+    size_t service(uint64_t until_us = UINT64_MAX) {
+        size_t delivered = 0;
+        uint64_t wire = std::max(wire_free_us_, HostClock::nowUs());
+        while (!pending_.empty()) {
+            uint64_t earliest = pending_[0].queued_us;
+            for (const auto& f : pending_) earliest = std::min(earliest, f.queued_us);
+            if (std::max(wire, earliest) > until_us) break;
+            wire = std::max(wire, earliest);
+
+            size_t winner = pending_.size();
+            for (size_t i = 0; i < pending_.size(); ++i) {
+                if (pending_[i].queued_us > wire) continue;
+                if (winner == pending_.size() || arbitrationKey(pending_[i]) < arbitrationKey(pending_[winner])) {
+                    winner = i;
+                }
+            }
+            VirtualCanFrame frame = pending_[winner];
+
+            const uint32_t frame_us = frameTimeUs(frame);
+            if (faults_.error_rate > 0.0 && unit_(rng_) < faults_.error_rate) {
+                // Error flag + delimiter + intermission (~20 bits) after a partial frame
+                const uint32_t wasted = frame_us / 2 + bitsToUs(20);
+                wire += wasted;
+                stats_.busy_us += wasted;
+                ++stats_.error_frames;
+                continue;
+            }
+            pending_.erase(pending_.begin() + static_cast<std::ptrdiff_t>(winner));
+
+            wire += frame_us;
+            stats_.busy_us += frame_us;
+            uint64_t rx = wire + faults_.latency_us;
+            if (faults_.jitter_us) {
+                rx += std::uniform_int_distribution<uint32_t>(0, faults_.jitter_us)(rng_);
+            }
+            frame.rx_us = rx;
+            const uint64_t queued = rx - frame.queued_us;
+            stats_.total_queue_us += queued;
+            if (queued > stats_.max_queue_us) stats_.max_queue_us = queued;
+            ++stats_.frames;
+            for (auto& receiver : receivers_) receiver(frame);
+            ++delivered;
+        }
+        wire_free_us_ = wire;
+        return delivered;
+    }
+
+    // Worst-case bit-stuffed length of a data frame, including the 3-bit
+    // intermission: 34/54 stuffable bits of header for standard/extended
+    // identifiers, plus 8 per data byte.
+    uint32_t frameBits(const VirtualCanFrame& frame) const {
+        const uint32_t g = frame.extended ? 54 : 34;
+        const uint32_t stuffable = g + 8u * frame.dlc;
+        return stuffable + 13 + (stuffable - 1) / 4;
+    }
+    uint32_t frameTimeUs(const VirtualCanFrame& frame) const { return bitsToUs(frameBits(frame)); }
+
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = Stats{}; }
+
+    // Fraction of the elapsed window the wire was busy
+    double utilisation(uint64_t window_us) const {
+        return window_us ? static_cast<double>(stats_.busy_us) / static_cast<double>(window_us) : 0.0;
+    }
+
+private:
+    static uint64_t arbitrationKey(const VirtualCanFrame& frame) {
+        // A standard ID wins against an extended ID with the same base bits
+        return frame.extended ? (static_cast<uint64_t>(frame.id) << 1) | 1
+                              : static_cast<uint64_t>(frame.id) << 19;
+    }
+    uint32_t bitsToUs(uint32_t bits) const {
+        return static_cast<uint32_t>((static_cast<uint64_t>(bits) * 1000000u + bitrate_ - 1) / bitrate_);
+    }
+
+    uint32_t bitrate_;
+    Faults faults_;
+    Stats stats_;
+    std::vector<VirtualCanFrame> pending_;
+    std::vector<Receiver> receivers_;
+    uint64_t wire_free_us_ = 0;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> unit_{0.0, 1.0};
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "ipm1_can_library.h"
+#include "virtual_can_bus.h"
+
+// Simulated Infinitybox cells for the native build.
+//
+// Each VirtualCell listens on a VirtualCanBus the way a field unit does:
+//
+//   Powercell   Applies Track frames (PGN 0xFF00 + address from the
+//               firmware's source address) and reports outputs 1-5 / 6-10
+//               on status PGNs 0xFF10 / 0xFF20 + (address & 0x0F): byte 0
+//               bits 7..3 on-state, bytes 1-5 current, 6 voltage, 7
+//               temperature. Reports after its response time on every
+//               change, on a 0x11 poll and every kStatusPeriodUs.
+//   inMotion    Same Track/status contract on the alternate status PGNs
+//               0xFF50 / 0xFF60, with a slower response and a motor inrush
+//               current that decays over kInrushUs after an output closes.
+//   Mastercell  Input cell: ignores Track and broadcasts its input state on
+//               PGN 0xFF30 + address every kInputPeriodUs. Pure load.
+//
+// A cell that hears no Track frame for kLocTimeoutUs drops its outputs
+// (loss-of-communication) and counts the event, as the real units do.
+// Each cell has one transmit buffer and one pending report: a report
+// that is still waiting when the next one is raised is merged into it, so
+// a cell losing arbitration sheds stale reports instead of building an
+// unbounded backlog.
+enum class VirtualCellKind : uint8_t { Powercell, InMotion, Mastercell };
+
+struct VirtualCellStats {
+    uint32_t tracks = 0;         // Track frames applied
+    uint32_t polls = 0;
+    uint32_t status_sent = 0;
+    uint32_t status_shed = 0;    // Replaced in the queue before reaching the wire
+    uint32_t loc_timeouts = 0;
+};
+
+class VirtualCell {
+public:
+    static constexpr uint64_t kStatusPeriodUs = 250000;
+    static constexpr uint64_t kInputPeriodUs = 100000;
+    static constexpr uint64_t kLocTimeoutUs = 10000000;
+    static constexpr uint64_t kInrushUs = 150000;
+    static constexpr uint8_t kStatusPriority = 6;
+
+    VirtualCell(VirtualCellKind kind, uint8_t address) : kind_(kind), address_(address) {
+        response_us_ = kind == VirtualCellKind::InMotion ? 5000 : 1500;
+        next_periodic_us_ = HostClock::nowUs() + kStatusPeriodUs + address * 997u;  // Stagger cells
+        last_track_us_ = HostClock::nowUs();
+    }
+
+    VirtualCellKind kind() const { return kind_; }
+    uint8_t address() const { return address_; }
+    uint8_t node() const {
+        return static_cast<uint8_t>((kind_ == VirtualCellKind::Mastercell ? 0xC0 : 0x80) + address_);
+    }
+    uint16_t outputs() const { return outputs_; }
+    const VirtualCellStats& stats() const { return stats_; }
+    void setResponseUs(uint32_t us) { response_us_ = us; }
+
+    // Bus receiver: the cell sees every frame on the wire
+    void onFrame(const VirtualCanFrame& frame) {
+        if (kind_ == VirtualCellKind::Mastercell || !frame.extended || frame.dlc < 2 ||
+            (frame.id & 0xFF) != Ipm1Can::kSourceAddress ||
+            ((frame.id >> 8) & 0x3FFFF) != Ipm1Can::NormalizePowercellPgn(address_, 0xFF00)) {
+            return;
+        }
+        last_track_us_ = frame.rx_us;
+        in_loc_ = false;
+        // A poll is byte 0 = 0x11 on the Track PGN, which is also the Track
+        // encoding of OUT4+OUT8 alone; the poll reading wins here
+        if (frame.data[0] == 0x11 && frame.data[1] == 0) {
+            ++stats_.polls;
+            queueStatus(frame.rx_us + response_us_, 0x3);
+            return;
+        }
+        ++stats_.tracks;
+        const uint16_t next = Ipm1Can::powercellTrackOutputs(frame.data);
+        const uint16_t closed = next & ~outputs_;
+        for (uint8_t i = 0; i < 10; ++i) {
+            if (closed & (1u << i)) inrush_start_us_[i] = frame.rx_us;
+        }
+        const uint16_t changed = next ^ outputs_;
+        outputs_ = next;
+        if (changed) {
+            queueStatus(frame.rx_us + response_us_, ((changed & 0x1F) ? 0x1 : 0) | ((changed & 0x3E0) ? 0x2 : 0));
+        }
+    }
+
+    // Time step: LOC supervision, periodic traffic and handing the next
+    // due report to the bus once the previous one has left.
+    void service(VirtualCanBus& bus, uint64_t now_us) {
+        if (kind_ == VirtualCellKind::Mastercell) {
+            if (now_us >= next_periodic_us_) {
+                next_periodic_us_ += kInputPeriodUs;
+                VirtualCanFrame frame = makeFrame(kStatusPriority, 0xFF30 + (address_ & 0x0F));
+                frame.data[0] = static_cast<uint8_t>(now_us / kInputPeriodUs);  // Changing input pattern
+                bus.transmit(frame);
+                ++stats_.status_sent;
+            }
+            return;
+        }
+        if (!in_loc_ && now_us > last_track_us_ + kLocTimeoutUs) {
+            in_loc_ = true;
+            outputs_ = 0;
+            ++stats_.loc_timeouts;
+            queueStatus(now_us, 0x3);
+        }
+        if (now_us >= next_periodic_us_) {
+            next_periodic_us_ += kStatusPeriodUs;
+            queueStatus(now_us, 0x3);
+        }
+        if (!pending_.banks || pending_.due_us > now_us || bus.pendingCount(node()) != 0) {
+            return;
+        }
+        const uint8_t banks = pending_.banks;
+        pending_.banks = 0;
+        // Both banks go out back to back; the wire arbitrates them with
+        // everyone else's traffic
+        for (uint8_t bank = 0; bank < 2; ++bank) {
+            if (banks & (1u << bank)) {
+                bus.transmit(statusFrame(bank, now_us));
+                ++stats_.status_sent;
+            }
+        }
+    }
+
+    // Current in 0.1 A units, as reported in the status bytes
+    uint8_t currentRaw(uint8_t index, uint64_t now_us) const {
+        if (!(outputs_ & (1u << index))) return 0;
+        uint32_t current = 45;  // 4.5 A resistive load
+        if (kind_ == VirtualCellKind::InMotion) {
+            const uint64_t age = now_us > inrush_start_us_[index] ? now_us - inrush_start_us_[index] : 0;
+            current = 30 + (age < kInrushUs ? static_cast<uint32_t>(150 * (kInrushUs - age) / kInrushUs) : 0);
+        }
+        return static_cast<uint8_t>(current > 255 ? 255 : current);
+    }
+
+private:
+    struct Pending {
+        uint64_t due_us = 0;
+        uint8_t banks = 0;  // bit 0 = outputs 1-5, bit 1 = outputs 6-10; 0 = nothing queued
+    };
+
+    void queueStatus(uint64_t due_us, uint8_t banks) {
+        // A report not yet sent is superseded: merge, keep the earlier due time
+        if (pending_.banks) {
+            pending_.banks |= banks;
+            pending_.due_us = std::min(pending_.due_us, due_us);
+            ++stats_.status_shed;
+            return;
+        }
+        pending_ = {due_us, banks};
+    }
+
+    VirtualCanFrame makeFrame(uint8_t priority, uint32_t pgn) const {
+        VirtualCanFrame frame;
+        frame.id = (static_cast<uint32_t>(priority) << 26) | (pgn << 8) | node();
+        frame.node = node();
+        return frame;
+    }
+
+    VirtualCanFrame statusFrame(uint8_t bank, uint64_t now_us) const {
+        const uint32_t base = kind_ == VirtualCellKind::InMotion ? (bank ? 0xFF60 : 0xFF50) : (bank ? 0xFF20 : 0xFF10);
+        VirtualCanFrame frame = makeFrame(kStatusPriority, base + (address_ & 0x0F));
+        for (uint8_t i = 0; i < 5; ++i) {
+            const uint8_t index = static_cast<uint8_t>(bank * 5 + i);
+            if (outputs_ & (1u << index)) frame.data[0] |= static_cast<uint8_t>(0x80 >> i);
+            frame.data[1 + i] = currentRaw(index, now_us);
+        }
+        frame.data[6] = 138;  // 13.8 V
+        frame.data[7] = 35;   // 35 C
+        return frame;
+    }
+
+    VirtualCellKind kind_;
+    uint8_t address_;
+    uint32_t response_us_;
+    uint16_t outputs_ = 0;
+    bool in_loc_ = false;
+    uint64_t last_track_us_ = 0;
+    uint64_t next_periodic_us_ = 0;
+    std::array<uint64_t, 10> inrush_start_us_{};
+    Pending pending_;
+    VirtualCellStats stats_;
+};
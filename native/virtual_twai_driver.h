@@ -0,0 +1,237 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "twai_driver.h"
+#include "virtual_can_bus.h"
+
+// TwaiDriver for the native build: CanManager's RX, TX and health tasks run
+// against a node on a VirtualCanBus instead of the TWAI controller.
+//
+// The bus is not thread-safe, so this driver owns its lock: the simulation
+// thread reaches the bus (other nodes transmitting, service()) through
+// withBus(), and the driver's own calls take the same lock. Behaviour
+// follows the ESP-IDF driver where CanManager can see it:
+//
+//   transmit   Queues onto the bus as node `node`; waits up to wait_ticks
+//              while tx_queue_len of our frames are still on it (Timeout),
+//              Fail when the controller is not running. stop() drops
+//              our frames not yet on the wire, as twai_stop() does.
+//   receive    Frames from other nodes that pass the acceptance filter, in
+//              an rx_queue_len queue; overflow counts rx_missed_count.
+//   alerts     forceBusOff() raises BusOff and drops our frames not yet on
+//              the wire (the TX queue is lost with the bus); initiateRecovery()
+//              completes at once (RecoveryInProgress + BusRecovered,
+//              controller stopped), so the health task restarts it as on
+//              hardware.
+class VirtualTwaiDriver : public TwaiDriver {
+public:
+    explicit VirtualTwaiDriver(VirtualCanBus& bus, uint8_t node = 0) : bus_(bus), node_(node) {
+        bus_.addReceiver([this](const VirtualCanFrame& frame) { onFrame(frame); });
+    }
+
+    // Runs fn(bus) under the driver lock; the only way to touch the bus
+    // while CanManager's tasks are running
+    template <typename Fn>
+    auto withBus(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return fn(bus_);
+    }
+
+    void forceBusOff() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_.state = TwaiState::BusOff;
+            status_.tx_error_counter = 256;
+            bus_.abort(node_);
+            raise(TwaiAlert::kBusOff);
+        }
+        cv_.notify_all();
+    }
+
+    uint32_t transmitted() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return transmitted_;
+    }
+
+    // ─── TwaiDriver ──────────────────────────────────────────────────────────
+
+    bool install(const TwaiConfig& config) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (installed_) {
+            last_error_ = "ESP_ERR_INVALID_STATE";
+            return false;
+        }
+        config_ = config;
+        installed_ = true;
+        rx_.assign(config.rx_queue_len, TwaiFrame{});  // The driver queue is allocated at install
+        rx_head_ = 0;
+        rx_count_ = 0;
+        alerts_ = 0;
+        status_ = TwaiStatus{};
+        return true;
+    }
+
+    void uninstall() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        installed_ = false;
+        status_.state = TwaiState::Stopped;
+    }
+
+    bool start() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!installed_ || status_.state != TwaiState::Stopped) {
+            last_error_ = "ESP_ERR_INVALID_STATE";
+            return false;
+        }
+        status_.state = TwaiState::Running;
+        status_.tx_error_counter = 0;
+        status_.rx_error_counter = 0;
+        return true;
+    }
+
+    void stop() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_.state = TwaiState::Stopped;
+            bus_.abort(node_);  // twai_stop() clears the TX queue
+        }
+        cv_.notify_all();
+    }
+
+    TwaiResult transmit(const TwaiFrame& frame, uint32_t wait_ticks) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const bool space = cv_.wait_for(lock, std::chrono::milliseconds(wait_ticks), [&] {
+            return status_.state != TwaiState::Running || bus_.pendingCount(node_) < config_.tx_queue_len;
+        });
+        if (status_.state != TwaiState::Running) {
+            last_error_ = "ESP_ERR_INVALID_STATE";
+            return TwaiResult::Fail;
+        }
+        if (!space) {
+            return TwaiResult::Timeout;
+        }
+        VirtualCanFrame out;
+        out.id = frame.identifier;
+        out.extended = frame.extended;
+        out.dlc = frame.length;
+        std::memcpy(out.data, frame.data, sizeof(out.data));
+        out.node = node_;
+        bus_.transmit(out);
+        ++transmitted_;
+        return TwaiResult::Ok;
+    }
+
+    bool receive(TwaiFrame& frame, uint32_t wait_ticks) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, std::chrono::milliseconds(wait_ticks), [&] { return rx_count_ != 0; })) {
+            return false;
+        }
+        frame = rx_[rx_head_];
+        rx_head_ = (rx_head_ + 1) % rx_.size();
+        --rx_count_;
+        return true;
+    }
+
+    bool readAlerts(uint32_t& alerts, uint32_t wait_ticks) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, std::chrono::milliseconds(wait_ticks), [&] { return alerts_ != 0; })) {
+            return false;
+        }
+        alerts = alerts_;
+        alerts_ = 0;
+        return true;
+    }
+
+    bool status(TwaiStatus& out) const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!installed_) {
+            return false;
+        }
+        out = status_;
+        out.msgs_to_tx = static_cast<uint32_t>(bus_.pendingCount(node_));
+        out.msgs_to_rx = static_cast<uint32_t>(rx_count_);
+        return true;
+    }
+
+    bool initiateRecovery() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (status_.state != TwaiState::BusOff) {
+                last_error_ = "ESP_ERR_INVALID_STATE";
+                return false;
+            }
+            status_.state = TwaiState::Stopped;
+            status_.tx_error_counter = 0;
+            raise(TwaiAlert::kRecoveryInProgress | TwaiAlert::kBusRecovered);
+        }
+        cv_.notify_all();
+        return true;
+    }
+
+    const char* lastError() const override { return last_error_; }
+
+    // TWAI acceptance filter, register layout as in CanFilterPlanner.
+    // Data frames only (RTR 0); the standard-frame data-byte fields are
+    // don't-care, as CanManager never filters on them.
+    static bool accepts(const TwaiConfig& config, const VirtualCanFrame& frame) {
+        if (config.accept_all) {
+            return true;
+        }
+        const uint32_t care = ~config.acceptance_mask;
+        if (config.single_filter) {
+            const uint32_t bits = frame.extended ? frame.id << 3 : frame.id << 21;
+            const uint32_t used = frame.extended ? 0xFFFFFFF8u : 0xFFE00000u;
+            return ((bits ^ config.acceptance_code) & care & used) == 0;
+        }
+        if (frame.extended) {
+            const uint32_t high = (frame.id >> 13) & 0xFFFF;
+            return ((((high << 16) ^ config.acceptance_code) & care & 0xFFFF0000u) == 0) ||
+                   (((high ^ config.acceptance_code) & care & 0x0000FFFFu) == 0);
+        }
+        return ((((frame.id << 21) ^ config.acceptance_code) & care & 0xFFE00000u) == 0) ||
+               ((((frame.id << 5) ^ config.acceptance_code) & care & 0x0000FFE0u) == 0);
+    }
+
+private:
+    // Bus delivery; runs inside service(), already under the lock
+    void onFrame(const VirtualCanFrame& frame) {
+        if (frame.node == node_) {
+            cv_.notify_all();  // Our frame left the TX queue
+            return;
+        }
+        if (status_.state != TwaiState::Running || !accepts(config_, frame)) {
+            return;
+        }
+        if (rx_count_ >= rx_.size()) {
+            ++status_.rx_missed_count;
+            return;
+        }
+        TwaiFrame& rx = rx_[(rx_head_ + rx_count_++) % rx_.size()];
+        rx.identifier = frame.id;
+        rx.extended = frame.extended;
+        rx.length = frame.dlc > 8 ? 8 : frame.dlc;
+        std::memcpy(rx.data, frame.data, rx.length);
+        cv_.notify_all();
+    }
+
+    void raise(uint32_t alerts) { alerts_ |= alerts & config_.alerts; }
+
+    VirtualCanBus& bus_;
+    const uint8_t node_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    TwaiConfig config_;
+    bool installed_ = false;
+    TwaiStatus status_;
+    std::vector<TwaiFrame> rx_;
+    std::size_t rx_head_ = 0;
+    std::size_t rx_count_ = 0;
+    uint32_t alerts_ = 0;
+    uint32_t transmitted_ = 0;
+    const char* last_error_ = "ESP_OK";
+};
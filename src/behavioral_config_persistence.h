@@ -26,9 +26,10 @@ inline bool saveBehavioralConfig(BehaviorEngine& engine) {
     
     DynamicJsonDocument doc(32768); // 32KB buffer
     
-    // Save outputs
+    // Save outputs (one snapshot for both lists, so they are consistent)
+    const auto snapshot = engine.snapshot();
     JsonArray outputsArray = doc.createNestedArray("outputs");
-    const auto& outputs = engine.getOutputs();
+    const auto& outputs = snapshot->outputs;
     
     for (const auto& [id, output] : outputs) {
         JsonObject outObj = outputsArray.createNestedObject();
@@ -41,7 +42,7 @@ inline bool saveBehavioralConfig(BehaviorEngine& engine) {
     
     // Save scenes
     JsonArray scenesArray = doc.createNestedArray("scenes");
-    const auto& scenes = engine.getScenes();
+    const auto& scenes = snapshot->scenes;
     
     for (const auto& [id, scene] : scenes) {
         JsonObject sceneObj = scenesArray.createNestedObject();
@@ -144,7 +144,8 @@ public:
                 return;
             }
             
-            auto* output = _engine->getOutput(id);
+            const auto snapshot = _engine->snapshot();
+            const auto* output = snapshot->findOutput(id);
             if (!output) {
                 request->send(404, "application/json", "{\"error\":\"Output not found\"}");
                 return;
@@ -196,11 +197,8 @@ public:
         
         // POST /api/outputs/stop-all - Stop all outputs
         _server->on("/api/outputs/stop-all", HTTP_POST, [this](AsyncWebServerRequest* request) {
-            const auto& outputs = _engine->getOutputs();
-            for (const auto& [id, output] : outputs) {
-                _engine->deactivateOutput(id);
-            }
-            request->send(200, "application/json", "{\"success\":true}");
+            bool success = _engine->deactivateAllOutputs();
+            request->send(200, "application/json", "{\"success\":" + String(success ? "true" : "false") + "}");
         });
         
         // ═══════════════════════════════════════════════════════════════════
@@ -242,12 +240,7 @@ public:
             String path = request->url();
             String id = extractSceneId(path);
 
-            bool success = _engine->activateScene(id);
-            if (success) {
-                request->send(200, "application/json", "{\"success\":true}");
-            } else {
-                request->send(404, "application/json", "{\"error\":\"Scene not found\"}");
-            }
+            sendControlResult(request, _engine->activateScene(id), "Scene not found");
         });
 
         // GET /api/scene/activate/{id} - Activate scene (preferred)
@@ -255,12 +248,7 @@ public:
             String path = request->url();
             String id = extractSceneId(path);
 
-            bool success = _engine->activateScene(id);
-            if (success) {
-                request->send(200, "application/json", "{\"success\":true}");
-            } else {
-                request->send(404, "application/json", "{\"error\":\"Scene not found\"}");
-            }
+            sendControlResult(request, _engine->activateScene(id), "Scene not found");
         });
         
         // POST /api/scenes/activate/{id} - Activate scene
@@ -268,12 +256,7 @@ public:
             String path = request->url();
             String id = extractSceneId(path);
             
-            bool success = _engine->activateScene(id);
-            if (success) {
-                request->send(200, "application/json", "{\"success\":true}");
-            } else {
-                request->send(404, "application/json", "{\"error\":\"Scene not found\"}");
-            }
+            sendControlResult(request, _engine->activateScene(id), "Scene not found");
         });
 
         // POST /api/scene/activate/{id} - Activate scene (preferred)
@@ -281,12 +264,7 @@ public:
             String path = request->url();
             String id = extractSceneId(path);
 
-            bool success = _engine->activateScene(id);
-            if (success) {
-                request->send(200, "application/json", "{\"success\":true}");
-            } else {
-                request->send(404, "application/json", "{\"error\":\"Scene not found\"}");
-            }
+            sendControlResult(request, _engine->activateScene(id), "Scene not found");
         });
         
         // POST /api/scenes/deactivate/{id} - Deactivate scene
@@ -346,12 +324,7 @@ public:
             String path = request->url();
             if (path.startsWith("/api/scenes/activate/")) {
                 String id = extractSceneId(path);
-                bool success = _engine->activateScene(id);
-                if (success) {
-                    request->send(200, "application/json", "{\"success\":true}");
-                } else {
-                    request->send(404, "application/json", "{\"error\":\"Scene not found\"}");
-                }
+                sendControlResult(request, _engine->activateScene(id), "Scene not found");
                 return;
             }
             if (path.startsWith("/api/scenes/deactivate/")) {
@@ -365,7 +338,8 @@ public:
                 return;
             }
             String id = extractSceneId(path);
-            auto* scene = _engine->getScene(id);
+            const auto snapshot = _engine->snapshot();
+            const auto* scene = snapshot->findScene(id);
             if (!scene) {
                 request->send(404, "application/json", "{\"error\":\"Scene not found\"}");
                 return;
@@ -389,6 +363,18 @@ private:
     AsyncWebServer* _server;
     BehaviorEngine* _engine;
     
+    // Turn-ons can be refused while the engine's command queue is full;
+    // that is a retryable 503, not a 404
+    void sendControlResult(AsyncWebServerRequest* request, ControlResult result, const char* notFound) {
+        if (result) {
+            request->send(200, "application/json", "{\"success\":true}");
+        } else if (result.code == ControlResult::QueueFull) {
+            request->send(503, "application/json", "{\"error\":\"Engine busy, retry\"}");
+        } else {
+            request->send(404, "application/json", String("{\"error\":\"") + notFound + "\"}");
+        }
+    }
+
     // ═══════════════════════════════════════════════════════════════════════
     // SERIALIZATION
     // ═══════════════════════════════════════════════════════════════════════
@@ -397,26 +383,28 @@ private:
         DynamicJsonDocument doc(8192);
         JsonArray array = doc.to<JsonArray>();
         
-        const auto& outputs = _engine->getOutputs();
+        const auto snapshot = _engine->snapshot();
+        const auto& outputs = snapshot->outputs;
         for (const auto& [id, output] : outputs) {
             JsonObject obj = array.createNestedObject();
             obj["id"] = output.id;
             obj["name"] = output.name;
             obj["cellAddress"] = output.cellAddress;
             obj["outputNumber"] = output.outputNumber;
-            obj["desiredActive"] = output.isActive;
-            obj["desiredValue"] = output.currentState ? 255 : 0;
+            obj["desiredActive"] = _engine->isOutputActive(output);
+            obj["desiredValue"] = _engine->outputState(output) ? 255 : 0;
             obj["description"] = output.description;
             obj["cellAddress"] = output.cellAddress;
             obj["outputNumber"] = output.outputNumber;
-            obj["isActive"] = output.isActive;
-            obj["currentValue"] = output.currentState ? 255 : 0;
+            obj["isActive"] = _engine->isOutputActive(output);
+            obj["currentValue"] = _engine->outputState(output) ? 255 : 0;
             
-            if (output.isActive) {
+            if (_engine->isOutputActive(output)) {
+                const LiveBehavior live = _engine->outputBehavior(output);
                 JsonObject behavior = obj.createNestedObject("behavior");
-                behavior["type"] = behaviorTypeToString(output.behavior.type);
-                behavior["targetValue"] = output.behavior.targetValue;
-                behavior["priority"] = output.behavior.priority;
+                behavior["type"] = behaviorTypeToString(live.type);
+                behavior["targetValue"] = live.targetValue;
+                behavior["priority"] = live.priority;
             }
         }
         
@@ -434,16 +422,17 @@ private:
         obj["description"] = output.description;
         obj["cellAddress"] = output.cellAddress;
         obj["outputNumber"] = output.outputNumber;
-        obj["isActive"] = output.isActive;
-        obj["currentValue"] = output.currentState ? 255 : 0;
+        obj["isActive"] = _engine->isOutputActive(output);
+        obj["currentValue"] = _engine->outputState(output) ? 255 : 0;
         
+        const LiveBehavior live = _engine->outputBehavior(output);
         JsonObject behavior = obj.createNestedObject("behavior");
-        behavior["type"] = behaviorTypeToString(output.behavior.type);
-        behavior["targetValue"] = output.behavior.targetValue;
-        behavior["period_ms"] = output.behavior.period_ms;
-        behavior["dutyCycle"] = output.behavior.dutyCycle;
-        behavior["duration_ms"] = output.behavior.duration_ms;
-        behavior["priority"] = output.behavior.priority;
+        behavior["type"] = behaviorTypeToString(live.type);
+        behavior["targetValue"] = live.targetValue;
+        behavior["period_ms"] = live.period_ms;
+        behavior["dutyCycle"] = live.dutyCycle;
+        behavior["duration_ms"] = live.duration_ms;
+        behavior["priority"] = live.priority;
         
         String result;
         serializeJson(doc, result);
@@ -456,18 +445,24 @@ private:
 
         const uint32_t now = millis();
         
-        const auto& outputs = _engine->getOutputs();
+        const auto snapshot = _engine->snapshot();
+        const auto& outputs = snapshot->outputs;
+        // One lock-free pass over every cell instead of two reads per output
+        auto cells = std::make_unique<CanManager::PowercellStatusSnapshot>();
+        CanManager::instance().snapshotAllCells(*cells);
         for (const auto& [id, output] : outputs) {
             JsonObject obj = array.createNestedObject();
             obj["id"] = output.id;
             obj["name"] = output.name;
             obj["cellAddress"] = output.cellAddress;
             obj["outputNumber"] = output.outputNumber;
-            obj["desiredActive"] = output.isActive;
-            obj["desiredValue"] = output.currentState ? 255 : 0;
+            obj["desiredActive"] = _engine->isOutputActive(output);
+            obj["desiredValue"] = _engine->outputState(output) ? 255 : 0;
 
-            const auto canState = CanManager::instance().getPowercellOutputState(output.cellAddress, output.outputNumber);
-            const auto cellTelemetry = CanManager::instance().getPowercellCellTelemetry(output.cellAddress);
+            const bool addressed = output.cellAddress >= 1 && output.cellAddress <= CanManager::kPowercellMaxAddress &&
+                                   output.outputNumber >= 1 && output.outputNumber <= CanManager::kPowercellOutputsPerCell;
+            const PowercellCellStatus cell = addressed ? (*cells)[output.cellAddress - 1] : PowercellCellStatus{};
+            const PowercellOutputState canState = addressed ? cell.outputs[output.outputNumber - 1] : PowercellOutputState{};
             const bool canFresh = canState.valid && (now - canState.last_seen_ms <= 1000);
             if (canFresh) {
                 const float currentAmps = static_cast<float>(canState.current_raw) * 0.117f;
@@ -477,17 +472,17 @@ private:
                 obj["source"] = "can";
                 obj["lastSeenMs"] = canState.last_seen_ms;
             } else {
-                obj["currentValue"] = output.currentState ? 255 : 0;
-                obj["isActive"] = output.isActive;
+                obj["currentValue"] = _engine->outputState(output) ? 255 : 0;
+                obj["isActive"] = _engine->isOutputActive(output);
                 obj["source"] = "engine";
             }
 
-            const bool cellFresh = cellTelemetry.valid && (now - cellTelemetry.last_seen_ms <= 1000);
+            const bool cellFresh = cell.last_seen_ms > 0 && (now - cell.last_seen_ms <= 1000);
             if (cellFresh) {
-                obj["cellVoltageRaw"] = cellTelemetry.voltage_raw;
-                obj["cellVoltageVolts"] = static_cast<float>(cellTelemetry.voltage_raw) * 0.125f;
-                obj["cellTemperatureC"] = cellTelemetry.temperature_c;
-                obj["cellLastSeenMs"] = cellTelemetry.last_seen_ms;
+                obj["cellVoltageRaw"] = cell.voltage_raw;
+                obj["cellVoltageVolts"] = static_cast<float>(cell.voltage_raw) * 0.125f;
+                obj["cellTemperatureC"] = cell.temperature_c;
+                obj["cellLastSeenMs"] = cell.last_seen_ms;
             }
         }
         
@@ -500,13 +495,14 @@ private:
         DynamicJsonDocument doc(8192);
         JsonArray array = doc.to<JsonArray>();
         
-        const auto& scenes = _engine->getScenes();
+        const auto snapshot = _engine->snapshot();
+        const auto& scenes = snapshot->scenes;
         for (const auto& [id, scene] : scenes) {
             JsonObject obj = array.createNestedObject();
             obj["id"] = scene.id;
             obj["name"] = scene.name;
             obj["description"] = scene.description;
-            obj["isActive"] = scene.isActive;
+            obj["isActive"] = _engine->isSceneActive(scene);
             obj["outputCount"] = scene.outputs.size();
             obj["canCount"] = scene.can_frames.size();
             obj["infinityboxCount"] = scene.infinitybox_actions.size();
@@ -580,7 +576,7 @@ private:
         obj["id"] = scene.id;
         obj["name"] = scene.name;
         obj["description"] = scene.description;
-        obj["isActive"] = scene.isActive;
+        obj["isActive"] = _engine->isSceneActive(scene);
         obj["duration_ms"] = scene.duration_ms;
         obj["priority"] = scene.priority;
         obj["exclusive"] = scene.exclusive;
@@ -708,13 +704,7 @@ private:
         behavior.priority = doc["priority"] | 100;
         behavior.softStart = doc["softStart"] | false;
         
-        bool success = _engine->setBehavior(id, behavior);
-        
-        if (success) {
-            request->send(200, "application/json", "{\"success\":true}");
-        } else {
-            request->send(404, "application/json", "{\"error\":\"Output not found\"}");
-        }
+        sendControlResult(request, _engine->setBehavior(id, behavior), "Output not found");
     }
     
     void handleCreateScene(AsyncWebServerRequest* request, uint8_t* data, size_t len) {
@@ -888,9 +878,10 @@ private:
 
     String resolveOutputId(const String& rawId) {
         if (rawId.isEmpty()) return rawId;
-        if (_engine->getOutput(rawId)) return rawId;
+        const auto snapshot = _engine->snapshot();
+        if (snapshot->findOutput(rawId)) return rawId;
         const String normalized = normalizeKey(rawId);
-        for (const auto& [key, output] : _engine->getOutputs()) {
+        for (const auto& [key, output] : snapshot->outputs) {
             if (normalizeKey(key) == normalized || normalizeKey(output.name) == normalized) {
                 return key;
             }
@@ -22,6 +22,8 @@
 #include "infinitybox_control.h"
 #include "ipm1_can_library.h"
 #include <ESPAsyncWebServer.h>
+#include <esp_timer.h>
+#include <atomic>
 
 using namespace BehavioralOutput;
 
@@ -33,11 +35,18 @@ inline BehaviorEngine behaviorEngine;
 inline PowercellSynthesizer* powercellSynthesizer = nullptr;
 inline BehavioralOutputAPI* outputAPI = nullptr;
 
+// Engine task: sleeps until the next behavior edge or keepalive, armed on a
+// one-shot esp_timer (microsecond resolution, not the 1 ms tick)
+inline TaskHandle_t behaviorTaskHandle = nullptr;
+inline esp_timer_handle_t behaviorWakeTimer = nullptr;
+inline std::atomic<uint32_t> behaviorWakeCount{0};
+
 // Forward declarations
 inline void loadInfinityBoxDefaults();
 inline void loadDefaultScenes();
 inline void applySceneActivationActions(const Scene& scene);
 inline void applySceneDeactivationActions(const Scene& scene);
+inline void startBehaviorTask();
 
 // ═══════════════════════════════════════════════════════════════════════════
 // INITIALIZATION
@@ -48,24 +57,21 @@ inline void initBehavioralOutputSystem(AsyncWebServer* webServer) {
     Serial.println("║  BEHAVIORAL OUTPUT SYSTEM - INITIALIZING                      ║");
     Serial.println("╚════════════════════════════════════════════════════════════════╝");
     
-    // Create frame synthesizer with CAN send callback
+    // Create frame synthesizer writing into the shared Powercell output shadow
     Serial.println("[Behavioral] Creating PowercellSynthesizer...");
     powercellSynthesizer = new PowercellSynthesizer(
         &behaviorEngine,
-        [](uint32_t pgn, uint8_t* data) {
-            // Send POWERCELL CAN frame via existing CanManager
-            constexpr uint8_t priority = 6;
-            const uint8_t source_addr = Ipm1Can::kSourceAddress;
-            CanManager::instance().sendJ1939Pgn(priority, pgn, source_addr, data);
+        [](uint8_t cell, uint16_t mask, uint16_t outputs) {
+            CanManager::instance().setPowercellOutputs(cell, mask, outputs, CanTxLane::Periodic);
         }
     );
     Serial.println("[Behavioral] ✓ PowercellSynthesizer created");
     
     // Configure update rates
     Serial.println("[Behavioral] Configuring update rates...");
-    behaviorEngine.setUpdateInterval(20);  // 50Hz behavior engine
-    powercellSynthesizer->setTransmitInterval(50);  // 20Hz CAN transmission
-    Serial.println("[Behavioral] ✓ Update rates: 50Hz engine, 20Hz transmission");
+    powercellSynthesizer->setKeepaliveInterval(PowercellSynthesizer::kDefaultKeepaliveMs);
+    Serial.printf("[Behavioral] ✓ Frames on change, %ums keepalive (LOC %lums)\n",
+                  powercellSynthesizer->keepaliveInterval(), PowercellSynthesizer::kLocTimeoutMs);
     
     // Register REST API endpoints
     if (webServer) {
@@ -76,6 +82,38 @@ inline void initBehavioralOutputSystem(AsyncWebServer* webServer) {
         webServer->on("/behavioral", HTTP_GET, [](AsyncWebServerRequest* request) {
             request->send_P(200, "text/html", BEHAVIORAL_OUTPUT_UI);
         });
+
+        // Synthesizer instrumentation: per-cell frame rates, event -> TX latency
+        webServer->on("/api/behavioral/synth", HTTP_GET, [](AsyncWebServerRequest* request) {
+            if (!powercellSynthesizer) {
+                request->send(503, "application/json", "{\"error\":\"synthesizer not running\"}");
+                return;
+            }
+            const SynthesizerStats stats = powercellSynthesizer->getStats();
+            DynamicJsonDocument doc(4096);
+            doc["keepalive_ms"] = stats.keepalive_ms;
+            doc["loc_timeout_ms"] = PowercellSynthesizer::kLocTimeoutMs;
+            JsonObject latency = doc.createNestedObject("latency_us");
+            latency["samples"] = stats.latencySamples;
+            latency["avg"] = stats.latencyAvgUs;
+            latency["max"] = stats.latencyMaxUs;
+            JsonArray cells = doc.createNestedArray("cells");
+            for (const auto& cell : stats.cells) {
+                if (!cell.known) continue;
+                JsonObject obj = cells.createNestedObject();
+                obj["address"] = cell.address;
+                obj["bitmap"] = cell.outputBitmap;
+                obj["active"] = cell.activeBitmap;
+                obj["frames_per_sec"] = cell.framesPerSec;
+                obj["change_frames"] = cell.changeFrames;
+                obj["keepalive_frames"] = cell.keepaliveFrames;
+                obj["last_latency_us"] = cell.lastLatencyUs;
+                obj["max_latency_us"] = cell.maxLatencyUs;
+            }
+            String json;
+            serializeJson(doc, json);
+            request->send(200, "application/json", json);
+        });
     }
 
     behaviorEngine.setSceneActivatedCallback([](const Scene& scene) {
@@ -87,32 +125,34 @@ inline void initBehavioralOutputSystem(AsyncWebServer* webServer) {
     
     // Try to load from persistent storage first
     bool loaded = loadBehavioralConfig(behaviorEngine);
-    size_t outputCount = behaviorEngine.getOutputs().size();
-    size_t sceneCount = behaviorEngine.getScenes().size();
+    size_t outputCount = behaviorEngine.snapshot()->outputs.size();
+    size_t sceneCount = behaviorEngine.snapshot()->scenes.size();
     
     if (!loaded) {
         // No saved config - load InfinityBox standard outputs
         Serial.println("[Behavioral Output] No saved config, loading InfinityBox defaults...");
         loadInfinityBoxDefaults();
         loadDefaultScenes();
-        outputCount = behaviorEngine.getOutputs().size();
-        sceneCount = behaviorEngine.getScenes().size();
+        outputCount = behaviorEngine.snapshot()->outputs.size();
+        sceneCount = behaviorEngine.snapshot()->scenes.size();
     } else {
         if (outputCount == 0) {
             Serial.println("[Behavioral Output] Saved config contained zero outputs. Restoring InfinityBox defaults...");
             loadInfinityBoxDefaults();
-            outputCount = behaviorEngine.getOutputs().size();
+            outputCount = behaviorEngine.snapshot()->outputs.size();
         }
         if (sceneCount == 0) {
             Serial.println("[Behavioral Output] Saved config had no scenes. Restoring default scenes...");
             loadDefaultScenes();
-            sceneCount = behaviorEngine.getScenes().size();
+            sceneCount = behaviorEngine.snapshot()->scenes.size();
         }
         Serial.printf("[Behavioral Output] Configuration ready (%u outputs, %u scenes)\n", 
                      static_cast<unsigned>(outputCount), 
                      static_cast<unsigned>(sceneCount));
     }
     
+    startBehaviorTask();
+
     Serial.println("[Behavioral Output] System initialized");
     Serial.println("[Behavioral Output] Visit /behavioral to view/modify outputs and scenes");
 }
@@ -539,31 +579,79 @@ inline void loadDefaultScenes() {
         behaviorEngine.getAllScenes().size());
 }
 
-// ═══════════════════════════════════════════════════════════════════════════// ═══════════════════════════════════════════════════════════════════════════
+// ═══════════════════════════════════════════════════════════════════════════
+// ENGINE TASK
+// ═══════════════════════════════════════════════════════════════════════════
+
+inline void behaviorTask(void* param) {
+    (void)param;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        behaviorWakeCount.fetch_add(1, std::memory_order_relaxed);
+
+        // Evaluate due behaviors, then send frames for any edge they produced
+        behaviorEngine.update();
+        if (powercellSynthesizer) {
+            powercellSynthesizer->update();
+        }
+
+        const int64_t now_us = esp_timer_get_time();
+        const uint32_t now_ms = static_cast<uint32_t>(now_us / 1000);
+        uint32_t wait_ms = behaviorEngine.msUntilNextDeadline(now_ms);
+        if (powercellSynthesizer) {
+            const uint32_t keepalive_ms = powercellSynthesizer->msUntilNextTransmit(now_ms);
+            if (keepalive_ms < wait_ms) wait_ms = keepalive_ms;
+        }
+
+        if (wait_ms == BehaviorEngine::kNoDeadline) {
+            continue;  // Idle until a configuration change wakes us
+        }
+        if (wait_ms == 0) {
+            xTaskNotifyGive(behaviorTaskHandle);
+            continue;
+        }
+        // Wake at the millisecond boundary millis() will report as the deadline
+        const int64_t delay_us = static_cast<int64_t>(wait_ms) * 1000 - (now_us % 1000);
+        esp_timer_stop(behaviorWakeTimer);
+        esp_timer_start_once(behaviorWakeTimer, delay_us > 0 ? delay_us : 1);
+    }
+}
+
+inline void startBehaviorTask() {
+    if (behaviorTaskHandle) return;
+
+    esp_timer_create_args_t args = {};
+    args.callback = [](void*) {
+        if (behaviorTaskHandle) xTaskNotifyGive(behaviorTaskHandle);
+    };
+    args.name = "behavior_wake";
+    if (esp_timer_create(&args, &behaviorWakeTimer) != ESP_OK) {
+        Serial.println("[Behavioral] Failed to create wake timer");
+        return;
+    }
+
+    xTaskCreatePinnedToCore(behaviorTask, "behavior", 6144, nullptr, 2, &behaviorTaskHandle, 1);
+    behaviorEngine.setWakeCallback([]() {
+        if (behaviorTaskHandle) xTaskNotifyGive(behaviorTaskHandle);
+    });
+    xTaskNotifyGive(behaviorTaskHandle);  // Evaluate whatever the loaded config activated
+}
+
+// ═══════════════════════════════════════════════════════════════════════════
 // MAIN LOOP INTEGRATION
 // ═══════════════════════════════════════════════════════════════════════════
 
+// The engine runs on its own task; the main loop only reports its activity.
 inline void updateBehavioralOutputSystem() {
     static uint32_t last_debug_ms = 0;
-    static uint32_t update_count = 0;
-    
-    update_count++;
     
-    // Debug every 5 seconds to confirm update loop is running
+    // Debug every 5 seconds to confirm the engine task is alive
     uint32_t now = millis();
     if (now - last_debug_ms >= 5000) {
-        Serial.printf("[Behavioral] Update loop running: %lu updates in 5s\n", update_count);
-        update_count = 0;
+        Serial.printf("[Behavioral] Engine task: %lu wakeups in 5s\n",
+                      behaviorWakeCount.exchange(0, std::memory_order_relaxed));
         last_debug_ms = now;
     }
-    
-    // Update behavior engine (evaluates all behaviors)
-    behaviorEngine.update();
-    
-    // Synthesize and transmit POWERCELL frames
-    if (powercellSynthesizer) {
-        powercellSynthesizer->update();
-    }
 }
 
 #endif // BEHAVIORAL_OUTPUT_INTEGRATION_H
@@ -87,7 +87,9 @@ inline void sceneButtonEvent(lv_event_t* e) {
     
     if (engine && scene_id) {
         Serial.printf("[Behavioral UI] Activating scene: %s\n", scene_id);
-        engine->activateScene(scene_id);
+        if (!engine->activateScene(scene_id)) {
+            Serial.printf("[Behavioral UI] Scene %s not activated (unknown or engine busy)\n", scene_id);
+        }
     }
 }
 
@@ -113,7 +115,9 @@ inline void behaviorButtonEvent(lv_event_t* e) {
         stopBehavior.target_value = 0;
         stopBehavior.duration_ms = 0;
         
-        engine->setBehavior(output_id, stopBehavior);
+        if (!engine->setBehavior(output_id, stopBehavior)) {
+            Serial.printf("[Behavioral UI] Output %s not set (unknown or engine busy)\n", output_id);
+        }
     }
 }
 
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Boot phase timeline.
+//
+// setup() calls mark() as each phase finishes; the timeline keeps the
+// micros() stamp of every mark, so a phase's duration is the gap to the
+// previous mark and the first phase is measured from reset. Phase names
+// must be string literals (only the pointer is stored). Marks past
+// kMaxPhases are dropped. Written only from setup(); readers on other
+// tasks (the web server starts mid-boot) see every phase below count().
+class BootTimeline {
+public:
+    static constexpr std::size_t kMaxPhases = 24;
+
+    struct Phase {
+        const char* name = nullptr;
+        uint32_t end_us = 0;       // micros() when the phase finished
+        uint32_t duration_us = 0;  // Time since the previous mark (or reset)
+    };
+
+    static BootTimeline& instance() {
+        static BootTimeline timeline;
+        return timeline;
+    }
+
+    void mark(const char* name) {
+        const std::size_t count = count_.load(std::memory_order_relaxed);
+        if (count >= kMaxPhases) return;
+        const uint32_t now = micros();
+        const uint32_t start = count ? phases_[count - 1].end_us : 0;
+        phases_[count] = {name, now, now - start};
+        count_.store(count + 1, std::memory_order_release);
+    }
+
+    std::size_t count() const { return count_.load(std::memory_order_acquire); }
+    const Phase& phase(std::size_t index) const { return phases_[index]; }
+    // End of the named phase, 0 while it has not been reached
+    uint32_t phaseEndUs(const char* name) const {
+        for (std::size_t i = 0, count = this->count(); i < count; ++i) {
+            if (std::strcmp(phases_[i].name, name) == 0) return phases_[i].end_us;
+        }
+        return 0;
+    }
+    uint32_t totalUs() const {
+        const std::size_t count = this->count();
+        return count ? phases_[count - 1].end_us : 0;
+    }
+
+    void printSummary() const {
+        Serial.println("[Boot] Phase timeline:");
+        for (std::size_t i = 0, count = this->count(); i < count; ++i) {
+            Serial.printf("[Boot]   %-12s %7lu ms  (+%lu ms)\n", phases_[i].name,
+                          static_cast<unsigned long>(phases_[i].end_us / 1000),
+                          static_cast<unsigned long>(phases_[i].duration_us / 1000));
+        }
+    }
+
+private:
+    BootTimeline() = default;
+
+    std::array<Phase, kMaxPhases> phases_{};
+    std::atomic<std::size_t> count_{0};
+};
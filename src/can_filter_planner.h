@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Plans the TWAI hardware acceptance filter from the set of frames the
+// firmware consumes, and provides the exact software check used as the
+// second stage (the hardware filter can only approximate the set).
+//
+// TWAI filter registers use "mask bit 1 = don't care". Layouts used here:
+//   Single filter, extended frame: code[31:3] = ID[28:0]
+//   Single filter, standard frame: code[31:21] = ID[10:0]
+//   Dual filter, extended frame:   filter 1 = code[31:16], filter 2 = code[15:0],
+//                                  each compared against ID[28:13]
+//   Dual filter, standard frame:   filter 1 = code[31:21], filter 2 = code[15:5]
+// In dual mode both filters see every frame, so the extended pattern in
+// filter 1 and the standard pattern in filter 2 each leak a few frames of
+// the other format; the software stage removes them.
+
+struct CanRxInterest {
+    uint32_t id = 0;
+    uint32_t care = 0;       // 1 = bit must match (ID bits only)
+    bool extended = true;
+
+    bool matches(uint32_t identifier, bool is_extended) const {
+        return is_extended == extended && ((identifier ^ id) & care) == 0;
+    }
+};
+
+// J1939 PGN interest: any priority, any source address
+inline CanRxInterest canPgnInterest(uint32_t pgn, uint32_t pgn_care = 0x3FFFF) {
+    CanRxInterest interest;
+    interest.id = (pgn & 0x3FFFF) << 8;
+    interest.care = (pgn_care & 0x3FFFF) << 8;
+    interest.extended = true;
+    return interest;
+}
+
+inline CanRxInterest canStdInterest(uint16_t id, uint16_t care = 0x7FF) {
+    CanRxInterest interest;
+    interest.id = id & 0x7FF;
+    interest.care = care & 0x7FF;
+    interest.extended = false;
+    return interest;
+}
+
+struct CanFilterPlan {
+    enum class Mode : uint8_t { AcceptAll, Single, Dual };
+
+    Mode mode = Mode::AcceptAll;
+    uint32_t acceptance_code = 0;
+    uint32_t acceptance_mask = 0xFFFFFFFF;   // TWAI convention: 1 = don't care
+
+    bool singleFilter() const { return mode != Mode::Dual; }
+    const char* modeName() const {
+        return mode == Mode::Single ? "single" : mode == Mode::Dual ? "dual" : "accept_all";
+    }
+};
+
+namespace CanFilterPlanner {
+
+// Smallest single pattern covering every interest of one frame format:
+// a bit is kept only if all interests care about it and agree on its value.
+inline bool coverPattern(const CanRxInterest* interests, std::size_t count, bool extended,
+                         uint32_t& id, uint32_t& care) {
+    bool any = false;
+    for (std::size_t i = 0; i < count; ++i) {
+        const CanRxInterest& interest = interests[i];
+        if (interest.extended != extended) {
+            continue;
+        }
+        if (!any) {
+            id = interest.id;
+            care = interest.care;
+            any = true;
+        } else {
+            care &= interest.care & ~(id ^ interest.id);
+        }
+    }
+    id &= care;
+    return any;
+}
+
+inline CanFilterPlan plan(const CanRxInterest* interests, std::size_t count) {
+    CanFilterPlan result;
+    uint32_t ext_id = 0, ext_care = 0, std_id = 0, std_care = 0;
+    const bool has_ext = coverPattern(interests, count, true, ext_id, ext_care);
+    const bool has_std = coverPattern(interests, count, false, std_id, std_care);
+
+    if (has_ext && !has_std) {
+        // Full 29-bit compare; RTR don't care
+        result.mode = CanFilterPlan::Mode::Single;
+        result.acceptance_code = ext_id << 3;
+        result.acceptance_mask = ~(ext_care << 3);
+    } else if (has_std && !has_ext) {
+        // ID only; RTR and the two data bytes don't care
+        result.mode = CanFilterPlan::Mode::Single;
+        result.acceptance_code = std_id << 21;
+        result.acceptance_mask = ~(std_care << 21);
+    } else if (has_ext && has_std) {
+        // Extended pattern on filter 1 (ID[28:13]), standard on filter 2
+        const uint32_t f1_code = (ext_id >> 13) & 0xFFFF;
+        const uint32_t f1_care = (ext_care >> 13) & 0xFFFF;
+        const uint32_t f2_code = (std_id << 5) & 0xFFFF;
+        const uint32_t f2_care = (std_care << 5) & 0xFFFF;
+        result.mode = CanFilterPlan::Mode::Dual;
+        result.acceptance_code = (f1_code << 16) | f2_code;
+        result.acceptance_mask = ~((f1_care << 16) | f2_care);
+    }
+    return result;
+}
+
+inline bool wanted(const CanRxInterest* interests, std::size_t count, uint32_t identifier, bool extended) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (interests[i].matches(identifier, extended)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace CanFilterPlanner
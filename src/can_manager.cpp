@@ -1,8 +1,10 @@
 #include "can_manager.h"
+#include "can_trace_recorder.h"
 #include "hardware_config.h"
-#include "web_server.h"
+#include "ipm1_can_library.h"
+#include "logger.h"
 
-#include <driver/twai.h>
+#include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 
 #include <algorithm>
@@ -26,35 +28,25 @@ CanManager& CanManager::instance() {
     if (!manager.suspension_mutex_) {
         manager.suspension_mutex_ = xSemaphoreCreateMutex();
     }
-    if (!manager.powercell_mutex_) {
-        manager.powercell_mutex_ = xSemaphoreCreateMutex();
+    if (!manager.quiesce_done_) {
+        manager.quiesce_done_ = xSemaphoreCreateBinary();
     }
-    return manager;
-}
-
-namespace {
-
-bool decodePowercellStatusPgn(uint32_t pgn, uint8_t& cellAddress, uint8_t& bankStart) {
-    if (pgn >= 0xFF10 && pgn <= 0xFF1F) {
-        bankStart = 1;
-    } else if (pgn >= 0xFF20 && pgn <= 0xFF2F) {
-        bankStart = 6;
-    } else if (pgn >= 0xFF50 && pgn <= 0xFF5F) {
-        bankStart = 1;
-    } else if (pgn >= 0xFF60 && pgn <= 0xFF6F) {
-        bankStart = 6;
-    } else {
-        return false;
+    if (!manager.monitor_pgns_mutex_) {
+        manager.monitor_pgns_mutex_ = xSemaphoreCreateMutex();
     }
-
-    cellAddress = static_cast<uint8_t>(pgn & 0x0F);
-    if (cellAddress == 0) {
-        cellAddress = 16;
+    if (!manager.powercell_sub_) {
+        manager.powercell_sub_ = manager.rx_bus_.subscribe("powercell");
+        manager.suspension_sub_ = manager.rx_bus_.subscribe("suspension");
+
+        // Frames the firmware consumes; they define the RX acceptance filter.
+        // Powercell status banks (see CanPath::decodePowercellStatusPgn) and 0x738.
+        manager.addRxInterest(canPgnInterest(0xFF10, 0x3FFF0));
+        manager.addRxInterest(canPgnInterest(0xFF20, 0x3FFF0));
+        manager.addRxInterest(canPgnInterest(0xFF50, 0x3FFF0));
+        manager.addRxInterest(canPgnInterest(0xFF60, 0x3FFF0));
+        manager.addRxInterest(canStdInterest(0x738));
     }
-
-    return true;
-}
-
+    return manager;
 }
 
 void CanManager::forceCanMux() {
@@ -72,93 +64,232 @@ bool CanManager::begin(gpio_num_t tx_pin, gpio_num_t rx_pin, std::uint32_t bitra
     Serial.println("[CanManager] Forcing USB_SEL to CAN mode...");
     forceCanMux();
 
-    // Start in LISTEN_ONLY to verify bus traffic before allowing TX
-    twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(tx_pin_, rx_pin_, TWAI_MODE_LISTEN_ONLY);
-    g_config.tx_queue_len = 8;
-    g_config.rx_queue_len = 16;
-    g_config.alerts_enabled = TWAI_ALERT_RX_DATA | TWAI_ALERT_BUS_ERROR | TWAI_ALERT_BUS_OFF | TWAI_ALERT_ERR_PASS;
-
     if (bitrate_ != 250000) {
         Serial.println("[CanManager] Unsupported bitrate requested. Falling back to 250 kbps.");
     }
 
-    const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_250KBITS();
-    
-    // Filter config: accept both EXT (Infinitybox J1939) and STD (Suspension 0x737/0x738)
-    // ACCEPT_ALL allows both frame types - this is critical for dual-format bus operation
-    const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    // Straight to NORMAL mode: bus liveness is derived from live traffic by
+    // the health task (updateBusAlive) instead of a blocking listen-only probe
+    bus_alive_.store(false, std::memory_order_relaxed);
+    alive_reset_.store(true, std::memory_order_release);  // The health task restarts its window
 
-    if (twai_driver_install(&g_config, &t_config, &f_config) != ESP_OK) {
-        Serial.println("[CanManager] Failed to install TWAI driver");
-        ready_ = false;
+    if (!driver_) {
+        Serial.println("[CanManager] No CAN driver set (setDriver)");
         return false;
     }
-
-    if (twai_start() != ESP_OK) {
-        Serial.println("[CanManager] Failed to start TWAI driver");
-        twai_driver_uninstall();  // Clean up on failure
-        ready_ = false;
+    if (!installNormalDriver(wantAcceptAll())) {
         return false;
     }
+    recovery_holdoff_ms_ = kRecoveryHoldoffMs;
+    Serial.println("[CanManager] TWAI bus ready in NORMAL mode at 250 kbps (bus liveness from traffic)");
 
-    Serial.println("[CanManager] TWAI started in LISTEN_ONLY mode, checking for bus traffic...");
-    
-    // Count RX frames for 1 second to verify bus is alive
-    uint32_t rx_count = 0;
-    uint32_t start_time = millis();
-    while (millis() - start_time < 1000) {
-        twai_message_t msg;
-        if (twai_receive(&msg, pdMS_TO_TICKS(10)) == ESP_OK) {
-            rx_count++;
-        }
+    if (!tx_task_) {
+        // Sole caller of TwaiDriver::transmit; above can_rx so queued commands go out promptly
+        xTaskCreatePinnedToCore(txTask, "can_tx", 4096, this, 4, &tx_task_, 1);
     }
-    
-    Serial.printf("[CanManager] Received %lu frames in 1 second\\n", rx_count);
-
-    // Record whether we saw traffic, but ALWAYS switch to NORMAL so we can transmit
-    bus_alive_ = (rx_count >= 3);
-    if (bus_alive_) {
-        Serial.println("[CanManager] Bus traffic detected - enabling NORMAL TX/RX mode");
-    } else {
-        Serial.println("[CanManager] WARNING: No bus traffic detected - enabling NORMAL mode anyway so this node can transmit");
+    if (!health_task_) {
+        // Sole caller of readAlerts / initiateRecovery
+        xTaskCreatePinnedToCore(healthTask, "can_health", 3072, this, 3, &health_task_, 1);
     }
+    return true;
+}
 
-    // Switch to NORMAL mode for TX/RX
-    twai_stop();
-    twai_driver_uninstall();
+// NORMAL-mode install with either the planned acceptance filter or accept-all
+// (CAN monitor open). The filter can only be changed by reinstalling.
+bool CanManager::installNormalDriver(bool accept_all) {
+    TwaiConfig config;
+    config.tx_pin = tx_pin_;
+    config.rx_pin = rx_pin_;
+    config.bitrate = 250000;
+    config.tx_queue_len = CanPath::kDriverTxQueueLen;
+    config.rx_queue_len = CanPath::kDriverRxQueueLen;
+    // Error-state alerts only (no per-frame TX_SUCCESS): they drive the health task
+    config.alerts = TwaiAlert::kTxFailed | TwaiAlert::kBusError | TwaiAlert::kBusOff | TwaiAlert::kErrPassive |
+                    TwaiAlert::kErrActive | TwaiAlert::kAboveErrWarn | TwaiAlert::kBelowErrWarn |
+                    TwaiAlert::kRecoveryInProgress | TwaiAlert::kBusRecovered;
+
+    loadRxInterests();
+    rx_filter_plan_ = CanFilterPlan{};
+    if (!accept_all) {
+        rx_filter_plan_ = CanFilterPlanner::plan(rx_interests_.data(), rx_interest_count_);
+        config.accept_all = rx_filter_plan_.mode == CanFilterPlan::Mode::AcceptAll;
+        config.acceptance_code = rx_filter_plan_.acceptance_code;
+        config.acceptance_mask = rx_filter_plan_.acceptance_mask;
+        config.single_filter = rx_filter_plan_.singleFilter();
+    }
 
-    // CRITICAL: Re-assert CAN mux before reinstalling TWAI
-    Serial.println("[CanManager] Re-asserting CAN mux before NORMAL mode...");
-    forceCanMux();
-    
-    g_config.mode = TWAI_MODE_NORMAL;
-    g_config.alerts_enabled = TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED | TWAI_ALERT_BUS_ERROR | TWAI_ALERT_BUS_OFF | TWAI_ALERT_ERR_PASS;
-    
-    if (twai_driver_install(&g_config, &t_config, &f_config) != ESP_OK) {
+    if (!driver_->install(config)) {
         Serial.println("[CanManager] Failed to reinstall TWAI in NORMAL mode");
-        ready_ = false;
         return false;
     }
-    
-    if (twai_start() != ESP_OK) {
+
+    if (!driver_->start()) {
         Serial.println("[CanManager] Failed to restart TWAI in NORMAL mode");
-        twai_driver_uninstall();  // Clean up on failure
-        ready_ = false;
+        driver_->uninstall();  // Clean up on failure
         return false;
     }
 
-    ready_ = true;
-    Serial.println("[CanManager] TWAI bus ready in NORMAL mode at 250 kbps");
+    rx_accept_all_.store(rx_filter_plan_.mode == CanFilterPlan::Mode::AcceptAll, std::memory_order_relaxed);
+    LOG_INFO("CanManager", "RX filter: %s code=0x%08lX mask=0x%08lX", rx_filter_plan_.modeName(),
+             rx_filter_plan_.acceptance_code, rx_filter_plan_.acceptance_mask);
+
+    // Publishes the filter plan to the RX task along with ready_
+    setBusState(CanBusState::Active);
+    ready_.store(true);
+    return true;
+}
+
+void CanManager::addRxInterest(const CanRxInterest& interest) {
+    if (rx_fixed_interest_count_ < rx_interests_.size()) {
+        rx_interests_[rx_fixed_interest_count_++] = interest;
+        rx_interest_count_ = rx_fixed_interest_count_;
+    }
+}
+
+void CanManager::setMonitorPgns(const std::vector<CanMonitorPgn>& pgns) {
+    std::array<uint32_t, MAX_CAN_MONITOR_PGNS> staged{};
+    std::size_t count = 0;
+    for (const CanMonitorPgn& entry : pgns) {
+        if (count >= staged.size()) {
+            break;
+        }
+        staged[count++] = entry.pgn;
+    }
+
+    xSemaphoreTake(monitor_pgns_mutex_, portMAX_DELAY);
+    if (count != monitor_pgn_count_ || staged != monitor_pgns_) {
+        monitor_pgns_ = staged;
+        monitor_pgn_count_ = count;
+        monitor_pgns_changed_.store(true, std::memory_order_release);  // Unchanged lists skip the reinstall
+    }
+    xSemaphoreGive(monitor_pgns_mutex_);
+}
+
+// Install only: rebuilds the interest list from the fixed interests and the
+// staged monitor PGNs. PDU1 PGNs (PF < 0xF0) carry the destination address
+// in their low byte, so any destination matches.
+void CanManager::loadRxInterests() {
+    xSemaphoreTake(monitor_pgns_mutex_, portMAX_DELAY);
+    rx_interest_count_ = rx_fixed_interest_count_;
+    for (std::size_t i = 0; i < monitor_pgn_count_ && rx_interest_count_ < rx_interests_.size(); ++i) {
+        const uint32_t pgn = monitor_pgns_[i];
+        const bool pdu1 = ((pgn >> 8) & 0xFF) < 0xF0;
+        rx_interests_[rx_interest_count_++] = canPgnInterest(pgn, pdu1 ? 0x3FF00 : 0x3FFFF);
+    }
+    monitor_pgns_changed_.store(false, std::memory_order_relaxed);
+    xSemaphoreGive(monitor_pgns_mutex_);
+}
+
+void CanManager::noteMonitorActivity() {
+    monitor_active_ms_.store(millis(), std::memory_order_relaxed);
+    monitor_seen_.store(true, std::memory_order_release);
+}
+
+bool CanManager::wantAcceptAll() const {
+    if (filter_override_all_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    if (CanTraceRecorder::instance().wantsAllFrames()) {
+        return true;
+    }
+    // Open monitor gets every frame; closing it restores filtering after a hold
+    return monitor_seen_.load(std::memory_order_acquire) &&
+           millis() - monitor_active_ms_.load(std::memory_order_relaxed) < kMonitorHoldMs;
+}
+
+// ─── Driver quiesce ──────────────────────────────────────────────────────────
+
+// Sequentially consistent on purpose: either the entering task sees ready_
+// cleared, or quiesceDriver() sees it in driver_users_ and waits for it
+bool CanManager::enterDriver() const {
+    driver_users_.fetch_add(1);
+    if (ready_.load()) {
+        return true;
+    }
+    leaveDriver();
+    return false;
+}
+
+void CanManager::leaveDriver() const {
+    if (driver_users_.fetch_sub(1) == 1 && quiescing_.load()) {
+        xSemaphoreGive(quiesce_done_);
+    }
+}
+
+// Park the RX, TX and health tasks outside the driver. Returns false if the
+// driver was not running (or another caller is already taking it down).
+// Must not be called between enterDriver() and leaveDriver() on one task.
+bool CanManager::quiesceDriver() {
+    bool running = true;
+    if (!ready_.compare_exchange_strong(running, false)) {
+        return false;
+    }
+    quiescing_.store(true);
+    if (tx_task_) {
+        xTaskNotifyGive(tx_task_);
+    }
+    // Each driver call returns within its own timeout (receive/alerts 50 ms,
+    // transmit 20 ms); the take timeout only re-checks after a stale give
+    while (driver_users_.load() != 0) {
+        xSemaphoreTake(quiesce_done_, pdMS_TO_TICKS(kHealthAlertWaitMs));
+    }
+    quiescing_.store(false);
+    // After the wait so a health step still in flight can't overwrite it
+    setBusState(CanBusState::Stopped);
     return true;
 }
 
+// Called from the health task: reinstall the driver when the wanted filter
+// mode differs from the installed one
+void CanManager::applyRxFilterMode() {
+    if (!ready_.load()) {
+        return;  // Stopped or mid-reinit; begin() picks the mode
+    }
+    const bool accept_all = wantAcceptAll();
+    // New monitor PGNs only matter to an installed filter; accept-all picks
+    // them up when it ends
+    const bool refilter = !accept_all && monitor_pgns_changed_.load(std::memory_order_acquire);
+    if (accept_all == rx_accept_all_.load(std::memory_order_relaxed) && !refilter) {
+        return;
+    }
+    const CanBusState state = busState();
+    if (state == CanBusState::BusOff || state == CanBusState::Recovering) {
+        return;  // Let recovery finish first
+    }
+
+    if (!quiesceDriver()) {
+        return;
+    }
+    drainDriverTx();
+    driver_->stop();
+    driver_->uninstall();
+    if (!installNormalDriver(accept_all)) {
+        LOG_ERROR("CanManager", "RX filter change failed; TWAI driver not running");
+    }
+}
+
+// With the tasks parked the controller keeps sending what the driver already
+// holds; stop() would discard it, Critical-lane frames included. Output
+// shadow frames are re-sent after the reinstall anyway (setBusState), so the
+// bound only matters when nothing acknowledges on the bus.
+void CanManager::drainDriverTx() {
+    const uint32_t start = millis();
+    TwaiStatus status;
+    while (driver_->status(status) && status.msgs_to_tx != 0) {
+        if (millis() - start >= kTxDrainTimeoutMs) {
+            LOG_WARN("CanManager", "RX filter change drops %lu queued TX frames", status.msgs_to_tx);
+            return;
+        }
+        vTaskDelay(1);
+    }
+}
+
 void CanManager::stop() {
-    if (!ready_) {
+    if (!quiesceDriver()) {
         return;
     }
-    twai_stop();
-    twai_driver_uninstall();
-    ready_ = false;
+    driver_->stop();
+    driver_->uninstall();
     Serial.println("[CanManager] TWAI driver stopped");
 }
 
@@ -178,102 +309,61 @@ bool CanManager::sendButtonReleaseAction(const ButtonConfig& button) {
     return sendFrame(button.can_off);
 }
 
-bool CanManager::sendFrame(const CanFrameConfig& frame) {
+bool CanManager::sendFrame(const CanFrameConfig& frame, CanTxLane lane) {
+    return enqueueFrame(frame, lane, 0);
+}
+
+bool CanManager::enqueueFrame(const CanFrameConfig& frame, CanTxLane lane, uint8_t powercell) {
     if (!ready_) {
-        Serial.println("[CanManager] TWAI bus not initialized");
+        LOG_WARN("CanManager", "TWAI bus not initialized");
         return false;
     }
 
     // If we haven't seen any traffic yet, warn but allow TX so this node
     // can be the first talker on the bus.
-    if (!bus_alive_) {
-        Serial.println("[CanManager] WARNING: TX while bus_alive_ == false (no startup traffic seen); attempting anyway");
+    if (!isBusAlive()) {
+        LOG_DEBUG("CanManager", "WARNING: TX while bus_alive_ == false (no recent traffic seen); attempting anyway");
     }
 
-    // Re-assert CAN mux before TX (belt and suspenders)
-    forceCanMux();
-
-    // Check for bus errors and recover if needed
-    twai_status_info_t status;
-    if (twai_get_status_info(&status) == ESP_OK) {
-        if (status.state == TWAI_STATE_BUS_OFF) {
-            Serial.println("[CanManager] Bus-off detected, initiating recovery");
-            twai_initiate_recovery();
-            vTaskDelay(pdMS_TO_TICKS(100));
-        } else if (status.state == TWAI_STATE_RECOVERING) {
-            Serial.println("[CanManager] Bus is recovering, waiting...");
-            vTaskDelay(pdMS_TO_TICKS(50));
-        }
+    CanTxRequest request;
+    request.identifier = buildIdentifier(frame);
+    request.extended = true;
+    request.length = frame.length > 8 ? 8 : frame.length;  // Use actual data length, not frame.data.size()
+    request.powercell = powercell;
+    for (std::size_t i = 0; i < request.length; ++i) {
+        request.data[i] = frame.data[i];
     }
 
-    twai_message_t message = {};
-    message.identifier = buildIdentifier(frame);
-    message.extd = 1;
-    message.data_length_code = frame.length;  // Use actual data length, not frame.data.size()
-    for (std::size_t i = 0; i < frame.length; ++i) {
-        message.data[i] = frame.data[i];
-    }
-
-    // VERBOSE LOGGING: Show exactly what we're sending
-    Serial.printf("[CanManager] TX Frame: ID=0x%08lX, Len=%d, Data=", 
-                  static_cast<unsigned long>(message.identifier), message.data_length_code);
-    for (std::size_t i = 0; i < message.data_length_code; ++i) {
-        Serial.printf("%02X ", message.data[i]);
-    }
-    Serial.println();
-    Serial.printf("[CanManager]   PGN=0x%05lX, Pri=%u, SA=0x%02X, DA=0x%02X\n",
-                  static_cast<unsigned long>(frame.pgn), frame.priority, 
-                  frame.source_address, frame.destination_address);
-
-    esp_err_t result = twai_transmit(&message, pdMS_TO_TICKS(50));
-    if (result != ESP_OK) {
-        Serial.printf("[CanManager] ✗ TX FAILED (err=%d)\n", static_cast<int>(result));
-        // Log the bus state for debugging
-        if (twai_get_status_info(&status) == ESP_OK) {
-            Serial.printf("[CanManager]   Bus state: %d, TX errors: %lu, RX errors: %lu\n",
-                         status.state, status.tx_error_counter, status.rx_error_counter);
-        }
-        return false;
-    }
+    // Per-frame trace: deferred, and compiled out below LOG_LEVEL_VERBOSE
+    LOG_VERBOSE("CanManager", "TX Frame: ID=0x%08lX, Len=%d, Data=%02X %02X %02X %02X %02X %02X %02X %02X",
+                request.identifier, request.length, request.data[0], request.data[1], request.data[2],
+                request.data[3], request.data[4], request.data[5], request.data[6], request.data[7]);
+    LOG_VERBOSE("CanManager", "  PGN=0x%05lX, Pri=%u, SA=0x%02X, DA=0x%02X",
+                frame.pgn, frame.priority, frame.source_address, frame.destination_address);
 
-    Serial.println("[CanManager] ✓ TX SUCCESS");
-    return true;
+    return enqueueTx(lane, request);
 }
 
-bool CanManager::sendStandardFrame(uint16_t identifier, const uint8_t data[8], uint8_t length) {
+bool CanManager::sendStandardFrame(uint16_t identifier, const uint8_t data[8], uint8_t length, CanTxLane lane) {
     if (!ready_) {
-        Serial.println("[CanManager] TWAI bus not initialized");
+        LOG_WARN("CanManager", "TWAI bus not initialized");
         return false;
     }
 
     if (length == 0) {
-        Serial.println("[CanManager] Standard TX length is 0");
-        return false;
-    }
-
-    forceCanMux();
-
-    twai_message_t msg = {};
-    msg.identifier = identifier & 0x7FF;
-    msg.extd = 0;
-    msg.data_length_code = length > 8 ? 8 : length;
-    memcpy(msg.data, data, msg.data_length_code);
-
-    esp_err_t result = twai_transmit(&msg, pdMS_TO_TICKS(50));
-    if (result != ESP_OK) {
-        Serial.printf("[CanManager] ✗ STD TX FAILED (err=%d)\n", static_cast<int>(result));
+        LOG_WARN("CanManager", "Standard TX length is 0");
         return false;
     }
 
-    CanRxMessage ws_msg;
-    ws_msg.identifier = msg.identifier;
-    ws_msg.length = msg.data_length_code;
-    memcpy(ws_msg.data, msg.data, 8);
-    ws_msg.timestamp = millis();
-    WebServerManager::instance().broadcastCanFrame(ws_msg, true);
+    CanTxRequest request;
+    request.identifier = identifier & 0x7FF;
+    request.extended = false;
+    request.length = length > 8 ? 8 : length;
+    request.flags = kTxFlagMonitor;
+    memcpy(request.data, data, request.length);
 
-    Serial.printf("[CanManager] ✓ STD TX ID=0x%03X Len=%d\n", msg.identifier, msg.data_length_code);
-    return true;
+    LOG_DEBUG("CanManager", "STD TX queued ID=0x%03X Len=%d", request.identifier, request.length);
+    return enqueueTx(lane, request);
 }
 
 std::uint32_t CanManager::buildIdentifier(const CanFrameConfig& frame) const {
@@ -295,78 +385,587 @@ std::uint32_t CanManager::buildIdentifier(const CanFrameConfig& frame) const {
            (static_cast<std::uint32_t>(frame.source_address));
 }
 
-bool CanManager::receiveMessage(CanRxMessage& msg, uint32_t timeout_ms) {
+uint32_t CanManager::serviceRx(uint32_t wait_ms) {
+    // injectRx() cannot wake a task blocked on the driver queue, so while a
+    // replay is feeding frames poll it every tick instead of every wait_ms
+    const uint32_t inject_ms = rx_inject_ms_.load(std::memory_order_relaxed);
+    TickType_t wait = pdMS_TO_TICKS(wait_ms);
+    if (inject_ms != 0 && millis() - inject_ms < kRxInjectHoldMs) {
+        wait = 1;
+    }
+    const uint32_t injected = drainInjectedRx();
+
+    if (!enterDriver()) {
+        // Driver not installed (boot or canreinit) - don't spin
+        vTaskDelay(wait ? wait : 1);
+        return injected + drainInjectedRx();
+    }
+
+    TwaiFrame rx_msg;
+    uint32_t drained = 0;
+
+    // Block (ISR-fed driver queue) for the first frame, then drain the backlog
+    // with zero timeout so a burst is emptied in one pass with no per-frame sleep.
+    // A pending quiesce ends the burst early instead of after the backlog.
+    while (ready_.load(std::memory_order_relaxed) && driver_->receive(rx_msg, wait)) {
+        wait = 0;
+
+        CanRxMessage msg;
+        msg.identifier = rx_msg.identifier;
+        msg.extended = rx_msg.extended;
+        msg.length = rx_msg.length > 8 ? 8 : rx_msg.length;
+        memcpy(msg.data, rx_msg.data, msg.length);
+        ++drained;
+
+        // The trace sees every frame the driver delivers, wanted or not
+        CanTraceRecorder::instance().record(msg.identifier, msg.extended, msg.data, msg.length, 0,
+                                            esp_timer_get_time());
+
+        // Second stage: the hardware filter only approximates the wanted set
+        if (!rx_accept_all_.load(std::memory_order_relaxed) && !CanFilterPlanner::wanted(rx_interests_.data(), rx_interest_count_,
+                                                          msg.identifier, msg.extended)) {
+            ++rx_sw_rejected_;
+            continue;
+        }
+
+        msg.timestamp = millis();
+        msg.timestamp_us = micros();
+
+        rx_bus_.publish(msg);
+        drainTelemetrySubscribers();
+    }
+    leaveDriver();
+
+    rx_frames_.fetch_add(drained, std::memory_order_relaxed);
+    return injected + drained + drainInjectedRx();
+}
+
+bool CanManager::injectRx(const CanRxMessage& msg) {
+    uint32_t now = millis();
+    rx_inject_ms_.store(now ? now : 1, std::memory_order_relaxed);
+    return rx_inject_.push(msg);
+}
+
+uint32_t CanManager::drainInjectedRx() {
+    uint32_t drained = 0;
+    CanRxMessage msg;
+    while (rx_inject_.pop(msg)) {
+        CanTraceRecorder::instance().record(msg.identifier, msg.extended, msg.data, msg.length,
+                                            kCanTraceInjected, esp_timer_get_time());
+        msg.timestamp = millis();
+        msg.timestamp_us = micros();
+        rx_bus_.publish(msg);
+        drainTelemetrySubscribers();
+        ++drained;
+    }
+    rx_injected_ += drained;
+    return drained;
+}
+
+void CanManager::drainTelemetrySubscribers() {
+    rx_bus_.drain(powercell_sub_, [this](const CanRxMessage& msg) {
+        if (msg.extended && msg.length == 8) {
+            updatePowercellStatusFromPgn((msg.identifier >> 8) & 0x3FFFF, msg.data);
+        }
+    });
+    rx_bus_.drain(suspension_sub_, [this](const CanRxMessage& msg) {
+        if (!msg.extended && msg.identifier == 0x738 && msg.length == 8) {
+            parseSuspensionStatus(msg.data);
+        }
+    });
+}
+
+CanRxStats CanManager::getRxStats() const {
+    CanRxStats stats;
+    stats.frames_received = rx_frames_.load(std::memory_order_relaxed);
+    stats.ring_capacity = kRxRingSize;
+    stats.hw_queue_len = CanPath::kDriverRxQueueLen;
+    stats.sw_rejected = rx_sw_rejected_;
+    stats.injected = rx_injected_;
+    stats.inject_drops = rx_inject_.drops();
+    if (!enterDriver()) {
+        return stats;
+    }
+
+    // The filter plan is only rewritten while the driver is quiesced
+    stats.filter_mode = rx_filter_plan_.modeName();
+    stats.acceptance_code = rx_filter_plan_.acceptance_code;
+    stats.acceptance_mask = rx_filter_plan_.acceptance_mask;
+
+    TwaiStatus status;
+    if (driver_->status(status)) {
+        stats.hw_pending = status.msgs_to_rx;
+        stats.hw_rx_missed = status.rx_missed_count;
+        stats.hw_rx_overrun = status.rx_overrun_count;
+        stats.bus_errors = status.bus_error_count;
+        stats.arb_lost = status.arb_lost_count;
+    }
+    leaveDriver();
+    return stats;
+}
+
+// Helper for J1939 PGN transmission (non-blocking, no ACK wait)
+bool CanManager::sendJ1939Pgn(uint8_t priority, uint32_t pgn, uint8_t source_addr, const uint8_t data[8],
+                              CanTxLane lane) {
     if (!ready_) {
+        LOG_WARN("CanManager", "TWAI not ready");
         return false;
     }
 
-    twai_message_t rx_msg;
-    esp_err_t result = twai_receive(&rx_msg, pdMS_TO_TICKS(timeout_ms));
-    
-    if (result != ESP_OK) {
+    // Build J1939 29-bit identifier: [Priority(3) | Reserved(1) | DataPage(1) | PDU Format(8) | PDU Specific(8) | Source Address(8)]
+    CanTxRequest request;
+    request.identifier = ((uint32_t)(priority & 0x7) << 26) | ((pgn & 0x3FFFF) << 8) | source_addr;
+    request.extended = true;  // Extended 29-bit ID
+    request.length = 8;
+    memcpy(request.data, data, 8);
+
+    LOG_VERBOSE("CanManager", "TX PGN=0x%05lX data=%02X %02X %02X %02X %02X %02X %02X %02X",
+                pgn, data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
+    return enqueueTx(lane, request);
+}
+
+// ─── TX scheduler ────────────────────────────────────────────────────────────
+
+namespace {
+constexpr uint32_t kTxLaneDeadlineMs[kCanTxLaneCount] = {
+    100,   // Critical: an output command older than this is stale
+    50,    // Periodic: the next cycle supersedes it (synthesizer runs at 20 Hz)
+    500,   // Diagnostic
+};
+constexpr const char* kTxLaneNames[kCanTxLaneCount] = {"critical", "periodic", "diagnostic"};
+constexpr TickType_t kTxDriverWaitTicks = pdMS_TO_TICKS(20);
+constexpr TickType_t kTxIdleWaitTicks = pdMS_TO_TICKS(10);
+}
+
+bool CanManager::enqueueTx(CanTxLane lane, const CanTxRequest& request) {
+    const auto index = static_cast<std::size_t>(lane);
+    TxLane& tx_lane = tx_lanes_[index];
+
+    // Bus off / recovering: only operator commands are held (until their
+    // deadline); periodic and diagnostic traffic is shed at the door
+    if (lane != CanTxLane::Critical && !canTransmit()) {
+        tx_lane.shed.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
 
-    msg.identifier = rx_msg.identifier;
-    msg.length = rx_msg.data_length_code;
-    msg.timestamp = millis();
-    
-    for (uint8_t i = 0; i < msg.length && i < 8; i++) {
-        msg.data[i] = rx_msg.data[i];
+    CanTxRequest stamped = request;
+    stamped.enqueue_us = micros();
+    stamped.deadline_us = stamped.enqueue_us + kTxLaneDeadlineMs[index] * 1000;
+
+    if (!tx_lane.queue.push(stamped)) {
+        LOG_WARN("CanManager", "TX lane %s full, frame 0x%08lX dropped", kTxLaneNames[index], request.identifier);
+        return false;
     }
+    tx_lane.enqueued.fetch_add(1, std::memory_order_relaxed);
+    if (tx_task_) {
+        xTaskNotifyGive(tx_task_);
+    }
+    return true;
+}
+
+// Hand one frame to the driver. Returns false when there is nothing to do
+// right now (lanes empty, or driver TX queue still full).
+bool CanManager::serviceTxOnce() {
+    const uint32_t now_us = micros();
 
+    // Critical first; otherwise earliest deadline between the remaining lanes
+    std::size_t pick = kCanTxLaneCount;
+    CanTxRequest* request = tx_lanes_[0].queue.front();
+    if (request) {
+        pick = 0;
+    } else {
+        for (std::size_t i = 1; i < kCanTxLaneCount; ++i) {
+            CanTxRequest* candidate = tx_lanes_[i].queue.front();
+            if (candidate && (!request || static_cast<int32_t>(candidate->deadline_us - request->deadline_us) < 0)) {
+                request = candidate;
+                pick = i;
+            }
+        }
+    }
+    if (!request) {
+        return false;
+    }
+
+    TxLane& lane = tx_lanes_[pick];
+    const auto lane_id = static_cast<CanTxLane>(pick);
+    if (static_cast<int32_t>(now_us - request->deadline_us) > 0) {
+        ++lane.expired;
+        const CanTxRequest expired = *request;
+        lane.queue.popFront();
+        completeTx(expired, lane_id, false);
+        return true;
+    }
+
+    TwaiFrame msg;
+    msg.identifier = request->identifier;
+    msg.extended = request->extended;
+    msg.length = request->length;
+    memcpy(msg.data, request->data, 8);
+
+    const TwaiResult result = driver_->transmit(msg, kTxDriverWaitTicks);
+    if (result == TwaiResult::Timeout) {
+        return false;  // Driver queue full (bus saturated / no ACK): retry until the deadline
+    }
+
+    const CanTxRequest done = *request;
+    lane.queue.popFront();
+
+    if (result != TwaiResult::Ok) {
+        ++lane.failed;
+        LOG_ERROR("CanManager", "✗ TX FAILED 0x%08lX (%s)", done.identifier, driver_->lastError());
+        completeTx(done, lane_id, false);
+        return true;
+    }
+
+    const uint32_t latency_us = micros() - done.enqueue_us;
+    std::size_t bucket = 0;
+    while (bucket < kCanTxLatencyBucketUs.size() && latency_us > kCanTxLatencyBucketUs[bucket]) {
+        ++bucket;
+    }
+    ++lane.latency_hist[bucket];
+    if (latency_us > lane.max_latency_us) {
+        lane.max_latency_us = latency_us;
+    }
+    ++lane.sent;
+    completeTx(done, lane_id, true);
     return true;
 }
 
-std::vector<CanRxMessage> CanManager::receiveAll(uint32_t timeout_ms) {
-    std::vector<CanRxMessage> messages;
-    
-    uint32_t start_time = millis();
-    while (millis() - start_time < timeout_ms) {
-        CanRxMessage msg;
-        if (receiveMessage(msg, 10)) {
-            messages.push_back(msg);
+void CanManager::completeTx(const CanTxRequest& request, CanTxLane lane, bool ok) {
+    if (ok) {
+        CanTraceRecorder::instance().record(request.identifier, request.extended, request.data, request.length,
+                                            kCanTraceTx, esp_timer_get_time());
+    } else if (request.powercell) {
+        // Lost output shadow frame: mark the cell dirty so its current state
+        // goes out again (after recovery, while the bus is down)
+        powercell_shadow_.write(request.powercell, 0, 0, lane == CanTxLane::Critical, micros());
+    }
+    if ((request.flags & kTxFlagSuspension) && suspension_mutex_) {
+        xSemaphoreTake(suspension_mutex_, portMAX_DELAY);
+        if (ok) {
+            suspension_stats_.tx_count++;
+            suspension_stats_.last_tx_ms = millis();
+            memcpy(suspension_stats_.last_tx_data, request.data, 8);
         } else {
-            break;
+            suspension_stats_.tx_fail_count++;
         }
+        xSemaphoreGive(suspension_mutex_);
+    }
+
+    // Echo to CAN monitor clients so standard-ID traffic (suspension) is
+    // visible. Handed to the main loop: the broadcast takes the web lock and
+    // writes to sockets, which the TX task must never wait on.
+    if (ok && (request.flags & kTxFlagMonitor)) {
+        CanRxMessage echo;
+        echo.identifier = request.identifier;
+        echo.extended = request.extended;
+        echo.length = request.length;
+        memcpy(echo.data, request.data, 8);
+        echo.timestamp = millis();
+        echo.timestamp_us = micros();
+        tx_echo_.push(echo);  // Full ring: counted in txEchoDrops()
     }
-    
-    return messages;
 }
 
-// Helper for J1939 PGN transmission (non-blocking, no ACK wait)
-bool CanManager::sendJ1939Pgn(uint8_t priority, uint32_t pgn, uint8_t source_addr, const uint8_t data[8]) {
-    if (!ready_) {
-        Serial.println("[CanManager] TWAI not ready");
+// Bus down: drop whatever cannot wait, keep Critical frames until they expire
+void CanManager::shedTx() {
+    for (std::size_t i = 0; i < kCanTxLaneCount; ++i) {
+        TxLane& lane = tx_lanes_[i];
+        const uint32_t now_us = micros();
+        while (CanTxRequest* request = lane.queue.front()) {
+            if (i == static_cast<std::size_t>(CanTxLane::Critical)) {
+                if (static_cast<int32_t>(now_us - request->deadline_us) <= 0) {
+                    break;
+                }
+                ++lane.expired;
+            } else {
+                lane.shed.fetch_add(1, std::memory_order_relaxed);
+            }
+            const CanTxRequest dropped = *request;
+            lane.queue.popFront();
+            completeTx(dropped, static_cast<CanTxLane>(i), false);
+        }
+    }
+}
+
+void CanManager::txTask(void* param) {
+    auto* self = static_cast<CanManager*>(param);
+    TickType_t wait = kTxIdleWaitTicks;
+    for (;;) {
+        // Producers notify on enqueue; the timeout retries a full driver queue
+        ulTaskNotifyTake(pdTRUE, wait);
+        wait = kTxIdleWaitTicks;
+        if (!self->ready_) {
+            continue;
+        }
+        if (!self->canTransmit()) {
+            // The Powercell shadow stays dirty and goes out after recovery
+            self->shedTx();
+            continue;
+        }
+        wait = self->flushPowercellShadow();
+        if (!self->enterDriver()) {
+            continue;
+        }
+        while (self->ready_.load(std::memory_order_relaxed) && self->canTransmit() && self->serviceTxOnce()) {
+        }
+        self->leaveDriver();
+    }
+}
+
+// ─── Bus health ──────────────────────────────────────────────────────────────
+
+const char* CanManager::busStateName(CanBusState state) {
+    switch (state) {
+        case CanBusState::Stopped: return "stopped";
+        case CanBusState::Active: return "active";
+        case CanBusState::Warning: return "warning";
+        case CanBusState::ErrorPassive: return "error_passive";
+        case CanBusState::BusOff: return "bus_off";
+        case CanBusState::Recovering: return "recovering";
+    }
+    return "unknown";
+}
+
+bool CanManager::canTransmit() const {
+    const CanBusState state = busState();
+    return state == CanBusState::Active || state == CanBusState::Warning || state == CanBusState::ErrorPassive;
+}
+
+CanBusHealth CanManager::getBusHealth() const {
+    return health_published_.load();
+}
+
+void CanManager::setBusState(CanBusState state) {
+    const CanBusState previous = busState();
+    if (previous == state) {
+        return;
+    }
+    health_.state = state;
+    health_.state_since_ms = millis();
+    bus_state_.store(static_cast<uint8_t>(state), std::memory_order_release);
+    health_published_.store(health_);
+
+    // Back on the bus after bus-off or a driver (re)install: whatever sat in
+    // the driver TX queue is gone, so every cell gets its current state again
+    const bool could_transmit = previous == CanBusState::Active || previous == CanBusState::Warning ||
+                                previous == CanBusState::ErrorPassive;
+    if (!could_transmit && canTransmit() && powercell_shadow_.resendAll(true, micros()) && tx_task_) {
+        xTaskNotifyGive(tx_task_);
+    }
+    if (state == CanBusState::BusOff || state == CanBusState::ErrorPassive) {
+        LOG_WARN("CanManager", "Bus state %s -> %s (TEC=%lu REC=%lu)", busStateName(previous), busStateName(state),
+                 health_.tx_error_counter, health_.rx_error_counter);
+    } else {
+        LOG_INFO("CanManager", "Bus state %s -> %s", busStateName(previous), busStateName(state));
+    }
+}
+
+// One step of the bus health state machine: wait for TWAI alerts, apply the
+// transitions they signal, then drive recovery. Runs only on can_health.
+void CanManager::serviceHealth(uint32_t wait_ms) {
+    if (!enterDriver()) {
+        return;
+    }
+    uint32_t alerts = 0;
+    if (!driver_->readAlerts(alerts, pdMS_TO_TICKS(wait_ms))) {
+        alerts = 0;
+    }
+    if (ready_.load(std::memory_order_relaxed)) {
+        applyHealthAlerts(alerts);
+    }
+    leaveDriver();
+}
+
+void CanManager::applyHealthAlerts(uint32_t alerts) {
+    TwaiStatus status;
+    const bool have_status = driver_->status(status);
+    if (have_status) {
+        health_.tx_error_counter = status.tx_error_counter;
+        health_.rx_error_counter = status.rx_error_counter;
+    }
+
+    const uint32_t now = millis();
+    CanBusState state = busState();
+
+    if (alerts & TwaiAlert::kBusOff) {
+        ++health_.bus_off_count;
+        health_.next_recovery_ms = now + recovery_holdoff_ms_;
+        state = CanBusState::BusOff;
+    }
+    if (alerts & TwaiAlert::kRecoveryInProgress) {
+        state = CanBusState::Recovering;
+    }
+    // Recovered leaves the controller STOPPED; also catch a missed alert
+    if ((alerts & TwaiAlert::kBusRecovered) ||
+        (state == CanBusState::Recovering && have_status && status.state == TwaiState::Stopped)) {
+        if (driver_->start()) {
+            ++health_.recovered_count;
+            state = CanBusState::Active;
+        }
+    }
+    if (state != CanBusState::BusOff && state != CanBusState::Recovering && have_status) {
+        CanBusState level = CanBusState::Active;
+        if (status.state == TwaiState::BusOff) {
+            // Alert missed (queue overflow): enter bus-off handling now
+            ++health_.bus_off_count;
+            health_.next_recovery_ms = now + recovery_holdoff_ms_;
+            level = CanBusState::BusOff;
+        } else if (status.tx_error_counter >= 128 || status.rx_error_counter >= 128) {
+            level = CanBusState::ErrorPassive;
+        } else if (status.tx_error_counter >= 96 || status.rx_error_counter >= 96) {
+            level = CanBusState::Warning;
+        }
+        if (level == CanBusState::ErrorPassive && state != CanBusState::ErrorPassive) {
+            ++health_.error_passive_count;
+        }
+        state = level;
+    }
+
+    // Recovery is deferred by a hold-off that doubles on repeated bus-offs so
+    // a shorted or unterminated bus doesn't flap; it resets after 5 s healthy
+    if (state == CanBusState::BusOff && static_cast<int32_t>(now - health_.next_recovery_ms) >= 0) {
+        if (driver_->initiateRecovery()) {
+            state = CanBusState::Recovering;
+            recovery_holdoff_ms_ = std::min(recovery_holdoff_ms_ * 2, kRecoveryHoldoffMaxMs);
+        } else {
+            health_.next_recovery_ms = now + recovery_holdoff_ms_;
+        }
+    }
+    if (state == CanBusState::Active && now - health_.state_since_ms > 5000) {
+        recovery_holdoff_ms_ = kRecoveryHoldoffMs;
+    }
+
+    setBusState(state);
+    health_published_.store(health_);  // Counters change without a state change
+}
+
+// Frames received from the driver. TX is deliberately not counted: a frame
+// TwaiDriver::transmit() accepted has only been queued, not ACKed, so our own
+// retries on an empty bus would look like traffic. Every node we talk to
+// (Powercells, IPM1) transmits on its own, so RX alone tells us the bus
+// has peers.
+uint32_t CanManager::busTraffic() const {
+    return rx_frames_.load(std::memory_order_relaxed);
+}
+
+// Bus liveness from live statistics. Alive once kBusAliveMinFrames arrive
+// within one kBusAliveWindowMs window; dead again after kBusQuietMs without
+// any. The acceptance filter hides every frame we don't consume, so while
+// it is narrow silence proves nothing: the quiet clock is held and only
+// accept-all (monitor open, trace capture) can declare the bus dead. Runs
+// only on can_health.
+void CanManager::updateBusAlive(uint32_t now) {
+    const uint32_t traffic = busTraffic();
+    if (alive_reset_.exchange(false, std::memory_order_acquire)) {
+        alive_window_ms_ = now;
+        alive_window_traffic_ = traffic;
+        last_traffic_ms_ = now;
+        last_traffic_ = traffic;
+        return;
+    }
+    if (traffic != last_traffic_ || !rx_accept_all_.load(std::memory_order_relaxed)) {
+        last_traffic_ = traffic;
+        last_traffic_ms_ = now;
+    }
+
+    const bool alive = isBusAlive();
+    if (!alive && now - alive_window_ms_ >= kBusAliveWindowMs) {
+        if (traffic - alive_window_traffic_ >= kBusAliveMinFrames) {
+            bus_alive_.store(true, std::memory_order_relaxed);
+            LOG_INFO("CanManager", "Bus traffic detected (%lu frames in %lu ms)", traffic - alive_window_traffic_,
+                     now - alive_window_ms_);
+        }
+        alive_window_ms_ = now;
+        alive_window_traffic_ = traffic;
+    } else if (alive && now - last_traffic_ms_ >= kBusQuietMs) {
+        bus_alive_.store(false, std::memory_order_relaxed);
+        alive_window_ms_ = now;
+        alive_window_traffic_ = traffic;
+        LOG_WARN("CanManager", "No bus traffic for %lu ms", now - last_traffic_ms_);
+    }
+}
+
+void CanManager::healthTask(void* param) {
+    auto* self = static_cast<CanManager*>(param);
+    for (;;) {
+        if (!self->ready_) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        self->serviceHealth(kHealthAlertWaitMs);
+        self->updateBusAlive(millis());
+        self->applyRxFilterMode();
+    }
+}
+
+std::array<CanTxLaneStats, kCanTxLaneCount> CanManager::getTxStats() const {
+    std::array<CanTxLaneStats, kCanTxLaneCount> stats{};
+    for (std::size_t i = 0; i < kCanTxLaneCount; ++i) {
+        const TxLane& lane = tx_lanes_[i];
+        CanTxLaneStats& out = stats[i];
+        out.name = kTxLaneNames[i];
+        out.depth = static_cast<uint32_t>(lane.queue.size());
+        out.capacity = kTxLaneSize;
+        out.deadline_ms = kTxLaneDeadlineMs[i];
+        out.enqueued = lane.enqueued.load(std::memory_order_relaxed);
+        out.queue_full = lane.queue.drops();
+        out.sent = lane.sent;
+        out.expired = lane.expired;
+        out.shed = lane.shed.load(std::memory_order_relaxed);
+        out.failed = lane.failed;
+        out.max_latency_us = lane.max_latency_us;
+        out.latency_hist = lane.latency_hist;
+    }
+    return stats;
+}
+
+// ─── Powercell output shadow ─────────────────────────────────────────────────
+
+bool CanManager::setPowercellOutputs(uint8_t cell_address, uint16_t mask, uint16_t outputs, CanTxLane lane) {
+    if (cell_address < 1 || cell_address > kPowercellMaxAddress) {
         return false;
     }
+    if (powercell_shadow_.write(cell_address, mask, outputs, lane == CanTxLane::Critical, micros()) && tx_task_) {
+        xTaskNotifyGive(tx_task_);
+    }
+    return ready_ && canTransmit();
+}
 
-    // Build J1939 29-bit identifier: [Priority(3) | Reserved(1) | DataPage(1) | PDU Format(8) | PDU Specific(8) | Source Address(8)]
-    uint32_t identifier = ((uint32_t)(priority & 0x7) << 26) | ((pgn & 0x3FFFF) << 8) | source_addr;
-
-    twai_message_t msg = {};
-    msg.identifier = identifier;
-    msg.extd = 1;  // Extended 29-bit ID
-    msg.data_length_code = 8;
-    memcpy(msg.data, data, 8);
-
-    // Non-blocking transmit with 50ms timeout
-    esp_err_t result = twai_transmit(&msg, pdMS_TO_TICKS(50));
-    if (result != ESP_OK) {
-        Serial.printf("[CanManager] TX queue fail: %s\n", esp_err_to_name(result));
+bool CanManager::setPowercellOutput(uint8_t cell_address, uint8_t output_number, bool on, CanTxLane lane) {
+    if (output_number < 1 || output_number > kPowercellOutputsPerCell) {
         return false;
     }
+    const uint16_t bit = static_cast<uint16_t>(1u << (output_number - 1));
+    return setPowercellOutputs(cell_address, bit, on ? bit : 0, lane);
+}
 
-    Serial.printf("[CanManager] TX PGN=0x%05lX data=%02X %02X %02X %02X %02X %02X %02X %02X\n",
-                  (unsigned long)pgn, data[0], data[1], data[2], data[3], 
-                  data[4], data[5], data[6], data[7]);
-    return true;
+uint16_t CanManager::powercellDesiredOutputs(uint8_t cell_address) const {
+    return powercell_shadow_.desired(cell_address);
+}
+
+// TX task: queue one complete Track frame per changed cell once the
+// coalescing window has passed. Returns how long the task may sleep.
+TickType_t CanManager::flushPowercellShadow() {
+    if (!powercell_shadow_.pending()) {
+        return kTxIdleWaitTicks;
+    }
+    if (powercell_shadow_.holdUs(micros(), kPowercellCoalesceUs) > 0) {
+        return 1;
+    }
+    // A full lane leaves the cell dirty; the retry comes after the idle wait
+    // (or the next enqueue), once serviceTxOnce has drained the lanes
+    powercell_shadow_.collect([this](uint8_t cell, uint16_t outputs, bool urgent) {
+        return enqueueFrame(Ipm1Can::powercellTrack(cell, outputs), urgent ? CanTxLane::Critical : CanTxLane::Periodic,
+                            cell);
+    });
+    return kTxIdleWaitTicks;
 }
 
 bool CanManager::updatePowercellStatusFromPgn(uint32_t pgn, const uint8_t data[8]) {
     uint8_t cellAddress = 0;
     uint8_t bankStart = 0;
-    if (!decodePowercellStatusPgn(pgn, cellAddress, bankStart)) {
+    if (!CanPath::decodePowercellStatusPgn(pgn, cellAddress, bankStart)) {
         return false;
     }
 
@@ -374,11 +973,8 @@ bool CanManager::updatePowercellStatusFromPgn(uint32_t pgn, const uint8_t data[8
         return false;
     }
 
-    if (powercell_mutex_) {
-        xSemaphoreTake(powercell_mutex_, portMAX_DELAY);
-    }
-
-    PowercellCellStatus& cell = powercell_status_[cellAddress - 1];
+    // RX task only: edit the private copy, then publish the whole cell
+    PowercellCellStatus& cell = powercell_rx_status_[cellAddress - 1];
     cell.last_seen_ms = millis();
     cell.voltage_raw = data[6];
     cell.temperature_c = static_cast<int8_t>(data[7]);
@@ -397,33 +993,18 @@ bool CanManager::updatePowercellStatusFromPgn(uint32_t pgn, const uint8_t data[8
         out.last_seen_ms = cell.last_seen_ms;
     }
 
-    if (powercell_mutex_) {
-        xSemaphoreGive(powercell_mutex_);
-    }
-
+    powercell_status_[cellAddress - 1].store(cell);
     return true;
 }
 
 PowercellOutputState CanManager::getPowercellOutputState(uint8_t cell_address, uint8_t output_number) const {
-    PowercellOutputState result;
     if (cell_address < 1 || cell_address > kPowercellMaxAddress) {
-        return result;
+        return {};
     }
     if (output_number < 1 || output_number > kPowercellOutputsPerCell) {
-        return result;
+        return {};
     }
-
-    if (powercell_mutex_) {
-        xSemaphoreTake(powercell_mutex_, portMAX_DELAY);
-    }
-
-    result = powercell_status_[cell_address - 1].outputs[output_number - 1];
-
-    if (powercell_mutex_) {
-        xSemaphoreGive(powercell_mutex_);
-    }
-
-    return result;
+    return powercell_status_[cell_address - 1].load().outputs[output_number - 1];
 }
 
 PowercellCellTelemetry CanManager::getPowercellCellTelemetry(uint8_t cell_address) const {
@@ -432,21 +1013,18 @@ PowercellCellTelemetry CanManager::getPowercellCellTelemetry(uint8_t cell_addres
         return result;
     }
 
-    if (powercell_mutex_) {
-        xSemaphoreTake(powercell_mutex_, portMAX_DELAY);
-    }
-
-    const PowercellCellStatus& cell = powercell_status_[cell_address - 1];
+    const PowercellCellStatus cell = powercell_status_[cell_address - 1].load();
     result.valid = (cell.last_seen_ms > 0);
     result.voltage_raw = cell.voltage_raw;
     result.temperature_c = cell.temperature_c;
     result.last_seen_ms = cell.last_seen_ms;
+    return result;
+}
 
-    if (powercell_mutex_) {
-        xSemaphoreGive(powercell_mutex_);
+void CanManager::snapshotAllCells(PowercellStatusSnapshot& out) const {
+    for (uint8_t i = 0; i < kPowercellMaxAddress; ++i) {
+        out[i] = powercell_status_[i].load();
     }
-
-    return result;
 }
 
 // ============================================================================
@@ -483,7 +1061,7 @@ SuspensionCANStats CanManager::getSuspensionStats() const {
 
 bool CanManager::sendSuspensionCommand() {
     if (!ready_) {
-        Serial.println("[Suspension] CAN not ready");
+        LOG_WARN("Suspension", "CAN not ready");
         return false;
     }
 
@@ -510,44 +1088,26 @@ bool CanManager::sendSuspensionCommand() {
     data[6] = 0x00;
     data[7] = 0x00;
 
-    // Build standard 11-bit CAN frame (0x737)
-    twai_message_t msg = {};
-    msg.identifier = 0x737;
-    msg.extd = 0;  // Standard 11-bit ID
-    msg.data_length_code = 8;
-    memcpy(msg.data, data, 8);
-
-    // Non-blocking transmit
-    esp_err_t result = twai_transmit(&msg, pdMS_TO_TICKS(50));
-    
-    // Update stats
-    if (suspension_mutex_) {
-        xSemaphoreTake(suspension_mutex_, portMAX_DELAY);
-        if (result == ESP_OK) {
-            suspension_stats_.tx_count++;
-            suspension_stats_.last_tx_ms = millis();
-            memcpy(suspension_stats_.last_tx_data, data, 8);
-        } else {
+    // Build standard 11-bit CAN frame (0x737); stats and the monitor echo are
+    // updated by the TX task once the driver has accepted it
+    CanTxRequest request;
+    request.identifier = 0x737;
+    request.extended = false;  // Standard 11-bit ID
+    request.length = 8;
+    request.flags = kTxFlagMonitor | kTxFlagSuspension;
+    memcpy(request.data, data, 8);
+
+    if (!enqueueTx(CanTxLane::Periodic, request)) {
+        if (suspension_mutex_) {
+            xSemaphoreTake(suspension_mutex_, portMAX_DELAY);
             suspension_stats_.tx_fail_count++;
+            xSemaphoreGive(suspension_mutex_);
         }
-        xSemaphoreGive(suspension_mutex_);
-    }
-
-    if (result != ESP_OK) {
-        Serial.printf("[Suspension] TX fail: %s\n", esp_err_to_name(result));
         return false;
     }
 
-    // Broadcast TX frame to CAN monitor clients so suspension traffic is visible
-    CanRxMessage ws_msg;
-    ws_msg.identifier = msg.identifier;
-    ws_msg.length = msg.data_length_code;
-    memcpy(ws_msg.data, msg.data, 8);
-    ws_msg.timestamp = millis();
-    WebServerManager::instance().broadcastCanFrame(ws_msg, true);
-
-    Serial.printf("[Suspension] TX 0x737: %02X %02X %02X %02X %02X %02X %02X %02X\n",
-                  data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
+    LOG_DEBUG("Suspension", "TX 0x737: %02X %02X %02X %02X %02X %02X %02X %02X",
+              data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
     return true;
 }
 
@@ -579,8 +1139,8 @@ void CanManager::parseSuspensionStatus(const uint8_t data[8]) {
         xSemaphoreGive(suspension_mutex_);
     }
 
-    Serial.printf("[Suspension] RX 0x738: %02X %02X %02X %02X %02X %02X %02X %02X (FL=%d%%, FR=%d%%, RL=%d%%, RR=%d%%)\n",
-                  data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7],
-                  data[1], data[2], data[3], data[4]);
+    LOG_DEBUG("Suspension", "RX 0x738: %02X %02X %02X %02X %02X %02X %02X %02X (FL=%d%%, FR=%d%%, RL=%d%%, RR=%d%%)",
+              data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7],
+              data[1], data[2], data[3], data[4]);
 }
 
@@ -3,19 +3,93 @@
 #include <Arduino.h>
 #include <hal/gpio_types.h>
 #include <array>
+#include <atomic>
 #include <vector>
 
+#include "can_filter_planner.h"
+#include "can_path_config.h"
 #include "config_types.h"
+#include "fanout_ring.h"
+#include "mpsc_ring.h"
+#include "powercell_shadow.h"
+#include "seqlock.h"
+#include "spsc_ring.h"
+#include "twai_driver.h"
 
 // Forward declaration
 class ESP_IOExpander;
 
-// Struct for received CAN messages (different from CanMessage in config_types.h)
-struct CanRxMessage {
-    uint32_t identifier;
-    uint8_t data[8];
-    uint8_t length;
-    uint32_t timestamp;
+// RX pipeline counters: TWAI driver/controller counters. Per-consumer drop
+// accounting lives on the RX bus (CanManager::rxBus().subscriberStats()).
+struct CanRxStats {
+    uint32_t frames_received = 0;   // Frames pulled from the TWAI driver queue
+    uint32_t ring_capacity = 0;
+    uint32_t hw_queue_len = 0;      // TWAI driver RX queue length
+    uint32_t hw_pending = 0;        // msgs_to_rx at time of query
+    uint32_t hw_rx_missed = 0;      // Driver RX queue full (rx_missed_count)
+    uint32_t hw_rx_overrun = 0;     // Controller FIFO overrun (rx_overrun_count)
+    uint32_t bus_errors = 0;
+    uint32_t arb_lost = 0;
+    uint32_t sw_rejected = 0;       // Passed the hardware filter, not wanted (second stage)
+    uint32_t injected = 0;          // Frames published from injectRx() (replay/simulation)
+    uint32_t inject_drops = 0;      // injectRx() calls refused, injection queue full
+    const char* filter_mode = "accept_all";
+    uint32_t acceptance_code = 0;
+    uint32_t acceptance_mask = 0xFFFFFFFF;
+};
+
+// Bus health as tracked by the CanManager health task from TWAI alerts.
+enum class CanBusState : uint8_t {
+    Stopped = 0,      // Driver not installed
+    Active,           // Error-active, TX allowed
+    Warning,          // An error counter passed the warning limit (96); TX allowed
+    ErrorPassive,     // An error counter passed 127; TX allowed, frames may be delayed
+    BusOff,           // TEC > 255: controller off the bus, recovery pending
+    Recovering,       // TwaiDriver::initiateRecovery() in progress
+};
+
+struct CanBusHealth {
+    CanBusState state = CanBusState::Stopped;
+    uint32_t state_since_ms = 0;
+    uint32_t bus_off_count = 0;
+    uint32_t recovered_count = 0;
+    uint32_t error_passive_count = 0;
+    uint32_t tx_error_counter = 0;
+    uint32_t rx_error_counter = 0;
+    uint32_t next_recovery_ms = 0;    // While BusOff: when recovery will be initiated
+};
+
+// TX scheduler lanes, highest priority first. Critical always goes first;
+// Periodic and Diagnostic are served earliest-deadline-first.
+enum class CanTxLane : uint8_t {
+    Critical = 0,    // Operator-driven outputs: horn, brake, turn signals, scene/button frames
+    Periodic = 1,    // Repeating state frames (Powercell synthesizer, suspension 0x737)
+    Diagnostic = 2,  // Polls, config frames, manual/REST test frames
+};
+
+constexpr std::size_t kCanTxLaneCount = 3;
+constexpr std::size_t kCanTxLatencyBuckets = 10;
+
+// Per-lane TX scheduler counters. Latency is enqueue -> accepted by the
+// TWAI driver; bucket i counts samples <= kCanTxLatencyBucketUs[i], the
+// last bucket everything slower.
+struct CanTxLaneStats {
+    const char* name = "";
+    uint32_t depth = 0;
+    uint32_t capacity = 0;
+    uint32_t deadline_ms = 0;
+    uint32_t enqueued = 0;
+    uint32_t queue_full = 0;    // Rejected at enqueue (lane full)
+    uint32_t sent = 0;
+    uint32_t expired = 0;       // Deadline passed before the bus was free
+    uint32_t shed = 0;          // Discarded while the bus was off / recovering
+    uint32_t failed = 0;        // Driver rejected the frame
+    uint32_t max_latency_us = 0;
+    std::array<uint32_t, kCanTxLatencyBuckets> latency_hist{};
+};
+
+constexpr std::array<uint32_t, kCanTxLatencyBuckets - 1> kCanTxLatencyBucketUs = {
+    100, 250, 500, 1000, 2000, 5000, 10000, 20000, 50000,
 };
 
 // Suspension state management (single source of truth)
@@ -61,6 +135,16 @@ struct PowercellCellTelemetry {
     uint32_t last_seen_ms = 0;
 };
 
+// Everything the status PGNs report for one Powercell
+struct PowercellCellStatus {
+    static constexpr uint8_t kOutputs = 10;
+
+    std::array<PowercellOutputState, kOutputs> outputs{};
+    uint8_t voltage_raw = 0;
+    int8_t temperature_c = 0;
+    uint32_t last_seen_ms = 0;  // 0 = never heard from
+};
+
 class CanManager {
 public:
     static CanManager& instance();
@@ -71,33 +155,117 @@ public:
     static constexpr gpio_num_t DEFAULT_TX_PIN = static_cast<gpio_num_t>(20);
     static constexpr gpio_num_t DEFAULT_RX_PIN = static_cast<gpio_num_t>(19);
 
+    static constexpr std::size_t kRxRingSize = CanPath::kRxRingSize;
+    static constexpr std::size_t kRxMaxSubscribers = CanPath::kRxMaxSubscribers;
+
+    // Every received frame is published once to this bus by the RX task (the
+    // sole caller of TwaiDriver::receive). Consumers subscribe for their own cursor.
+    using CanFrameBus = FanoutRing<CanRxMessage, kRxRingSize, kRxMaxSubscribers>;
+
     void setExpander(ESP_IOExpander* exp) { expander_ = exp; }
+    // CAN controller driver; set before begin() (espTwaiDriver() on the
+    // device, a VirtualTwaiDriver in the native build)
+    void setDriver(TwaiDriver* driver) { driver_ = driver; }
     bool begin(gpio_num_t tx_pin = DEFAULT_TX_PIN, gpio_num_t rx_pin = DEFAULT_RX_PIN, std::uint32_t bitrate = 250000);
     void stop();
     bool sendButtonAction(const ButtonConfig& button);
     bool sendButtonReleaseAction(const ButtonConfig& button);
-    bool sendFrame(const CanFrameConfig& frame);
-    bool sendStandardFrame(uint16_t identifier, const uint8_t data[8], uint8_t length);
+
+    // TX: every send* call only enqueues onto its lane (lock-free, never
+    // blocks the caller) and returns false if the bus is down or the lane is
+    // full. The CAN TX task hands frames to the driver in lane order.
+    bool sendFrame(const CanFrameConfig& frame, CanTxLane lane = CanTxLane::Critical);
+    bool sendStandardFrame(uint16_t identifier, const uint8_t data[8], uint8_t length,
+                           CanTxLane lane = CanTxLane::Critical);
+    std::array<CanTxLaneStats, kCanTxLaneCount> getTxStats() const;
+
+    // Sent frames flagged for the CAN monitor (standard-ID traffic such as
+    // suspension 0x737). The TX task pushes them here instead of touching
+    // the web server; the main loop pops them and broadcasts them as TX.
+    bool popTxEcho(CanRxMessage& msg) { return tx_echo_.pop(msg); }
+    uint32_t txEchoDrops() const { return tx_echo_.drops(); }
     
-    bool receiveMessage(CanRxMessage& msg, uint32_t timeout_ms = 10);
-    std::vector<CanRxMessage> receiveAll(uint32_t timeout_ms = 100);
+    // RX engine (called only from can_rx_task): blocks up to wait_ms for the
+    // first frame, then drains every pending frame without sleeping. Each frame
+    // is published to the RX bus; powercell telemetry and suspension feedback
+    // are drained from it on the same task. Returns the number of frames drained.
+    uint32_t serviceRx(uint32_t wait_ms);
+    CanFrameBus& rxBus() { return rx_bus_; }
+    CanRxStats getRxStats() const;
+
+    // Replay/simulation: queue a frame as if the driver had received it.
+    // The RX task publishes it (the RX bus has one producer), so injection
+    // works whether or not the driver is installed. Injected frames skip the
+    // acceptance filter and are traced with kCanTraceInjected. Any task;
+    // never blocks; returns false when the injection queue is full.
+    bool injectRx(const CanRxMessage& msg);
+
+    // RX acceptance filter. Interests describe the frames the firmware
+    // consumes (addRxInterest, before begin()) plus the configured monitor
+    // PGNs; the hardware filter is planned from them at driver install.
+    // setMonitorPgns may be called from any task: the health task reinstalls
+    // the driver to apply a change. While a monitor (WebSocket, canmon,
+    // /api/can/receive) has been active in the last kMonitorHoldMs the driver
+    // runs accept-all instead.
+    void addRxInterest(const CanRxInterest& interest);
+    void setMonitorPgns(const std::vector<CanMonitorPgn>& pgns);
+    void noteMonitorActivity();
+    void setFilterOverrideAll(bool accept_all) { filter_override_all_.store(accept_all, std::memory_order_relaxed); }
+    bool filterOverrideAll() const { return filter_override_all_.load(std::memory_order_relaxed); }
 
     // Helper for sending J1939 PGN (used by background tasks)
-    bool sendJ1939Pgn(uint8_t priority, uint32_t pgn, uint8_t source_addr, const uint8_t data[8]);
+    bool sendJ1939Pgn(uint8_t priority, uint32_t pgn, uint8_t source_addr, const uint8_t data[8],
+                      CanTxLane lane = CanTxLane::Periodic);
 
     // Suspension control (separate from Infinitybox pipeline)
     void updateSuspensionState(const SuspensionState& state);
     SuspensionState getSuspensionState() const;
     SuspensionCANStats getSuspensionStats() const;
-    bool sendSuspensionCommand();  // Sends current state to 0x737
+    bool sendSuspensionCommand();  // Queues current state to 0x737 (Periodic lane)
     void parseSuspensionStatus(const uint8_t data[8]);  // Parse 0x738 response
 
+    // Powercell output shadow: the desired Track state of every cell, shared
+    // by all producers (IPM1 actions, behavior synthesizer, raw REST). A write
+    // changes only the outputs in `mask` (bit n-1 = OUTn) and never blocks;
+    // the TX task sends each changed cell as one complete frame, holding
+    // writes for kPowercellCoalesceUs so changes from the same tick share it.
+    // A zero mask re-sends the cell unchanged (keepalive). Critical writes go
+    // out on the Critical lane, anything else on Periodic. A frame that
+    // expires or is shed marks its cell dirty again, and every written cell
+    // is re-sent when the bus comes back. Returns false for a bad address or
+    // while the bus is down (the state is kept and sent on recovery).
+    bool setPowercellOutputs(uint8_t cell_address, uint16_t mask, uint16_t outputs,
+                             CanTxLane lane = CanTxLane::Critical);
+    bool setPowercellOutput(uint8_t cell_address, uint8_t output_number, bool on,
+                            CanTxLane lane = CanTxLane::Critical);
+    uint16_t powercellDesiredOutputs(uint8_t cell_address) const;
+    // Flushes that held a cell back because OUT4+OUT8 alone aliases the poll
+    uint32_t powercellPollAliasHeld() const { return powercell_shadow_.pollAliasHeld(); }
+
+    static constexpr uint8_t kPowercellMaxAddress = 16;
+    static constexpr uint8_t kPowercellOutputsPerCell = PowercellCellStatus::kOutputs;
+    using PowercellStatusSnapshot = std::array<PowercellCellStatus, kPowercellMaxAddress>;  // [address - 1]
+
+    // Status PGNs are decoded on the RX task, the only writer. Readers never
+    // take a lock and never hold up the RX task: each cell is a seqlock, and
+    // a read returns the cell as of one complete status frame.
     bool updatePowercellStatusFromPgn(uint32_t pgn, const uint8_t data[8]);
     PowercellOutputState getPowercellOutputState(uint8_t cell_address, uint8_t output_number) const;
     PowercellCellTelemetry getPowercellCellTelemetry(uint8_t cell_address) const;
+    // All cells in one pass; use this instead of per-output getters in loops
+    void snapshotAllCells(PowercellStatusSnapshot& out) const;
+
+    bool isReady() const { return ready_.load(std::memory_order_acquire); }
+    // Frames received recently (our own TX does not count); maintained by the
+    // health task. With the narrow RX filter installed it is never cleared
+    // by silence, since frames we don't consume never reach us.
+    bool isBusAlive() const { return bus_alive_.load(std::memory_order_relaxed); }
 
-    bool isReady() const { return ready_; }
-    bool isBusAlive() const { return bus_alive_; }
+    // Published by the health task; senders read it, nobody polls the driver
+    CanBusState busState() const { return static_cast<CanBusState>(bus_state_.load(std::memory_order_acquire)); }
+    bool canTransmit() const;
+    CanBusHealth getBusHealth() const;  // Any task; a consistent snapshot
+    static const char* busStateName(CanBusState state);
     gpio_num_t txPin() const { return tx_pin_; }
     gpio_num_t rxPin() const { return rx_pin_; }
 
@@ -108,29 +276,142 @@ private:
     void forceCanMux();
 
     ESP_IOExpander* expander_ = nullptr;
-    bool ready_ = false;
-    bool bus_alive_ = false;
+    TwaiDriver* driver_ = nullptr;
+    std::atomic<bool> ready_{false};
+    std::atomic<bool> bus_alive_{false};
     gpio_num_t tx_pin_ = DEFAULT_TX_PIN;
     gpio_num_t rx_pin_ = DEFAULT_RX_PIN;
     std::uint32_t bitrate_ = 250000;
 
+    // RX pipeline: can_rx_task publishes, subscribers drain independently
+    CanFrameBus rx_bus_;
+    CanFrameBus::Subscriber* powercell_sub_ = nullptr;
+    CanFrameBus::Subscriber* suspension_sub_ = nullptr;
+    std::atomic<uint32_t> rx_frames_{0};   // can_rx writes; can_health and stats read
+
+    // Injected RX frames (injectRx). While injection is recent the RX task
+    // waits on the driver for at most one tick so replay spacing survives.
+    static constexpr std::size_t kRxInjectSize = 256;
+    static constexpr uint32_t kRxInjectHoldMs = 100;
+    MpscRing<CanRxMessage, kRxInjectSize> rx_inject_;
+    std::atomic<uint32_t> rx_inject_ms_{0};
+    uint32_t rx_injected_ = 0;
+
+    // RX acceptance filter (installed by installNormalDriver)
+    static constexpr std::size_t kMaxRxInterests = 16;
+    static constexpr uint32_t kMonitorHoldMs = 10000;
+    static constexpr uint32_t kTxDrainTimeoutMs = 20;   // Driver TX queue drain before a filter reinstall
+    std::array<CanRxInterest, kMaxRxInterests> rx_interests_{};  // Fixed interests, then monitor PGNs
+    std::size_t rx_interest_count_ = 0;
+    std::size_t rx_fixed_interest_count_ = 0;
+    // Configured monitor PGNs, staged by setMonitorPgns; copied into
+    // rx_interests_ at install, while no task reads them
+    SemaphoreHandle_t monitor_pgns_mutex_ = nullptr;
+    std::array<uint32_t, MAX_CAN_MONITOR_PGNS> monitor_pgns_{};
+    std::size_t monitor_pgn_count_ = 0;
+    std::atomic<bool> monitor_pgns_changed_{false};
+    CanFilterPlan rx_filter_plan_;
+    std::atomic<bool> rx_accept_all_{true};   // Installed filter; RX and health tasks read it
+    uint32_t rx_sw_rejected_ = 0;
+    std::atomic<uint32_t> monitor_active_ms_{0};
+    std::atomic<bool> monitor_seen_{false};
+    std::atomic<bool> filter_override_all_{false};
+
     // Suspension state (separate from Infinitybox)
     SuspensionState suspension_state_;
     SuspensionCANStats suspension_stats_;
     mutable SemaphoreHandle_t suspension_mutex_ = nullptr;
 
-    static constexpr uint8_t kPowercellMaxAddress = 16;
-    static constexpr uint8_t kPowercellOutputsPerCell = 10;
+    // Powercell status: published per cell; the RX task edits its own copy
+    std::array<Seqlock<PowercellCellStatus>, kPowercellMaxAddress> powercell_status_{};
+    PowercellStatusSnapshot powercell_rx_status_{};
+
+    // Output shadow; flushed by the TX task
+    static constexpr uint32_t kPowercellCoalesceUs = CanPath::kPowercellCoalesceUs;
+    PowercellShadow powercell_shadow_;
 
-    struct PowercellCellStatus {
-        std::array<PowercellOutputState, kPowercellOutputsPerCell> outputs{};
-        uint8_t voltage_raw = 0;
-        int8_t temperature_c = 0;
-        uint32_t last_seen_ms = 0;
+    // TX scheduler: producers push onto a lane, can_tx task drains
+    static constexpr std::size_t kTxLaneSize = CanPath::kTxLaneSize;
+    static constexpr uint8_t kTxFlagMonitor = 0x01;      // Echo to /ws/can once sent
+    static constexpr uint8_t kTxFlagSuspension = 0x02;   // Update suspension TX stats
+
+    using CanTxRequest = CanPath::TxRequest;
+
+    struct TxLane {
+        MpscRing<CanTxRequest, kTxLaneSize> queue;
+        std::atomic<uint32_t> enqueued{0};
+        uint32_t sent = 0;
+        uint32_t expired = 0;
+        std::atomic<uint32_t> shed{0};   // Also bumped by producers at enqueue
+        uint32_t failed = 0;
+        uint32_t max_latency_us = 0;
+        std::array<uint32_t, kCanTxLatencyBuckets> latency_hist{};
     };
 
-    std::array<PowercellCellStatus, kPowercellMaxAddress> powercell_status_{};
-    mutable SemaphoreHandle_t powercell_mutex_ = nullptr;
+    std::array<TxLane, kCanTxLaneCount> tx_lanes_;
+    TaskHandle_t tx_task_ = nullptr;
+
+    // TX task -> main loop monitor echo (popTxEcho)
+    static constexpr std::size_t kTxEchoSize = 32;
+    SpscRing<CanRxMessage, kTxEchoSize> tx_echo_;
+
+    // Bus health state machine (can_health task, driven by TwaiDriver::readAlerts)
+    static constexpr uint32_t kHealthAlertWaitMs = 50;
+    static constexpr uint32_t kRecoveryHoldoffMs = 100;
+    static constexpr uint32_t kRecoveryHoldoffMaxMs = 2000;
+    std::atomic<uint8_t> bus_state_{static_cast<uint8_t>(CanBusState::Stopped)};
+    // health_ is only written by whoever holds the driver (the health task,
+    // or begin()/quiesceDriver() while it is parked), one at a time, which
+    // is all Seqlock needs; readers take the published copy
+    CanBusHealth health_;
+    Seqlock<CanBusHealth> health_published_;
+    uint32_t recovery_holdoff_ms_ = kRecoveryHoldoffMs;
+    TaskHandle_t health_task_ = nullptr;
+
+    // Bus liveness (updateBusAlive, can_health task)
+    static constexpr uint32_t kBusAliveWindowMs = 1000;
+    static constexpr uint32_t kBusAliveMinFrames = 3;
+    static constexpr uint32_t kBusQuietMs = 5000;
+    uint32_t alive_window_ms_ = 0;
+    uint32_t alive_window_traffic_ = 0;
+    uint32_t last_traffic_ms_ = 0;
+    uint32_t last_traffic_ = 0;
+    std::atomic<bool> alive_reset_{false};   // Set by begin(): restart the window
+
+    bool enqueueTx(CanTxLane lane, const CanTxRequest& request);
+    bool serviceTxOnce();
+    bool enqueueFrame(const CanFrameConfig& frame, CanTxLane lane, uint8_t powercell);
+    void completeTx(const CanTxRequest& request, CanTxLane lane, bool ok);
+    void shedTx();
+    TickType_t flushPowercellShadow();
+    static void txTask(void* param);
+
+    // Driver quiesce: every driver call outside install/uninstall is bracketed
+    // by enterDriver()/leaveDriver(). quiesceDriver() clears ready_ and
+    // returns only once every task inside has left (the last one out gives
+    // quiesce_done_), so the driver can then be stopped or reinstalled.
+    mutable std::atomic<uint32_t> driver_users_{0};
+    std::atomic<bool> quiescing_{false};
+    SemaphoreHandle_t quiesce_done_ = nullptr;
+
+    bool enterDriver() const;
+    void leaveDriver() const;
+    bool quiesceDriver();
+
+    bool installNormalDriver(bool accept_all);
+    void loadRxInterests();
+    void drainDriverTx();
+    bool wantAcceptAll() const;
+    void applyRxFilterMode();
+
+    void setBusState(CanBusState state);
+    void serviceHealth(uint32_t wait_ms);
+    void applyHealthAlerts(uint32_t alerts);
+    uint32_t busTraffic() const;
+    void updateBusAlive(uint32_t now);
+    static void healthTask(void* param);
 
     std::uint32_t buildIdentifier(const CanFrameConfig& frame) const;
+    void drainTelemetrySubscribers();
+    uint32_t drainInjectedRx();
 };
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "can_path_config.h"
+
+// Binary wire format for the /ws/can monitor socket.
+//
+// Frames are coalesced into one binary WebSocket message per batch window.
+// All multi-byte fields are little-endian (native on the ESP32 and on every
+// browser DataView call with littleEndian=true).
+//
+//   Batch header (8 bytes)
+//     [0]    magic   0xCB
+//     [1]    version 1
+//     [2..3] record count
+//     [4..7] frames dropped before this batch (running total)
+//
+//   Record (18 bytes, fixed size)
+//     [0..3]   identifier (11 or 29 bit)
+//     [4..7]   timestamp, microseconds (micros(), wraps)
+//     [8]      flags: bit0 = extended ID, bit1 = TX
+//     [9]      DLC (0-8)
+//     [10..17] data, zero padded
+//
+// Clients that cannot parse binary opt into JSON by sending
+// {"format":"json"} after connecting; they receive {"type":"can_frames",...}
+// text batches built from the same records (buildJsonBatch).
+namespace CanMonitorProtocol {
+
+constexpr std::uint8_t kMagic = 0xCB;
+constexpr std::uint8_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 8;
+constexpr std::size_t kRecordSize = 18;
+
+constexpr std::uint8_t kFlagExtended = 0x01;
+constexpr std::uint8_t kFlagTx = 0x02;
+
+inline void putU16(std::uint8_t* out, std::uint16_t value) {
+    out[0] = static_cast<std::uint8_t>(value);
+    out[1] = static_cast<std::uint8_t>(value >> 8);
+}
+
+inline void putU32(std::uint8_t* out, std::uint32_t value) {
+    out[0] = static_cast<std::uint8_t>(value);
+    out[1] = static_cast<std::uint8_t>(value >> 8);
+    out[2] = static_cast<std::uint8_t>(value >> 16);
+    out[3] = static_cast<std::uint8_t>(value >> 24);
+}
+
+inline std::uint32_t getU32(const std::uint8_t* in) {
+    return static_cast<std::uint32_t>(in[0]) | (static_cast<std::uint32_t>(in[1]) << 8) |
+           (static_cast<std::uint32_t>(in[2]) << 16) | (static_cast<std::uint32_t>(in[3]) << 24);
+}
+
+inline void writeHeader(std::uint8_t* out, std::uint16_t count, std::uint32_t dropped) {
+    out[0] = kMagic;
+    out[1] = kVersion;
+    putU16(out + 2, count);
+    putU32(out + 4, dropped);
+}
+
+inline void writeRecord(std::uint8_t* out, const CanRxMessage& msg, bool is_tx) {
+    const std::uint8_t dlc = msg.length > 8 ? 8 : msg.length;
+    putU32(out, msg.identifier);
+    putU32(out + 4, msg.timestamp_us);
+    out[8] = static_cast<std::uint8_t>((msg.extended ? kFlagExtended : 0) | (is_tx ? kFlagTx : 0));
+    out[9] = dlc;
+    std::memset(out + 10, 0, 8);
+    std::memcpy(out + 10, msg.data, dlc);
+}
+
+// JSON fallback: {"type":"can_frames","dropped":N,"frames":[...]} for
+// `count` records as laid out by writeRecord
+inline String buildJsonBatch(const std::uint8_t* records, std::uint16_t count, std::uint32_t dropped) {
+    String json;
+    json.reserve(40 + count * 96);
+    json += "{\"type\":\"can_frames\",\"dropped\":";
+    json += dropped;
+    json += ",\"frames\":[";
+    for (std::uint16_t i = 0; i < count; ++i) {
+        const std::uint8_t* rec = records + i * kRecordSize;
+        const bool ext = (rec[8] & kFlagExtended) != 0;
+        const std::uint8_t dlc = rec[9];
+        char item[128];
+        int used = snprintf(item, sizeof(item), "%s{\"id\":\"%0*lX\",\"ext\":%s,\"ts_us\":%lu,\"dir\":\"%s\",\"data\":[",
+                            i ? "," : "", ext ? 8 : 3, static_cast<unsigned long>(getU32(rec)),
+                            ext ? "true" : "false", static_cast<unsigned long>(getU32(rec + 4)),
+                            (rec[8] & kFlagTx) ? "TX" : "RX");
+        for (std::uint8_t b = 0; b < dlc && used > 0 && used < static_cast<int>(sizeof(item)); ++b) {
+            used += snprintf(item + used, sizeof(item) - used, b ? ",%u" : "%u", rec[10 + b]);
+        }
+        json += item;
+        json += "]}";
+    }
+    json += "]}";
+    return json;
+}
+
+}  // namespace CanMonitorProtocol
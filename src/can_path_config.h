@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Sizes and timings of CanManager's CAN path, its frame types and the
+// Powercell status decoder, kept free of ESP-IDF headers so the native
+// soak model and bench (native/) run against the same numbers and types as
+// the firmware instead of copies of them.
+
+// Struct for received CAN messages (different from CanMessage in config_types.h)
+struct CanRxMessage {
+    uint32_t identifier = 0;
+    uint8_t data[8] = {0};
+    uint8_t length = 0;
+    bool extended = false;   // 29-bit identifier (J1939) vs 11-bit standard
+    uint32_t timestamp = 0;      // millis() at receive
+    uint32_t timestamp_us = 0;   // micros() at receive (wraps every ~71 min)
+};
+
+namespace CanPath {
+
+constexpr std::size_t kTxLaneSize = 32;          // Entries per TX scheduler lane
+constexpr std::size_t kDriverTxQueueLen = 8;     // twai_general_config_t::tx_queue_len
+// twai_general_config_t::rx_queue_len. 250 kbps J1939 peaks around 1,800
+// frames/s, so the old 16-deep queue overflowed on any scheduling hiccup.
+constexpr uint16_t kDriverRxQueueLen = 128;
+constexpr std::size_t kRxRingSize = 512;         // RX bus (FanoutRing) slots
+constexpr std::size_t kRxMaxSubscribers = 8;
+constexpr uint32_t kPowercellCoalesceUs = 1000;  // Output shadow batching window
+
+// One frame waiting in a TX lane
+struct TxRequest {
+    uint32_t identifier = 0;
+    uint8_t data[8] = {0};
+    uint8_t length = 0;
+    bool extended = false;
+    uint8_t flags = 0;
+    uint8_t powercell = 0;       // Output shadow frame for this cell (0 = none)
+    uint32_t enqueue_us = 0;
+    uint32_t deadline_us = 0;
+};
+
+// Powercell status PGN -> cell address and first output of the 5-output
+// bank it reports (0xFF1x/0xFF5x: OUT1-5, 0xFF2x/0xFF6x: OUT6-10)
+inline bool decodePowercellStatusPgn(uint32_t pgn, uint8_t& cellAddress, uint8_t& bankStart) {
+    if (pgn >= 0xFF10 && pgn <= 0xFF1F) {
+        bankStart = 1;
+    } else if (pgn >= 0xFF20 && pgn <= 0xFF2F) {
+        bankStart = 6;
+    } else if (pgn >= 0xFF50 && pgn <= 0xFF5F) {
+        bankStart = 1;
+    } else if (pgn >= 0xFF60 && pgn <= 0xFF6F) {
+        bankStart = 6;
+    } else {
+        return false;
+    }
+
+    cellAddress = static_cast<uint8_t>(pgn & 0x0F);
+    if (cellAddress == 0) {
+        cellAddress = 16;
+    }
+
+    return true;
+}
+
+}  // namespace CanPath
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <FS.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "can_trace_format.h"
+
+// Deterministic playback of recorded CAN traces.
+//
+// The player paces records from a CanTraceSource by their capture
+// timestamps: record i is due at start + (ts_i - ts_0) / speed, so the
+// inter-frame spacing of the original bus is preserved at 1x and scaled at
+// Nx. Speed 0 plays as fast as the sink accepts frames. Due times are
+// computed from the first record rather than accumulated, so lateness in
+// one service() call never drifts the rest of the trace. Timestamps are
+// taken as a running maximum, so a record stamped earlier than its
+// predecessor (clock step, merged traces) plays immediately after it
+// instead of wrapping the offset into a wait of centuries.
+//
+// Only received frames are replayed by default: the firmware regenerates
+// its own TX traffic. Gap records (frames the recorder lost) are skipped.
+// Portable; the device drives it from CanReplayManager, the host from the
+// native soak harness.
+
+class CanTraceSource {
+public:
+    virtual ~CanTraceSource() = default;
+    virtual bool next(CanTraceRecord& out) = 0;
+    virtual bool rewind() = 0;
+};
+
+// Binary trace (CanTraceFileHeader + records), e.g. a recorder spill file
+class CanTraceFileSource : public CanTraceSource {
+public:
+    bool open(fs::FS& fs, const char* path) {
+        file_ = fs.open(path, FILE_READ);
+        if (!file_) {
+            return false;
+        }
+        if (file_.read(reinterpret_cast<uint8_t*>(&header_), sizeof(header_)) != sizeof(header_) ||
+            std::memcmp(header_.magic, CanTraceFileHeader{}.magic, sizeof(header_.magic)) != 0 ||
+            header_.record_size != sizeof(CanTraceRecord)) {
+            file_.close();
+            return false;
+        }
+        remaining_ = header_.records;
+        return true;
+    }
+
+    void close() { file_.close(); }
+    const CanTraceFileHeader& header() const { return header_; }
+
+    bool next(CanTraceRecord& out) override {
+        if (remaining_ == 0 || !file_) {
+            return false;
+        }
+        if (file_.read(reinterpret_cast<uint8_t*>(&out), sizeof(out)) != sizeof(out)) {
+            remaining_ = 0;
+            return false;
+        }
+        --remaining_;
+        return true;
+    }
+
+    bool rewind() override {
+        if (!file_ || !file_.seek(sizeof(header_))) {
+            return false;
+        }
+        remaining_ = header_.records;
+        return true;
+    }
+
+private:
+    fs::File file_;
+    CanTraceFileHeader header_;
+    uint32_t remaining_ = 0;
+};
+
+struct CanReplayOptions {
+    uint32_t speed_permille = 1000;  // 1000 = real time, 4000 = 4x, 0 = as fast as possible
+    bool include_tx = false;         // Also replay frames the recording node sent
+    bool loop = false;
+    uint32_t max_burst = 64;         // Frames per service() call at speed 0
+};
+
+struct CanReplayStats {
+    uint32_t played = 0;
+    uint32_t skipped = 0;            // Gap and (unless include_tx) TX records
+    uint32_t rejected = 0;           // Sink refused the frame (queue full)
+    uint32_t loops = 0;
+    uint32_t max_late_us = 0;        // Worst delivery behind schedule
+};
+
+class CanReplayPlayer {
+public:
+    static constexpr uint32_t kIdle = UINT32_MAX;
+
+    void start(CanTraceSource* source, const CanReplayOptions& options, uint64_t now_us) {
+        source_ = source;
+        options_ = options;
+        stats_ = CanReplayStats{};
+        origin_us_ = now_us;
+        have_next_ = false;
+        first_ts_valid_ = false;
+        active_ = source_ != nullptr;
+    }
+
+    void stop() {
+        active_ = false;
+        source_ = nullptr;
+    }
+
+    bool active() const { return active_; }
+    const CanReplayStats& stats() const { return stats_; }
+    const CanReplayOptions& options() const { return options_; }
+
+    // Hands every due record to sink(record) -> bool (false = try again
+    // later). Returns microseconds until the next record is due, 0 when
+    // more are due now, or kIdle once the trace has finished.
+    template <typename Sink>
+    uint32_t service(uint64_t now_us, Sink&& sink) {
+        uint32_t burst = 0;
+        while (active_) {
+            if (!have_next_ && !fetch(now_us)) {
+                active_ = false;
+                break;
+            }
+            const uint64_t due = dueUs();
+            if (due > now_us) {
+                const uint64_t wait = due - now_us;
+                return wait > kIdle - 1 ? kIdle - 1 : static_cast<uint32_t>(wait);
+            }
+            if (options_.speed_permille == 0 && burst >= options_.max_burst) {
+                return 0;
+            }
+            if (!sink(next_)) {
+                ++stats_.rejected;
+                return 0;  // Sink full: keep the record, retry on the next call
+            }
+            const uint64_t late = now_us - due;
+            if (options_.speed_permille != 0 && late > stats_.max_late_us) {
+                stats_.max_late_us = late > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(late);
+            }
+            ++stats_.played;
+            ++burst;
+            have_next_ = false;
+        }
+        return kIdle;
+    }
+
+private:
+    bool fetch(uint64_t now_us) {
+        for (;;) {
+            if (!source_->next(next_)) {
+                if (!options_.loop || stats_.played == 0 || !source_->rewind()) {
+                    return false;
+                }
+                // Next pass starts now, spaced like the first
+                ++stats_.loops;
+                origin_us_ = now_us;
+                first_ts_valid_ = false;
+                continue;
+            }
+            if ((next_.flags & kCanTraceGap) || ((next_.flags & kCanTraceTx) && !options_.include_tx)) {
+                ++stats_.skipped;
+                continue;
+            }
+            if (!first_ts_valid_) {
+                first_ts_ = next_.timestamp_us;
+                max_ts_ = next_.timestamp_us;
+                first_ts_valid_ = true;
+            } else if (next_.timestamp_us > max_ts_) {
+                max_ts_ = next_.timestamp_us;
+            }
+            have_next_ = true;
+            return true;
+        }
+    }
+
+    uint64_t dueUs() const {
+        if (options_.speed_permille == 0) {
+            return origin_us_;
+        }
+        const uint64_t offset = max_ts_ - first_ts_;
+        return origin_us_ + offset * 1000 / options_.speed_permille;
+    }
+
+    CanTraceSource* source_ = nullptr;
+    CanReplayOptions options_;
+    CanReplayStats stats_;
+    CanTraceRecord next_;
+    bool have_next_ = false;
+    bool active_ = false;
+    bool first_ts_valid_ = false;
+    uint64_t first_ts_ = 0;
+    uint64_t max_ts_ = 0;             // Latest timestamp fetched this pass
+    uint64_t origin_us_ = 0;
+};
@@ -0,0 +1,118 @@
+#include "can_replay_manager.h"
+
+#include <LittleFS.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "can_manager.h"
+#include "can_trace_recorder.h"
+
+CanReplayManager& CanReplayManager::instance() {
+    static CanReplayManager manager;
+    return manager;
+}
+
+bool CanReplayManager::start(const char* path, const CanReplayOptions& options) {
+    if (running_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (!path || !*path) {
+        path = CanTraceRecorder::kSpillPath;
+    }
+    if (!status_mutex_) {
+        status_mutex_ = xSemaphoreCreateMutex();
+    }
+    if (!source_.open(LittleFS, path)) {
+        Serial.printf("[Replay] %s is not a readable trace file\n", path);
+        return false;
+    }
+    strlcpy(path_, path, sizeof(path_));
+    options_ = options;
+    last_stats_ = CanReplayStats{};
+    stop_requested_.store(false, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+
+    if (!task_) {
+        // Above the UI, below the CAN RX/TX tasks it feeds
+        xTaskCreatePinnedToCore(replayTask, "can_replay", 4096, this, 3, &task_, 0);
+    } else {
+        xTaskNotifyGive(task_);
+    }
+    Serial.printf("[Replay] Playing %s (%lu records) at %lu.%03lux%s\n", path_,
+                  static_cast<unsigned long>(source_.header().records),
+                  static_cast<unsigned long>(options_.speed_permille / 1000),
+                  static_cast<unsigned long>(options_.speed_permille % 1000), options_.loop ? ", looping" : "");
+    return true;
+}
+
+void CanReplayManager::stop() {
+    if (running_.load(std::memory_order_acquire)) {
+        stop_requested_.store(true, std::memory_order_release);
+        xTaskNotifyGive(task_);
+    }
+}
+
+void CanReplayManager::replayTask(void* param) {
+    auto* self = static_cast<CanReplayManager*>(param);
+    for (;;) {
+        if (self->running_.load(std::memory_order_acquire)) {
+            self->run();
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void CanReplayManager::run() {
+    auto& can = CanManager::instance();
+    auto inject = [&can](const CanTraceRecord& record) {
+        CanRxMessage msg;
+        msg.identifier = record.identifier;
+        msg.extended = (record.flags & kCanTraceExtended) != 0;
+        msg.length = record.length;
+        memcpy(msg.data, record.data, sizeof(msg.data));
+        return can.injectRx(msg);
+    };
+
+    player_.start(&source_, options_, esp_timer_get_time());
+    while (!stop_requested_.load(std::memory_order_acquire)) {
+        const uint32_t wait_us = player_.service(esp_timer_get_time(), inject);
+
+        xSemaphoreTake(status_mutex_, portMAX_DELAY);
+        last_stats_ = player_.stats();
+        xSemaphoreGive(status_mutex_);
+
+        if (wait_us == CanReplayPlayer::kIdle) {
+            break;
+        }
+        // Frames due within the same tick go out together; a full injection
+        // queue (wait 0) backs off one tick so the RX task can drain it
+        const TickType_t ticks = std::max<TickType_t>(1, pdMS_TO_TICKS(wait_us / 1000));
+        ulTaskNotifyTake(pdTRUE, ticks);
+    }
+    player_.stop();
+    source_.close();
+
+    const CanReplayStats& stats = last_stats_;
+    Serial.printf("[Replay] %s: %lu frames played, %lu skipped, %lu retried, max %lu us late\n",
+                  stop_requested_.load(std::memory_order_relaxed) ? "Stopped" : "Finished",
+                  static_cast<unsigned long>(stats.played), static_cast<unsigned long>(stats.skipped),
+                  static_cast<unsigned long>(stats.rejected), static_cast<unsigned long>(stats.max_late_us));
+    running_.store(false, std::memory_order_release);
+}
+
+CanReplayStatus CanReplayManager::getStatus() const {
+    CanReplayStatus status;
+    status.running = running_.load(std::memory_order_acquire);
+    strlcpy(status.path, path_, sizeof(status.path));
+    status.speed_permille = options_.speed_permille;
+    status.loop = options_.loop;
+    status.records = source_.header().records;
+    if (status_mutex_) {
+        xSemaphoreTake(status_mutex_, portMAX_DELAY);
+        status.stats = last_stats_;
+        xSemaphoreGive(status_mutex_);
+    }
+    return status;
+}
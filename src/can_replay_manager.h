@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "can_replay.h"
+
+struct CanReplayStatus {
+    bool running = false;
+    char path[48] = {0};
+    uint32_t speed_permille = 0;
+    bool loop = false;
+    uint32_t records = 0;          // Records in the trace file
+    CanReplayStats stats;
+};
+
+// Plays a binary trace file back into the CAN RX path (CanManager::injectRx)
+// from its own task, so decoders, the behavior engine and the UI see the
+// recorded bus without hardware attached. One replay at a time; the file is
+// owned by the replay task from start() until the trace ends or stop().
+class CanReplayManager {
+public:
+    static CanReplayManager& instance();
+
+    // Opens `path` (default: the recorder spill file) and starts playback.
+    // Returns false if the file is not a valid trace or a replay is running.
+    bool start(const char* path, const CanReplayOptions& options);
+    void stop();
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    CanReplayStatus getStatus() const;
+
+private:
+    CanReplayManager() = default;
+
+    void run();
+    static void replayTask(void* param);
+
+    CanTraceFileSource source_;
+    CanReplayPlayer player_;
+    CanReplayOptions options_;
+    char path_[48] = {0};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_requested_{false};
+    SemaphoreHandle_t status_mutex_ = nullptr;
+    CanReplayStats last_stats_;
+    TaskHandle_t task_ = nullptr;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// On-disk / on-wire CAN trace format shared by the recorder (device), the
+// replay player and the host tools.
+
+// Raw binary format: a CanTraceFileHeader followed by `records` of these,
+// little-endian. A record with kCanTraceGap set stands for one frame that
+// was overwritten before it could be read; its other fields are zero.
+struct CanTraceRecord {
+    uint64_t timestamp_us = 0;   // esp_timer time at capture
+    uint32_t identifier = 0;     // 11- or 29-bit
+    uint8_t length = 0;
+    uint8_t flags = 0;           // kCanTrace*
+    uint16_t reserved = 0;
+    uint8_t data[8] = {0};
+};
+static_assert(sizeof(CanTraceRecord) == 24, "CanTraceRecord is an on-disk format");
+
+constexpr uint8_t kCanTraceExtended = 0x01;
+constexpr uint8_t kCanTraceTx = 0x02;
+constexpr uint8_t kCanTraceInjected = 0x04;  // Replayed into the RX path, not from the wire
+constexpr uint8_t kCanTraceGap = 0x80;
+
+struct CanTraceFileHeader {
+    char magic[4] = {'C', 'T', 'R', 'C'};
+    uint16_t version = 1;
+    uint16_t record_size = sizeof(CanTraceRecord);
+    uint32_t records = 0;
+    uint32_t first_sequence = 0;  // Ring position of the first record
+    uint64_t trigger_us = 0;      // Timestamp of the trigger frame (spills), 0 otherwise
+};
+static_assert(sizeof(CanTraceFileHeader) == 24, "CanTraceFileHeader is an on-disk format");
+
+enum class CanTraceFormat : uint8_t {
+    Candump,  // can-utils log: "(sec.usec) can0 ID#DATA"
+    Asc,      // Vector ASCII trace
+    Binary,   // CanTraceFileHeader + CanTraceRecord[]
+};
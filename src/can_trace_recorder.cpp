@@ -0,0 +1,419 @@
+#include "can_trace_recorder.h"
+
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr const char* kSpillTempPath = "/can_trace.tmp";
+constexpr std::size_t kSpillBatch = 32;             // Records per LittleFS write
+constexpr uint32_t kSpillPollMs = 10;               // Waiting for post-trigger frames
+constexpr uint32_t kSpillIdleTimeoutMs = 5000;      // Quiet bus: close the spill short
+constexpr uint32_t kNotYetRetries = 1000;           // A writer mid-copy finishes in well under this
+
+enum ExportPhase : uint8_t { kPhaseHeader = 0, kPhaseRecords, kPhaseTrailer, kPhaseDone };
+
+// Slots a reader keeps away from the writer so a read in progress is not lapped
+uint32_t readGuard(uint32_t capacity) { return capacity / 16; }
+
+size_t appendHex(char* out, const uint8_t* data, uint8_t length, bool spaced) {
+    static const char kHex[] = "0123456789ABCDEF";
+    size_t n = 0;
+    for (uint8_t i = 0; i < length; ++i) {
+        if (spaced) out[n++] = ' ';
+        out[n++] = kHex[data[i] >> 4];
+        out[n++] = kHex[data[i] & 0x0F];
+    }
+    out[n] = '\0';
+    return n;
+}
+}
+
+CanTraceRecorder& CanTraceRecorder::instance() {
+    static CanTraceRecorder recorder;
+    return recorder;
+}
+
+bool CanTraceRecorder::begin(uint32_t capacity) {
+    if (slots_) {
+        return true;
+    }
+    uint32_t rounded = 1;
+    while (rounded * 2 <= capacity) {
+        rounded *= 2;
+    }
+    auto* slots = static_cast<Slot*>(heap_caps_calloc(rounded, sizeof(Slot), MALLOC_CAP_SPIRAM));
+    if (!slots) {
+        Serial.printf("[Trace] Failed to allocate %lu records in PSRAM; recorder disabled\n",
+                      static_cast<unsigned long>(rounded));
+        return false;
+    }
+    capacity_ = rounded;
+    mask_ = rounded - 1;
+    slots_ = slots;
+
+    // Low priority: the spill only trails the ring, it never gates capture
+    xTaskCreatePinnedToCore(spillTask, "can_trace", 4096, this, 1, &spill_task_, 0);
+    Serial.printf("[Trace] Recorder ready: %lu records (%lu KB PSRAM)\n", static_cast<unsigned long>(capacity_),
+                  static_cast<unsigned long>(capacity_ * sizeof(Slot) / 1024));
+    return true;
+}
+
+void CanTraceRecorder::clear() {
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+CanTraceRecorder::ReadResult CanTraceRecorder::read(uint32_t pos, CanTraceRecord& out) const {
+    uint32_t head = head_.load(std::memory_order_acquire);
+    if (static_cast<int32_t>(head - pos) <= 0) {
+        return ReadResult::NotYet;
+    }
+    if (head - pos > capacity_) {
+        return ReadResult::Lost;
+    }
+    const Slot& slot = slots_[pos & mask_];
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1) {
+        // Either its writer is mid-copy, or a lapping writer took the slot
+        head = head_.load(std::memory_order_acquire);
+        return head - pos > capacity_ ? ReadResult::Lost : ReadResult::NotYet;
+    }
+    out = slot.record;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == pos + 1 ? ReadResult::Ok : ReadResult::Lost;
+}
+
+// ─── Triggered spill ─────────────────────────────────────────────────────────
+
+bool CanTraceRecorder::armTrigger(const CanTraceTrigger& trigger) {
+    if (!slots_ || spilling_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    trigger_armed_.store(false, std::memory_order_relaxed);
+    trigger_ = trigger;
+    trigger_.pre_records = std::min(trigger.pre_records, capacity_ - readGuard(capacity_));
+    trigger_armed_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool CanTraceRecorder::triggerNow() {
+    if (!slots_ || spilling_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    trigger_armed_.store(true, std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    fireTrigger(head == tail_.load(std::memory_order_relaxed) ? head : head - 1);
+    return true;
+}
+
+void CanTraceRecorder::fireTrigger(uint32_t pos) {
+    bool armed = true;
+    if (!trigger_armed_.compare_exchange_strong(armed, false, std::memory_order_acq_rel)) {
+        return;  // Another frame (or task) fired it first
+    }
+    trigger_pos_.store(pos, std::memory_order_relaxed);
+    spilling_.store(true, std::memory_order_release);
+    if (spill_task_) {
+        xTaskNotifyGive(spill_task_);
+    }
+}
+
+void CanTraceRecorder::spill() {
+    const uint32_t trigger_pos = trigger_pos_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t window = capacity_ - readGuard(capacity_);
+    const uint32_t oldest = (head - tail > window) ? head - window : tail;
+    const uint32_t pre = static_cast<int32_t>(trigger_pos - oldest) > 0 ? trigger_pos - oldest : 0;
+    const uint32_t start = trigger_pos - std::min(trigger_.pre_records, pre);
+    const uint32_t end = trigger_pos + 1 + trigger_.post_records;
+
+    File file = LittleFS.open(kSpillTempPath, FILE_WRITE);
+    if (!file) {
+        Serial.println("[Trace] Spill failed: cannot open temp file");
+        spilling_.store(false, std::memory_order_release);
+        return;
+    }
+
+    CanTraceFileHeader header;
+    header.first_sequence = start;
+    CanTraceRecord trigger_record;
+    if (read(trigger_pos, trigger_record) == ReadResult::Ok) {
+        header.trigger_us = trigger_record.timestamp_us;
+    }
+    file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+
+    CanTraceRecord batch[kSpillBatch];
+    uint32_t pos = start;
+    uint32_t gaps = 0;
+    uint32_t last_progress_ms = millis();
+    while (pos != end) {
+        std::size_t n = 0;
+        while (n < kSpillBatch && pos != end) {
+            const ReadResult result = read(pos, batch[n]);
+            if (result == ReadResult::NotYet) {
+                break;
+            }
+            if (result == ReadResult::Lost) {
+                batch[n] = CanTraceRecord{};
+                batch[n].flags = kCanTraceGap;
+                ++gaps;
+            }
+            ++n;
+            ++pos;
+        }
+        if (n > 0) {
+            file.write(reinterpret_cast<const uint8_t*>(batch), n * sizeof(CanTraceRecord));
+            last_progress_ms = millis();
+            continue;
+        }
+        // Waiting for post-trigger frames; give up on a quiet or stopped bus
+        if (!enabled() || millis() - last_progress_ms > kSpillIdleTimeoutMs) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(kSpillPollMs));
+    }
+
+    header.records = pos - start;
+    file.seek(0);
+    file.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    file.close();
+
+    if (LittleFS.exists(kSpillPath)) {
+        LittleFS.remove(kSpillPath);
+    }
+    if (!LittleFS.rename(kSpillTempPath, kSpillPath)) {
+        Serial.println("[Trace] Spill failed: rename");
+    } else {
+        spills_.fetch_add(1, std::memory_order_relaxed);
+        spill_records_.store(header.records, std::memory_order_relaxed);
+        spill_gaps_.store(gaps, std::memory_order_relaxed);
+        Serial.printf("[Trace] Spilled %lu records (%lu lost) to %s\n", static_cast<unsigned long>(header.records),
+                      static_cast<unsigned long>(gaps), kSpillPath);
+    }
+    spilling_.store(false, std::memory_order_release);
+}
+
+void CanTraceRecorder::spillTask(void* param) {
+    auto* self = static_cast<CanTraceRecorder*>(param);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (self->spilling_.load(std::memory_order_acquire)) {
+            self->spill();
+        }
+    }
+}
+
+CanTraceStats CanTraceRecorder::getStats() const {
+    CanTraceStats stats;
+    stats.allocated = slots_ != nullptr;
+    stats.enabled = enabled();
+    stats.capture_all = capture_all_.load(std::memory_order_relaxed);
+    stats.capacity = capacity_;
+    stats.recorded = head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    stats.available = std::min(stats.recorded, capacity_ - readGuard(capacity_));
+    stats.trigger_armed = trigger_armed_.load(std::memory_order_relaxed);
+    stats.spilling = spilling_.load(std::memory_order_relaxed);
+    stats.spills = spills_.load(std::memory_order_relaxed);
+    stats.spill_records = spill_records_.load(std::memory_order_relaxed);
+    stats.spill_gaps = spill_gaps_.load(std::memory_order_relaxed);
+    stats.export_gaps = export_gaps_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ─── Export ──────────────────────────────────────────────────────────────────
+
+bool CanTraceRecorder::parseFormat(const char* name, CanTraceFormat& out) {
+    if (strcasecmp(name, "candump") == 0 || strcasecmp(name, "log") == 0) {
+        out = CanTraceFormat::Candump;
+    } else if (strcasecmp(name, "asc") == 0) {
+        out = CanTraceFormat::Asc;
+    } else if (strcasecmp(name, "bin") == 0 || strcasecmp(name, "binary") == 0) {
+        out = CanTraceFormat::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* CanTraceRecorder::contentType(CanTraceFormat format) {
+    return format == CanTraceFormat::Binary ? "application/octet-stream" : "text/plain";
+}
+
+const char* CanTraceRecorder::fileExtension(CanTraceFormat format) {
+    switch (format) {
+        case CanTraceFormat::Candump: return "log";
+        case CanTraceFormat::Asc: return "asc";
+        case CanTraceFormat::Binary: return "bin";
+    }
+    return "bin";
+}
+
+void CanTraceRecorder::beginExport(Export& out, CanTraceFormat format, uint32_t max_records) const {
+    out = Export{};
+    out.format = format;
+    if (!slots_) {
+        return;
+    }
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    const uint32_t recorded = head - tail_.load(std::memory_order_relaxed);
+    uint32_t count = std::min(recorded, capacity_ - readGuard(capacity_));
+    if (max_records > 0 && count > max_records) {
+        count = max_records;
+    }
+    out.next = head - count;
+    out.end = head;
+    out.header.records = count;
+    out.header.first_sequence = out.next;
+
+    CanTraceRecord first;
+    if (count > 0 && read(out.next, first) == ReadResult::Ok) {
+        out.base_us = first.timestamp_us;
+    }
+}
+
+bool CanTraceRecorder::beginSpillExport(Export& out, CanTraceFormat format) const {
+    out = Export{};
+    out.format = format;
+    out.from_file = true;
+    out.file = LittleFS.open(kSpillPath, FILE_READ);
+    if (!out.file) {
+        return false;
+    }
+    if (out.file.read(reinterpret_cast<uint8_t*>(&out.header), sizeof(out.header)) != sizeof(out.header) ||
+        memcmp(out.header.magic, CanTraceFileHeader{}.magic, sizeof(out.header.magic)) != 0 ||
+        out.header.record_size != sizeof(CanTraceRecord)) {
+        out.file.close();
+        return false;
+    }
+    out.next = 0;
+    out.end = out.header.records;
+
+    CanTraceRecord first;
+    if (out.end > 0 && out.file.read(reinterpret_cast<uint8_t*>(&first), sizeof(first)) == sizeof(first)) {
+        out.base_us = first.timestamp_us;
+        out.file.seek(sizeof(out.header));
+    }
+    return true;
+}
+
+bool CanTraceRecorder::nextRecord(Export& state, CanTraceRecord& out) {
+    if (state.next == state.end) {
+        return false;
+    }
+    if (state.from_file) {
+        if (state.file.read(reinterpret_cast<uint8_t*>(&out), sizeof(out)) != sizeof(out)) {
+            state.next = state.end;  // Truncated file
+            return false;
+        }
+        ++state.next;
+        return true;
+    }
+
+    ReadResult result = read(state.next, out);
+    for (uint32_t tries = 0; result == ReadResult::NotYet && tries < kNotYetRetries; ++tries) {
+        result = read(state.next, out);
+    }
+    if (result != ReadResult::Ok) {
+        out = CanTraceRecord{};
+        out.flags = kCanTraceGap;
+        export_gaps_.fetch_add(1, std::memory_order_relaxed);
+    }
+    ++state.next;
+    return true;
+}
+
+size_t CanTraceRecorder::formatRecord(const Export& state, const CanTraceRecord& record, char* line,
+                                      size_t size) const {
+    char data[8 * 3 + 1];
+    if (state.format == CanTraceFormat::Candump) {
+        // (seconds.micros) can0 18FF0163#0011223344556677
+        appendHex(data, record.data, record.length, false);
+        return snprintf(line, size, "(%lu.%06lu) can0 %0*lX#%s\n",
+                        static_cast<unsigned long>(record.timestamp_us / 1000000),
+                        static_cast<unsigned long>(record.timestamp_us % 1000000),
+                        (record.flags & kCanTraceExtended) ? 8 : 3, static_cast<unsigned long>(record.identifier),
+                        data);
+    }
+
+    //    0.001234 1  18FF0163x       Rx   d 8 00 11 22 33 44 55 66 77
+    const uint64_t rel_us = record.timestamp_us - state.base_us;
+    char id[12];
+    snprintf(id, sizeof(id), "%lX%s", static_cast<unsigned long>(record.identifier),
+             (record.flags & kCanTraceExtended) ? "x" : "");
+    appendHex(data, record.data, record.length, true);
+    return snprintf(line, size, "%4lu.%06lu 1  %-15s %s   d %u%s\n", static_cast<unsigned long>(rel_us / 1000000),
+                    static_cast<unsigned long>(rel_us % 1000000), id, (record.flags & kCanTraceTx) ? "Tx" : "Rx",
+                    record.length, data);
+}
+
+size_t CanTraceRecorder::formatGap(const Export& state, char* line, size_t size) {
+    // Comment syntax of each format, so canplayer / CANalyzer skip the line
+    return snprintf(line, size, "%s gap: %lu records lost\n", state.format == CanTraceFormat::Asc ? "//" : "#",
+                    static_cast<unsigned long>(state.gap_run));
+}
+
+size_t CanTraceRecorder::nextExport(Export& state, uint8_t* buf, size_t max_len) {
+    size_t written = 0;
+    while (written < max_len) {
+        if (state.pending_off < state.pending_len) {
+            const size_t n = std::min<size_t>(state.pending_len - state.pending_off, max_len - written);
+            memcpy(buf + written, state.pending + state.pending_off, n);
+            state.pending_off += n;
+            written += n;
+            continue;
+        }
+        state.pending_off = 0;
+        state.pending_len = 0;
+
+        size_t len = 0;
+        if (state.phase == kPhaseHeader) {
+            if (state.format == CanTraceFormat::Binary) {
+                CanTraceFileHeader header = state.header;
+                header.records = state.end - state.next;
+                memcpy(state.pending, &header, sizeof(header));
+                len = sizeof(header);
+            } else if (state.format == CanTraceFormat::Asc) {
+                len = snprintf(state.pending, sizeof(state.pending),
+                               "date Thu Jan 1 00:00:00.000 am 1970\nbase hex  timestamps absolute\n"
+                               "internal events logged\nBegin Triggerblock\n");
+            }
+            state.phase = kPhaseRecords;
+        } else if (state.phase == kPhaseRecords) {
+            CanTraceRecord record;
+            const bool more = nextRecord(state, record);
+            if (!more) {
+                state.phase = kPhaseTrailer;
+            }
+            if (more && state.format == CanTraceFormat::Binary) {
+                memcpy(state.pending, &record, sizeof(record));
+                len = sizeof(record);
+            } else if (more && (record.flags & kCanTraceGap)) {
+                ++state.gap_run;  // Reported once the run ends
+            } else {
+                // A finished gap run goes out ahead of the record (or the
+                // trailer) that ends it; both fit in `pending`
+                if (state.gap_run > 0) {
+                    len = formatGap(state, state.pending, sizeof(state.pending));
+                    state.gap_run = 0;
+                }
+                if (more) {
+                    len += formatRecord(state, record, state.pending + len, sizeof(state.pending) - len);
+                }
+            }
+        } else if (state.phase == kPhaseTrailer) {
+            if (state.format == CanTraceFormat::Asc) {
+                len = snprintf(state.pending, sizeof(state.pending), "End TriggerBlock\n");
+            }
+            if (state.from_file) {
+                state.file.close();
+            }
+            state.phase = kPhaseDone;
+        } else {
+            break;
+        }
+        state.pending_len = static_cast<uint8_t>(std::min(len, sizeof(state.pending) - 1));
+    }
+    return written;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "can_trace_format.h"
+
+// CAN flight recorder.
+//
+// Every frame the RX task pulls from the driver and every frame the TX task
+// hands to it is copied into a fixed-size binary record in a PSRAM ring.
+// Capture is a slot reservation plus a 24-byte copy: no allocation, no lock,
+// no queue that can fill, so a saturated bus is recorded in full (the only
+// loss point left is the TWAI driver queue itself, see hw_rx_missed). The
+// ring overwrites its oldest records; readers detect a lapped slot through
+// its sequence stamp.
+//
+// A trigger (identifier/mask match, or manual) spills the records around
+// it to LittleFS from a low-priority task. Exports stream the ring or the
+// spill file over HTTP as candump log, Vector ASC or the raw binary format.
+
+struct CanTraceTrigger {
+    uint32_t identifier = 0;
+    uint32_t mask = 0;             // 0 = any frame
+    uint32_t pre_records = 1024;   // Kept from before the trigger frame
+    uint32_t post_records = 4096;  // Captured after it
+};
+
+struct CanTraceStats {
+    bool allocated = false;
+    bool enabled = false;
+    bool capture_all = false;
+    uint32_t capacity = 0;
+    uint32_t recorded = 0;         // Total records written since clear()
+    uint32_t available = 0;        // Currently readable from the ring
+    bool trigger_armed = false;
+    bool spilling = false;
+    uint32_t spills = 0;
+    uint32_t spill_records = 0;    // Records in the last spill file
+    uint32_t spill_gaps = 0;       // Records the last spill lost to the ring lapping it
+    uint32_t export_gaps = 0;      // Records lost to lapping during exports, total
+};
+
+class CanTraceRecorder {
+public:
+    static constexpr uint32_t kDefaultCapacity = 65536;  // 2 MB of PSRAM; ~35 s of a saturated 250 kbit/s bus
+    static constexpr const char* kSpillPath = "/can_trace.bin";
+
+    static CanTraceRecorder& instance();
+
+    // Allocates the ring in PSRAM (capacity rounded down to a power of two)
+    // and starts the spill task. Recording stays off until setEnabled(true).
+    bool begin(uint32_t capacity = kDefaultCapacity);
+
+    void setEnabled(bool enabled) { enabled_.store(enabled && slots_, std::memory_order_release); }
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    // While recording, ask CanManager for an accept-all RX filter so the
+    // trace is the whole bus rather than the frames the firmware consumes
+    void setCaptureAll(bool capture_all) { capture_all_.store(capture_all, std::memory_order_relaxed); }
+    bool wantsAllFrames() const { return enabled() && capture_all_.load(std::memory_order_relaxed); }
+
+    void clear();
+
+    // Hot path (CAN RX and TX tasks). Never blocks or allocates. `flags`
+    // carries the direction/origin bits (kCanTraceTx, kCanTraceInjected).
+    void record(uint32_t identifier, bool extended, const uint8_t* data, uint8_t length, uint8_t flags,
+                uint64_t timestamp_us) {
+        if (!enabled_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const uint32_t pos = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask_];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        CanTraceRecord& rec = slot.record;
+        rec.timestamp_us = timestamp_us;
+        rec.identifier = identifier;
+        rec.length = length > 8 ? 8 : length;
+        rec.flags = static_cast<uint8_t>((extended ? kCanTraceExtended : 0) | (flags & ~kCanTraceExtended));
+        memcpy(rec.data, data, rec.length);
+        memset(rec.data + rec.length, 0, 8 - rec.length);
+        slot.seq.store(pos + 1, std::memory_order_release);
+
+        if (trigger_armed_.load(std::memory_order_acquire) &&
+            ((identifier ^ trigger_.identifier) & trigger_.mask) == 0) {
+            fireTrigger(pos);
+        }
+    }
+
+    // Spill the records around the next matching frame (or the current
+    // position, for triggerNow) to kSpillPath. One spill at a time.
+    bool armTrigger(const CanTraceTrigger& trigger);
+    void disarmTrigger() { trigger_armed_.store(false, std::memory_order_relaxed); }
+    bool triggerNow();
+    CanTraceTrigger trigger() const { return trigger_; }
+
+    CanTraceStats getStats() const;
+
+    // Streaming export of a fixed window. begin*() snapshots it; next()
+    // fills up to max_len bytes and returns 0 once the window is done.
+    // Partial text lines carry over between calls, so any max_len works.
+    // Text formats report each run of lost records as one comment line
+    // ("# gap: N records lost" / "// gap: N records lost") in its place.
+    struct Export {
+        CanTraceFormat format = CanTraceFormat::Candump;
+        uint32_t next = 0;
+        uint32_t end = 0;
+        uint64_t base_us = 0;     // ASC timestamps are relative to the first record
+        uint32_t gap_run = 0;     // Text formats: lost records not yet reported
+        bool from_file = false;
+        File file;
+        CanTraceFileHeader header;
+        uint8_t phase = 0;
+        char pending[128] = {0};
+        uint8_t pending_len = 0;
+        uint8_t pending_off = 0;
+    };
+
+    void beginExport(Export& out, CanTraceFormat format, uint32_t max_records = 0) const;
+    bool beginSpillExport(Export& out, CanTraceFormat format) const;
+    size_t nextExport(Export& state, uint8_t* buf, size_t max_len);
+
+    static bool parseFormat(const char* name, CanTraceFormat& out);
+    static const char* contentType(CanTraceFormat format);
+    static const char* fileExtension(CanTraceFormat format);
+
+private:
+    CanTraceRecorder() = default;
+
+    struct Slot {
+        std::atomic<uint32_t> seq{0};  // Ring position + 1 once written; 0 while being written
+        CanTraceRecord record;
+    };
+
+    enum class ReadResult : uint8_t { Ok, NotYet, Lost };
+
+    ReadResult read(uint32_t pos, CanTraceRecord& out) const;
+    bool nextRecord(Export& state, CanTraceRecord& out);
+    size_t formatRecord(const Export& state, const CanTraceRecord& record, char* line, size_t size) const;
+    static size_t formatGap(const Export& state, char* line, size_t size);
+    void fireTrigger(uint32_t pos);
+    void spill();
+    static void spillTask(void* param);
+
+    Slot* slots_ = nullptr;
+    uint32_t capacity_ = 0;
+    uint32_t mask_ = 0;
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> tail_{0};   // First position of the current recording (clear())
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> capture_all_{true};
+
+    CanTraceTrigger trigger_;
+    std::atomic<bool> trigger_armed_{false};
+    std::atomic<uint32_t> trigger_pos_{0};
+    std::atomic<bool> spilling_{false};
+    std::atomic<uint32_t> spills_{0};
+    std::atomic<uint32_t> spill_records_{0};
+    std::atomic<uint32_t> spill_gaps_{0};
+    std::atomic<uint32_t> export_gaps_{0};
+    TaskHandle_t spill_task_ = nullptr;
+};
@@ -5,13 +5,55 @@
 #include <LittleFS.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <cctype>
 
+#include "config_snapshot.h"
 #include "version_auto.h"
 
 namespace {
-constexpr const char* kConfigPath = "/config.json";
+// Storage layout: one small JSON file per section and one binary file per
+// image, each rewritten only when its content changes. /config.json is the
+// older single-file format; when present at boot it is imported once and
+// removed after the sections have been written.
+constexpr const char* kLegacyConfigPath = "/config.json";
+constexpr const char* kLegacyTempPath = "/config.tmp";
+constexpr const char* kSystemPath = "/cfg_system.json";  // version, header, display, OTA, CAN library, fonts
+constexpr const char* kThemePath = "/cfg_theme.json";
+constexpr const char* kWifiPath = "/cfg_wifi.json";
+constexpr const char* kPageIndexPath = "/cfg_pages.json";  // Page count; page N is /cfg_page_NN.json
+constexpr const char* kSectionTempPath = "/cfg_section.tmp";
+// Compiled image of the whole config (config_snapshot.h) for parse-free
+// boot. Written after the sections it mirrors; removed before any of them
+// changes, so it is never newer or older than the files it replaces.
+constexpr const char* kSnapshotPath = "/cfg_snapshot.bin";
+constexpr const char* kAssetPaths[] = {
+    "/cfg_img_header.bin",      // images.header_logo
+    "/cfg_img_splash.bin",      // images.splash_logo
+    "/cfg_img_background.bin",  // images.background_image
+    "/cfg_img_sleep.bin",       // images.sleep_logo
+    "/cfg_img_logo_v1.bin",     // header.logo_base64 (deprecated)
+    "/cfg_img_sleep_v1.bin",    // display.sleep_icon_base64 (deprecated)
+};
+constexpr std::size_t kAssetCount = sizeof(kAssetPaths) / sizeof(kAssetPaths[0]);
+
+// Change-detection slots in ConfigManager::section_hashes_
+constexpr std::size_t kSlotSystem = 0;
+constexpr std::size_t kSlotTheme = 1;
+constexpr std::size_t kSlotWifi = 2;
+constexpr std::size_t kSlotPageIndex = 3;
+constexpr std::size_t kSlotFirstPage = 4;
+constexpr std::size_t kSlotFirstAsset = kSlotFirstPage + MAX_PAGES;
+
+// Every section file carries "schema"; readers take older schemas field by
+// field, so a missing key keeps its default
+constexpr int kSectionSchema = 1;
+
+// Only one section is held as a JSON tree at a time. The largest is a page
+// with a full grid of buttons; the images never pass through the parser.
+constexpr std::size_t kSectionDocSize = 32 * 1024;
 
 template <typename T>
 T clampValue(T value, T min_value, T max_value) {
@@ -74,6 +116,838 @@ std::string fallbackId(const char* prefix, std::size_t index) {
     oss << prefix << '_' << index;
     return oss.str();
 }
+
+constexpr std::uint32_t kFnvBasis = 2166136261u;
+
+inline std::uint32_t fnv1a(std::uint32_t hash, std::uint8_t byte) {
+    return (hash ^ byte) * 16777619u;
+}
+
+std::uint32_t fnv1a(const std::string& text) {
+    std::uint32_t hash = kFnvBasis;
+    for (char c : text) {
+        hash = fnv1a(hash, static_cast<std::uint8_t>(c));
+    }
+    return hash;
+}
+
+// ArduinoJson writer that only hashes, used to skip unchanged sections
+struct HashWriter {
+    std::uint32_t hash = kFnvBasis;
+
+    std::size_t write(std::uint8_t c) {
+        hash = fnv1a(hash, c);
+        return 1;
+    }
+    std::size_t write(const std::uint8_t* s, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            hash = fnv1a(hash, s[i]);
+        }
+        return n;
+    }
+};
+
+// ArduinoJson writer appending to a std::string
+struct StringWriter {
+    std::string& out;
+
+    std::size_t write(std::uint8_t c) {
+        out.push_back(static_cast<char>(c));
+        return 1;
+    }
+    std::size_t write(const std::uint8_t* s, std::size_t n) {
+        out.append(reinterpret_cast<const char*>(s), n);
+        return n;
+    }
+};
+
+// ArduinoJson reader feeding the parser from a file through a small fixed
+// buffer. Hashes what it reads, so a section loaded from flash is known to
+// match what save() would write for it.
+class SectionReader {
+public:
+    explicit SectionReader(File& file) : file_(file) {}
+
+    int read() {
+        if (pos_ == len_ && !fill()) {
+            return -1;
+        }
+        return buffer_[pos_++];
+    }
+
+    std::size_t readBytes(char* out, std::size_t n) {
+        std::size_t done = 0;
+        while (done < n) {
+            if (pos_ == len_ && !fill()) {
+                break;
+            }
+            const std::size_t chunk = std::min(n - done, len_ - pos_);
+            std::memcpy(out + done, buffer_ + pos_, chunk);
+            pos_ += chunk;
+            done += chunk;
+        }
+        return done;
+    }
+
+    std::uint32_t hash() const { return hash_; }
+
+private:
+    bool fill() {
+        len_ = file_.read(buffer_, sizeof(buffer_));
+        pos_ = 0;
+        for (std::size_t i = 0; i < len_; ++i) {
+            hash_ = fnv1a(hash_, buffer_[i]);
+        }
+        return len_ > 0;
+    }
+
+    File& file_;
+    std::uint8_t buffer_[256];
+    std::size_t pos_ = 0;
+    std::size_t len_ = 0;
+    std::uint32_t hash_ = kFnvBasis;
+};
+
+// ─── Image assets ───────────────────────────────────────────────────────────
+//
+// Images arrive as "lvimg:<fmt>:<W>x<H>:<base64>" or "data:<mime>;base64,
+// <base64>". On flash the text header is kept as-is and the base64 body is
+// stored decoded (3/4 of the size), converted in fixed blocks so neither
+// direction needs a second full-size copy. Bodies that are not canonical
+// base64 are stored verbatim, so every value round-trips byte for byte.
+
+enum AssetEncoding : std::uint8_t { kAssetVerbatim = 0, kAssetBase64 = 1 };
+
+struct AssetHeader {
+    char magic[4] = {'C', 'F', 'G', 'A'};
+    std::uint8_t schema = 1;
+    std::uint8_t encoding = kAssetVerbatim;
+    std::uint16_t prefix_length = 0;   // Text header stored as-is
+    std::uint32_t payload_length = 0;  // Bytes following the prefix
+};
+static_assert(sizeof(AssetHeader) == 12, "AssetHeader is an on-flash layout");
+
+constexpr std::size_t kAssetBlockChars = 1024;  // Base64 characters per block
+constexpr std::size_t kAssetBlockBytes = kAssetBlockChars / 4 * 3;
+constexpr char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+std::size_t base64Padding(const char* text, std::size_t length) {
+    return (text[length - 1] == '=') + (text[length - 2] == '=');
+}
+
+// Canonical means re-encoding the decoded bytes yields the same text
+bool isCanonicalBase64(const char* text, std::size_t length) {
+    if (length == 0 || length % 4 != 0) {
+        return false;
+    }
+    const std::size_t padding = base64Padding(text, length);
+    for (std::size_t i = 0; i < length - padding; ++i) {
+        if (base64Value(text[i]) < 0) {
+            return false;
+        }
+    }
+    if (padding == 1) {
+        return (base64Value(text[length - 2]) & 0x03) == 0;
+    }
+    if (padding == 2) {
+        return (base64Value(text[length - 3]) & 0x0F) == 0;
+    }
+    return true;
+}
+
+// `length` is a multiple of 4 and already validated
+std::size_t decodeBase64Block(const char* text, std::size_t length, std::uint8_t* out) {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < length; i += 4) {
+        const bool has_2 = text[i + 2] != '=';
+        const bool has_3 = text[i + 3] != '=';
+        const std::uint32_t triple = (static_cast<std::uint32_t>(base64Value(text[i])) << 18) |
+                                     (static_cast<std::uint32_t>(base64Value(text[i + 1])) << 12) |
+                                     (has_2 ? static_cast<std::uint32_t>(base64Value(text[i + 2])) << 6 : 0) |
+                                     (has_3 ? static_cast<std::uint32_t>(base64Value(text[i + 3])) : 0);
+        out[n++] = static_cast<std::uint8_t>(triple >> 16);
+        if (has_2) out[n++] = static_cast<std::uint8_t>(triple >> 8);
+        if (has_3) out[n++] = static_cast<std::uint8_t>(triple);
+    }
+    return n;
+}
+
+void appendBase64(std::string& out, const std::uint8_t* data, std::size_t length) {
+    std::size_t i = 0;
+    for (; i + 3 <= length; i += 3) {
+        const std::uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out.push_back(kBase64Alphabet[(triple >> 18) & 0x3F]);
+        out.push_back(kBase64Alphabet[(triple >> 12) & 0x3F]);
+        out.push_back(kBase64Alphabet[(triple >> 6) & 0x3F]);
+        out.push_back(kBase64Alphabet[triple & 0x3F]);
+    }
+    if (i < length) {
+        const bool two = i + 1 < length;
+        const std::uint32_t triple = (data[i] << 16) | (two ? data[i + 1] << 8 : 0);
+        out.push_back(kBase64Alphabet[(triple >> 18) & 0x3F]);
+        out.push_back(kBase64Alphabet[(triple >> 12) & 0x3F]);
+        out.push_back(two ? kBase64Alphabet[(triple >> 6) & 0x3F] : '=');
+        out.push_back('=');
+    }
+}
+
+void removeIfExists(const char* path) {
+    if (LittleFS.exists(path)) {
+        LittleFS.remove(path);
+    }
+}
+
+// Same brownout-safe pattern as the single-file format: the section is
+// fully written to the temp file before the old one is replaced
+bool commitSectionTemp(const char* path) {
+    removeIfExists(path);
+    if (!LittleFS.rename(kSectionTempPath, path)) {
+        Serial.printf("[ConfigManager] Failed to rename temp to %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool writeAsset(const char* path, const std::string& value) {
+    if (value.empty()) {
+        removeIfExists(path);
+        return true;
+    }
+
+    // Everything up to the last ':' or ',' is the text header
+    std::size_t prefix = value.find_last_of(",:");
+    prefix = (prefix == std::string::npos || prefix >= 0xFFFF) ? 0 : prefix + 1;
+    const char* body = value.data() + prefix;
+    const std::size_t body_length = value.size() - prefix;
+
+    AssetHeader header;
+    if (isCanonicalBase64(body, body_length)) {
+        header.encoding = kAssetBase64;
+        header.prefix_length = static_cast<std::uint16_t>(prefix);
+        header.payload_length = static_cast<std::uint32_t>(body_length / 4 * 3 - base64Padding(body, body_length));
+    } else {
+        header.payload_length = static_cast<std::uint32_t>(value.size());
+    }
+
+    File file = LittleFS.open(kSectionTempPath, FILE_WRITE);
+    if (!file) {
+        Serial.println("[ConfigManager] Could not open temp file for writing");
+        return false;
+    }
+    bool ok = file.write(reinterpret_cast<const std::uint8_t*>(&header), sizeof(header)) == sizeof(header);
+    if (header.encoding == kAssetBase64) {
+        ok = ok && file.write(reinterpret_cast<const std::uint8_t*>(value.data()), prefix) == prefix;
+        std::uint8_t block[kAssetBlockBytes];
+        for (std::size_t offset = 0; ok && offset < body_length; offset += kAssetBlockChars) {
+            const std::size_t chunk = std::min(kAssetBlockChars, body_length - offset);
+            const std::size_t bytes = decodeBase64Block(body + offset, chunk, block);
+            ok = file.write(block, bytes) == bytes;
+        }
+    } else {
+        ok = ok && file.write(reinterpret_cast<const std::uint8_t*>(value.data()), value.size()) == value.size();
+    }
+    file.close();
+
+    if (!ok) {
+        Serial.printf("[ConfigManager] Incomplete write of %s\n", path);
+        LittleFS.remove(kSectionTempPath);
+        return false;
+    }
+    return commitSectionTemp(path);
+}
+
+// A missing file is an empty asset
+bool readAsset(const char* path, std::string& out) {
+    out.clear();
+    if (!LittleFS.exists(path)) {
+        return true;
+    }
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file) {
+        Serial.printf("[ConfigManager] Could not open %s\n", path);
+        return false;
+    }
+
+    AssetHeader header;
+    bool ok = file.read(reinterpret_cast<std::uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+              std::memcmp(header.magic, AssetHeader{}.magic, sizeof(header.magic)) == 0 &&
+              header.schema <= AssetHeader{}.schema && header.encoding <= kAssetBase64;
+    if (ok) {
+        const std::size_t body_length = header.encoding == kAssetBase64
+                                            ? (static_cast<std::size_t>(header.payload_length) + 2) / 3 * 4
+                                            : header.payload_length;
+        out.reserve(header.prefix_length + body_length);
+        out.resize(header.prefix_length);
+        ok = file.read(reinterpret_cast<std::uint8_t*>(&out[0]), header.prefix_length) == header.prefix_length;
+        if (header.encoding == kAssetBase64) {
+            std::uint8_t block[kAssetBlockBytes];
+            for (std::size_t remaining = header.payload_length; ok && remaining > 0;) {
+                const std::size_t chunk = std::min(sizeof(block), remaining);
+                ok = file.read(block, chunk) == chunk;
+                appendBase64(out, block, chunk);
+                remaining -= chunk;
+            }
+        } else if (ok) {
+            out.resize(header.prefix_length + body_length);
+            ok = file.read(reinterpret_cast<std::uint8_t*>(&out[header.prefix_length]), body_length) == body_length;
+        }
+    }
+    file.close();
+
+    if (!ok) {
+        Serial.printf("[ConfigManager] %s is not a valid image asset\n", path);
+        out.clear();
+    }
+    return ok;
+}
+
+std::string& assetField(DeviceConfig& cfg, std::size_t index) {
+    switch (index) {
+        case 0: return cfg.images.header_logo;
+        case 1: return cfg.images.splash_logo;
+        case 2: return cfg.images.background_image;
+        case 3: return cfg.images.sleep_logo;
+        case 4: return cfg.header.logo_base64;
+        default: return cfg.display.sleep_icon_base64;
+    }
+}
+
+const std::string& assetField(const DeviceConfig& cfg, std::size_t index) {
+    return assetField(const_cast<DeviceConfig&>(cfg), index);
+}
+
+void pagePath(std::size_t index, char (&out)[24]) {
+    std::snprintf(out, sizeof(out), "/cfg_page_%02u.json", static_cast<unsigned>(index));
+}
+
+JsonObject beginSection(DynamicJsonDocument& doc) {
+    doc.clear();
+    JsonObject root = doc.to<JsonObject>();
+    root["schema"] = kSectionSchema;
+    return root;
+}
+
+// ─── Section encoders ───────────────────────────────────────────────────────
+//
+// Shared by the section files and the full JSON document (toJson). The
+// section files leave out image strings, which are stored as assets.
+
+void encodeHeader(const HeaderConfig& source, JsonObject header, bool with_images) {
+    header["title"] = source.title.c_str();
+    header["subtitle"] = source.subtitle.c_str();
+    header["show_logo"] = source.show_logo;
+    header["logo_variant"] = source.logo_variant.c_str();
+    if (with_images) {
+        header["logo_base64"] = source.logo_base64.c_str();
+    }
+    header["title_font"] = source.title_font.c_str();
+    header["subtitle_font"] = source.subtitle_font.c_str();
+    header["title_align"] = source.title_align.c_str();
+    header["logo_position"] = source.logo_position.c_str();
+    header["logo_target_height"] = source.logo_target_height;
+    header["logo_preserve_aspect"] = source.logo_preserve_aspect;
+    header["nav_spacing"] = source.nav_spacing;
+}
+
+void encodeDisplay(const DisplayConfig& source, JsonObject display, bool with_images) {
+    display["brightness"] = source.brightness;
+    display["sleep_enabled"] = source.sleep_enabled;
+    display["sleep_timeout_seconds"] = source.sleep_timeout_seconds;
+    if (with_images) {
+        display["sleep_icon_base64"] = source.sleep_icon_base64.c_str();
+    }
+}
+
+void encodeImages(const ImageAssets& source, JsonObject images) {
+    images["header_logo"] = source.header_logo.c_str();
+    images["splash_logo"] = source.splash_logo.c_str();
+    images["background_image"] = source.background_image.c_str();
+    images["sleep_logo"] = source.sleep_logo.c_str();
+}
+
+void encodeTheme(const ThemeConfig& source, JsonObject theme) {
+    theme["bg_color"] = source.bg_color.c_str();
+    theme["surface_color"] = source.surface_color.c_str();
+    theme["page_bg_color"] = source.page_bg_color.c_str();
+    theme["accent_color"] = source.accent_color.c_str();
+    theme["text_primary"] = source.text_primary.c_str();
+    theme["text_secondary"] = source.text_secondary.c_str();
+    theme["border_color"] = source.border_color.c_str();
+    theme["header_border_color"] = source.header_border_color.c_str();
+    theme["nav_button_color"] = source.nav_button_color.c_str();
+    theme["nav_button_active_color"] = source.nav_button_active_color.c_str();
+    theme["nav_button_text_color"] = source.nav_button_text_color.c_str();
+    theme["nav_button_radius"] = source.nav_button_radius;
+    theme["button_radius"] = source.button_radius;
+    theme["border_width"] = source.border_width;
+    theme["header_border_width"] = source.header_border_width;
+}
+
+void encodeWifi(const WifiConfig& source, JsonObject wifi) {
+    JsonObject ap = wifi["ap"].to<JsonObject>();
+    ap["enabled"] = source.ap.enabled;
+    ap["ssid"] = source.ap.ssid.c_str();
+    ap["password"] = source.ap.password.c_str();
+
+    JsonObject sta = wifi["sta"].to<JsonObject>();
+    sta["enabled"] = source.sta.enabled;
+    sta["ssid"] = source.sta.ssid.c_str();
+    sta["password"] = source.sta.password.c_str();
+}
+
+void encodeOta(const OTAConfig& source, JsonObject ota) {
+    ota["enabled"] = source.enabled;
+    // ota["auto_apply"] = source.auto_apply;  // Removed - manual-only
+    ota["manifest_url"] = source.manifest_url.c_str();
+    ota["channel"] = source.channel.c_str();
+    // ota["check_interval_minutes"] = source.check_interval_minutes;  // Removed - manual-only
+}
+
+void encodePage(const PageConfig& page, JsonObject page_obj) {
+    page_obj["id"] = page.id.c_str();
+    page_obj["name"] = page.name.c_str();
+    page_obj["nav_text"] = page.nav_text.c_str();
+    page_obj["nav_color"] = page.nav_color.c_str();
+    page_obj["nav_inactive_color"] = page.nav_inactive_color.c_str();
+    page_obj["nav_text_color"] = page.nav_text_color.c_str();
+    if (page.nav_button_radius >= 0) {
+        page_obj["nav_button_radius"] = page.nav_button_radius;
+    }
+    page_obj["bg_color"] = page.bg_color.c_str();
+    page_obj["text_color"] = page.text_color.c_str();
+    page_obj["button_color"] = page.button_color.c_str();
+    page_obj["button_pressed_color"] = page.button_pressed_color.c_str();
+    page_obj["button_border_color"] = page.button_border_color.c_str();
+    page_obj["button_border_width"] = page.button_border_width;
+    page_obj["button_radius"] = page.button_radius;
+    page_obj["rows"] = page.rows;
+    page_obj["cols"] = page.cols;
+    page_obj["type"] = page.type.c_str();
+    page_obj["custom_content"] = page.custom_content.c_str();
+
+    JsonArray buttons = page_obj["buttons"].to<JsonArray>();
+    for (const auto& button : page.buttons) {
+        JsonObject btn_obj = buttons.createNestedObject();
+        btn_obj["id"] = button.id.c_str();
+        btn_obj["label"] = button.label.c_str();
+        btn_obj["color"] = button.color.c_str();
+        btn_obj["pressed_color"] = button.pressed_color.c_str();
+        btn_obj["text_color"] = button.text_color.c_str();
+        btn_obj["icon"] = button.icon.c_str();
+        btn_obj["row"] = button.row;
+        btn_obj["col"] = button.col;
+        btn_obj["row_span"] = button.row_span;
+        btn_obj["col_span"] = button.col_span;
+        btn_obj["momentary"] = button.momentary;
+        btn_obj["font_size"] = button.font_size;
+        btn_obj["font_family"] = button.font_family.c_str();
+        btn_obj["font_weight"] = button.font_weight.c_str();
+        btn_obj["font_name"] = button.font_name.c_str();
+        btn_obj["text_align"] = button.text_align.c_str();
+        btn_obj["corner_radius"] = button.corner_radius;
+        btn_obj["border_width"] = button.border_width;
+        btn_obj["border_color"] = button.border_color.c_str();
+
+        JsonObject can_obj = btn_obj["can"].to<JsonObject>();
+        can_obj["enabled"] = button.can.enabled;
+        can_obj["pgn"] = button.can.pgn;
+        can_obj["priority"] = button.can.priority;
+        can_obj["source_address"] = button.can.source_address;
+        can_obj["destination_address"] = button.can.destination_address;
+
+        JsonArray data_arr = can_obj["data"].to<JsonArray>();
+        for (std::uint8_t i = 0; i < button.can.length; ++i) {
+            data_arr.add(button.can.data[i]);
+        }
+
+        JsonObject can_off_obj = btn_obj["can_off"].to<JsonObject>();
+        can_off_obj["enabled"] = button.can_off.enabled;
+        can_off_obj["pgn"] = button.can_off.pgn;
+        can_off_obj["priority"] = button.can_off.priority;
+        can_off_obj["source_address"] = button.can_off.source_address;
+        can_off_obj["destination_address"] = button.can_off.destination_address;
+
+        JsonArray off_data_arr = can_off_obj["data"].to<JsonArray>();
+        for (std::uint8_t i = 0; i < button.can_off.length; ++i) {
+            off_data_arr.add(button.can_off.data[i]);
+        }
+
+        // Behavioral output system fields
+        btn_obj["mode"] = button.mode.c_str();
+        btn_obj["scene_id"] = button.scene_id.c_str();
+        btn_obj["scene_action"] = button.scene_action.c_str();
+        btn_obj["scene_duration_ms"] = button.scene_duration_ms;
+        btn_obj["scene_release_off"] = button.scene_release_off;
+
+        JsonObject output_behavior = btn_obj["output_behavior"].to<JsonObject>();
+        output_behavior["output_id"] = button.output_behavior.output_id.c_str();
+        output_behavior["action"] = button.output_behavior.action.c_str();
+        output_behavior["behavior_type"] = button.output_behavior.behavior_type.c_str();
+        output_behavior["target_value"] = button.output_behavior.target_value;
+        output_behavior["period_ms"] = button.output_behavior.period_ms;
+        output_behavior["duty_cycle"] = button.output_behavior.duty_cycle;
+        output_behavior["fade_time_ms"] = button.output_behavior.fade_time_ms;
+        output_behavior["hold_duration_ms"] = button.output_behavior.hold_duration_ms;
+        output_behavior["on_time_ms"] = button.output_behavior.on_time_ms;
+        output_behavior["off_time_ms"] = button.output_behavior.off_time_ms;
+        output_behavior["auto_off"] = button.output_behavior.auto_off;
+
+        // Legacy fields (backward compatibility)
+        btn_obj["infinitybox_function"] = button.infinitybox_function.c_str();
+        btn_obj["flash_frequency"] = button.flash_frequency;
+        btn_obj["fade_time"] = button.fade_time;
+        btn_obj["on_time"] = button.on_time;
+    }
+}
+
+void encodeCanLibrary(const std::vector<CanMessage>& source, JsonArray can_library) {
+    for (const auto& msg : source) {
+        JsonObject msg_obj = can_library.createNestedObject();
+        msg_obj["id"] = msg.id.c_str();
+        msg_obj["name"] = msg.name.c_str();
+        msg_obj["pgn"] = msg.pgn;
+        msg_obj["priority"] = msg.priority;
+        msg_obj["source_address"] = msg.source_address;
+        msg_obj["destination_address"] = msg.destination_address;
+        msg_obj["description"] = msg.description.c_str();
+
+        JsonArray data_arr = msg_obj["data"].to<JsonArray>();
+        for (std::uint8_t byte : msg.data) {
+            data_arr.add(byte);
+        }
+    }
+}
+
+void encodeCanMonitorPgns(const std::vector<CanMonitorPgn>& source, JsonArray pgns) {
+    for (const auto& entry : source) {
+        JsonObject pgn_obj = pgns.createNestedObject();
+        pgn_obj["pgn"] = entry.pgn;
+        pgn_obj["name"] = entry.name.c_str();
+    }
+}
+
+void encodeFonts(const std::vector<FontConfig>& source, JsonArray fonts) {
+    for (const auto& font : source) {
+        JsonObject font_obj = fonts.createNestedObject();
+        font_obj["name"] = font.name.c_str();
+        font_obj["display_name"] = font.display_name.c_str();
+        font_obj["size"] = font.size;
+    }
+}
+
+// ─── Section decoders ───────────────────────────────────────────────────────
+//
+// Absent objects leave the target untouched, so a partial update or an
+// older section schema keeps the current values.
+
+void decodeHeader(JsonObjectConst header, HeaderConfig& target) {
+    if (header.isNull()) {
+        return;
+    }
+    target.title = safeString(header["title"], target.title);
+    target.subtitle = safeString(header["subtitle"], target.subtitle);
+    target.show_logo = header["show_logo"] | target.show_logo;
+    target.logo_variant = safeString(header["logo_variant"], target.logo_variant);
+    target.logo_base64 = safeString(header["logo_base64"], target.logo_base64);
+    target.title_font = safeString(header["title_font"], target.title_font);
+    target.subtitle_font = safeString(header["subtitle_font"], target.subtitle_font);
+    target.title_align = safeString(header["title_align"], target.title_align);
+    target.logo_position = safeString(header["logo_position"], target.logo_position);
+    target.logo_target_height = clampValue<std::uint16_t>(header["logo_target_height"] | target.logo_target_height, 16u, 128u);
+    target.logo_preserve_aspect = header["logo_preserve_aspect"] | target.logo_preserve_aspect;
+    target.nav_spacing = clampValue<std::uint8_t>(header["nav_spacing"] | target.nav_spacing, 0u, 60u);
+}
+
+void decodeDisplay(JsonObjectConst display, DisplayConfig& target) {
+    if (display.isNull()) {
+        return;
+    }
+    target.brightness = clampValue<std::uint8_t>(display["brightness"] | target.brightness, 0u, 100u);
+    target.sleep_enabled = display["sleep_enabled"] | target.sleep_enabled;
+    target.sleep_timeout_seconds = clampValue<std::uint16_t>(display["sleep_timeout_seconds"] | target.sleep_timeout_seconds, 5u, 3600u);
+    target.sleep_icon_base64 = safeString(display["sleep_icon_base64"], target.sleep_icon_base64);
+}
+
+void decodeImages(JsonObjectConst images, ImageAssets& target) {
+    if (images.isNull()) {
+        return;
+    }
+    target.header_logo = safeString(images["header_logo"], target.header_logo);
+    target.splash_logo = safeString(images["splash_logo"], target.splash_logo);
+    target.background_image = safeString(images["background_image"], target.background_image);
+    target.sleep_logo = safeString(images["sleep_logo"], target.sleep_logo);
+}
+
+void decodeTheme(JsonObjectConst theme, ThemeConfig& target) {
+    if (theme.isNull()) {
+        return;
+    }
+    target.bg_color = sanitizeColor(safeString(theme["bg_color"], target.bg_color));
+    target.surface_color = sanitizeColor(safeString(theme["surface_color"], target.surface_color));
+    target.page_bg_color = sanitizeColor(safeString(theme["page_bg_color"], target.page_bg_color));
+    target.accent_color = sanitizeColor(safeString(theme["accent_color"], target.accent_color));
+    target.text_primary = sanitizeColor(safeString(theme["text_primary"], target.text_primary));
+    target.text_secondary = sanitizeColor(safeString(theme["text_secondary"], target.text_secondary));
+    target.border_color = sanitizeColor(safeString(theme["border_color"], target.border_color));
+    target.header_border_color = sanitizeColor(safeString(theme["header_border_color"], target.header_border_color));
+    target.nav_button_color = sanitizeColor(safeString(theme["nav_button_color"], target.nav_button_color));
+    target.nav_button_active_color = sanitizeColor(safeString(theme["nav_button_active_color"], target.nav_button_active_color));
+    target.nav_button_text_color = sanitizeColor(safeString(theme["nav_button_text_color"], target.nav_button_text_color));
+    target.nav_button_radius = clampValue<std::uint8_t>(theme["nav_button_radius"] | target.nav_button_radius, 0u, 50u);
+    target.button_radius = clampValue<std::uint8_t>(theme["button_radius"] | target.button_radius, 0u, 50u);
+    target.border_width = clampValue<std::uint8_t>(theme["border_width"] | target.border_width, 0u, 10u);
+    target.header_border_width = clampValue<std::uint8_t>(theme["header_border_width"] | target.header_border_width, 0u, 10u);
+}
+
+void decodeWifi(JsonObjectConst wifi, WifiConfig& target) {
+    if (wifi.isNull()) {
+        return;
+    }
+    JsonObjectConst ap = wifi["ap"];
+    if (!ap.isNull()) {
+        target.ap.enabled = ap["enabled"] | true;
+        target.ap.ssid = safeString(ap["ssid"], target.ap.ssid);
+        target.ap.password = safeString(ap["password"], target.ap.password);
+    }
+
+    JsonObjectConst sta = wifi["sta"];
+    if (!sta.isNull()) {
+        target.sta.enabled = sta["enabled"] | false;
+        target.sta.ssid = safeString(sta["ssid"], target.sta.ssid);
+        target.sta.password = safeString(sta["password"], target.sta.password);
+    }
+}
+
+void decodeOta(JsonObjectConst ota, OTAConfig& target) {
+    target.manifest_url = kOtaManifestUrl;  // OTA endpoint is centrally managed
+    if (ota.isNull()) {
+        return;
+    }
+    target.enabled = ota["enabled"] | target.enabled;
+    // target.auto_apply = ota["auto_apply"] | target.auto_apply;  // Removed - manual-only
+    target.channel = safeString(ota["channel"], target.channel);
+    // const std::uint32_t interval = ota["check_interval_minutes"] | target.check_interval_minutes;  // Removed - manual-only
+    // target.check_interval_minutes = clampValue<std::uint32_t>(interval, 5u, 1440u);  // Removed - manual-only
+}
+
+void decodePage(JsonObjectConst page_obj, std::size_t page_index, PageConfig& page) {
+    page.id = safeString(page_obj["id"], fallbackId("page", page_index));
+    std::string raw_name = trimCopy(safeString(page_obj["name"], ""));
+    if (raw_name.empty()) {
+        raw_name = page.id;
+    }
+    page.name = raw_name;
+    page.nav_text = trimCopy(safeString(page_obj["nav_text"], ""));
+    page.nav_color = sanitizeColorOptional(safeString(page_obj["nav_color"], ""));
+    page.nav_inactive_color = sanitizeColorOptional(safeString(page_obj["nav_inactive_color"], ""));
+    page.nav_text_color = sanitizeColorOptional(safeString(page_obj["nav_text_color"], ""));
+    JsonVariantConst nav_radius_variant = page_obj["nav_button_radius"];
+    if (!nav_radius_variant.isNull()) {
+        int radius_value = nav_radius_variant | -1;
+        radius_value = std::max(-1, std::min(50, radius_value));
+        page.nav_button_radius = radius_value;
+    } else {
+        page.nav_button_radius = -1;
+    }
+    page.bg_color = sanitizeColorOptional(safeString(page_obj["bg_color"], ""));
+    page.text_color = sanitizeColorOptional(safeString(page_obj["text_color"], ""));
+    page.button_color = sanitizeColorOptional(safeString(page_obj["button_color"], ""));
+    page.button_pressed_color = sanitizeColorOptional(safeString(page_obj["button_pressed_color"], ""));
+    page.button_border_color = sanitizeColorOptional(safeString(page_obj["button_border_color"], ""));
+    page.button_border_width = clampValue<std::uint8_t>(page_obj["button_border_width"] | page.button_border_width, 0u, 10u);
+    page.button_radius = clampValue<std::uint8_t>(page_obj["button_radius"] | page.button_radius, 0u, 50u);
+    page.rows = clampValue<std::uint8_t>(page_obj["rows"] | 2, 1, 4);
+    page.cols = clampValue<std::uint8_t>(page_obj["cols"] | 2, 1, 4);
+    page.type = safeString(page_obj["type"], "");
+    page.custom_content = safeString(page_obj["custom_content"], "");
+
+    JsonArrayConst buttons = page_obj["buttons"].as<JsonArrayConst>();
+    if (buttons.isNull()) {
+        return;
+    }
+    std::size_t button_index = 0;
+    for (JsonObjectConst btn_obj : buttons) {
+        if (button_index >= MAX_BUTTONS_PER_PAGE) {
+            break;
+        }
+
+        ButtonConfig button;
+        button.id = safeString(btn_obj["id"], fallbackId("btn", button_index));
+        button.label = safeString(btn_obj["label"], button.id);
+        button.color = sanitizeColor(safeString(btn_obj["color"], button.color));
+        button.pressed_color = sanitizeColor(safeString(btn_obj["pressed_color"], button.pressed_color));
+        button.text_color = sanitizeColorOptional(safeString(btn_obj["text_color"], ""));
+        button.icon = safeString(btn_obj["icon"], "");
+        button.row = clampValue<std::uint8_t>(btn_obj["row"] | 0, 0, page.rows - 1);
+        button.col = clampValue<std::uint8_t>(btn_obj["col"] | 0, 0, page.cols - 1);
+        button.row_span = clampValue<std::uint8_t>(btn_obj["row_span"] | 1, 1, page.rows - button.row);
+        button.col_span = clampValue<std::uint8_t>(btn_obj["col_span"] | 1, 1, page.cols - button.col);
+        button.momentary = btn_obj["momentary"] | false;
+        button.font_size = clampValue<std::uint8_t>(btn_obj["font_size"] | 24, 8, 72);
+        button.font_family = safeString(btn_obj["font_family"], "montserrat");
+        button.font_weight = safeString(btn_obj["font_weight"], "400");
+        button.font_name = safeString(btn_obj["font_name"], "montserrat_16");
+        button.text_align = safeString(btn_obj["text_align"], "center");
+        button.corner_radius = clampValue<std::uint8_t>(btn_obj["corner_radius"] | 12, 0, 50);
+        button.border_width = clampValue<std::uint8_t>(btn_obj["border_width"] | 0, 0, 10);
+        button.border_color = sanitizeColor(safeString(btn_obj["border_color"], "#FFFFFF"));
+
+        JsonObjectConst can_obj = btn_obj["can"];
+        if (!can_obj.isNull()) {
+            button.can.enabled = can_obj["enabled"] | false;
+            button.can.pgn = can_obj["pgn"] | button.can.pgn;
+            button.can.priority = clampValue<std::uint8_t>(can_obj["priority"] | button.can.priority, 0u, 7u);
+            button.can.source_address = can_obj["source_address"] | button.can.source_address;
+            button.can.destination_address = can_obj["destination_address"] | button.can.destination_address;
+
+            JsonArrayConst data_arr = can_obj["data"].as<JsonArrayConst>();
+            if (!data_arr.isNull()) {
+                std::size_t i = 0;
+                for (JsonVariantConst byte_val : data_arr) {
+                    if (i >= button.can.data.size()) {
+                        break;
+                    }
+                    button.can.data[i] = clampValue<std::uint8_t>(byte_val | 0, 0u, 255u);
+                    ++i;
+                }
+                button.can.length = static_cast<std::uint8_t>(i);  // Set length based on actual data bytes
+            }
+        }
+
+        JsonObjectConst can_off_obj = btn_obj["can_off"];
+        if (!can_off_obj.isNull()) {
+            button.can_off.enabled = can_off_obj["enabled"] | false;
+            button.can_off.pgn = can_off_obj["pgn"] | button.can_off.pgn;
+            button.can_off.priority = clampValue<std::uint8_t>(can_off_obj["priority"] | button.can_off.priority, 0u, 7u);
+            button.can_off.source_address = can_off_obj["source_address"] | button.can_off.source_address;
+            button.can_off.destination_address = can_off_obj["destination_address"] | button.can_off.destination_address;
+
+            JsonArrayConst off_data_arr = can_off_obj["data"].as<JsonArrayConst>();
+            if (!off_data_arr.isNull()) {
+                std::size_t i = 0;
+                for (JsonVariantConst byte_val : off_data_arr) {
+                    if (i >= button.can_off.data.size()) {
+                        break;
+                    }
+                    button.can_off.data[i] = clampValue<std::uint8_t>(byte_val | 0, 0u, 255u);
+                    ++i;
+                }
+                button.can_off.length = static_cast<std::uint8_t>(i);  // Set length based on actual data bytes
+            }
+        }
+
+        // Behavioral output system fields
+        button.mode = safeString(btn_obj["mode"], "can");
+        button.scene_id = safeString(btn_obj["scene_id"], "");
+        button.scene_action = safeString(btn_obj["scene_action"], "on");
+        button.scene_duration_ms = clampValue<std::uint16_t>(btn_obj["scene_duration_ms"] | 0, 0u, 60000u);
+        button.scene_release_off = btn_obj["scene_release_off"] | false;
+
+        JsonObjectConst output_behavior = btn_obj["output_behavior"];
+        if (!output_behavior.isNull()) {
+            button.output_behavior.output_id = safeString(output_behavior["output_id"], "");
+            button.output_behavior.action = safeString(output_behavior["action"], "on");
+            button.output_behavior.behavior_type = safeString(output_behavior["behavior_type"], "steady");
+            button.output_behavior.target_value = clampValue<std::uint8_t>(output_behavior["target_value"] | 100, 0u, 100u);
+            button.output_behavior.period_ms = clampValue<std::uint16_t>(output_behavior["period_ms"] | 500, 1u, 10000u);
+            button.output_behavior.duty_cycle = clampValue<std::uint8_t>(output_behavior["duty_cycle"] | 50, 0u, 100u);
+            button.output_behavior.fade_time_ms = clampValue<std::uint16_t>(output_behavior["fade_time_ms"] | 1000, 0u, 10000u);
+            button.output_behavior.hold_duration_ms = clampValue<std::uint16_t>(output_behavior["hold_duration_ms"] | 0, 0u, 60000u);
+            button.output_behavior.on_time_ms = clampValue<std::uint16_t>(output_behavior["on_time_ms"] | 100, 1u, 10000u);
+            button.output_behavior.off_time_ms = clampValue<std::uint16_t>(output_behavior["off_time_ms"] | 100, 1u, 10000u);
+            if (output_behavior.containsKey("auto_off")) {
+                button.output_behavior.auto_off = output_behavior["auto_off"] | false;
+            } else {
+                button.output_behavior.auto_off = (button.mode == "output");
+            }
+        }
+
+        // Legacy fields (backward compatibility)
+        button.infinitybox_function = btn_obj["infinitybox_function"] | "";
+        button.flash_frequency = btn_obj["flash_frequency"] | 500;
+        button.fade_time = btn_obj["fade_time"] | 1000;
+        button.on_time = btn_obj["on_time"] | 2000;
+
+        page.buttons.push_back(std::move(button));
+        ++button_index;
+    }
+}
+
+void decodeCanLibrary(JsonArrayConst can_library, std::vector<CanMessage>& target) {
+    target.clear();
+    if (can_library.isNull()) {
+        return;
+    }
+    std::size_t msg_index = 0;
+    for (JsonObjectConst msg_obj : can_library) {
+        if (msg_index >= 50) {  // Reasonable limit for CAN library
+            break;
+        }
+
+        CanMessage msg;
+        msg.id = safeString(msg_obj["id"], fallbackId("can_msg", msg_index));
+        msg.name = safeString(msg_obj["name"], msg.id);
+        msg.pgn = msg_obj["pgn"] | 0;
+        msg.priority = clampValue<std::uint8_t>(msg_obj["priority"] | 6, 0u, 7u);
+        msg.source_address = msg_obj["source_address"] | 0xF9;
+        msg.destination_address = msg_obj["destination_address"] | 0xFF;
+        msg.description = safeString(msg_obj["description"], "");
+
+        JsonArrayConst data_arr = msg_obj["data"].as<JsonArrayConst>();
+        if (!data_arr.isNull()) {
+            std::size_t i = 0;
+            for (JsonVariantConst byte_val : data_arr) {
+                if (i >= msg.data.size()) {
+                    break;
+                }
+                msg.data[i] = clampValue<std::uint8_t>(byte_val | 0, 0u, 255u);
+                ++i;
+            }
+        }
+
+        target.push_back(std::move(msg));
+        ++msg_index;
+    }
+}
+
+void decodeCanMonitorPgns(JsonArrayConst pgns, std::vector<CanMonitorPgn>& target) {
+    target.clear();
+    if (pgns.isNull()) {
+        return;
+    }
+    for (JsonObjectConst pgn_obj : pgns) {
+        if (target.size() >= MAX_CAN_MONITOR_PGNS) {
+            break;
+        }
+        CanMonitorPgn entry;
+        entry.pgn = (pgn_obj["pgn"] | 0u) & 0x3FFFFu;  // 18-bit J1939 PGN
+        entry.name = safeString(pgn_obj["name"], "");
+        target.push_back(std::move(entry));
+    }
+}
+
+void decodeFonts(JsonArrayConst fonts, std::vector<FontConfig>& target) {
+    target.clear();
+    if (fonts.isNull()) {
+        return;
+    }
+    for (JsonObjectConst font_obj : fonts) {
+        FontConfig font;
+        font.name = safeString(font_obj["name"], "montserrat_16");
+        font.display_name = safeString(font_obj["display_name"], "Montserrat 16");
+        font.size = clampValue<std::uint8_t>(font_obj["size"] | 16, 8, 72);
+        target.push_back(std::move(font));
+    }
+}
 }
 
 ConfigManager& ConfigManager::instance() {
@@ -87,19 +961,32 @@ bool ConfigManager::begin() {
         return false;
     }
 
-    if (!LittleFS.exists(kConfigPath)) {
+    section_hashes_.fill(0);
+    stored_page_count_ = MAX_PAGES;
+    snapshot_on_flash_ = LittleFS.exists(kSnapshotPath);
+    snapshot_current_ = false;
+
+    // A single-file /config.json (older firmware, or placed by uploadfs)
+    // takes precedence and is split into sections by the save below
+    const bool legacy = LittleFS.exists(kLegacyConfigPath);
+    if (!legacy && !LittleFS.exists(kSystemPath)) {
         Serial.println("[ConfigManager] No config file found. Creating defaults.");
         config_ = buildDefaultConfig();
         return save();
     }
 
-    if (!loadFromStorage()) {
+    const uint32_t load_start_us = micros();
+    const bool from_snapshot = !legacy && snapshot_on_flash_ && loadSnapshot();
+    if (!from_snapshot && !(legacy ? importLegacyConfig() : loadFromStorage())) {
         Serial.println("[ConfigManager] Failed to load config. Reverting to defaults.");
         config_ = buildDefaultConfig();
         return save();
     }
+    Serial.printf("[ConfigManager] Loaded from %s in %lu us\n", from_snapshot ? "snapshot" : "JSON sections",
+                  static_cast<unsigned long>(micros() - load_start_us));
 
-    bool needs_save = false;
+    // Without a usable snapshot the save below compiles one for next boot
+    bool needs_save = legacy || !from_snapshot;
 
     // Check if config needs upgrade based on available fonts
     DeviceConfig defaults = buildDefaultConfig();
@@ -167,18 +1054,83 @@ int ConfigManager::compareVersions(const std::string& lhs, const std::string& rh
 }
 
 bool ConfigManager::save() const {
-    std::string json = toJson();
-    return writeToStorage(json);
+    static_assert(kAssetCount == kImageAssetCount, "one hash slot per image asset");
+    static_assert(kSlotFirstAsset + kAssetCount == kSectionSlots, "section slot layout");
+
+    DynamicJsonDocument doc(kSectionDocSize);
+    bool ok = true;
+
+    JsonObject root = beginSection(doc);
+    root["version"] = config_.version.c_str();
+    encodeHeader(config_.header, root["header"].to<JsonObject>(), false);
+    encodeDisplay(config_.display, root["display"].to<JsonObject>(), false);
+    encodeOta(config_.ota, root["ota"].to<JsonObject>());
+    encodeCanLibrary(config_.can_library, root["can_library"].to<JsonArray>());
+    encodeCanMonitorPgns(config_.can_monitor_pgns, root["can_monitor_pgns"].to<JsonArray>());
+    encodeFonts(config_.available_fonts, root["available_fonts"].to<JsonArray>());
+    ok = writeSection(kSlotSystem, kSystemPath, doc) && ok;
+
+    encodeTheme(config_.theme, beginSection(doc));
+    ok = writeSection(kSlotTheme, kThemePath, doc) && ok;
+
+    encodeWifi(config_.wifi, beginSection(doc));
+    ok = writeSection(kSlotWifi, kWifiPath, doc) && ok;
+
+    // Pages go first and the index after them, so the index never counts
+    // a page that is not on flash; pages past the new end are removed last
+    const std::size_t page_count = std::min(config_.pages.size(), MAX_PAGES);
+    char path[24];
+    for (std::size_t i = 0; i < page_count; ++i) {
+        encodePage(config_.pages[i], beginSection(doc));
+        pagePath(i, path);
+        ok = writeSection(kSlotFirstPage + i, path, doc) && ok;
+    }
+    beginSection(doc)["count"] = page_count;
+    if (ok && writeSection(kSlotPageIndex, kPageIndexPath, doc)) {
+        for (std::size_t i = page_count; i < stored_page_count_; ++i) {
+            pagePath(i, path);
+            removeIfExists(path);
+            section_hashes_[kSlotFirstPage + i] = 0;
+        }
+        stored_page_count_ = page_count;
+    } else {
+        ok = false;
+    }
+
+    for (std::size_t i = 0; i < kAssetCount; ++i) {
+        ok = writeAssetSection(kSlotFirstAsset + i, kAssetPaths[i], assetField(config_, i)) && ok;
+    }
+
+    if (ok && LittleFS.exists(kLegacyConfigPath)) {
+        LittleFS.remove(kLegacyConfigPath);
+        Serial.println("[ConfigManager] Migrated /config.json to section files");
+    }
+    // The snapshot is a boot cache: failing to write it costs the next boot
+    // a JSON parse, not the save
+    if (ok && !snapshot_current_) {
+        writeSnapshot();
+    }
+    return ok;
 }
 
 void ConfigManager::factoryReset() {
-    Serial.println("[ConfigManager] Factory reset - deleting config file");
-    if (LittleFS.exists(kConfigPath)) {
-        LittleFS.remove(kConfigPath);
+    Serial.println("[ConfigManager] Factory reset - deleting config files");
+    for (const char* path : {kLegacyConfigPath, kLegacyTempPath, kSectionTempPath, kSnapshotPath, kSystemPath,
+                             kThemePath, kWifiPath, kPageIndexPath}) {
+        removeIfExists(path);
+    }
+    char path[24];
+    for (std::size_t i = 0; i < MAX_PAGES; ++i) {
+        pagePath(i, path);
+        removeIfExists(path);
     }
-    if (LittleFS.exists("/config.tmp")) {
-        LittleFS.remove("/config.tmp");
+    for (const char* asset : kAssetPaths) {
+        removeIfExists(asset);
     }
+    section_hashes_.fill(0);
+    stored_page_count_ = MAX_PAGES;
+    snapshot_on_flash_ = false;
+    snapshot_current_ = false;
     // Reset to defaults in memory
     config_ = buildDefaultConfig();
 }
@@ -189,11 +1141,66 @@ bool ConfigManager::resetToDefaults() {
 }
 
 std::string ConfigManager::toJson() const {
-    DynamicJsonDocument doc(524288);  // 512KB for base64 images
-    encodeConfig(config_, doc);
-
+    // Assembled section by section, so only one section's tree is alive at
+    // a time; image strings are linked into it, never copied
+    std::size_t image_bytes = 0;
+    for (std::size_t i = 0; i < kAssetCount; ++i) {
+        image_bytes += assetField(config_, i).size();
+    }
     std::string output;
-    serializeJson(doc, output);
+    output.reserve(image_bytes + 16 * 1024);
+    StringWriter writer{output};
+    DynamicJsonDocument doc(kSectionDocSize);
+
+    auto member = [&](const char* key) {
+        output += output.empty() ? "{\"" : ",\"";
+        output += key;
+        output += "\":";
+        serializeJson(doc, writer);
+    };
+
+    doc.set(config_.version.c_str());
+    member("version");
+    doc.clear();
+    encodeHeader(config_.header, doc.to<JsonObject>(), true);
+    member("header");
+    doc.clear();
+    encodeDisplay(config_.display, doc.to<JsonObject>(), true);
+    member("display");
+    doc.clear();
+    encodeImages(config_.images, doc.to<JsonObject>());
+    member("images");
+    doc.clear();
+    encodeTheme(config_.theme, doc.to<JsonObject>());
+    member("theme");
+    doc.clear();
+    encodeWifi(config_.wifi, doc.to<JsonObject>());
+    member("wifi");
+    doc.clear();
+    encodeOta(config_.ota, doc.to<JsonObject>());
+    member("ota");
+
+    output += ",\"pages\":[";
+    for (std::size_t i = 0; i < config_.pages.size(); ++i) {
+        if (i > 0) {
+            output += ',';
+        }
+        doc.clear();
+        encodePage(config_.pages[i], doc.to<JsonObject>());
+        serializeJson(doc, writer);
+    }
+    output += ']';
+
+    doc.clear();
+    encodeCanLibrary(config_.can_library, doc.to<JsonArray>());
+    member("can_library");
+    doc.clear();
+    encodeCanMonitorPgns(config_.can_monitor_pgns, doc.to<JsonArray>());
+    member("can_monitor_pgns");
+    doc.clear();
+    encodeFonts(config_.available_fonts, doc.to<JsonArray>());
+    member("available_fonts");
+    output += '}';
     return output;
 }
 
@@ -208,12 +1215,71 @@ bool ConfigManager::updateFromJson(JsonVariantConst json, std::string& error) {
 }
 
 bool ConfigManager::loadFromStorage() {
-    File file = LittleFS.open(kConfigPath, FILE_READ);
+    const DeviceConfig defaults = buildDefaultConfig();
+    DeviceConfig loaded = defaults;
+    DynamicJsonDocument doc(kSectionDocSize);
+
+    // The system section is required; any other section that is missing or
+    // unreadable falls back to its defaults on its own
+    if (!readSection(kSlotSystem, kSystemPath, doc)) {
+        return false;
+    }
+    JsonObjectConst root = doc.as<JsonObjectConst>();
+    loaded.version = safeString(root["version"], loaded.version);
+    decodeHeader(root["header"], loaded.header);
+    decodeDisplay(root["display"], loaded.display);
+    decodeOta(root["ota"], loaded.ota);
+    decodeCanLibrary(root["can_library"].as<JsonArrayConst>(), loaded.can_library);
+    decodeCanMonitorPgns(root["can_monitor_pgns"].as<JsonArrayConst>(), loaded.can_monitor_pgns);
+    decodeFonts(root["available_fonts"].as<JsonArrayConst>(), loaded.available_fonts);
+    if (loaded.available_fonts.empty()) {
+        loaded.available_fonts = defaults.available_fonts;
+    }
+
+    if (readSection(kSlotTheme, kThemePath, doc)) {
+        decodeTheme(doc.as<JsonObjectConst>(), loaded.theme);
+    }
+    if (readSection(kSlotWifi, kWifiPath, doc)) {
+        decodeWifi(doc.as<JsonObjectConst>(), loaded.wifi);
+    }
+
+    loaded.pages.clear();
+    if (readSection(kSlotPageIndex, kPageIndexPath, doc)) {
+        const std::size_t count = std::min<std::size_t>(doc["count"] | 0u, MAX_PAGES);
+        char path[24];
+        for (std::size_t i = 0; i < count; ++i) {
+            pagePath(i, path);
+            if (!readSection(kSlotFirstPage + i, path, doc)) {
+                Serial.printf("[ConfigManager] Skipping unreadable page %u\n", static_cast<unsigned>(i));
+                continue;
+            }
+            PageConfig page;
+            decodePage(doc.as<JsonObjectConst>(), loaded.pages.size(), page);
+            loaded.pages.push_back(std::move(page));
+        }
+    }
+    if (loaded.pages.empty()) {
+        loaded.pages = defaults.pages;
+    }
+
+    for (std::size_t i = 0; i < kAssetCount; ++i) {
+        std::string& value = assetField(loaded, i);
+        section_hashes_[kSlotFirstAsset + i] = readAsset(kAssetPaths[i], value) ? fnv1a(value) : 0;
+    }
+
+    config_ = std::move(loaded);
+    return true;
+}
+
+bool ConfigManager::importLegacyConfig() {
+    Serial.println("[ConfigManager] Importing single-file /config.json");
+    File file = LittleFS.open(kLegacyConfigPath, FILE_READ);
     if (!file) {
         Serial.println("[ConfigManager] Could not open config file");
         return false;
     }
 
+    // One-time cost: the old format inlines every image in one document
     DynamicJsonDocument doc(524288);  // 512KB for base64 images
     DeserializationError err = deserializeJson(doc, file);
     file.close();
@@ -232,39 +1298,143 @@ bool ConfigManager::loadFromStorage() {
     return true;
 }
 
-bool ConfigManager::writeToStorage(const std::string& json) const {
-    // ATOMIC WRITE: Use temp file + rename to prevent corruption during brownout
-    const char* kTempPath = "/config.tmp";
-    
-    // Write to temp file first
-    File file = LittleFS.open(kTempPath, FILE_WRITE);
+bool ConfigManager::readSection(std::size_t slot, const char* path, DynamicJsonDocument& doc) {
+    section_hashes_[slot] = 0;
+    if (!LittleFS.exists(path)) {
+        return false;
+    }
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file) {
+        Serial.printf("[ConfigManager] Could not open %s\n", path);
+        return false;
+    }
+
+    SectionReader reader(file);
+    DeserializationError err = deserializeJson(doc, reader);
+    file.close();
+
+    if (err) {
+        Serial.printf("[ConfigManager] %s: JSON parse error: %s\n", path, err.c_str());
+        return false;
+    }
+    const int schema = doc["schema"] | 0;
+    if (schema > kSectionSchema) {
+        Serial.printf("[ConfigManager] %s: schema %d is newer than %d, reading known fields\n", path, schema,
+                      kSectionSchema);
+    }
+    section_hashes_[slot] = reader.hash();
+    return true;
+}
+
+bool ConfigManager::writeSection(std::size_t slot, const char* path, const DynamicJsonDocument& doc) const {
+    if (doc.overflowed()) {
+        Serial.printf("[ConfigManager] %s exceeds %u bytes, not saved\n", path,
+                      static_cast<unsigned>(kSectionDocSize));
+        return false;
+    }
+
+    HashWriter hasher;
+    const std::size_t expected = serializeJson(doc, hasher);
+    if (section_hashes_[slot] == hasher.hash) {
+        return true;  // Unchanged since the last load or save
+    }
+    invalidateSnapshot();
+
+    File file = LittleFS.open(kSectionTempPath, FILE_WRITE);
     if (!file) {
         Serial.println("[ConfigManager] Could not open temp file for writing");
         return false;
     }
+    const std::size_t written = serializeJson(doc, file);
+    file.close();
 
-    size_t written = file.print(json.c_str());
+    if (written != expected) {
+        Serial.printf("[ConfigManager] Incomplete write of %s\n", path);
+        LittleFS.remove(kSectionTempPath);
+        return false;
+    }
+    if (!commitSectionTemp(path)) {
+        return false;
+    }
+    section_hashes_[slot] = hasher.hash;
+    return true;
+}
+
+bool ConfigManager::writeAssetSection(std::size_t slot, const char* path, const std::string& value) const {
+    const std::uint32_t hash = fnv1a(value);
+    if (section_hashes_[slot] == hash) {
+        return true;
+    }
+    invalidateSnapshot();
+    if (!writeAsset(path, value)) {
+        return false;
+    }
+    section_hashes_[slot] = hash;
+    return true;
+}
+
+bool ConfigManager::loadSnapshot() {
+    File file = LittleFS.open(kSnapshotPath, FILE_READ);
+    if (!file) {
+        return false;
+    }
+    // Decoded field by field straight from the file: no copy of the whole
+    // snapshot, no tokenizing, no key lookups. The section hashes come back
+    // with it, so the next save still rewrites only what changed.
+    DeviceConfig loaded;
+    std::array<std::uint32_t, kSectionSlots> hashes{};
+    bool ok = readConfigSnapshot(file, file.size(), loaded, hashes.data(), kSectionSlots);
     file.close();
-    
-    if (written != json.size()) {
-        Serial.println("[ConfigManager] Incomplete write to temp file");
-        LittleFS.remove(kTempPath);
+
+    // Images are referenced by hash, not embedded: each asset file must be
+    // the one the snapshot was written with
+    for (std::size_t i = 0; ok && i < kAssetCount; ++i) {
+        std::string& value = assetField(loaded, i);
+        ok = readAsset(kAssetPaths[i], value) && fnv1a(value) == hashes[kSlotFirstAsset + i];
+    }
+    if (!ok) {
+        Serial.println("[ConfigManager] Snapshot missing, corrupt or from other firmware; using JSON");
+        return false;
+    }
+    config_ = std::move(loaded);
+    section_hashes_ = hashes;
+    snapshot_current_ = true;
+    return true;
+}
+
+bool ConfigManager::writeSnapshot() const {
+    File file = LittleFS.open(kSectionTempPath, FILE_WRITE);
+    if (!file) {
+        Serial.println("[ConfigManager] Could not open temp file for writing");
         return false;
     }
-    
-    // Atomic rename (remove old, rename temp)
-    if (LittleFS.exists(kConfigPath)) {
-        LittleFS.remove(kConfigPath);
+    const bool written = writeConfigSnapshot(file, config_, section_hashes_.data(), kSectionSlots,
+                                             [&file](const ConfigSnapshotHeader& header) {
+                                                 const auto* bytes = reinterpret_cast<const std::uint8_t*>(&header);
+                                                 return file.seek(0) && file.write(bytes, sizeof(header)) == sizeof(header);
+                                             });
+    file.close();
+    if (!written) {
+        Serial.println("[ConfigManager] Incomplete snapshot write");
+        LittleFS.remove(kSectionTempPath);
+        return false;
     }
-    
-    if (!LittleFS.rename(kTempPath, kConfigPath)) {
-        Serial.println("[ConfigManager] Failed to rename temp to config");
+    if (!commitSectionTemp(kSnapshotPath)) {
         return false;
     }
-    
+    snapshot_on_flash_ = true;
+    snapshot_current_ = true;
     return true;
 }
 
+void ConfigManager::invalidateSnapshot() const {
+    if (snapshot_on_flash_) {
+        removeIfExists(kSnapshotPath);
+        snapshot_on_flash_ = false;
+    }
+    snapshot_current_ = false;
+}
+
 DeviceConfig ConfigManager::buildDefaultConfig() const {
     DeviceConfig cfg;
     cfg.version = APP_VERSION;
@@ -383,197 +1553,6 @@ DeviceConfig ConfigManager::buildDefaultConfig() const {
     return cfg;
 }
 
-void ConfigManager::encodeConfig(const DeviceConfig& source, DynamicJsonDocument& doc) const {
-    doc.clear();
-    doc["version"] = source.version.c_str();
-
-    JsonObject header = doc["header"].to<JsonObject>();
-    header["title"] = source.header.title.c_str();
-    header["subtitle"] = source.header.subtitle.c_str();
-    header["show_logo"] = source.header.show_logo;
-    header["logo_variant"] = source.header.logo_variant.c_str();
-    header["logo_base64"] = source.header.logo_base64.c_str();
-    header["title_font"] = source.header.title_font.c_str();
-    header["subtitle_font"] = source.header.subtitle_font.c_str();
-    header["title_align"] = source.header.title_align.c_str();
-    header["logo_position"] = source.header.logo_position.c_str();
-    header["logo_target_height"] = source.header.logo_target_height;
-    header["logo_preserve_aspect"] = source.header.logo_preserve_aspect;
-    header["nav_spacing"] = source.header.nav_spacing;
-
-    JsonObject display = doc["display"].to<JsonObject>();
-    display["brightness"] = source.display.brightness;
-    display["sleep_enabled"] = source.display.sleep_enabled;
-    display["sleep_timeout_seconds"] = source.display.sleep_timeout_seconds;
-    display["sleep_icon_base64"] = source.display.sleep_icon_base64.c_str();
-
-    JsonObject images = doc["images"].to<JsonObject>();
-    images["header_logo"] = source.images.header_logo.c_str();
-    images["splash_logo"] = source.images.splash_logo.c_str();
-    images["background_image"] = source.images.background_image.c_str();
-    images["sleep_logo"] = source.images.sleep_logo.c_str();
-
-    JsonObject theme = doc["theme"].to<JsonObject>();
-    theme["bg_color"] = source.theme.bg_color.c_str();
-    theme["surface_color"] = source.theme.surface_color.c_str();
-    theme["page_bg_color"] = source.theme.page_bg_color.c_str();
-    theme["accent_color"] = source.theme.accent_color.c_str();
-    theme["text_primary"] = source.theme.text_primary.c_str();
-    theme["text_secondary"] = source.theme.text_secondary.c_str();
-    theme["border_color"] = source.theme.border_color.c_str();
-    theme["header_border_color"] = source.theme.header_border_color.c_str();
-    theme["nav_button_color"] = source.theme.nav_button_color.c_str();
-    theme["nav_button_active_color"] = source.theme.nav_button_active_color.c_str();
-    theme["nav_button_text_color"] = source.theme.nav_button_text_color.c_str();
-    theme["nav_button_radius"] = source.theme.nav_button_radius;
-    theme["button_radius"] = source.theme.button_radius;
-    theme["border_width"] = source.theme.border_width;
-    theme["header_border_width"] = source.theme.header_border_width;
-
-    JsonObject wifi = doc["wifi"].to<JsonObject>();
-    JsonObject ap = wifi["ap"].to<JsonObject>();
-    ap["enabled"] = source.wifi.ap.enabled;
-    ap["ssid"] = source.wifi.ap.ssid.c_str();
-    ap["password"] = source.wifi.ap.password.c_str();
-
-    JsonObject sta = wifi["sta"].to<JsonObject>();
-    sta["enabled"] = source.wifi.sta.enabled;
-    sta["ssid"] = source.wifi.sta.ssid.c_str();
-    sta["password"] = source.wifi.sta.password.c_str();
-
-    JsonObject ota = doc["ota"].to<JsonObject>();
-    ota["enabled"] = source.ota.enabled;
-    // ota["auto_apply"] = source.ota.auto_apply;  // Removed - manual-only
-    ota["manifest_url"] = source.ota.manifest_url.c_str();
-    ota["channel"] = source.ota.channel.c_str();
-    // ota["check_interval_minutes"] = source.ota.check_interval_minutes;  // Removed - manual-only
-
-    JsonArray pages = doc["pages"].to<JsonArray>();
-    for (const auto& page : source.pages) {
-        JsonObject page_obj = pages.createNestedObject();
-        page_obj["id"] = page.id.c_str();
-        page_obj["name"] = page.name.c_str();
-        page_obj["nav_text"] = page.nav_text.c_str();
-        page_obj["nav_color"] = page.nav_color.c_str();
-        page_obj["nav_inactive_color"] = page.nav_inactive_color.c_str();
-        page_obj["nav_text_color"] = page.nav_text_color.c_str();
-        if (page.nav_button_radius >= 0) {
-            page_obj["nav_button_radius"] = page.nav_button_radius;
-        }
-        page_obj["bg_color"] = page.bg_color.c_str();
-        page_obj["text_color"] = page.text_color.c_str();
-        page_obj["button_color"] = page.button_color.c_str();
-        page_obj["button_pressed_color"] = page.button_pressed_color.c_str();
-        page_obj["button_border_color"] = page.button_border_color.c_str();
-        page_obj["button_border_width"] = page.button_border_width;
-        page_obj["button_radius"] = page.button_radius;
-        page_obj["rows"] = page.rows;
-        page_obj["cols"] = page.cols;
-        page_obj["type"] = page.type.c_str();
-        page_obj["custom_content"] = page.custom_content.c_str();
-
-        JsonArray buttons = page_obj["buttons"].to<JsonArray>();
-        for (const auto& button : page.buttons) {
-            JsonObject btn_obj = buttons.createNestedObject();
-            btn_obj["id"] = button.id.c_str();
-            btn_obj["label"] = button.label.c_str();
-            btn_obj["color"] = button.color.c_str();
-            btn_obj["pressed_color"] = button.pressed_color.c_str();
-            btn_obj["text_color"] = button.text_color.c_str();
-            btn_obj["icon"] = button.icon.c_str();
-            btn_obj["row"] = button.row;
-            btn_obj["col"] = button.col;
-            btn_obj["row_span"] = button.row_span;
-            btn_obj["col_span"] = button.col_span;
-            btn_obj["momentary"] = button.momentary;
-            btn_obj["font_size"] = button.font_size;
-            btn_obj["font_family"] = button.font_family.c_str();
-            btn_obj["font_weight"] = button.font_weight.c_str();
-            btn_obj["font_name"] = button.font_name.c_str();
-            btn_obj["text_align"] = button.text_align.c_str();
-            btn_obj["corner_radius"] = button.corner_radius;
-            btn_obj["border_width"] = button.border_width;
-            btn_obj["border_color"] = button.border_color.c_str();
-
-            JsonObject can_obj = btn_obj["can"].to<JsonObject>();
-            can_obj["enabled"] = button.can.enabled;
-            can_obj["pgn"] = button.can.pgn;
-            can_obj["priority"] = button.can.priority;
-            can_obj["source_address"] = button.can.source_address;
-            can_obj["destination_address"] = button.can.destination_address;
-
-            JsonArray data_arr = can_obj["data"].to<JsonArray>();
-            for (std::uint8_t i = 0; i < button.can.length; ++i) {
-                data_arr.add(button.can.data[i]);
-            }
-
-            JsonObject can_off_obj = btn_obj["can_off"].to<JsonObject>();
-            can_off_obj["enabled"] = button.can_off.enabled;
-            can_off_obj["pgn"] = button.can_off.pgn;
-            can_off_obj["priority"] = button.can_off.priority;
-            can_off_obj["source_address"] = button.can_off.source_address;
-            can_off_obj["destination_address"] = button.can_off.destination_address;
-
-            JsonArray off_data_arr = can_off_obj["data"].to<JsonArray>();
-            for (std::uint8_t i = 0; i < button.can_off.length; ++i) {
-                off_data_arr.add(button.can_off.data[i]);
-            }
-            
-            // Behavioral output system fields
-            btn_obj["mode"] = button.mode.c_str();
-            btn_obj["scene_id"] = button.scene_id.c_str();
-            btn_obj["scene_action"] = button.scene_action.c_str();
-            btn_obj["scene_duration_ms"] = button.scene_duration_ms;
-            btn_obj["scene_release_off"] = button.scene_release_off;
-            
-            JsonObject output_behavior = btn_obj["output_behavior"].to<JsonObject>();
-            output_behavior["output_id"] = button.output_behavior.output_id.c_str();
-            output_behavior["action"] = button.output_behavior.action.c_str();
-            output_behavior["behavior_type"] = button.output_behavior.behavior_type.c_str();
-            output_behavior["target_value"] = button.output_behavior.target_value;
-            output_behavior["period_ms"] = button.output_behavior.period_ms;
-            output_behavior["duty_cycle"] = button.output_behavior.duty_cycle;
-            output_behavior["fade_time_ms"] = button.output_behavior.fade_time_ms;
-            output_behavior["hold_duration_ms"] = button.output_behavior.hold_duration_ms;
-            output_behavior["on_time_ms"] = button.output_behavior.on_time_ms;
-            output_behavior["off_time_ms"] = button.output_behavior.off_time_ms;
-            output_behavior["auto_off"] = button.output_behavior.auto_off;
-            
-            // Legacy fields (backward compatibility)
-            btn_obj["infinitybox_function"] = button.infinitybox_function.c_str();
-            btn_obj["flash_frequency"] = button.flash_frequency;
-            btn_obj["fade_time"] = button.fade_time;
-            btn_obj["on_time"] = button.on_time;
-        }
-    }
-
-    JsonArray can_library = doc["can_library"].to<JsonArray>();
-    for (const auto& msg : source.can_library) {
-        JsonObject msg_obj = can_library.createNestedObject();
-        msg_obj["id"] = msg.id.c_str();
-        msg_obj["name"] = msg.name.c_str();
-        msg_obj["pgn"] = msg.pgn;
-        msg_obj["priority"] = msg.priority;
-        msg_obj["source_address"] = msg.source_address;
-        msg_obj["destination_address"] = msg.destination_address;
-        msg_obj["description"] = msg.description.c_str();
-        
-        JsonArray data_arr = msg_obj["data"].to<JsonArray>();
-        for (std::uint8_t byte : msg.data) {
-            data_arr.add(byte);
-        }
-    }
-
-    // Encode available fonts
-    JsonArray fonts = doc["available_fonts"].to<JsonArray>();
-    for (const auto& font : source.available_fonts) {
-        JsonObject font_obj = fonts.createNestedObject();
-        font_obj["name"] = font.name.c_str();
-        font_obj["display_name"] = font.display_name.c_str();
-        font_obj["size"] = font.size;
-    }
-}
-
 bool ConfigManager::decodeConfig(JsonVariantConst json, DeviceConfig& target, std::string& error) const {
     if (json.isNull()) {
         error = "JSON payload is empty";
@@ -581,237 +1560,23 @@ bool ConfigManager::decodeConfig(JsonVariantConst json, DeviceConfig& target, st
     }
 
     target.version = safeString(json["version"], "1.0.0");
-
-    JsonObjectConst header = json["header"];
-    if (!header.isNull()) {
-        target.header.title = safeString(header["title"], target.header.title);
-        target.header.subtitle = safeString(header["subtitle"], target.header.subtitle);
-        target.header.show_logo = header["show_logo"] | target.header.show_logo;
-        target.header.logo_variant = safeString(header["logo_variant"], target.header.logo_variant);
-        target.header.logo_base64 = safeString(header["logo_base64"], target.header.logo_base64);
-        target.header.title_font = safeString(header["title_font"], target.header.title_font);
-        target.header.subtitle_font = safeString(header["subtitle_font"], target.header.subtitle_font);
-        target.header.title_align = safeString(header["title_align"], target.header.title_align);
-        target.header.logo_position = safeString(header["logo_position"], target.header.logo_position);
-        target.header.logo_target_height = clampValue<std::uint16_t>(header["logo_target_height"] | target.header.logo_target_height, 16u, 128u);
-        target.header.logo_preserve_aspect = header["logo_preserve_aspect"] | target.header.logo_preserve_aspect;
-        target.header.nav_spacing = clampValue<std::uint8_t>(header["nav_spacing"] | target.header.nav_spacing, 0u, 60u);
-    }
-
-    JsonObjectConst display = json["display"];
-    if (!display.isNull()) {
-        target.display.brightness = clampValue<std::uint8_t>(display["brightness"] | target.display.brightness, 0u, 100u);
-        target.display.sleep_enabled = display["sleep_enabled"] | target.display.sleep_enabled;
-        target.display.sleep_timeout_seconds = clampValue<std::uint16_t>(display["sleep_timeout_seconds"] | target.display.sleep_timeout_seconds, 5u, 3600u);
-        target.display.sleep_icon_base64 = safeString(display["sleep_icon_base64"], target.display.sleep_icon_base64);
-    }
-
-    JsonObjectConst images = json["images"];
-    if (!images.isNull()) {
-        target.images.header_logo = safeString(images["header_logo"], target.images.header_logo);
-        target.images.splash_logo = safeString(images["splash_logo"], target.images.splash_logo);
-        target.images.background_image = safeString(images["background_image"], target.images.background_image);
-        target.images.sleep_logo = safeString(images["sleep_logo"], target.images.sleep_logo);
-    }
-
-    JsonObjectConst theme = json["theme"];
-    if (!theme.isNull()) {
-        target.theme.bg_color = sanitizeColor(safeString(theme["bg_color"], target.theme.bg_color));
-        target.theme.surface_color = sanitizeColor(safeString(theme["surface_color"], target.theme.surface_color));
-        target.theme.page_bg_color = sanitizeColor(safeString(theme["page_bg_color"], target.theme.page_bg_color));
-        target.theme.accent_color = sanitizeColor(safeString(theme["accent_color"], target.theme.accent_color));
-        target.theme.text_primary = sanitizeColor(safeString(theme["text_primary"], target.theme.text_primary));
-        target.theme.text_secondary = sanitizeColor(safeString(theme["text_secondary"], target.theme.text_secondary));
-        target.theme.border_color = sanitizeColor(safeString(theme["border_color"], target.theme.border_color));
-        target.theme.header_border_color = sanitizeColor(safeString(theme["header_border_color"], target.theme.header_border_color));
-        target.theme.nav_button_color = sanitizeColor(safeString(theme["nav_button_color"], target.theme.nav_button_color));
-        target.theme.nav_button_active_color = sanitizeColor(safeString(theme["nav_button_active_color"], target.theme.nav_button_active_color));
-        target.theme.nav_button_text_color = sanitizeColor(safeString(theme["nav_button_text_color"], target.theme.nav_button_text_color));
-        target.theme.nav_button_radius = clampValue<std::uint8_t>(theme["nav_button_radius"] | target.theme.nav_button_radius, 0u, 50u);
-        target.theme.button_radius = clampValue<std::uint8_t>(theme["button_radius"] | target.theme.button_radius, 0u, 50u);
-        target.theme.border_width = clampValue<std::uint8_t>(theme["border_width"] | target.theme.border_width, 0u, 10u);
-        target.theme.header_border_width = clampValue<std::uint8_t>(theme["header_border_width"] | target.theme.header_border_width, 0u, 10u);
-    }
-
-    JsonObjectConst wifi = json["wifi"];
-    if (!wifi.isNull()) {
-        JsonObjectConst ap = wifi["ap"];
-        if (!ap.isNull()) {
-            target.wifi.ap.enabled = ap["enabled"] | true;
-            target.wifi.ap.ssid = safeString(ap["ssid"], target.wifi.ap.ssid);
-            target.wifi.ap.password = safeString(ap["password"], target.wifi.ap.password);
-        }
-
-        JsonObjectConst sta = wifi["sta"];
-        if (!sta.isNull()) {
-            target.wifi.sta.enabled = sta["enabled"] | false;
-            target.wifi.sta.ssid = safeString(sta["ssid"], target.wifi.sta.ssid);
-            target.wifi.sta.password = safeString(sta["password"], target.wifi.sta.password);
-        }
-    }
-
-    target.ota.manifest_url = kOtaManifestUrl;  // OTA endpoint is centrally managed
-    JsonObjectConst ota = json["ota"];
-    if (!ota.isNull()) {
-        target.ota.enabled = ota["enabled"] | target.ota.enabled;
-        // target.ota.auto_apply = ota["auto_apply"] | target.ota.auto_apply;  // Removed - manual-only
-        target.ota.channel = safeString(ota["channel"], target.ota.channel);
-        // const std::uint32_t interval = ota["check_interval_minutes"] | target.ota.check_interval_minutes;  // Removed - manual-only
-        // target.ota.check_interval_minutes = clampValue<std::uint32_t>(interval, 5u, 1440u);  // Removed - manual-only
-    }
+    decodeHeader(json["header"], target.header);
+    decodeDisplay(json["display"], target.display);
+    decodeImages(json["images"], target.images);
+    decodeTheme(json["theme"], target.theme);
+    decodeWifi(json["wifi"], target.wifi);
+    decodeOta(json["ota"], target.ota);
 
     target.pages.clear();
     JsonArrayConst pages = json["pages"].as<JsonArrayConst>();
     if (!pages.isNull()) {
-        std::size_t page_index = 0;
         for (JsonObjectConst page_obj : pages) {
-            if (page_index >= MAX_PAGES) {
+            if (target.pages.size() >= MAX_PAGES) {
                 break;
             }
-
             PageConfig page;
-            page.id = safeString(page_obj["id"], fallbackId("page", page_index));
-            std::string raw_name = trimCopy(safeString(page_obj["name"], ""));
-            if (raw_name.empty()) {
-                raw_name = page.id;
-            }
-            page.name = raw_name;
-            page.nav_text = trimCopy(safeString(page_obj["nav_text"], ""));
-            page.nav_color = sanitizeColorOptional(safeString(page_obj["nav_color"], ""));
-            page.nav_inactive_color = sanitizeColorOptional(safeString(page_obj["nav_inactive_color"], ""));
-            page.nav_text_color = sanitizeColorOptional(safeString(page_obj["nav_text_color"], ""));
-            JsonVariantConst nav_radius_variant = page_obj["nav_button_radius"];
-            if (!nav_radius_variant.isNull()) {
-                int radius_value = nav_radius_variant | -1;
-                radius_value = std::max(-1, std::min(50, radius_value));
-                page.nav_button_radius = radius_value;
-            } else {
-                page.nav_button_radius = -1;
-            }
-            page.bg_color = sanitizeColorOptional(safeString(page_obj["bg_color"], ""));
-            page.text_color = sanitizeColorOptional(safeString(page_obj["text_color"], ""));
-            page.button_color = sanitizeColorOptional(safeString(page_obj["button_color"], ""));
-            page.button_pressed_color = sanitizeColorOptional(safeString(page_obj["button_pressed_color"], ""));
-            page.button_border_color = sanitizeColorOptional(safeString(page_obj["button_border_color"], ""));
-            page.button_border_width = clampValue<std::uint8_t>(page_obj["button_border_width"] | page.button_border_width, 0u, 10u);
-            page.button_radius = clampValue<std::uint8_t>(page_obj["button_radius"] | page.button_radius, 0u, 50u);
-            page.rows = clampValue<std::uint8_t>(page_obj["rows"] | 2, 1, 4);
-            page.cols = clampValue<std::uint8_t>(page_obj["cols"] | 2, 1, 4);
-            page.type = safeString(page_obj["type"], "");
-            page.custom_content = safeString(page_obj["custom_content"], "");
-
-            JsonArrayConst buttons = page_obj["buttons"].as<JsonArrayConst>();
-            if (!buttons.isNull()) {
-                std::size_t button_index = 0;
-                for (JsonObjectConst btn_obj : buttons) {
-                    if (button_index >= MAX_BUTTONS_PER_PAGE) {
-                        break;
-                    }
-
-                    ButtonConfig button;
-                    button.id = safeString(btn_obj["id"], fallbackId("btn", button_index));
-                    button.label = safeString(btn_obj["label"], button.id);
-                    button.color = sanitizeColor(safeString(btn_obj["color"], button.color));
-                    button.pressed_color = sanitizeColor(safeString(btn_obj["pressed_color"], button.pressed_color));
-                    button.text_color = sanitizeColorOptional(safeString(btn_obj["text_color"], ""));
-                    button.icon = safeString(btn_obj["icon"], "");
-                    button.row = clampValue<std::uint8_t>(btn_obj["row"] | 0, 0, page.rows - 1);
-                    button.col = clampValue<std::uint8_t>(btn_obj["col"] | 0, 0, page.cols - 1);
-                    button.row_span = clampValue<std::uint8_t>(btn_obj["row_span"] | 1, 1, page.rows - button.row);
-                    button.col_span = clampValue<std::uint8_t>(btn_obj["col_span"] | 1, 1, page.cols - button.col);
-                    button.momentary = btn_obj["momentary"] | false;
-                    button.font_size = clampValue<std::uint8_t>(btn_obj["font_size"] | 24, 8, 72);
-                    button.font_family = safeString(btn_obj["font_family"], "montserrat");
-                    button.font_weight = safeString(btn_obj["font_weight"], "400");
-                    button.font_name = safeString(btn_obj["font_name"], "montserrat_16");
-                    button.text_align = safeString(btn_obj["text_align"], "center");
-                    button.corner_radius = clampValue<std::uint8_t>(btn_obj["corner_radius"] | 12, 0, 50);
-                    button.border_width = clampValue<std::uint8_t>(btn_obj["border_width"] | 0, 0, 10);
-                    button.border_color = sanitizeColor(safeString(btn_obj["border_color"], "#FFFFFF"));
-
-                    JsonObjectConst can_obj = btn_obj["can"];
-                    if (!can_obj.isNull()) {
-                        button.can.enabled = can_obj["enabled"] | false;
-                        button.can.pgn = can_obj["pgn"] | button.can.pgn;
-                        button.can.priority = clampValue<std::uint8_t>(can_obj["priority"] | button.can.priority, 0u, 7u);
-                        button.can.source_address = can_obj["source_address"] | button.can.source_address;
-                        button.can.destination_address = can_obj["destination_address"] | button.can.destination_address;
-
-                        JsonArrayConst data_arr = can_obj["data"].as<JsonArrayConst>();
-                        if (!data_arr.isNull()) {
-                            std::size_t i = 0;
-                            for (JsonVariantConst byte_val : data_arr) {
-                                if (i >= button.can.data.size()) {
-                                    break;
-                                }
-                                button.can.data[i] = clampValue<std::uint8_t>(byte_val | 0, 0u, 255u);
-                                ++i;
-                            }
-                            button.can.length = static_cast<std::uint8_t>(i);  // Set length based on actual data bytes
-                        }
-                    }
-
-                    JsonObjectConst can_off_obj = btn_obj["can_off"];
-                    if (!can_off_obj.isNull()) {
-                        button.can_off.enabled = can_off_obj["enabled"] | false;
-                        button.can_off.pgn = can_off_obj["pgn"] | button.can_off.pgn;
-                        button.can_off.priority = clampValue<std::uint8_t>(can_off_obj["priority"] | button.can_off.priority, 0u, 7u);
-                        button.can_off.source_address = can_off_obj["source_address"] | button.can_off.source_address;
-                        button.can_off.destination_address = can_off_obj["destination_address"] | button.can_off.destination_address;
-
-                        JsonArrayConst off_data_arr = can_off_obj["data"].as<JsonArrayConst>();
-                        if (!off_data_arr.isNull()) {
-                            std::size_t i = 0;
-                            for (JsonVariantConst byte_val : off_data_arr) {
-                                if (i >= button.can_off.data.size()) {
-                                    break;
-                                }
-                                button.can_off.data[i] = clampValue<std::uint8_t>(byte_val | 0, 0u, 255u);
-                                ++i;
-                            }
-                            button.can_off.length = static_cast<std::uint8_t>(i);  // Set length based on actual data bytes
-                        }
-                    }
-                    
-                    // Behavioral output system fields
-                    button.mode = safeString(btn_obj["mode"], "can");
-                    button.scene_id = safeString(btn_obj["scene_id"], "");
-                    button.scene_action = safeString(btn_obj["scene_action"], "on");
-                    button.scene_duration_ms = clampValue<std::uint16_t>(btn_obj["scene_duration_ms"] | 0, 0u, 60000u);
-                    button.scene_release_off = btn_obj["scene_release_off"] | false;
-                    
-                    JsonObjectConst output_behavior = btn_obj["output_behavior"];
-                    if (!output_behavior.isNull()) {
-                        button.output_behavior.output_id = safeString(output_behavior["output_id"], "");
-                        button.output_behavior.action = safeString(output_behavior["action"], "on");
-                        button.output_behavior.behavior_type = safeString(output_behavior["behavior_type"], "steady");
-                        button.output_behavior.target_value = clampValue<std::uint8_t>(output_behavior["target_value"] | 100, 0u, 100u);
-                        button.output_behavior.period_ms = clampValue<std::uint16_t>(output_behavior["period_ms"] | 500, 1u, 10000u);
-                        button.output_behavior.duty_cycle = clampValue<std::uint8_t>(output_behavior["duty_cycle"] | 50, 0u, 100u);
-                        button.output_behavior.fade_time_ms = clampValue<std::uint16_t>(output_behavior["fade_time_ms"] | 1000, 0u, 10000u);
-                        button.output_behavior.hold_duration_ms = clampValue<std::uint16_t>(output_behavior["hold_duration_ms"] | 0, 0u, 60000u);
-                        button.output_behavior.on_time_ms = clampValue<std::uint16_t>(output_behavior["on_time_ms"] | 100, 1u, 10000u);
-                        button.output_behavior.off_time_ms = clampValue<std::uint16_t>(output_behavior["off_time_ms"] | 100, 1u, 10000u);
-                        if (output_behavior.containsKey("auto_off")) {
-                            button.output_behavior.auto_off = output_behavior["auto_off"] | false;
-                        } else {
-                            button.output_behavior.auto_off = (button.mode == "output");
-                        }
-                    }
-                    
-                    // Legacy fields (backward compatibility)
-                    button.infinitybox_function = btn_obj["infinitybox_function"] | "";
-                    button.flash_frequency = btn_obj["flash_frequency"] | 500;
-                    button.fade_time = btn_obj["fade_time"] | 1000;
-                    button.on_time = btn_obj["on_time"] | 2000;
-
-                    page.buttons.push_back(std::move(button));
-                    ++button_index;
-                }
-            }
-
+            decodePage(page_obj, target.pages.size(), page);
             target.pages.push_back(std::move(page));
-            ++page_index;
         }
     }
 
@@ -819,56 +1584,13 @@ bool ConfigManager::decodeConfig(JsonVariantConst json, DeviceConfig& target, st
         target.pages = buildDefaultConfig().pages;
     }
 
-    // Decode CAN library
-    target.can_library.clear();
-    JsonArrayConst can_library = json["can_library"].as<JsonArrayConst>();
-    if (!can_library.isNull()) {
-        std::size_t msg_index = 0;
-        for (JsonObjectConst msg_obj : can_library) {
-            if (msg_index >= 50) {  // Reasonable limit for CAN library
-                break;
-            }
-
-            CanMessage msg;
-            msg.id = safeString(msg_obj["id"], fallbackId("can_msg", msg_index));
-            msg.name = safeString(msg_obj["name"], msg.id);
-            msg.pgn = msg_obj["pgn"] | 0;
-            msg.priority = clampValue<std::uint8_t>(msg_obj["priority"] | 6, 0u, 7u);
-            msg.source_address = msg_obj["source_address"] | 0xF9;
-            msg.destination_address = msg_obj["destination_address"] | 0xFF;
-            msg.description = safeString(msg_obj["description"], "");
-
-            JsonArrayConst data_arr = msg_obj["data"].as<JsonArrayConst>();
-            if (!data_arr.isNull()) {
-                std::size_t i = 0;
-                for (JsonVariantConst byte_val : data_arr) {
-                    if (i >= msg.data.size()) {
-                        break;
-                    }
-                    msg.data[i] = clampValue<std::uint8_t>(byte_val | 0, 0u, 255u);
-                    ++i;
-                }
-            }
-
-            target.can_library.push_back(std::move(msg));
-            ++msg_index;
-        }
+    decodeCanLibrary(json["can_library"].as<JsonArrayConst>(), target.can_library);
+    if (!json["can_monitor_pgns"].isNull()) {
+        decodeCanMonitorPgns(json["can_monitor_pgns"].as<JsonArrayConst>(), target.can_monitor_pgns);
     }
 
-    // Decode available fonts
-    target.available_fonts.clear();
-    JsonArrayConst fonts = json["available_fonts"].as<JsonArrayConst>();
-    if (!fonts.isNull()) {
-        for (JsonObjectConst font_obj : fonts) {
-            FontConfig font;
-            font.name = safeString(font_obj["name"], "montserrat_16");
-            font.display_name = safeString(font_obj["display_name"], "Montserrat 16");
-            font.size = clampValue<std::uint8_t>(font_obj["size"] | 16, 8, 72);
-            target.available_fonts.push_back(std::move(font));
-        }
-    }
-    
     // If no fonts defined, use default list
+    decodeFonts(json["available_fonts"].as<JsonArrayConst>(), target.available_fonts);
     if (target.available_fonts.empty()) {
         target.available_fonts = buildDefaultConfig().available_fonts;
     }
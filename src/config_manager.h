@@ -1,6 +1,9 @@
 #pragma once
 
 #include <ArduinoJson.h>
+
+#include <array>
+#include <cstdint>
 #include <string>
 
 #include "config_types.h"
@@ -10,25 +13,40 @@ public:
     static ConfigManager& instance();
 
     bool begin();
-    bool save() const;
+    bool save() const;  // Rewrites only the sections that changed since the last load or save
     bool resetToDefaults();
-    void factoryReset();  // Nuclear option - wipe config file
+    void factoryReset();  // Nuclear option - wipe config files
 
     DeviceConfig& getConfig() { return config_; }
     const DeviceConfig& getConfig() const { return config_; }
 
-    std::string toJson() const;
+    std::string toJson() const;  // Full document, as served by /api/config
     bool updateFromJson(JsonVariantConst json, std::string& error);
 
 private:
     ConfigManager() = default;
 
+    // Storage is split into sections (system, theme, wifi, page index, one
+    // file per page, one binary file per image); see config_manager.cpp
+    static constexpr std::size_t kImageAssetCount = 6;
+    static constexpr std::size_t kSectionSlots = 4 + MAX_PAGES + kImageAssetCount;
+
     DeviceConfig config_{};
+    // FNV-1a of each section as last read from or written to flash; 0 = unknown
+    mutable std::array<std::uint32_t, kSectionSlots> section_hashes_{};
+    mutable std::size_t stored_page_count_ = MAX_PAGES;  // Page files that may exist
+    mutable bool snapshot_on_flash_ = false;  // /cfg_snapshot.bin may exist
+    mutable bool snapshot_current_ = false;   // ...and matches config_ and the sections
 
     bool loadFromStorage();
-    bool writeToStorage(const std::string& json) const;
+    bool importLegacyConfig();
+    bool readSection(std::size_t slot, const char* path, DynamicJsonDocument& doc);
+    bool writeSection(std::size_t slot, const char* path, const DynamicJsonDocument& doc) const;
+    bool writeAssetSection(std::size_t slot, const char* path, const std::string& value) const;
+    bool loadSnapshot();
+    bool writeSnapshot() const;
+    void invalidateSnapshot() const;
     DeviceConfig buildDefaultConfig() const;
     static int compareVersions(const std::string& lhs, const std::string& rhs);
     bool decodeConfig(JsonVariantConst json, DeviceConfig& target, std::string& error) const;
-    void encodeConfig(const DeviceConfig& source, DynamicJsonDocument& doc) const;
 };
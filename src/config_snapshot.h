@@ -0,0 +1,554 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "config_types.h"
+
+// Compiled binary image of a DeviceConfig, loaded at boot without parsing.
+//
+// A ConfigSnapshotHeader is followed by the body: every field of the config
+// in declaration order, scalars as little-endian fixed-width values, strings
+// as a u32 length plus bytes, vectors as a u32 count plus elements. The
+// body holds no pointers or absolute offsets and is decoded front to back,
+// so it streams straight from a file (or any other source) into the
+// config without an image of the whole snapshot in RAM.
+//
+// Image assets (fields visited with v.asset()) are not in the body: they
+// already have their own files, and the caller keeps their hashes in the
+// tags to check the files it pairs with the snapshot.
+//
+// visitConfigFields() is the single field list. Writing, reading and the
+// layout fingerprint all use it, so adding, removing or retyping a field
+// changes the fingerprint: a snapshot from other firmware is rejected (the
+// caller falls back to JSON) instead of being misread.
+//
+// Portable; the host bench exercises it without ArduinoJson.
+
+struct ConfigSnapshotHeader {
+    char magic[4] = {'C', 'F', 'G', 'S'};
+    uint16_t format = 2;
+    uint16_t header_size = 24;
+    uint32_t layout = 0;     // configSnapshotLayout()
+    uint32_t tag_count = 0;  // Caller words stored ahead of the config
+    uint32_t body_size = 0;
+    uint32_t body_crc = 0;   // CRC-32 of the body
+};
+static_assert(sizeof(ConfigSnapshotHeader) == 24, "ConfigSnapshotHeader is an on-flash format");
+
+// ─── Field list ─────────────────────────────────────────────────────────────
+
+template <typename V>
+void visitConfigFields(V& v, CanFrameConfig& f) {
+    v("enabled", f.enabled);
+    v("pgn", f.pgn);
+    v("priority", f.priority);
+    v("source_address", f.source_address);
+    v("destination_address", f.destination_address);
+    v("data", f.data);
+    v("length", f.length);
+}
+
+template <typename V>
+void visitConfigFields(V& v, ButtonConfig::OutputBehaviorConfig& f) {
+    v("output_id", f.output_id);
+    v("action", f.action);
+    v("behavior_type", f.behavior_type);
+    v("target_value", f.target_value);
+    v("period_ms", f.period_ms);
+    v("duty_cycle", f.duty_cycle);
+    v("fade_time_ms", f.fade_time_ms);
+    v("hold_duration_ms", f.hold_duration_ms);
+    v("on_time_ms", f.on_time_ms);
+    v("off_time_ms", f.off_time_ms);
+    v("auto_off", f.auto_off);
+}
+
+template <typename V>
+void visitConfigFields(V& v, ButtonConfig& f) {
+    v("id", f.id);
+    v("label", f.label);
+    v("color", f.color);
+    v("pressed_color", f.pressed_color);
+    v("text_color", f.text_color);
+    v("icon", f.icon);
+    v("row", f.row);
+    v("col", f.col);
+    v("row_span", f.row_span);
+    v("col_span", f.col_span);
+    v("momentary", f.momentary);
+    v("font_size", f.font_size);
+    v("font_family", f.font_family);
+    v("font_weight", f.font_weight);
+    v("font_name", f.font_name);
+    v("text_align", f.text_align);
+    v("corner_radius", f.corner_radius);
+    v("border_width", f.border_width);
+    v("border_color", f.border_color);
+    v("can", f.can);
+    v("can_off", f.can_off);
+    v("mode", f.mode);
+    v("output_behavior", f.output_behavior);
+    v("scene_id", f.scene_id);
+    v("scene_action", f.scene_action);
+    v("scene_duration_ms", f.scene_duration_ms);
+    v("scene_release_off", f.scene_release_off);
+    v("infinitybox_function", f.infinitybox_function);
+    v("behavioral_scene", f.behavioral_scene);
+    v("flash_frequency", f.flash_frequency);
+    v("fade_time", f.fade_time);
+    v("on_time", f.on_time);
+}
+
+template <typename V>
+void visitConfigFields(V& v, PageConfig& f) {
+    v("id", f.id);
+    v("name", f.name);
+    v("type", f.type);
+    v("custom_content", f.custom_content);
+    v("nav_text", f.nav_text);
+    v("nav_color", f.nav_color);
+    v("nav_inactive_color", f.nav_inactive_color);
+    v("nav_text_color", f.nav_text_color);
+    v("nav_button_radius", f.nav_button_radius);
+    v("bg_color", f.bg_color);
+    v("text_color", f.text_color);
+    v("button_color", f.button_color);
+    v("button_pressed_color", f.button_pressed_color);
+    v("button_border_color", f.button_border_color);
+    v("button_border_width", f.button_border_width);
+    v("button_radius", f.button_radius);
+    v("rows", f.rows);
+    v("cols", f.cols);
+    v("buttons", f.buttons);
+}
+
+template <typename V>
+void visitConfigFields(V& v, FontConfig& f) {
+    v("name", f.name);
+    v("display_name", f.display_name);
+    v("size", f.size);
+}
+
+template <typename V>
+void visitConfigFields(V& v, WifiCredentials& f) {
+    v("enabled", f.enabled);
+    v("ssid", f.ssid);
+    v("password", f.password);
+}
+
+template <typename V>
+void visitConfigFields(V& v, WifiConfig& f) {
+    v("ap", f.ap);
+    v("sta", f.sta);
+}
+
+template <typename V>
+void visitConfigFields(V& v, OTAConfig& f) {
+    v("enabled", f.enabled);
+    v("manifest_url", f.manifest_url);
+    v("channel", f.channel);
+}
+
+template <typename V>
+void visitConfigFields(V& v, HeaderConfig& f) {
+    v("title", f.title);
+    v("subtitle", f.subtitle);
+    v("show_logo", f.show_logo);
+    v("logo_variant", f.logo_variant);
+    v.asset("logo_base64", f.logo_base64);
+    v("title_font", f.title_font);
+    v("subtitle_font", f.subtitle_font);
+    v("title_align", f.title_align);
+    v("logo_position", f.logo_position);
+    v("logo_target_height", f.logo_target_height);
+    v("logo_preserve_aspect", f.logo_preserve_aspect);
+    v("nav_spacing", f.nav_spacing);
+}
+
+template <typename V>
+void visitConfigFields(V& v, ImageAssets& f) {
+    v.asset("header_logo", f.header_logo);
+    v.asset("splash_logo", f.splash_logo);
+    v.asset("background_image", f.background_image);
+    v.asset("sleep_logo", f.sleep_logo);
+}
+
+template <typename V>
+void visitConfigFields(V& v, DisplayConfig& f) {
+    v("brightness", f.brightness);
+    v("sleep_enabled", f.sleep_enabled);
+    v("sleep_timeout_seconds", f.sleep_timeout_seconds);
+    v.asset("sleep_icon_base64", f.sleep_icon_base64);
+}
+
+template <typename V>
+void visitConfigFields(V& v, ThemeConfig& f) {
+    v("bg_color", f.bg_color);
+    v("surface_color", f.surface_color);
+    v("page_bg_color", f.page_bg_color);
+    v("accent_color", f.accent_color);
+    v("text_primary", f.text_primary);
+    v("text_secondary", f.text_secondary);
+    v("border_color", f.border_color);
+    v("header_border_color", f.header_border_color);
+    v("nav_button_color", f.nav_button_color);
+    v("nav_button_active_color", f.nav_button_active_color);
+    v("nav_button_text_color", f.nav_button_text_color);
+    v("nav_button_radius", f.nav_button_radius);
+    v("button_radius", f.button_radius);
+    v("border_width", f.border_width);
+    v("header_border_width", f.header_border_width);
+}
+
+template <typename V>
+void visitConfigFields(V& v, CanMessage& f) {
+    v("id", f.id);
+    v("name", f.name);
+    v("pgn", f.pgn);
+    v("priority", f.priority);
+    v("source_address", f.source_address);
+    v("destination_address", f.destination_address);
+    v("data", f.data);
+    v("description", f.description);
+}
+
+template <typename V>
+void visitConfigFields(V& v, CanMonitorPgn& f) {
+    v("pgn", f.pgn);
+    v("name", f.name);
+}
+
+template <typename V>
+void visitConfigFields(V& v, DeviceConfig& f) {
+    v("version", f.version);
+    v("wifi", f.wifi);
+    v("ota", f.ota);
+    v("header", f.header);
+    v("theme", f.theme);
+    v("display", f.display);
+    v("images", f.images);
+    v("pages", f.pages);
+    v("can_library", f.can_library);
+    v("can_monitor_pgns", f.can_monitor_pgns);
+    v("available_fonts", f.available_fonts);
+}
+
+// ─── Encoding ───────────────────────────────────────────────────────────────
+
+namespace config_snapshot_detail {
+
+template <typename T>
+struct IsVector : std::false_type {};
+template <typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+template <typename T>
+struct IsByteArray : std::false_type {};
+template <std::size_t N>
+struct IsByteArray<std::array<std::uint8_t, N>> : std::true_type {};
+
+// Reflected CRC-32 (IEEE), nibble table: small and fast enough for boot
+inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, std::size_t length) {
+    static constexpr uint32_t kTable[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (std::size_t i = 0; i < length; ++i) {
+        crc = kTable[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = kTable[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+// FNV-1a over field names and type codes
+class LayoutHasher {
+public:
+    template <typename T>
+    void operator()(const char* name, T& value) {
+        while (*name) {
+            mix(static_cast<uint8_t>(*name++));
+        }
+        if constexpr (std::is_integral<T>::value) {
+            mix(static_cast<uint8_t>(std::is_signed<T>::value ? 0x80 | sizeof(T) : sizeof(T)));
+        } else if constexpr (std::is_same<T, std::string>::value) {
+            mix('s');
+        } else if constexpr (IsByteArray<T>::value) {
+            mix('a');
+            mix(static_cast<uint8_t>(value.size()));
+        } else if constexpr (IsVector<T>::value) {
+            mix('[');
+            typename T::value_type element{};
+            visitConfigFields(*this, element);
+            mix(']');
+        } else {
+            mix('{');
+            visitConfigFields(*this, value);
+            mix('}');
+        }
+    }
+
+    void asset(const char* name, std::string& value) {
+        mix('@');
+        (*this)(name, value);
+    }
+
+    uint32_t hash() const { return hash_; }
+
+private:
+    void mix(uint8_t byte) { hash_ = (hash_ ^ byte) * 16777619u; }
+
+    uint32_t hash_ = 2166136261u;
+};
+
+// Streams the body to sink.write(const uint8_t*, size_t) -> size_t,
+// counting bytes and running the CRC as it goes. Image assets are
+// included only when `assets` is set (section CRCs, not snapshots).
+template <typename Sink>
+class BodyWriter {
+public:
+    explicit BodyWriter(Sink& sink, bool assets = true) : sink_(sink), assets_(assets) {}
+
+    template <typename T>
+    void operator()(const char*, T& value) {
+        if constexpr (std::is_integral<T>::value) {
+            put(&value, sizeof(value));
+        } else if constexpr (std::is_same<T, std::string>::value) {
+            putLength(value.size());
+            put(value.data(), value.size());
+        } else if constexpr (IsByteArray<T>::value) {
+            put(value.data(), value.size());
+        } else if constexpr (IsVector<T>::value) {
+            putLength(value.size());
+            for (auto& element : value) {
+                visitConfigFields(*this, element);
+            }
+        } else {
+            visitConfigFields(*this, value);
+        }
+    }
+
+    void asset(const char* name, std::string& value) {
+        if (assets_) {
+            (*this)(name, value);
+        }
+    }
+
+    void putLength(std::size_t length) {
+        const uint32_t value = static_cast<uint32_t>(length);
+        put(&value, sizeof(value));
+    }
+
+    bool ok() const { return ok_; }
+    uint32_t size() const { return size_; }
+    uint32_t crc() const { return crc_; }
+
+private:
+    void put(const void* data, std::size_t length) {
+        if (!ok_ || length == 0) {
+            return;
+        }
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        ok_ = sink_.write(bytes, length) == length;
+        crc_ = crc32Update(crc_, bytes, length);
+        size_ += static_cast<uint32_t>(length);
+    }
+
+    Sink& sink_;
+    bool assets_;
+    bool ok_ = true;
+    uint32_t size_ = 0;
+    uint32_t crc_ = 0;
+};
+
+// Bounds-checked decoder pulling the body from source.read(uint8_t*,
+// size_t) -> size_t and running the CRC as it goes. Fields land directly
+// in their destination; nothing is trusted until crc() is checked.
+// Image assets are not in the body and keep their defaults.
+template <typename Source>
+class BodyReader {
+public:
+    BodyReader(Source& source, std::size_t size) : source_(source), remaining_(size) {}
+
+    template <typename T>
+    void operator()(const char*, T& value) {
+        if constexpr (std::is_integral<T>::value) {
+            take(&value, sizeof(value));
+        } else if constexpr (std::is_same<T, std::string>::value) {
+            // A length past the end of the body fails before it allocates
+            const uint32_t length = takeLength();
+            if (!ok_ || length > remaining_) {
+                ok_ = false;
+                return;
+            }
+            value.resize(length);
+            take(&value[0], length);
+        } else if constexpr (IsByteArray<T>::value) {
+            take(value.data(), value.size());
+        } else if constexpr (IsVector<T>::value) {
+            const uint32_t count = takeLength();
+            // Every element takes at least one byte, so a bad count cannot
+            // force a huge allocation
+            if (!ok_ || count > remaining_) {
+                ok_ = false;
+                return;
+            }
+            value.clear();
+            value.resize(count);
+            for (auto& element : value) {
+                visitConfigFields(*this, element);
+            }
+        } else {
+            visitConfigFields(*this, value);
+        }
+    }
+
+    void asset(const char*, std::string&) {}
+
+    uint32_t takeLength() {
+        uint32_t value = 0;
+        take(&value, sizeof(value));
+        return value;
+    }
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return remaining_ == 0; }
+    uint32_t crc() const { return crc_; }
+
+private:
+    void take(void* out, std::size_t length) {
+        if (!ok_ || length > remaining_) {
+            ok_ = false;
+            return;
+        }
+        if (length == 0) {
+            return;
+        }
+        auto* bytes = static_cast<uint8_t*>(out);
+        ok_ = source_.read(bytes, length) == length;
+        crc_ = crc32Update(crc_, bytes, length);
+        remaining_ -= length;
+    }
+
+    Source& source_;
+    std::size_t remaining_;
+    bool ok_ = true;
+    uint32_t crc_ = 0;
+};
+
+// In-memory source, for images already in RAM (or memory-mapped)
+class MemorySource {
+public:
+    MemorySource(const uint8_t* data, std::size_t size) : cursor_(data), end_(data + size) {}
+
+    std::size_t read(uint8_t* out, std::size_t length) {
+        length = std::min(length, static_cast<std::size_t>(end_ - cursor_));
+        std::memcpy(out, cursor_, length);
+        cursor_ += length;
+        return length;
+    }
+
+private:
+    const uint8_t* cursor_;
+    const uint8_t* end_;
+};
+
+}  // namespace config_snapshot_detail
+
+inline uint32_t configSnapshotLayout() {
+    static const uint32_t layout = [] {
+        config_snapshot_detail::LayoutHasher hasher;
+        DeviceConfig probe;
+        visitConfigFields(hasher, probe);
+        return hasher.hash();
+    }();
+    return layout;
+}
+
+// CRC-32 of one config section's encoded fields (e.g. a PageConfig): equal
+// content gives an equal CRC, so callers can tell what an update changed
+template <typename T>
+uint32_t configSectionCrc(const T& section) {
+    struct CountingSink {
+        std::size_t write(const uint8_t*, std::size_t length) { return length; }
+    } sink;
+    config_snapshot_detail::BodyWriter<CountingSink> body(sink);
+    body("section", const_cast<T&>(section));
+    return body.crc();
+}
+
+// Streams header + body to `sink`. The header goes first with zeroed size
+// and CRC; `rewriteHeader(const ConfigSnapshotHeader&)` is then called so
+// the sink can seek back and patch it (a vector sink simply overwrites).
+// `tags` are caller words kept with the snapshot (e.g. source hashes).
+template <typename Sink, typename RewriteHeader>
+bool writeConfigSnapshot(Sink& sink, const DeviceConfig& config, const uint32_t* tags, uint32_t tag_count,
+                         RewriteHeader&& rewriteHeader) {
+    ConfigSnapshotHeader header;
+    header.layout = configSnapshotLayout();
+    header.tag_count = tag_count;
+    if (sink.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+
+    config_snapshot_detail::BodyWriter<Sink> body(sink, false);
+    for (uint32_t i = 0; i < tag_count; ++i) {
+        uint32_t tag = tags[i];
+        body("tag", tag);
+    }
+    // The writer only reads; the visitor interface is shared with the reader
+    visitConfigFields(body, const_cast<DeviceConfig&>(config));
+    if (!body.ok()) {
+        return false;
+    }
+    header.body_size = body.size();
+    header.body_crc = body.crc();
+    return rewriteHeader(header);
+}
+
+// Decodes a snapshot of `size` bytes from source.read(uint8_t*, size_t)
+// (e.g. an open File). Fails without touching `config` or `tags` if the
+// header, layout, tag count or CRC do not match. Image assets in `config`
+// are left empty for the caller to fill from their own files.
+template <typename Source>
+bool readConfigSnapshot(Source& source, std::size_t size, DeviceConfig& config, uint32_t* tags,
+                        uint32_t tag_count) {
+    ConfigSnapshotHeader header;
+    if (size < sizeof(header) ||
+        source.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+    if (std::memcmp(header.magic, ConfigSnapshotHeader{}.magic, sizeof(header.magic)) != 0 ||
+        header.format != ConfigSnapshotHeader{}.format || header.header_size != sizeof(header) ||
+        header.layout != configSnapshotLayout() || header.tag_count != tag_count ||
+        header.body_size != size - sizeof(header)) {
+        return false;
+    }
+
+    config_snapshot_detail::BodyReader<Source> reader(source, header.body_size);
+    std::vector<uint32_t> read_tags(tag_count);
+    for (uint32_t& tag : read_tags) {
+        reader("tag", tag);
+    }
+    DeviceConfig decoded;
+    visitConfigFields(reader, decoded);
+    if (!reader.ok() || !reader.atEnd() || reader.crc() != header.body_crc) {
+        return false;
+    }
+    std::copy(read_tags.begin(), read_tags.end(), tags);
+    config = std::move(decoded);
+    return true;
+}
+
+inline bool readConfigSnapshot(const uint8_t* data, std::size_t size, DeviceConfig& config, uint32_t* tags,
+                               uint32_t tag_count) {
+    config_snapshot_detail::MemorySource source(data, size);
+    return readConfigSnapshot(source, size, config, tags, tag_count);
+}
@@ -9,6 +9,7 @@
 // Limits that align with the documentation
 constexpr std::size_t MAX_PAGES = 20;
 constexpr std::size_t MAX_BUTTONS_PER_PAGE = 12;
+constexpr std::size_t MAX_CAN_MONITOR_PGNS = 8;
 
 constexpr const char kOtaManifestUrl[] =
     "https://image-optimizer-still-flower-1282.fly.dev/ota/manifest";
@@ -193,6 +194,13 @@ struct CanMessage {
     std::string description = "";
 };
 
+// PGN received (from any source address) while the CAN RX acceptance filter
+// is installed, on top of the frames the firmware itself consumes
+struct CanMonitorPgn {
+    std::uint32_t pgn = 0;
+    std::string name = "";
+};
+
 struct DeviceConfig {
     std::string version = "1.0.0";
     WifiConfig wifi{};
@@ -203,5 +211,6 @@ struct DeviceConfig {
     ImageAssets images{};
     std::vector<PageConfig> pages;
     std::vector<CanMessage> can_library;
+    std::vector<CanMonitorPgn> can_monitor_pgns;  // At most MAX_CAN_MONITOR_PGNS
     std::vector<FontConfig> available_fonts;  // List of available fonts for UI
 };
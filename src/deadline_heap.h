@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-capacity indexed binary min-heap of millisecond deadlines.
+//
+// Each id in [0, Capacity) has at most one pending deadline: schedule()
+// inserts or moves it, cancel() removes it, both O(log n) with no
+// allocation. Deadlines are compared wrap-safe (millis() rollover), so all
+// pending deadlines must lie within 2^31 ms of each other.
+template <std::size_t Capacity>
+class DeadlineHeap {
+    static_assert(Capacity > 0 && Capacity < 0xFFFF, "DeadlineHeap capacity must fit a uint16_t index");
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+
+    DeadlineHeap() { pos_.fill(kNone); }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+    bool contains(std::size_t id) const { return id < Capacity && pos_[id] != kNone; }
+
+    // Valid only when !empty()
+    std::uint32_t topDeadline() const { return deadline_[heap_[0]]; }
+    std::size_t topId() const { return heap_[0]; }
+
+    void schedule(std::size_t id, std::uint32_t deadline) {
+        if (id >= Capacity) return;
+        deadline_[id] = deadline;
+        if (pos_[id] == kNone) {
+            pos_[id] = static_cast<std::uint16_t>(size_);
+            heap_[size_++] = static_cast<std::uint16_t>(id);
+            siftUp(pos_[id]);
+        } else {
+            siftUp(pos_[id]);
+            siftDown(pos_[id]);
+        }
+    }
+
+    void cancel(std::size_t id) {
+        if (!contains(id)) return;
+        const std::size_t at = pos_[id];
+        pos_[id] = kNone;
+        --size_;
+        if (at == size_) return;
+        const std::uint16_t moved = heap_[size_];
+        heap_[at] = moved;
+        pos_[moved] = static_cast<std::uint16_t>(at);
+        siftUp(at);
+        siftDown(pos_[moved]);
+    }
+
+    void pop() {
+        if (size_ > 0) cancel(heap_[0]);
+    }
+
+    static bool before(std::uint32_t a, std::uint32_t b) { return static_cast<std::int32_t>(a - b) < 0; }
+
+private:
+    static constexpr std::uint16_t kNone = 0xFFFF;
+
+    void swapAt(std::size_t a, std::size_t b) {
+        const std::uint16_t id_a = heap_[a];
+        heap_[a] = heap_[b];
+        heap_[b] = id_a;
+        pos_[heap_[a]] = static_cast<std::uint16_t>(a);
+        pos_[heap_[b]] = static_cast<std::uint16_t>(b);
+    }
+
+    void siftUp(std::size_t at) {
+        while (at > 0) {
+            const std::size_t parent = (at - 1) / 2;
+            if (!before(deadline_[heap_[at]], deadline_[heap_[parent]])) break;
+            swapAt(at, parent);
+            at = parent;
+        }
+    }
+
+    void siftDown(std::size_t at) {
+        for (;;) {
+            const std::size_t left = 2 * at + 1;
+            if (left >= size_) break;
+            std::size_t best = left;
+            if (left + 1 < size_ && before(deadline_[heap_[left + 1]], deadline_[heap_[left]])) {
+                best = left + 1;
+            }
+            if (!before(deadline_[heap_[best]], deadline_[heap_[at]])) break;
+            swapAt(at, best);
+            at = best;
+        }
+    }
+
+    std::array<std::uint16_t, Capacity> heap_{};
+    std::array<std::uint16_t, Capacity> pos_{};
+    std::array<std::uint32_t, Capacity> deadline_{};
+    std::size_t size_ = 0;
+};
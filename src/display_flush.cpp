@@ -0,0 +1,201 @@
+#include "display_flush.h"
+
+#include <Arduino.h>
+#include <ESP_Panel_Library.h>
+#include <esp_heap_caps.h>
+
+#include <cstdio>
+
+namespace {
+constexpr uint32_t kFlushTaskStack = 3072;
+constexpr UBaseType_t kFlushTaskPriority = 3;     // Above the LVGL task so a waiting render resumes promptly
+constexpr BaseType_t kFlushTaskCore = 0;           // lvgl_port_task is pinned to core 1 (main.cpp)
+constexpr TickType_t kWaitSliceTicks = pdMS_TO_TICKS(10);  // Re-check interval while LVGL waits for a buffer
+
+uint32_t tenths(uint32_t us) { return (us + 50) / 100; }
+}
+
+DisplayFlush& DisplayFlush::instance() {
+    static DisplayFlush flush;
+    return flush;
+}
+
+// ─── Setup ──────────────────────────────────────────────────────────────────
+
+void* DisplayFlush::allocateBuffer(uint32_t bytes) {
+    if (internal_buffers_) {
+        return heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    }
+    return heap_caps_calloc(1, bytes, MALLOC_CAP_SPIRAM);
+}
+
+void DisplayFlush::begin(lv_disp_drv_t& drv, uint16_t hor_res) {
+    async_ = BRONCO_LVGL_ASYNC_FLUSH;
+    internal_buffers_ = BRONCO_LVGL_BUF_INTERNAL;
+    buffer_lines_ = BRONCO_LVGL_BUF_LINES;
+
+    const uint32_t buf_px = static_cast<uint32_t>(hor_res) * buffer_lines_;
+    const uint32_t buf_bytes = buf_px * sizeof(lv_color_t);
+    void* buf1 = allocateBuffer(buf_bytes);
+    void* buf2 = buf1 ? allocateBuffer(buf_bytes) : nullptr;
+    if (internal_buffers_ && !buf2) {
+        Serial.printf("[LVGL] Internal RAM too short for 2x %lu byte buffers (largest block %lu); using PSRAM\n",
+                      static_cast<unsigned long>(buf_bytes),
+                      static_cast<unsigned long>(heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA)));
+        heap_caps_free(buf1);
+        internal_buffers_ = false;
+        buf1 = allocateBuffer(buf_bytes);
+        buf2 = buf1 ? allocateBuffer(buf_bytes) : nullptr;
+    }
+    if (!buf2) {
+        Serial.printf("[ERROR] Unable to allocate LVGL buffers (2x %lu bytes)\n", static_cast<unsigned long>(buf_bytes));
+        Serial.printf("[ERROR] Free PSRAM: %lu bytes\n",
+                      static_cast<unsigned long>(heap_caps_get_free_size(MALLOC_CAP_SPIRAM)));
+        while (true) delay(1000);
+    }
+    lv_disp_draw_buf_init(&draw_buf_, buf1, buf2, buf_px);
+    Serial.printf("[LVGL] ✓ Allocated 2x %lu byte buffers (%lu lines) in %s\n", static_cast<unsigned long>(buf_bytes),
+                  static_cast<unsigned long>(buffer_lines_), internal_buffers_ ? "internal RAM" : "PSRAM");
+
+    flush_done_ = xSemaphoreCreateBinary();
+#if ESP_PANEL_LCD_BUS_TYPE == ESP_PANEL_BUS_TYPE_RGB
+    if (async_) {
+        requests_ = xQueueCreate(1, sizeof(FlushRequest));
+    }
+#endif
+
+    drv_ = &drv;
+    drv.draw_buf = &draw_buf_;
+    drv.flush_cb = flushCb;
+    drv.wait_cb = waitCb;
+    drv.render_start_cb = renderStartCb;
+    drv.monitor_cb = monitorCb;
+}
+
+void DisplayFlush::start(ESP_Panel* panel) {
+    panel_ = panel;
+    if (async_) {
+#if ESP_PANEL_LCD_BUS_TYPE == ESP_PANEL_BUS_TYPE_RGB
+        xTaskCreatePinnedToCore(flushTask, "lv_flush", kFlushTaskStack, this, kFlushTaskPriority, &task_, kFlushTaskCore);
+#else
+        panel_->getLcd()->setCallback(transferDone, this);
+#endif
+    }
+    stats_.publish(millis());
+    lv_timer_create(statsTimer, kStatsPeriodMs, this);
+    Serial.printf("[LVGL] Flush: %s\n", async_ ? "asynchronous" : "synchronous");
+}
+
+// ─── Flush ──────────────────────────────────────────────────────────────────
+
+void DisplayFlush::flushCb(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p) {
+    DisplayFlush& self = instance();
+#if ESP_PANEL_LCD_BUS_TYPE == ESP_PANEL_BUS_TYPE_RGB
+    if (self.async_) {
+        // LVGL renders the next area into the other buffer meanwhile
+        const FlushRequest request{drv, *area, color_p};
+        xQueueSend(self.requests_, &request, portMAX_DELAY);
+        return;
+    }
+#else
+    if (self.async_) {
+        // Completed by transferDone() when the DMA transfer finishes
+        self.transfer_start_us_ = micros();
+        self.panel_->getLcd()->drawBitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_p);
+        return;
+    }
+#endif
+    const uint32_t start_us = micros();
+    self.panel_->getLcd()->drawBitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_p);
+    const uint32_t copy_us = micros() - start_us;
+    self.stats_.flushDone(copy_us);
+    self.frame_wait_us_ += copy_us;  // Rendering is stalled for the copy either way
+    lv_disp_flush_ready(drv);
+}
+
+void DisplayFlush::flushTask(void* arg) {
+    auto* self = static_cast<DisplayFlush*>(arg);
+    FlushRequest request;
+    for (;;) {
+        if (xQueueReceive(self->requests_, &request, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        const uint32_t start_us = micros();
+        self->panel_->getLcd()->drawBitmap(request.area.x1, request.area.y1, request.area.x2 + 1, request.area.y2 + 1,
+                                           request.pixels);
+        self->stats_.flushDone(micros() - start_us);
+        lv_disp_flush_ready(request.drv);
+        xSemaphoreGive(self->flush_done_);
+    }
+}
+
+bool DisplayFlush::transferDone(void* user_ctx) {
+    auto* self = static_cast<DisplayFlush*>(user_ctx);
+    self->stats_.flushDone(micros() - self->transfer_start_us_);
+    lv_disp_flush_ready(self->drv_);
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->flush_done_, &woken);
+    return woken == pdTRUE;
+}
+
+void DisplayFlush::waitCb(lv_disp_drv_t*) {
+    // LVGL re-checks its flushing flag after each return
+    DisplayFlush& self = instance();
+    const uint32_t start_us = micros();
+    xSemaphoreTake(self.flush_done_, kWaitSliceTicks);
+    self.frame_wait_us_ += micros() - start_us;
+}
+
+// ─── Stats ──────────────────────────────────────────────────────────────────
+
+void DisplayFlush::renderStartCb(lv_disp_drv_t*) {
+    DisplayFlush& self = instance();
+    self.frame_start_us_ = micros();
+    self.frame_wait_us_ = 0;
+}
+
+void DisplayFlush::monitorCb(lv_disp_drv_t*, uint32_t, uint32_t px) {
+    DisplayFlush& self = instance();
+    self.stats_.frameDone(micros() - self.frame_start_us_, self.frame_wait_us_, px);
+}
+
+void DisplayFlush::statsTimer(lv_timer_t* timer) {
+    auto* self = static_cast<DisplayFlush*>(timer->user_data);
+    self->stats_.publish(millis());
+    self->refreshOverlay();
+}
+
+void DisplayFlush::refreshOverlay() {
+    if (!overlay_requested_.load(std::memory_order_relaxed)) {
+        if (overlay_ && !lv_obj_has_flag(overlay_, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_add_flag(overlay_, LV_OBJ_FLAG_HIDDEN);
+        }
+        return;
+    }
+    if (!overlay_) {
+        overlay_ = lv_label_create(lv_layer_sys());
+        lv_obj_set_style_bg_color(overlay_, lv_color_hex(0x000000), 0);
+        lv_obj_set_style_bg_opa(overlay_, LV_OPA_70, 0);
+        lv_obj_set_style_text_color(overlay_, lv_color_hex(0x00FF00), 0);
+        lv_obj_set_style_text_font(overlay_, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_pad_all(overlay_, 4, 0);
+        lv_obj_align(overlay_, LV_ALIGN_TOP_RIGHT, -4, 4);
+    }
+    lv_obj_clear_flag(overlay_, LV_OBJ_FLAG_HIDDEN);
+
+    // The overlay's own redraw is one small refresh per period
+    const DisplayStats::Window window = stats_.lastWindow();
+    const uint32_t screen_px = static_cast<uint32_t>(drv_->hor_res) * drv_->ver_res;
+    char text[160];
+    std::snprintf(text, sizeof(text),
+                  "%lu.%lu fps\nrender %lu.%lu ms (max %lu.%lu)\nflush %lu.%lu ms x%lu\nwait %lu.%lu ms\narea %lu%% (max %lu%%)",
+                  static_cast<unsigned long>(window.fpsTenths() / 10), static_cast<unsigned long>(window.fpsTenths() % 10),
+                  static_cast<unsigned long>(tenths(window.render_us_avg) / 10), static_cast<unsigned long>(tenths(window.render_us_avg) % 10),
+                  static_cast<unsigned long>(tenths(window.render_us_max) / 10), static_cast<unsigned long>(tenths(window.render_us_max) % 10),
+                  static_cast<unsigned long>(tenths(window.flush_us_avg) / 10), static_cast<unsigned long>(tenths(window.flush_us_avg) % 10),
+                  static_cast<unsigned long>(window.flushes),
+                  static_cast<unsigned long>(tenths(window.wait_us_avg) / 10), static_cast<unsigned long>(tenths(window.wait_us_avg) % 10),
+                  static_cast<unsigned long>(window.px_avg * 100ull / screen_px),
+                  static_cast<unsigned long>(window.px_max * 100ull / screen_px));
+    lv_label_set_text(overlay_, text);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <lvgl.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include "display_stats.h"
+
+class ESP_Panel;
+
+// LVGL draw buffers and display flush.
+//
+// LVGL renders into one of two partial draw buffers while the other is on
+// its way to the panel. On the RGB panel "on its way" is a CPU copy into
+// the PSRAM framebuffer, so flush_cb hands the area to a flush task on the
+// other core and returns; the task copies, then calls
+// lv_disp_flush_ready(). On SPI/I80 panels drawBitmap() starts a DMA
+// transfer and the bus's transfer-done callback completes the flush. While
+// LVGL waits for a buffer (wait_cb) it blocks on a semaphore instead of
+// spinning with the LVGL mutex held.
+//
+// Build options (platformio build_flags):
+//   BRONCO_LVGL_ASYNC_FLUSH    1 (default) or 0 for the old inline copy
+//   BRONCO_LVGL_BUF_INTERNAL   1 to render into internal SRAM instead of
+//                              PSRAM (falls back to PSRAM if it won't fit)
+//   BRONCO_LVGL_BUF_LINES      Lines per draw buffer (40 in PSRAM, 20 in SRAM)
+//
+// Per-refresh timing is collected in DisplayStats and can be drawn as an
+// overlay on the system layer.
+
+#ifndef BRONCO_LVGL_ASYNC_FLUSH
+#define BRONCO_LVGL_ASYNC_FLUSH 1
+#endif
+
+#ifndef BRONCO_LVGL_BUF_INTERNAL
+#define BRONCO_LVGL_BUF_INTERNAL 0
+#endif
+
+#ifndef BRONCO_LVGL_BUF_LINES
+#if BRONCO_LVGL_BUF_INTERNAL
+#define BRONCO_LVGL_BUF_LINES 20
+#else
+#define BRONCO_LVGL_BUF_LINES 40
+#endif
+#endif
+
+class DisplayFlush {
+public:
+    static constexpr uint32_t kStatsPeriodMs = 1000;
+
+    static DisplayFlush& instance();
+
+    // Allocates both draw buffers and fills in the driver's buffer and
+    // callbacks; call before lv_disp_drv_register(). Halts on allocation
+    // failure like the rest of display bring-up.
+    void begin(lv_disp_drv_t& drv, uint16_t hor_res);
+
+    // After panel->begin(), before the LVGL task runs: starts the flush
+    // task (or hooks the DMA callback) and the stats timer
+    void start(ESP_Panel* panel);
+
+    const DisplayStats& stats() const { return stats_; }
+    bool asyncFlush() const { return async_; }
+    bool internalBuffers() const { return internal_buffers_; }
+    uint32_t bufferLines() const { return buffer_lines_; }
+
+    // Any task; applied by the LVGL task at the next stats period
+    void setOverlayEnabled(bool enabled) { overlay_requested_.store(enabled, std::memory_order_relaxed); }
+    bool overlayEnabled() const { return overlay_requested_.load(std::memory_order_relaxed); }
+
+private:
+    DisplayFlush() = default;
+
+    struct FlushRequest {
+        lv_disp_drv_t* drv;
+        lv_area_t area;
+        lv_color_t* pixels;
+    };
+
+    void* allocateBuffer(uint32_t bytes);
+    void refreshOverlay();
+
+    static void flushCb(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p);
+    static void waitCb(lv_disp_drv_t* drv);
+    static void renderStartCb(lv_disp_drv_t* drv);
+    static void monitorCb(lv_disp_drv_t* drv, uint32_t time_ms, uint32_t px);
+    static bool transferDone(void* user_ctx);
+    static void flushTask(void* arg);
+    static void statsTimer(lv_timer_t* timer);
+
+    ESP_Panel* panel_ = nullptr;
+    lv_disp_draw_buf_t draw_buf_{};
+    lv_disp_drv_t* drv_ = nullptr;
+    bool async_ = false;
+    bool internal_buffers_ = false;
+    uint32_t buffer_lines_ = 0;
+
+    QueueHandle_t requests_ = nullptr;       // Depth 1: LVGL never has two flushes in flight
+    SemaphoreHandle_t flush_done_ = nullptr;  // Given after every lv_disp_flush_ready()
+    TaskHandle_t task_ = nullptr;
+    volatile uint32_t transfer_start_us_ = 0;  // DMA path only
+
+    // LVGL task only
+    uint32_t frame_start_us_ = 0;
+    uint32_t frame_wait_us_ = 0;
+    lv_obj_t* overlay_ = nullptr;
+
+    DisplayStats stats_;
+    std::atomic<bool> overlay_requested_{false};
+};
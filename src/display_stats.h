@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "seqlock.h"
+
+// Display pipeline timing.
+//
+// The LVGL task reports every refresh with frameDone(): how long the
+// refresh took from the start of rendering until LVGL handed off its last
+// area, how much of that it spent waiting for the flush task to free a
+// draw buffer, and how many pixels were invalidated. The flush side
+// reports each copy or DMA transfer with flushDone(), from its own task
+// or ISR. Once per window the LVGL task calls publish(), which folds both
+// into a Window that any task can read without locking.
+class DisplayStats {
+public:
+    struct Window {
+        uint32_t window_ms = 0;       // Length of the window
+        uint32_t frames = 0;          // Refreshes in the window
+        uint32_t render_us_avg = 0;   // Per refresh, excluding waits for a free buffer
+        uint32_t render_us_max = 0;
+        uint32_t wait_us_avg = 0;     // Per refresh, blocked on the flush side (or copying inline)
+        uint32_t flushes = 0;         // Areas handed to the panel
+        uint32_t flush_us_avg = 0;    // Per area, copy or transfer time
+        uint32_t flush_us_max = 0;
+        uint32_t px_avg = 0;          // Invalidated pixels per refresh
+        uint32_t px_max = 0;
+
+        uint32_t fpsTenths() const { return window_ms ? frames * 10000u / window_ms : 0; }
+    };
+
+    // Flush task or ISR
+    void flushDone(uint32_t us) {
+        flushes_.fetch_add(1, std::memory_order_relaxed);
+        flush_us_total_.fetch_add(us, std::memory_order_relaxed);
+        uint32_t seen = flush_us_max_.load(std::memory_order_relaxed);
+        while (us > seen && !flush_us_max_.compare_exchange_weak(seen, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    // LVGL task
+    void frameDone(uint32_t frame_us, uint32_t wait_us, uint32_t px) {
+        const uint32_t render_us = frame_us > wait_us ? frame_us - wait_us : 0;
+        ++frames_;
+        render_us_total_ += render_us;
+        render_us_max_ = std::max(render_us_max_, render_us);
+        wait_us_total_ += wait_us;
+        px_total_ += px;
+        px_max_ = std::max(px_max_, px);
+    }
+
+    // LVGL task: close the window that started at the previous publish()
+    void publish(uint32_t now_ms) {
+        Window window;
+        window.window_ms = now_ms - window_start_ms_;
+        window.frames = frames_;
+        if (frames_ > 0) {
+            window.render_us_avg = static_cast<uint32_t>(render_us_total_ / frames_);
+            window.wait_us_avg = static_cast<uint32_t>(wait_us_total_ / frames_);
+            window.px_avg = static_cast<uint32_t>(px_total_ / frames_);
+        }
+        window.render_us_max = render_us_max_;
+        window.px_max = px_max_;
+
+        window.flushes = flushes_.exchange(0, std::memory_order_relaxed);
+        const uint32_t flush_total = flush_us_total_.exchange(0, std::memory_order_relaxed);
+        window.flush_us_max = flush_us_max_.exchange(0, std::memory_order_relaxed);
+        window.flush_us_avg = window.flushes ? flush_total / window.flushes : 0;
+
+        published_.store(window);
+        window_start_ms_ = now_ms;
+        frames_ = 0;
+        render_us_total_ = wait_us_total_ = px_total_ = 0;
+        render_us_max_ = px_max_ = 0;
+    }
+
+    Window lastWindow() const { return published_.load(); }
+
+private:
+    Seqlock<Window> published_;
+
+    // LVGL task only
+    uint32_t window_start_ms_ = 0;
+    uint32_t frames_ = 0;
+    uint64_t render_us_total_ = 0;
+    uint32_t render_us_max_ = 0;
+    uint64_t wait_us_total_ = 0;
+    uint64_t px_total_ = 0;
+    uint32_t px_max_ = 0;
+
+    // Flush side; a flush that straddles publish() lands in either window
+    std::atomic<uint32_t> flushes_{0};
+    std::atomic<uint32_t> flush_us_total_{0};
+    std::atomic<uint32_t> flush_us_max_{0};
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Single-producer, multi-subscriber broadcast ring.
+//
+// The producer publishes every item exactly once and never waits for readers.
+// Each subscriber owns an independent cursor and drains at its own pace; each
+// item is copied out of its slot and handed to the drain callback only once
+// the copy is known to be intact. A subscriber that falls more than kReadable items behind is
+// fast-forwarded and the skipped items are charged to its own drop counter,
+// so one slow consumer never costs the others a frame.
+//
+// Slots carry a sequence stamp so a reader can tell when the producer has
+// lapped it mid-copy; such an item is counted as dropped, never delivered.
+// kGuard slots of headroom keep that from happening in practice: the
+// producer would have to publish kGuard items during a single drain step.
+template <typename T, std::size_t Capacity, std::size_t MaxSubscribers>
+class FanoutRing {
+    static_assert(Capacity >= 16 && (Capacity & (Capacity - 1)) == 0, "FanoutRing capacity must be a power of two");
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+    static constexpr std::size_t kMaxSubscribers = MaxSubscribers;
+    static constexpr std::uint32_t kGuard = static_cast<std::uint32_t>(Capacity / 8);
+    static constexpr std::uint32_t kReadable = static_cast<std::uint32_t>(Capacity) - kGuard;
+
+    struct Subscriber {
+        const char* name = "";
+        std::atomic<std::uint32_t> cursor{0};     // Advanced only by the subscriber's task
+        std::atomic<std::uint32_t> delivered{0};
+        std::atomic<std::uint32_t> dropped{0};
+    };
+
+    struct SubscriberStats {
+        const char* name = "";
+        std::uint32_t delivered = 0;
+        std::uint32_t dropped = 0;
+        std::uint32_t lag = 0;                    // Items published but not yet drained
+    };
+
+    // Register a subscriber. It sees only items published after this call.
+    // Intended for setup time; returns nullptr when all slots are taken.
+    Subscriber* subscribe(const char* name) {
+        const std::size_t index = sub_count_.load(std::memory_order_relaxed);
+        if (index >= MaxSubscribers) {
+            return nullptr;
+        }
+        Subscriber& sub = subs_[index];
+        sub.name = name;
+        sub.cursor.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+        sub_count_.store(index + 1, std::memory_order_release);
+        return &sub;
+    }
+
+    // Producer side (single task). Never blocks, never fails.
+    void publish(const T& item) {
+        const std::uint32_t head = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[head & kMask];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = item;
+        slot.seq.store(head + 1, std::memory_order_release);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // Subscriber side: invoke fn(const T&) for up to max_items pending items.
+    // fn may return bool: false leaves that item pending and ends the drain
+    // (the consumer has no room for it). Only the task that owns the
+    // subscriber may drain it.
+    template <typename Fn>
+    std::size_t drain(Subscriber* sub, Fn&& fn, std::size_t max_items = static_cast<std::size_t>(-1)) {
+        if (!sub) {
+            return 0;
+        }
+        std::size_t handled = 0;
+        std::uint32_t cursor = sub->cursor.load(std::memory_order_relaxed);
+        while (handled < max_items) {
+            const std::uint32_t head = head_.load(std::memory_order_acquire);
+            if (cursor == head) {
+                break;
+            }
+            if (head - cursor > kReadable) {
+                const std::uint32_t skipped = head - cursor - kReadable;
+                sub->dropped.fetch_add(skipped, std::memory_order_relaxed);
+                cursor += skipped;
+            }
+
+            const Slot& slot = slots_[cursor & kMask];
+            const std::uint32_t expected = cursor + 1;
+            if (slot.seq.load(std::memory_order_acquire) != expected) {
+                sub->dropped.fetch_add(1, std::memory_order_relaxed);
+                ++cursor;
+                continue;
+            }
+
+            // Copy, then check the producer did not rewrite the slot meanwhile
+            const T item = slot.value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != expected) {
+                sub->dropped.fetch_add(1, std::memory_order_relaxed);
+                ++cursor;
+                continue;
+            }
+
+            if constexpr (std::is_same<std::invoke_result_t<Fn&, const T&>, bool>::value) {
+                if (!fn(item)) {
+                    break;
+                }
+            } else {
+                fn(item);
+            }
+            sub->delivered.fetch_add(1, std::memory_order_relaxed);
+            ++cursor;
+            ++handled;
+        }
+        sub->cursor.store(cursor, std::memory_order_relaxed);
+        return handled;
+    }
+
+    std::uint32_t published() const { return head_.load(std::memory_order_acquire); }
+    std::size_t subscriberCount() const { return sub_count_.load(std::memory_order_acquire); }
+
+    SubscriberStats subscriberStats(std::size_t index) const {
+        SubscriberStats stats;
+        if (index >= subscriberCount()) {
+            return stats;
+        }
+        const Subscriber& sub = subs_[index];
+        stats.name = sub.name;
+        stats.delivered = sub.delivered.load(std::memory_order_relaxed);
+        stats.dropped = sub.dropped.load(std::memory_order_relaxed);
+        const std::uint32_t lag = published() - sub.cursor.load(std::memory_order_relaxed);
+        stats.lag = lag > kReadable ? kReadable : lag;
+        return stats;
+    }
+
+private:
+    static constexpr std::uint32_t kMask = static_cast<std::uint32_t>(Capacity - 1);
+
+    struct Slot {
+        std::atomic<std::uint32_t> seq{0};
+        T value{};
+    };
+
+    std::array<Slot, Capacity> slots_{};
+    std::array<Subscriber, MaxSubscribers> subs_{};
+    std::atomic<std::uint32_t> head_{0};
+    std::atomic<std::size_t> sub_count_{0};
+};
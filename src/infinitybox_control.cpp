@@ -174,6 +174,7 @@ bool InfinityboxController::begin(Ipm1CanSystem* can_system, BehavioralOutput::B
                 }
 
                 applyBehaviorBindings(f);
+                f.can_circuit = m_can_system->resolveCircuit(f.name);
 
                 if (!f.name.empty()) {
                     addFunction(f);
@@ -522,40 +523,24 @@ void InfinityboxController::updateFunctionFeedback(const std::string& name, floa
 
 bool InfinityboxController::sendCanCommand(const Function& func, bool state) {
     if (!m_can_system) return false;
-    
-    // Send to all outputs for this function
-    for (const auto& output : func.outputs) {
-        const Device* device = getDevice(output.device_id);
-        if (!device) {
-            Serial.printf("[IBOX] Device %s not found\n", output.device_id.c_str());
-            continue;
-        }
-        
-        // Prepare JSON action for IPM1 system
-        StaticJsonDocument<256> doc;
-        JsonObject action = doc.to<JsonObject>();
-        
-        action["circuit"] = func.name;
-        action["action"] = "toggle";
-        
-        JsonObject params = action.createNestedObject("params");
-        params["state"] = state ? "on" : "off";
-        
-        String error;
-        StaticJsonDocument<128> responseDoc;
-        JsonObject response = responseDoc.to<JsonObject>();
-        
-        // Pass action as JsonVariantConst
-        if (!m_can_system->handleAction(action, error, response)) {
-            Serial.printf("[IBOX] CAN send failed: %s\n", error.c_str());
-            continue;
-        }
-        
-        Serial.printf("[IBOX] CAN: %s (dev=%s addr=%d out=%d) -> %s\n",
-                      func.name.c_str(), device->id.c_str(), device->address,
-                      output.output_num, state ? "ON" : "OFF");
+    if (!func.can_circuit.valid()) {
+        Serial.printf("[IBOX] No IPM1 circuit for %s\n", func.name.c_str());
+        return false;
     }
-    
+
+    // Handle resolved at begin(): one typed call covers every output of the function
+    Ipm1CanSystem::OpParams params;
+    params.has_state = true;
+    params.state = state;
+    String error;
+    if (!m_can_system->apply(func.can_circuit, Ipm1CanSystem::Op::Set, params, error)) {
+        Serial.printf("[IBOX] CAN send failed: %s\n", error.c_str());
+        return false;
+    }
+
+    Serial.printf("[IBOX] CAN: %s (addr=%d mask=0x%03X) -> %s\n",
+                  func.name.c_str(), func.can_circuit.cell, func.can_circuit.output_mask,
+                  state ? "ON" : "OFF");
     return true;
 }
 
@@ -675,10 +660,13 @@ bool InfinityboxController::applyBehaviorOutputs(Function& func, BehaviorType be
 
     // Scene binding takes priority
     if (!func.behavior_scene_id.empty()) {
-        if (state) {
-            m_behavior_engine->activateScene(func.behavior_scene_id.c_str());
-        } else {
+        // Handled by the engine either way (false here means "not bound");
+        // a refused turn-on is only logged
+        if (!state) {
             m_behavior_engine->deactivateScene(func.behavior_scene_id.c_str());
+        } else if (!m_behavior_engine->activateScene(func.behavior_scene_id.c_str())) {
+            Serial.printf("[IBOX] Scene %s not activated for %s (unknown or engine busy)\n",
+                          func.behavior_scene_id.c_str(), func.name.c_str());
         }
         return true;
     }
@@ -743,7 +731,10 @@ bool InfinityboxController::applyFlashBehavior(Function& func, uint16_t on_ms, u
         if (duration_ms > 0) {
             Serial.println("[IBOX] Scene-based flash durations are fixed; ignoring custom duration");
         }
-        m_behavior_engine->activateScene(func.behavior_scene_id.c_str());
+        if (!m_behavior_engine->activateScene(func.behavior_scene_id.c_str())) {
+            Serial.printf("[IBOX] Scene %s not activated for %s (unknown or engine busy)\n",
+                          func.behavior_scene_id.c_str(), func.name.c_str());
+        }
         return true;
     }
 
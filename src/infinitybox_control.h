@@ -24,11 +24,9 @@
 #include <map>
 #include <functional>
 
+#include "ipm1_can_system.h"
 #include "output_behavior_engine.h"
 
-// Forward declaration
-class Ipm1CanSystem;
-
 namespace InfinityboxControl {
 
 // ===== ENUMS =====
@@ -91,6 +89,7 @@ struct Function {
     bool renameable;
     std::vector<std::string> behavior_output_ids; // BehavioralOutput bindings
     std::string behavior_scene_id;                 // Optional scene binding
+    Ipm1CanSystem::CircuitHandle can_circuit;      // IPM1 circuit, resolved at begin()
     
     // Runtime state
     BehaviorType active_behavior;
@@ -217,7 +216,6 @@ private:
     // Internal helpers
     bool isBlocked(const Function& func) const;
     bool sendCanCommand(const Function& func, bool state);
-    bool sendCanCommandMultiOutput(const Function& func, bool state);
     bool usesBehaviorEngine(const Function& func) const;
     bool applyBehaviorOutputs(Function& func, BehaviorType behavior, bool state);
     bool applyFlashBehavior(Function& func, uint16_t on_ms, uint16_t off_ms, uint32_t duration_ms);
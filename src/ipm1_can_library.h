@@ -24,7 +24,12 @@ inline CanFrameConfig powercellConfig(std::uint8_t cell_address, std::uint8_t co
     return frame;
 }
 
-inline CanFrameConfig powercellOutput(std::uint8_t cell_address, std::uint8_t output, std::uint8_t value) {
+// Track personality control frame carrying the complete state of outputs
+// 1-10 (bit n-1 of `outputs` = OUTn): OUT1..OUT8 = byte 0 bit 7..0,
+// OUT9/OUT10 = byte 1 bit 7/6, bytes 2-7 zero.
+constexpr std::uint16_t kPowercellOutputMask = 0x03FF;
+
+inline CanFrameConfig powercellTrack(std::uint8_t cell_address, std::uint16_t outputs) {
     CanFrameConfig frame;
     frame.enabled = true;
     frame.pgn = NormalizePowercellPgn(cell_address, 0xFF00);
@@ -34,20 +39,44 @@ inline CanFrameConfig powercellOutput(std::uint8_t cell_address, std::uint8_t ou
     frame.data = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
     frame.length = 8;
 
-    const bool on = (value > 0);
-    if (on) {
-        if (output >= 1 && output <= 8) {
-            frame.data[0] |= static_cast<std::uint8_t>(1u << (8 - output));
-        } else if (output == 9) {
-            frame.data[1] |= 0x80;
-        } else if (output == 10) {
-            frame.data[1] |= 0x40;
+    for (std::uint8_t out = 1; out <= 8; ++out) {
+        if (outputs & (1u << (out - 1))) {
+            frame.data[0] |= static_cast<std::uint8_t>(1u << (8 - out));
         }
     }
-
+    if (outputs & (1u << 8)) {
+        frame.data[1] |= 0x80;
+    }
+    if (outputs & (1u << 9)) {
+        frame.data[1] |= 0x40;
+    }
     return frame;
 }
 
+// Inverse of powercellTrack: output bitmap from the first two data bytes
+inline std::uint16_t powercellTrackOutputs(const std::uint8_t* data) {
+    std::uint16_t outputs = 0;
+    for (std::uint8_t out = 1; out <= 8; ++out) {
+        if (data[0] & (1u << (8 - out))) {
+            outputs |= static_cast<std::uint16_t>(1u << (out - 1));
+        }
+    }
+    if (data[1] & 0x80) {
+        outputs |= 1u << 8;
+    }
+    if (data[1] & 0x40) {
+        outputs |= 1u << 9;
+    }
+    return outputs;
+}
+
+// Frame with only `output` set; every other output on the cell goes OFF.
+// Producers sharing a cell should write CanManager's output shadow instead.
+inline CanFrameConfig powercellOutput(std::uint8_t cell_address, std::uint8_t output, std::uint8_t value) {
+    const bool on = value > 0 && output >= 1 && output <= 10;
+    return powercellTrack(cell_address, on ? static_cast<std::uint16_t>(1u << (output - 1)) : 0);
+}
+
 inline CanFrameConfig powercellPoll(std::uint8_t cell_address) {
     CanFrameConfig frame;
     frame.enabled = true;
@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include <LittleFS.h>
+#include <cstring>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
@@ -92,6 +93,9 @@ Ipm1CanSystem& Ipm1CanSystem::instance() {
 
 bool Ipm1CanSystem::begin() {
     String error;
+    if (!effect_mutex_) {
+        effect_mutex_ = xSemaphoreCreateMutex();
+    }
     // Try to load persisted system JSON from LittleFS first
     if (LittleFS.exists(kSystemPath)) {
         File file = LittleFS.open(kSystemPath, "r");
@@ -122,6 +126,10 @@ bool Ipm1CanSystem::begin() {
         return false;
     }
 
+    if (!effect_task_) {
+        // Runs every timed/flash/fade effect; replaces a task per action
+        xTaskCreatePinnedToCore(effectTask, "ipm1_fx", 3072, this, 1, &effect_task_, 1);
+    }
     return true;
 }
 
@@ -133,6 +141,11 @@ String Ipm1CanSystem::getSystemJson() const {
 }
 
 bool Ipm1CanSystem::loadFromJson(const String& json, String& error) {
+    // Effect slots are indexed by circuit; drop them before the tables change
+    lockEffects();
+    effects_.clear();
+    unlockEffects();
+
     devices_.clear();
     circuits_.clear();
     states_.clear();
@@ -150,11 +163,22 @@ bool Ipm1CanSystem::loadFromJson(const String& json, String& error) {
         device.id = dev["id"] | "";
         device.type = dev["type"] | "";
         device.address = dev["address"] | 0;
+        if (device.type == "powercell") {
+            device.kind = DeviceKind::Powercell;
+        } else if (device.type == "inmotion") {
+            device.kind = DeviceKind::InMotion;
+        } else if (device.type == "mastercell") {
+            device.kind = DeviceKind::Mastercell;
+        }
         if (!device.id.empty()) {
             devices_.push_back(device);
         }
     }
 
+    auto outputBit = [](int output) -> std::uint16_t {
+        return (output >= 1 && output <= 10) ? static_cast<std::uint16_t>(1u << (output - 1)) : 0;
+    };
+
     JsonArray functions = doc["functions"].as<JsonArray>();
     for (JsonObject f : functions) {
         Circuit circuit;
@@ -167,18 +191,40 @@ bool Ipm1CanSystem::loadFromJson(const String& json, String& error) {
         if (output.is<int>()) {
             circuit.output_is_numeric = true;
             circuit.output_number = output.as<int>();
+            circuit.output_mask = outputBit(circuit.output_number);
         } else if (output.is<const char*>()) {
             circuit.output_is_numeric = false;
             circuit.output_name = output.as<const char*>();
         }
 
+        // Multi-output circuits (4-Ways) drive every listed output together
+        JsonArray outputs = f["outputs"].as<JsonArray>();
+        for (JsonVariant out : outputs) {
+            if (!out.is<int>()) {
+                continue;
+            }
+            if (!circuit.output_is_numeric) {
+                circuit.output_is_numeric = true;
+                circuit.output_number = out.as<int>();
+            }
+            circuit.output_mask |= outputBit(out.as<int>());
+        }
+
         JsonArray behaviors = f["behaviors"].as<JsonArray>();
         for (JsonVariant behavior : behaviors) {
             if (behavior.is<const char*>()) {
                 circuit.capabilities.emplace_back(behavior.as<const char*>());
+                Op op;
+                if (parseOp(behavior.as<const char*>(), op)) {
+                    circuit.ops |= static_cast<std::uint16_t>(1u << static_cast<unsigned>(op));
+                }
             }
         }
 
+        if (const Device* device = findDevice(circuit.device_id)) {
+            circuit.device_index = static_cast<std::int16_t>(deviceIndex(*device));
+        }
+
         if (!circuit.name.empty()) {
             circuits_.push_back(circuit);
             CircuitState state;
@@ -208,22 +254,38 @@ const Ipm1CanSystem::Device* Ipm1CanSystem::findDevice(const std::string& id) co
     return nullptr;
 }
 
-Ipm1CanSystem::CircuitState* Ipm1CanSystem::findState(const std::string& name) {
-    for (auto& state : states_) {
-        if (state.name == name) {
-            return &state;
+bool Ipm1CanSystem::parseOp(const char* name, Op& op) {
+    static constexpr struct {
+        const char* name;
+        Op op;
+    } kOps[] = {
+        {"toggle", Op::Toggle},        {"momentary", Op::Momentary},   {"timed", Op::Timed},
+        {"flash", Op::Flash},          {"flash_timed", Op::FlashTimed}, {"flash_stop", Op::FlashStop},
+        {"fade", Op::Fade},
+    };
+    for (const auto& entry : kOps) {
+        if (strcmp(name, entry.name) == 0) {
+            op = entry.op;
+            return true;
         }
     }
-    return nullptr;
+    return false;
 }
 
-bool Ipm1CanSystem::circuitSupports(const Circuit& circuit, const std::string& action) const {
-    for (const auto& cap : circuit.capabilities) {
-        if (cap == action) {
-            return true;
-        }
+Ipm1CanSystem::CircuitHandle Ipm1CanSystem::resolveCircuit(const std::string& name) const {
+    CircuitHandle handle;
+    const Circuit* circuit = findCircuit(name);
+    if (!circuit) {
+        return handle;
     }
-    return false;
+    handle.index = static_cast<std::uint16_t>(circuitIndex(*circuit));
+    handle.output_mask = circuit->output_mask;
+    if (circuit->device_index >= 0) {
+        const Device& device = devices_[circuit->device_index];
+        handle.device = device.kind;
+        handle.cell = device.address;
+    }
+    return handle;
 }
 
 bool Ipm1CanSystem::handleAction(JsonVariantConst action_json, String& error, JsonObject response) {
@@ -233,167 +295,161 @@ bool Ipm1CanSystem::handleAction(JsonVariantConst action_json, String& error, Js
     }
 
     JsonObjectConst obj = action_json.as<JsonObjectConst>();
-    String action = obj["action"] | "";
-    String target = obj["target"] | "";
+    const char* action = obj["action"] | "";
+    const char* target = obj["target"] | "";
 
-    if (action.isEmpty() || target.isEmpty()) {
+    if (action[0] == '\0' || target[0] == '\0') {
         error = "Action requires 'action' and 'target' fields";
         return false;
     }
 
-    const Circuit* circuit = findCircuit(target.c_str());
-    if (!circuit) {
-        error = "Unknown circuit: " + target;
+    const CircuitHandle circuit = resolveCircuit(target);
+    if (!circuit.valid()) {
+        error = String("Unknown circuit: ") + target;
         return false;
     }
 
-    const Device* device = findDevice(circuit->device_id);
-    if (!device) {
-        error = "Unknown device for circuit: " + target;
+    Op op;
+    if (!parseOp(action, op)) {
+        error = "Unsupported action";
         return false;
     }
 
-    const std::string action_name = action.c_str();
-    if (action_name != "flash_stop" && !circuitSupports(*circuit, action_name)) {
-        error = "Action not supported by circuit";
-        return false;
+    OpParams params;
+    if (op == Op::Momentary && obj.containsKey("pressed")) {
+        params.has_state = parseBool(obj["pressed"], params.state);
+    } else if (!obj["state"].isNull()) {
+        params.has_state = parseBool(obj["state"], params.state);
     }
+    params.duration_ms = obj["duration_ms"] | 0;
+    params.period_ms = obj["period_ms"] | 0;
+    params.target_pwm = obj["target_pwm"] | 0;
 
-    if (action == "toggle") {
-        return applyToggle(*circuit, *device, obj, error, response);
-    }
-    if (action == "momentary") {
-        return applyMomentary(*circuit, *device, obj, error, response);
-    }
-    if (action == "timed") {
-        return applyTimed(*circuit, *device, obj, error, response);
-    }
-    if (action == "flash") {
-        return applyFlash(*circuit, *device, obj, false, error, response);
-    }
-    if (action == "flash_timed") {
-        return applyFlash(*circuit, *device, obj, true, error, response);
+    return apply(circuit, op, params, error, response);
+}
+
+bool Ipm1CanSystem::apply(const CircuitHandle& handle, Op op, const OpParams& params, String& error,
+                          JsonObject response) {
+    if (!handle.valid() || handle.index >= circuits_.size()) {
+        error = "Invalid circuit handle";
+        return false;
     }
-    if (action == "flash_stop") {
-        return applyFlashStop(*circuit, *device, error, response);
+    const Circuit& circuit = circuits_[handle.index];
+    if (circuit.device_index < 0) {
+        error = String("Unknown device for circuit: ") + circuit.name.c_str();
+        return false;
     }
-    if (action == "fade") {
-        return applyFade(*circuit, *device, obj, error, response);
+    const Device& device = devices_[circuit.device_index];
+
+    if (op != Op::FlashStop && op != Op::Set && !(circuit.ops & (1u << static_cast<unsigned>(op)))) {
+        error = "Action not supported by circuit";
+        return false;
     }
 
-    error = "Unsupported action";
-    return false;
+    lockEffects();
+    bool ok = false;
+    switch (op) {
+        case Op::Toggle: ok = applyToggle(circuit, device, params, error, response); break;
+        case Op::Momentary: ok = applyMomentary(circuit, device, params, error, response); break;
+        case Op::Timed: ok = applyTimed(circuit, device, params, error, response); break;
+        case Op::Flash: ok = applyFlash(circuit, params, false, error, response); break;
+        case Op::FlashTimed: ok = applyFlash(circuit, params, true, error, response); break;
+        case Op::FlashStop: ok = applyFlashStop(circuit, device, error, response); break;
+        case Op::Fade: ok = applyFade(circuit, params, error, response); break;
+        case Op::Set:
+            if (params.has_state) {
+                ok = applyToggle(circuit, device, params, error, response);
+            } else {
+                error = "Set requires a state";
+            }
+            break;
+    }
+    unlockEffects();
+    return ok;
 }
 
-bool Ipm1CanSystem::applyToggle(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response) {
+bool Ipm1CanSystem::applyToggle(const Circuit& circuit, const Device& device, const OpParams& params, String& error, JsonObject response) {
     if (!circuit.output_is_numeric) {
         error = "Toggle requires a numeric output";
         return false;
     }
-    bool desired_on = false;
-    bool has_state = false;
-    JsonVariantConst state_value = action_json["state"];
-    if (!state_value.isNull()) {
-        has_state = parseBool(state_value, desired_on);
-    }
 
-    CircuitState* state = findState(circuit.name);
-    if (!has_state) {
-        bool current = state ? state->is_on : false;
-        desired_on = !current;
-    }
+    CircuitState& state = states_[circuitIndex(circuit)];
+    const bool desired_on = params.has_state ? params.state : !state.is_on;
 
-    if (!sendPowercellValue(device, circuit.output_number, desired_on ? 0xFF : 0x00, error)) {
+    if (!sendPowercellValue(device, circuit.output_mask, desired_on ? 0xFF : 0x00, error)) {
         return false;
     }
 
-    if (state) {
-        state->is_on = desired_on;
-        state->pwm = desired_on ? 0xFF : 0x00;
-    }
+    state.is_on = desired_on;
+    state.pwm = desired_on ? 0xFF : 0x00;
 
-    cancelActiveAction(circuit.name);
+    cancelEffect(circuitIndex(circuit));
     response["circuit"] = circuit.name.c_str();
     response["state"] = desired_on ? "on" : "off";
     response["owner"] = "toggle";
     return true;
 }
 
-bool Ipm1CanSystem::applyMomentary(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response) {
+bool Ipm1CanSystem::applyMomentary(const Circuit& circuit, const Device& device, const OpParams& params, String& error, JsonObject response) {
     if (!circuit.output_is_numeric) {
         error = "Momentary requires a numeric output";
         return false;
     }
 
-    bool pressed = false;
-    bool has_value = false;
-    if (action_json.containsKey("pressed")) {
-        has_value = parseBool(action_json["pressed"], pressed);
-    } else if (action_json.containsKey("state")) {
-        has_value = parseBool(action_json["state"], pressed);
-    }
-
-    if (!has_value) {
+    if (!params.has_state) {
         error = "Momentary requires 'pressed' or 'state'";
         return false;
     }
+    const bool pressed = params.state;
 
-    if (!sendPowercellValue(device, circuit.output_number, pressed ? 0xFF : 0x00, error)) {
+    if (!sendPowercellValue(device, circuit.output_mask, pressed ? 0xFF : 0x00, error)) {
         return false;
     }
 
-    CircuitState* state = findState(circuit.name);
-    if (state) {
-        state->is_on = pressed;
-        state->pwm = pressed ? 0xFF : 0x00;
-    }
+    setState(circuitIndex(circuit), pressed ? 0xFF : 0x00);
 
-    cancelActiveAction(circuit.name);
+    cancelEffect(circuitIndex(circuit));
     response["circuit"] = circuit.name.c_str();
     response["state"] = pressed ? "on" : "off";
     response["owner"] = "momentary";
     return true;
 }
 
-bool Ipm1CanSystem::applyTimed(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response) {
+bool Ipm1CanSystem::applyTimed(const Circuit& circuit, const Device& device, const OpParams& params, String& error, JsonObject response) {
     if (!circuit.output_is_numeric) {
         error = "Timed action requires a numeric output";
         return false;
     }
 
-    std::uint32_t duration_ms = action_json["duration_ms"] | 0;
+    const std::uint32_t duration_ms = params.duration_ms;
     if (duration_ms == 0) {
         error = "Timed action requires duration_ms";
         return false;
     }
 
-    cancelActiveAction(circuit.name);
-
-    if (!sendPowercellValue(device, circuit.output_number, 0xFF, error)) {
+    // The timer that turns the output off again needs a slot; check before ON goes out
+    if (!checkEffectSlot(circuitIndex(circuit), error)) {
         return false;
     }
 
-    CircuitState* state = findState(circuit.name);
-    if (state) {
-        state->is_on = true;
-        state->pwm = 0xFF;
+    cancelEffect(circuitIndex(circuit));
+
+    if (!sendPowercellValue(device, circuit.output_mask, 0xFF, error)) {
+        return false;
     }
 
-    auto* ctx = new ActionTaskContext{};
-    ctx->system = this;
-    ctx->circuit = circuit.name;
-    ctx->address = device.address;
-    ctx->output = circuit.output_number;
-    ctx->duration_ms = duration_ms;
+    setState(circuitIndex(circuit), 0xFF);
 
-    TaskHandle_t task = nullptr;
-    if (xTaskCreate(timedTask, "ipm1_timed", 4096, ctx, 1, &task) != pdTRUE) {
-        delete ctx;
-        error = "Failed to start timed task";
+    Effect effect;
+    effect.kind = EffectKind::Timed;
+    effect.device = static_cast<std::uint16_t>(circuit.device_index);
+    effect.mask = circuit.output_mask;
+    effect.duration_ms = duration_ms;
+    if (!startEffect(circuitIndex(circuit), effect, error)) {
         return false;
     }
 
-    setActiveAction(circuit.name, "timed", task);
     response["circuit"] = circuit.name.c_str();
     response["state"] = "on";
     response["owner"] = "timed";
@@ -401,13 +457,13 @@ bool Ipm1CanSystem::applyTimed(const Circuit& circuit, const Device& device, Jso
     return true;
 }
 
-bool Ipm1CanSystem::applyFlash(const Circuit& circuit, const Device& device, JsonVariantConst action_json, bool timed, String& error, JsonObject response) {
+bool Ipm1CanSystem::applyFlash(const Circuit& circuit, const OpParams& params, bool timed, String& error, JsonObject response) {
     if (!circuit.output_is_numeric) {
         error = "Flash action requires a numeric output";
         return false;
     }
 
-    std::uint32_t period_ms = action_json["period_ms"] | 0;
+    const std::uint32_t period_ms = params.period_ms;
     if (period_ms == 0) {
         error = "Flash action requires period_ms";
         return false;
@@ -415,31 +471,25 @@ bool Ipm1CanSystem::applyFlash(const Circuit& circuit, const Device& device, Jso
 
     std::uint32_t duration_ms = 0;
     if (timed) {
-        duration_ms = action_json["duration_ms"] | 0;
+        duration_ms = params.duration_ms;
         if (duration_ms == 0) {
             error = "Flash timed requires duration_ms";
             return false;
         }
     }
 
-    cancelActiveAction(circuit.name);
-
-    auto* ctx = new ActionTaskContext{};
-    ctx->system = this;
-    ctx->circuit = circuit.name;
-    ctx->address = device.address;
-    ctx->output = circuit.output_number;
-    ctx->period_ms = period_ms;
-    ctx->duration_ms = duration_ms;
+    cancelEffect(circuitIndex(circuit));
 
-    TaskHandle_t task = nullptr;
-    if (xTaskCreate(flashTask, "ipm1_flash", 4096, ctx, 1, &task) != pdTRUE) {
-        delete ctx;
-        error = "Failed to start flash task";
+    Effect effect;
+    effect.kind = EffectKind::Flash;
+    effect.device = static_cast<std::uint16_t>(circuit.device_index);
+    effect.mask = circuit.output_mask;
+    effect.period_ms = period_ms;
+    effect.duration_ms = duration_ms;
+    if (!startEffect(circuitIndex(circuit), effect, error)) {
         return false;
     }
 
-    setActiveAction(circuit.name, timed ? "flash_timed" : "flash", task);
     response["circuit"] = circuit.name.c_str();
     response["owner"] = timed ? "flash_timed" : "flash";
     response["period_ms"] = period_ms;
@@ -455,16 +505,12 @@ bool Ipm1CanSystem::applyFlashStop(const Circuit& circuit, const Device& device,
         return false;
     }
 
-    cancelActiveAction(circuit.name);
-    if (!sendPowercellValue(device, circuit.output_number, 0x00, error)) {
+    cancelEffect(circuitIndex(circuit));
+    if (!sendPowercellValue(device, circuit.output_mask, 0x00, error)) {
         return false;
     }
 
-    CircuitState* state = findState(circuit.name);
-    if (state) {
-        state->is_on = false;
-        state->pwm = 0;
-    }
+    setState(circuitIndex(circuit), 0x00);
 
     response["circuit"] = circuit.name.c_str();
     response["state"] = "off";
@@ -472,41 +518,34 @@ bool Ipm1CanSystem::applyFlashStop(const Circuit& circuit, const Device& device,
     return true;
 }
 
-bool Ipm1CanSystem::applyFade(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response) {
+bool Ipm1CanSystem::applyFade(const Circuit& circuit, const OpParams& params, String& error, JsonObject response) {
     if (!circuit.output_is_numeric) {
         error = "Fade action requires a numeric output";
         return false;
     }
 
-    std::uint32_t duration_ms = action_json["duration_ms"] | 0;
-    std::uint8_t target_pwm = action_json["target_pwm"] | 0;
+    const std::uint32_t duration_ms = params.duration_ms;
+    const std::uint8_t target_pwm = params.target_pwm;
     if (duration_ms == 0) {
         error = "Fade action requires duration_ms";
         return false;
     }
 
-    CircuitState* state = findState(circuit.name);
-    std::uint8_t start_pwm = state ? state->pwm : 0;
+    const std::uint8_t start_pwm = states_[circuitIndex(circuit)].pwm;
 
-    cancelActiveAction(circuit.name);
+    cancelEffect(circuitIndex(circuit));
 
-    auto* ctx = new ActionTaskContext{};
-    ctx->system = this;
-    ctx->circuit = circuit.name;
-    ctx->address = device.address;
-    ctx->output = circuit.output_number;
-    ctx->start_pwm = start_pwm;
-    ctx->target_pwm = target_pwm;
-    ctx->fade_ms = duration_ms;
-
-    TaskHandle_t task = nullptr;
-    if (xTaskCreate(fadeTask, "ipm1_fade", 4096, ctx, 1, &task) != pdTRUE) {
-        delete ctx;
-        error = "Failed to start fade task";
+    Effect effect;
+    effect.kind = EffectKind::Fade;
+    effect.device = static_cast<std::uint16_t>(circuit.device_index);
+    effect.mask = circuit.output_mask;
+    effect.period_ms = duration_ms / kFadeSteps;
+    effect.start_pwm = start_pwm;
+    effect.target_pwm = target_pwm;
+    if (!startEffect(circuitIndex(circuit), effect, error)) {
         return false;
     }
 
-    setActiveAction(circuit.name, "fade", task);
     response["circuit"] = circuit.name.c_str();
     response["owner"] = "fade";
     response["target_pwm"] = target_pwm;
@@ -514,145 +553,102 @@ bool Ipm1CanSystem::applyFade(const Circuit& circuit, const Device& device, Json
     return true;
 }
 
-bool Ipm1CanSystem::sendPowercellValue(const Device& device, std::int32_t output, std::uint8_t value, String& error) {
-    if (device.type != "powercell") {
+bool Ipm1CanSystem::sendPowercellValue(const Device& device, std::uint16_t mask, std::uint8_t value, String& error) {
+    if (device.kind != DeviceKind::Powercell) {
         error = "Device type not supported for output control";
         return false;
     }
 
-    if (output < 1 || output > 8) {
-        error = "Powercell output out of range (1-8)";
+    if (mask == 0) {
+        error = "Powercell output out of range (1-10)";
         return false;
     }
 
-    CanFrameConfig frame = Ipm1Can::powercellOutput(device.address, static_cast<std::uint8_t>(output), value);
-    return CanManager::instance().sendFrame(frame);
+    // Merged into the cell's shadow so the other outputs keep their state
+    return CanManager::instance().setPowercellOutputs(device.address, mask, value > 0 ? mask : 0);
 }
 
-void Ipm1CanSystem::cancelActiveAction(const std::string& circuit) {
-    for (auto it = active_actions_.begin(); it != active_actions_.end(); ++it) {
-        if (it->circuit == circuit) {
-            if (it->task) {
-                vTaskDelete(it->task);
-            }
-            active_actions_.erase(it);
-            break;
-        }
+void Ipm1CanSystem::lockEffects() const {
+    if (effect_mutex_) {
+        xSemaphoreTake(effect_mutex_, portMAX_DELAY);
     }
 }
 
-void Ipm1CanSystem::setActiveAction(const std::string& circuit, const std::string& action, TaskHandle_t task) {
-    ActiveAction active;
-    active.circuit = circuit;
-    active.action = action;
-    active.task = task;
-    active_actions_.push_back(active);
-}
-
-void Ipm1CanSystem::clearActiveAction(const std::string& circuit) {
-    for (auto it = active_actions_.begin(); it != active_actions_.end(); ++it) {
-        if (it->circuit == circuit) {
-            active_actions_.erase(it);
-            break;
-        }
+void Ipm1CanSystem::unlockEffects() const {
+    if (effect_mutex_) {
+        xSemaphoreGive(effect_mutex_);
     }
 }
 
-void Ipm1CanSystem::timedTask(void* pv) {
-    auto* ctx = static_cast<ActionTaskContext*>(pv);
-    if (!ctx || !ctx->system) {
-        vTaskDelete(nullptr);
-        return;
-    }
-
-    vTaskDelay(pdMS_TO_TICKS(ctx->duration_ms));
-
-    String error;
-    Ipm1CanSystem::Device device;
-    device.type = "powercell";
-    device.address = ctx->address;
-    ctx->system->sendPowercellValue(device, ctx->output, ctx->off_value, error);
-
-    if (auto* state = ctx->system->findState(ctx->circuit)) {
-        state->is_on = false;
-        state->pwm = 0;
+void Ipm1CanSystem::setState(std::size_t circuit, std::uint8_t value) {
+    if (circuit < states_.size()) {
+        states_[circuit].is_on = value > 0;
+        states_[circuit].pwm = value;
     }
+}
 
-    ctx->system->clearActiveAction(ctx->circuit);
-    delete ctx;
-    vTaskDelete(nullptr);
+// Caller holds the effect lock
+void Ipm1CanSystem::cancelEffect(std::size_t circuit) {
+    effects_.cancel(circuit);
 }
 
-void Ipm1CanSystem::flashTask(void* pv) {
-    auto* ctx = static_cast<ActionTaskContext*>(pv);
-    if (!ctx || !ctx->system || ctx->period_ms == 0) {
-        vTaskDelete(nullptr);
-        return;
+// Circuits past the first kMaxEffects have no effect slot
+bool Ipm1CanSystem::checkEffectSlot(std::size_t circuit, String& error) const {
+    if (circuit < kMaxEffects) {
+        return true;
     }
+    error = String("Circuit has no effect slot (max ") + static_cast<unsigned>(kMaxEffects) + ")";
+    return false;
+}
 
-    const std::uint32_t start_ms = millis();
-    bool on = false;
-    while (true) {
-        if (ctx->duration_ms > 0 && (millis() - start_ms) >= ctx->duration_ms) {
-            break;
-        }
-
-        on = !on;
-        String error;
-        Ipm1CanSystem::Device device;
-        device.type = "powercell";
-        device.address = ctx->address;
-        ctx->system->sendPowercellValue(device, ctx->output, on ? ctx->on_value : ctx->off_value, error);
-
-        if (auto* state = ctx->system->findState(ctx->circuit)) {
-            state->is_on = on;
-            state->pwm = on ? ctx->on_value : ctx->off_value;
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(ctx->period_ms));
+// Caller holds the effect lock. Overwrites whatever the circuit was running.
+bool Ipm1CanSystem::startEffect(std::size_t circuit, const Effect& effect, String& error) {
+    if (!checkEffectSlot(circuit, error)) {
+        return false;
     }
-
-    String error;
-    Ipm1CanSystem::Device device;
-    device.type = "powercell";
-    device.address = ctx->address;
-    ctx->system->sendPowercellValue(device, ctx->output, ctx->off_value, error);
-
-    if (auto* state = ctx->system->findState(ctx->circuit)) {
-        state->is_on = false;
-        state->pwm = 0;
+    auto output = [this](std::size_t c, std::uint16_t device, std::uint16_t mask, std::uint8_t value) {
+        effectOutput(c, device, mask, value);
+    };
+    const bool was_idle = effects_.empty();
+    effects_.start(circuit, effect, millis(), output);  // Fails only for a slot out of range
+    if (was_idle && !effects_.empty() && effect_task_) {
+        xTaskNotifyGive(effect_task_);
     }
-
-    ctx->system->clearActiveAction(ctx->circuit);
-    delete ctx;
-    vTaskDelete(nullptr);
+    return true;
 }
 
-void Ipm1CanSystem::fadeTask(void* pv) {
-    auto* ctx = static_cast<ActionTaskContext*>(pv);
-    if (!ctx || !ctx->system || ctx->fade_ms == 0) {
-        vTaskDelete(nullptr);
+// Caller holds the effect lock
+void Ipm1CanSystem::effectOutput(std::size_t circuit, std::uint16_t device, std::uint16_t mask, std::uint8_t value) {
+    if (device >= devices_.size()) {
         return;
     }
+    String error;
+    sendPowercellValue(devices_[device], mask, value, error);
+    setState(circuit, value);
+}
 
-    const int steps = 20;
-    const std::uint32_t step_delay = ctx->fade_ms / steps;
-    for (int i = 1; i <= steps; ++i) {
-        float t = static_cast<float>(i) / static_cast<float>(steps);
-        std::uint8_t value = static_cast<std::uint8_t>(ctx->start_pwm + (ctx->target_pwm - ctx->start_pwm) * t);
-        String error;
-        Ipm1CanSystem::Device device;
-        device.type = "powercell";
-        device.address = ctx->address;
-        ctx->system->sendPowercellValue(device, ctx->output, value, error);
-        if (auto* state = ctx->system->findState(ctx->circuit)) {
-            state->is_on = value > 0;
-            state->pwm = value;
+// Single task for all effects: ticks the wheel every kEffectTickMs while any
+// effect is pending and blocks on a notification otherwise.
+void Ipm1CanSystem::effectTask(void* pv) {
+    auto* self = static_cast<Ipm1CanSystem*>(pv);
+    auto output = [self](std::size_t circuit, std::uint16_t device, std::uint16_t mask, std::uint8_t value) {
+        self->effectOutput(circuit, device, mask, value);
+    };
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        self->lockEffects();
+        const bool idle = self->effects_.empty();
+        self->unlockEffects();
+
+        if (idle) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+            continue;
         }
-        vTaskDelay(pdMS_TO_TICKS(step_delay > 0 ? step_delay : 1));
-    }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(kEffectTickMs));
 
-    ctx->system->clearActiveAction(ctx->circuit);
-    delete ctx;
-    vTaskDelete(nullptr);
+        self->lockEffects();
+        self->effects_.tick(millis(), output);
+        self->unlockEffects();
+    }
 }
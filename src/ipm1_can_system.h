@@ -1,25 +1,68 @@
 #pragma once
 
+#include <Arduino.h>
 #include <ArduinoJson.h>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 #include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <freertos/task.h>
 
+#include "ipm1_effect_scheduler.h"
+
 class Ipm1CanSystem {
 public:
+    enum class DeviceKind : std::uint8_t { Powercell, InMotion, Mastercell, Other };
+
+    // Set drives the outputs to params.state without a capability check, for
+    // callers that enforce behaviours themselves (InfinityboxController); it
+    // has no JSON name.
+    enum class Op : std::uint8_t { Toggle, Momentary, Timed, Flash, FlashTimed, FlashStop, Fade, Set };
+
+    // Parameters for apply(); each op reads only the fields it needs
+    struct OpParams {
+        bool has_state = false;         // Toggle: explicit state (else invert); Momentary: required
+        bool state = false;
+        std::uint32_t duration_ms = 0;  // Timed, FlashTimed, Fade
+        std::uint32_t period_ms = 0;    // Flash, FlashTimed
+        std::uint8_t target_pwm = 0;    // Fade
+    };
+
+    // A circuit resolved once: its table index plus what the CAN layer needs.
+    // Valid until the system JSON is reloaded (begin()).
+    struct CircuitHandle {
+        static constexpr std::uint16_t kInvalidIndex = 0xFFFF;
+        std::uint16_t index = kInvalidIndex;
+        DeviceKind device = DeviceKind::Other;
+        std::uint8_t cell = 0;              // Device CAN address
+        std::uint16_t output_mask = 0;      // Powercell outputs, bit n-1 = OUTn
+
+        bool valid() const { return index != kInvalidIndex; }
+    };
+
     static Ipm1CanSystem& instance();
 
     bool begin();
     String getSystemJson() const;
 
+    // JSON entry point (REST): parses the action and forwards to apply()
     bool handleAction(JsonVariantConst action_json, String& error, JsonObject response);
 
+    // Typed entry point: no JSON, no name lookups, no string dispatch.
+    // `response` is optional; a null object discards the fields.
+    CircuitHandle resolveCircuit(const std::string& name) const;
+    bool apply(const CircuitHandle& circuit, Op op, const OpParams& params, String& error,
+               JsonObject response = JsonObject());
+    static bool parseOp(const char* name, Op& op);
+
 private:
     struct Device {
         std::string id;
         std::string type;
+        DeviceKind kind = DeviceKind::Other;
         std::uint8_t address = 0;
     };
 
@@ -32,6 +75,10 @@ private:
         std::string output_name;
         std::vector<std::string> capabilities;
         bool user_renameable = false;
+        // Resolved at load
+        std::int16_t device_index = -1;
+        std::uint16_t output_mask = 0;      // "output" or every entry of "outputs"
+        std::uint16_t ops = 0;              // bit per Op from capabilities
     };
 
     struct CircuitState {
@@ -40,52 +87,46 @@ private:
         std::uint8_t pwm = 0;
     };
 
-    struct ActiveAction {
-        std::string circuit;
-        std::string action;
-        TaskHandle_t task = nullptr;
-    };
+    // One effect slot per circuit (same index as circuits_/states_), stepped
+    // by the shared effect task; starting a new action on a circuit
+    // overwrites its slot, so cancel and retrigger are O(1).
+    using Effect = Ipm1EffectScheduler::Effect;
+    using EffectKind = Ipm1EffectScheduler::Kind;
 
-    struct ActionTaskContext {
-        Ipm1CanSystem* system = nullptr;
-        std::string circuit;
-        std::uint8_t address = 0;
-        std::int32_t output = -1;
-        std::uint32_t duration_ms = 0;
-        std::uint32_t period_ms = 0;
-        std::uint8_t on_value = 0xFF;
-        std::uint8_t off_value = 0x00;
-        std::uint8_t start_pwm = 0;
-        std::uint8_t target_pwm = 0;
-        std::uint32_t fade_ms = 0;
-    };
+    static constexpr std::size_t kMaxEffects = Ipm1EffectScheduler::kSlots;  // circuits that can run an effect
+    static constexpr std::uint32_t kEffectTickMs = Ipm1EffectScheduler::kTickMs;
+    static constexpr std::uint8_t kFadeSteps = Ipm1EffectScheduler::kFadeSteps;
 
-    static void timedTask(void* pv);
-    static void flashTask(void* pv);
-    static void fadeTask(void* pv);
+    static void effectTask(void* pv);
+    bool checkEffectSlot(std::size_t circuit, String& error) const;
+    bool startEffect(std::size_t circuit, const Effect& effect, String& error);
+    void effectOutput(std::size_t circuit, std::uint16_t device, std::uint16_t mask, std::uint8_t value);
+    void setState(std::size_t circuit, std::uint8_t value);
+    std::size_t circuitIndex(const Circuit& circuit) const { return static_cast<std::size_t>(&circuit - circuits_.data()); }
+    std::size_t deviceIndex(const Device& device) const { return static_cast<std::size_t>(&device - devices_.data()); }
+    void lockEffects() const;
+    void unlockEffects() const;
 
     bool loadFromJson(const String& json, String& error);
     const Circuit* findCircuit(const std::string& name) const;
     const Device* findDevice(const std::string& id) const;
-    CircuitState* findState(const std::string& name);
-    bool circuitSupports(const Circuit& circuit, const std::string& action) const;
 
-    bool applyToggle(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response);
-    bool applyMomentary(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response);
-    bool applyTimed(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response);
-    bool applyFlash(const Circuit& circuit, const Device& device, JsonVariantConst action_json, bool timed, String& error, JsonObject response);
+    bool applyToggle(const Circuit& circuit, const Device& device, const OpParams& params, String& error, JsonObject response);
+    bool applyMomentary(const Circuit& circuit, const Device& device, const OpParams& params, String& error, JsonObject response);
+    bool applyTimed(const Circuit& circuit, const Device& device, const OpParams& params, String& error, JsonObject response);
+    bool applyFlash(const Circuit& circuit, const OpParams& params, bool timed, String& error, JsonObject response);
     bool applyFlashStop(const Circuit& circuit, const Device& device, String& error, JsonObject response);
-    bool applyFade(const Circuit& circuit, const Device& device, JsonVariantConst action_json, String& error, JsonObject response);
+    bool applyFade(const Circuit& circuit, const OpParams& params, String& error, JsonObject response);
 
-    bool sendPowercellValue(const Device& device, std::int32_t output, std::uint8_t value, String& error);
-    void cancelActiveAction(const std::string& circuit);
-    void setActiveAction(const std::string& circuit, const std::string& action, TaskHandle_t task);
-    void clearActiveAction(const std::string& circuit);
+    bool sendPowercellValue(const Device& device, std::uint16_t mask, std::uint8_t value, String& error);
+    void cancelEffect(std::size_t circuit);
 
     String system_json_;
     std::string last_error_;
     std::vector<Device> devices_;
     std::vector<Circuit> circuits_;
     std::vector<CircuitState> states_;
-    std::vector<ActiveAction> active_actions_;
+    Ipm1EffectScheduler effects_;
+    mutable SemaphoreHandle_t effect_mutex_ = nullptr;
+    TaskHandle_t effect_task_ = nullptr;
 };
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "timer_wheel.h"
+
+// Timed, flash and fade effects for IPM1 circuits, run as fixed state
+// records off one hashed timer wheel instead of a task per action.
+//
+// Each slot (Ipm1CanSystem uses the circuit index) holds at most one
+// effect; start() overwrites whatever the slot was running, so cancel and
+// retrigger are O(1) and nothing is allocated. Output goes through a
+// callback, out(slot, device, mask, value), so the same stepping runs on the
+// device (Ipm1CanSystem's effect task) and in the native stress test.
+// Not thread-safe: the owner serialises every call.
+class Ipm1EffectScheduler {
+public:
+    enum class Kind : std::uint8_t { None, Timed, Flash, Fade };
+
+    struct Effect {
+        Kind kind = Kind::None;
+        std::uint16_t device = 0;           // index into the owner's device table
+        std::uint16_t mask = 0;             // Powercell outputs driven together
+        std::uint32_t start_ms = 0;
+        std::uint32_t duration_ms = 0;      // timed/flash_timed; 0 = flash forever
+        std::uint32_t period_ms = 0;        // flash half-period, fade step
+        bool on = false;                    // flash phase
+        std::uint8_t step = 0;              // fade step, 1..kFadeSteps
+        std::uint8_t start_pwm = 0;
+        std::uint8_t target_pwm = 0;
+    };
+
+    static constexpr std::size_t kSlots = 64;
+    static constexpr std::uint32_t kTickMs = 10;
+    static constexpr std::uint8_t kFadeSteps = 20;
+
+    bool empty() const { return wheel_.empty(); }
+    std::size_t pending() const { return wheel_.size(); }
+    bool active(std::size_t slot) const { return slot < kSlots && effects_[slot].kind != Kind::None; }
+
+    void clear() {
+        wheel_.clear();
+        effects_.fill(Effect{});
+    }
+
+    void cancel(std::size_t slot) {
+        if (slot >= kSlots) {
+            return;
+        }
+        wheel_.cancel(slot);
+        effects_[slot].kind = Kind::None;
+    }
+
+    // Flash and fade take their first step immediately, as the old
+    // per-action tasks did. False when the slot is out of range.
+    template <typename Output>
+    bool start(std::size_t slot, const Effect& effect, std::uint32_t now_ms, Output&& out) {
+        if (slot >= kSlots) {
+            return false;
+        }
+        effects_[slot] = effect;
+        effects_[slot].start_ms = now_ms;
+        if (effect.kind == Kind::Timed) {
+            arm(slot, effect.duration_ms);
+        } else {
+            step(slot, now_ms, out);
+        }
+        return true;
+    }
+
+    // Advance one kTickMs tick and step every effect due on it
+    template <typename Output>
+    void tick(std::uint32_t now_ms, Output&& out) {
+        wheel_.advance([&](std::size_t slot) { step(slot, now_ms, out); });
+    }
+
+private:
+    void arm(std::size_t slot, std::uint32_t delay_ms) { wheel_.schedule(slot, (delay_ms + kTickMs - 1) / kTickMs); }
+
+    // Runs one transition of the slot's effect and re-arms it on the wheel
+    // if it has more to do
+    template <typename Output>
+    void step(std::size_t slot, std::uint32_t now_ms, Output& out) {
+        Effect& effect = effects_[slot];
+        std::uint32_t next_ms = 0;
+
+        switch (effect.kind) {
+            case Kind::Timed:
+                out(slot, effect.device, effect.mask, static_cast<std::uint8_t>(0x00));
+                effect.kind = Kind::None;
+                return;
+
+            case Kind::Flash:
+                if (effect.duration_ms > 0 && (now_ms - effect.start_ms) >= effect.duration_ms) {
+                    out(slot, effect.device, effect.mask, static_cast<std::uint8_t>(0x00));
+                    effect.kind = Kind::None;
+                    return;
+                }
+                effect.on = !effect.on;
+                out(slot, effect.device, effect.mask, static_cast<std::uint8_t>(effect.on ? 0xFF : 0x00));
+                next_ms = effect.period_ms;
+                break;
+
+            case Kind::Fade: {
+                ++effect.step;
+                const float t = static_cast<float>(effect.step) / static_cast<float>(kFadeSteps);
+                const std::uint8_t value =
+                    static_cast<std::uint8_t>(effect.start_pwm + (effect.target_pwm - effect.start_pwm) * t);
+                out(slot, effect.device, effect.mask, value);
+                if (effect.step >= kFadeSteps) {
+                    effect.kind = Kind::None;
+                    return;
+                }
+                next_ms = effect.period_ms;
+                break;
+            }
+
+            case Kind::None:
+                return;
+        }
+
+        arm(slot, next_ms);
+    }
+
+    std::array<Effect, kSlots> effects_{};
+    TimerWheel<kSlots, 256> wheel_;
+};
@@ -0,0 +1,72 @@
+#include "logger.h"
+
+#include <cstring>
+
+namespace {
+constexpr uint32_t kFlushIntervalMs = 20;
+constexpr std::size_t kLineBufferSize = 256;
+
+const char* const kLevelNames[] = {"none", "error", "warn", "info", "debug", "verbose"};
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+void Logger::begin() {
+    if (task_) {
+        return;
+    }
+    // Lowest useful priority: formatting and USB CDC writes happen here, never on the caller
+    xTaskCreatePinnedToCore(flushTask, "log_flush", 4096, this, 1, &task_, 0);
+}
+
+const char* Logger::levelName(LogLevel level) {
+    const auto index = static_cast<uint8_t>(level);
+    return index < sizeof(kLevelNames) / sizeof(kLevelNames[0]) ? kLevelNames[index] : "?";
+}
+
+bool Logger::parseLevel(const char* name, LogLevel& out) {
+    for (uint8_t i = 0; i < sizeof(kLevelNames) / sizeof(kLevelNames[0]); ++i) {
+        if (strcasecmp(name, kLevelNames[i]) == 0) {
+            out = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::push(const Record& record) {
+    portENTER_CRITICAL(&producer_lock_);
+    ring_.push(record);
+    portEXIT_CRITICAL(&producer_lock_);
+}
+
+void Logger::flush() {
+    static uint32_t reported_drops = 0;
+    char line[kLineBufferSize];
+    Record record;
+
+    while (ring_.pop(record)) {
+        const uintptr_t* a = record.args;
+        // Unused trailing arguments are ignored by printf-style formatting
+        snprintf(line, sizeof(line), record.fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8], a[9],
+                 a[10], a[11]);
+        Serial.printf("[%s] %s\n", record.tag, line);
+    }
+
+    const uint32_t drops = ring_.drops();
+    if (drops != reported_drops) {
+        Serial.printf("[Log] %lu messages dropped (ring full)\n", static_cast<unsigned long>(drops - reported_drops));
+        reported_drops = drops;
+    }
+}
+
+void Logger::flushTask(void* param) {
+    auto* logger = static_cast<Logger*>(param);
+    for (;;) {
+        logger->flush();
+        vTaskDelay(pdMS_TO_TICKS(kFlushIntervalMs));
+    }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#include "spsc_ring.h"
+
+// Leveled, deferred logger for hot paths (CAN TX/RX, per-frame traces).
+//
+// LOG_* calls do not format or touch Serial: they copy a timestamp, the
+// format pointer and up to kMaxArgs integer/pointer arguments into a ring,
+// and a low-priority task formats and prints them later. Levels above
+// LOG_COMPILE_LEVEL are removed at compile time; the remaining levels are
+// gated at runtime (serial command "loglevel").
+//
+// Constraints of the deferred format: arguments must be integers, enums or
+// pointers to strings that outlive the call (literals, esp_err_to_name());
+// no floats and no String::c_str() of temporaries.
+
+#define LOG_LEVEL_NONE    0
+#define LOG_LEVEL_ERROR   1
+#define LOG_LEVEL_WARN    2
+#define LOG_LEVEL_INFO    3
+#define LOG_LEVEL_DEBUG   4
+#define LOG_LEVEL_VERBOSE 5
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_VERBOSE
+#endif
+
+enum class LogLevel : uint8_t {
+    None = LOG_LEVEL_NONE,
+    Error = LOG_LEVEL_ERROR,
+    Warn = LOG_LEVEL_WARN,
+    Info = LOG_LEVEL_INFO,
+    Debug = LOG_LEVEL_DEBUG,
+    Verbose = LOG_LEVEL_VERBOSE,
+};
+
+class Logger {
+public:
+    static constexpr std::size_t kMaxArgs = 12;
+    static constexpr std::size_t kRingSize = 128;
+
+    static Logger& instance();
+
+    // Starts the flush task. Records written earlier are kept and printed then.
+    void begin();
+
+    // Formats and prints everything pending; the flush task's body. Single
+    // consumer: only that task (or code that never started it) may call it.
+    void flush();
+
+    bool enabled(LogLevel level) const {
+        return static_cast<uint8_t>(level) <= level_.load(std::memory_order_relaxed);
+    }
+    void setLevel(LogLevel level) { level_.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+    LogLevel level() const { return static_cast<LogLevel>(level_.load(std::memory_order_relaxed)); }
+
+    uint32_t dropped() const { return ring_.drops(); }
+    uint32_t highWater() const { return ring_.highWater(); }
+
+    static const char* levelName(LogLevel level);
+    static bool parseLevel(const char* name, LogLevel& out);
+
+    template <typename... Args>
+    void write(LogLevel level, const char* tag, const char* fmt, Args... args) {
+        static_assert(sizeof...(Args) <= kMaxArgs, "Too many deferred log arguments");
+        Record record;
+        record.timestamp_ms = millis();
+        record.level = level;
+        record.tag = tag;
+        record.fmt = fmt;
+        record.argc = static_cast<uint8_t>(sizeof...(Args));
+        std::size_t i = 0;
+        ((record.args[i++] = toArg(args)), ...);
+        (void)i;
+        push(record);
+    }
+
+private:
+    Logger() = default;
+
+    struct Record {
+        uint32_t timestamp_ms = 0;
+        LogLevel level = LogLevel::Info;
+        uint8_t argc = 0;
+        const char* tag = "";
+        const char* fmt = "";
+        uintptr_t args[kMaxArgs] = {};
+    };
+
+    template <typename T>
+    static uintptr_t toArg(T value) {
+        static_assert(!std::is_floating_point<T>::value, "Deferred log arguments cannot be floating point");
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                      "Deferred log arguments must be integers, enums or pointers");
+        if constexpr (std::is_pointer<T>::value) {
+            return reinterpret_cast<uintptr_t>(value);
+        } else {
+            return static_cast<uintptr_t>(value);
+        }
+    }
+
+    void push(const Record& record);
+    static void flushTask(void* param);
+
+    SpscRing<Record, kRingSize> ring_;
+    portMUX_TYPE producer_lock_ = portMUX_INITIALIZER_UNLOCKED;  // Serializes writers onto the SPSC ring
+    std::atomic<uint8_t> level_{LOG_LEVEL_INFO};
+    TaskHandle_t task_ = nullptr;
+};
+
+#define LOG_AT(level_value, level_enum, tag, fmt, ...)                                         \
+    do {                                                                                       \
+        if constexpr ((level_value) <= LOG_COMPILE_LEVEL) {                                    \
+            if (Logger::instance().enabled(level_enum)) {                                      \
+                Logger::instance().write(level_enum, tag, fmt, ##__VA_ARGS__);                 \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
+
+#define LOG_ERROR(tag, fmt, ...)   LOG_AT(LOG_LEVEL_ERROR, LogLevel::Error, tag, fmt, ##__VA_ARGS__)
+#define LOG_WARN(tag, fmt, ...)    LOG_AT(LOG_LEVEL_WARN, LogLevel::Warn, tag, fmt, ##__VA_ARGS__)
+#define LOG_INFO(tag, fmt, ...)    LOG_AT(LOG_LEVEL_INFO, LogLevel::Info, tag, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(tag, fmt, ...)   LOG_AT(LOG_LEVEL_DEBUG, LogLevel::Debug, tag, fmt, ##__VA_ARGS__)
+#define LOG_VERBOSE(tag, fmt, ...) LOG_AT(LOG_LEVEL_VERBOSE, LogLevel::Verbose, tag, fmt, ##__VA_ARGS__)
@@ -8,7 +8,7 @@
  * 
  * HARDWARE INITIALIZATION: Direct calls (no BSP abstraction).
  * All core stability fixes are in this file:
- *   1. Synchronous LVGL flush (no async callback)
+ *   1. LVGL flush overlapped with rendering (see display_flush.h)
  *   2. Double-buffer LVGL (prevents tearing)
  *   3. Mux watchdog (reasserts USB_SEL every 1s)
  *   4. LVGL mutex created immediately after lv_init()
@@ -25,8 +25,12 @@
 #include <esp_system.h>
 #include <rom/rtc.h>
 
+#include "boot_timeline.h"
 #include "can_manager.h"
+#include "can_replay_manager.h"
+#include "can_trace_recorder.h"
 #include "config_manager.h"
+#include "display_flush.h"
 #include "ipm1_can_system.h"
 #include "ui_builder.h"
 #include "ui_theme.h"
@@ -36,23 +40,12 @@
 #include "hardware_config.h"
 #include "infinitybox_control.h"
 #include "behavioral_output_integration.h"
+#include "logger.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <Preferences.h>
 
-// CAN message queue structure
-struct CanFrame {
-    uint32_t id;
-    bool ext;
-    uint8_t dlc;
-    uint8_t data[8];
-    uint32_t timestamp_ms;
-};
-
-static QueueHandle_t g_can_queue = nullptr;
-static constexpr size_t CAN_QUEUE_SIZE = 128;
-
 enum class PanelVariant : uint8_t {
     kFourPointThreeInch = BRONCO_PANEL_VARIANT_4_3,
     kSevenInch = BRONCO_PANEL_VARIANT_7_0,
@@ -89,11 +82,13 @@ static bool g_disable_ota = false;
 static ESP_IOExpander* g_expander = nullptr;
 static volatile bool g_safe_boot_requested = false;
 static volatile uint32_t g_can_frames_received = 0;
+static CanManager::CanFrameBus::Subscriber* g_can_monitor_sub = nullptr;
 Preferences g_prefs;
 
 // LVGL Task timing constants
 constexpr uint32_t LVGL_TASK_STACK_SIZE = 6 * 1024;
 constexpr uint32_t LVGL_TASK_PRIORITY = 2;
+constexpr BaseType_t LVGL_TASK_CORE = 1;  // DisplayFlush's copy task runs on core 0
 constexpr uint32_t LVGL_TASK_MAX_DELAY_MS = 500;
 constexpr uint32_t LVGL_TASK_MIN_DELAY_MS = 1;
 
@@ -169,41 +164,13 @@ void suspension_tx_task(void*) {
 }
 
 // CAN receive task - runs on core 1, never blocks UI
-// Pulls messages from TWAI and pushes to queue for processing
+// Sleeps on the ISR-fed TWAI queue and drains every pending frame per wakeup;
+// this task is the only driver receive caller and publishes to the RX bus.
 void can_rx_task(void* param) {
     Serial.println("[CAN-TASK] RX task started on core 1");
-    CanRxMessage msg;
     
     for (;;) {
-        // Non-blocking receive with short timeout
-        if (CanManager::instance().receiveMessage(msg, 50)) {
-            // Check for suspension status frame (0x738)
-            // Standard IDs are 11-bit (0-0x7FF), extended are 29-bit
-            bool is_standard = (msg.identifier <= 0x7FF);
-            if (is_standard && msg.identifier == 0x738 && msg.length == 8) {
-                CanManager::instance().parseSuspensionStatus(msg.data);
-            }
-            if (!is_standard && msg.length == 8) {
-                const uint32_t pgn = (msg.identifier >> 8) & 0x3FFFF;
-                CanManager::instance().updatePowercellStatusFromPgn(pgn, msg.data);
-            }
-            
-            // Queue frame for general processing (Infinitybox, diagnostics, etc.)
-            CanFrame frame;
-            frame.id = msg.identifier;
-            frame.ext = (msg.identifier & 0x80000000) != 0;  // Infer from ID
-            frame.dlc = msg.length;
-            memcpy(frame.data, msg.data, 8);
-            frame.timestamp_ms = millis();
-            
-            // Non-blocking queue send - drop if full (don't block CAN RX)
-            if (xQueueSend(g_can_queue, &frame, 0) == pdTRUE) {
-                g_can_frames_received++;
-            }
-        }
-        
-        // Always yield to prevent watchdog
-        vTaskDelay(pdMS_TO_TICKS(1));
+        g_can_frames_received += CanManager::instance().serviceRx(50);
     }
 }
 
@@ -230,29 +197,14 @@ void health_monitor_task(void* param) {
         }
         last_heap = heap;
         
-        Serial.printf("[HEALTH] heap=%lu psram=%lu can_fps=%lu\n", heap, psram, can_fps);
+        const CanRxStats rx = CanManager::instance().getRxStats();
+        Serial.printf("[HEALTH] heap=%lu psram=%lu can_fps=%lu rx_missed=%lu rx_overrun=%lu\n",
+                      heap, psram, can_fps, rx.hw_rx_missed, rx.hw_rx_overrun);
         
         vTaskDelay(pdMS_TO_TICKS(2000));
     }
 }
 
-#if ESP_PANEL_LCD_BUS_TYPE == ESP_PANEL_BUS_TYPE_RGB
-void lvgl_port_disp_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p) {
-    panel->getLcd()->drawBitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_p);
-    lv_disp_flush_ready(disp);
-}
-#else
-void lvgl_port_disp_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p) {
-    panel->getLcd()->drawBitmap(area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_p);
-    lv_disp_flush_ready(disp);  // Always call synchronously
-}
-
-bool notify_lvgl_flush_ready(void* user_ctx) {
-    // No longer needed with synchronous flush
-    return false;
-}
-#endif
-
 #if ESP_PANEL_USE_LCD_TOUCH
 void lvgl_port_tp_read(lv_indev_drv_t* indev, lv_indev_data_t* data) {
     panel->getLcdTouch()->readData();
@@ -309,11 +261,16 @@ void lvgl_port_task(void* arg) {
 void setup() {
     Serial.begin(115200);
     Serial.flush();
-    delay(500);  // Allow serial to stabilize - increased delay
+    // No settle delay: output before the USB CDC host attaches is lost either
+    // way, and the boot phase summary printed at the end of setup() survives
     
     // CRITICAL: Print immediately to confirm setup() is reached
     Serial.println("\n\n\n*** SETUP() STARTED ***");
     Serial.flush();
+
+    // Deferred logger flush task (hot-path LOG_* calls never block on USB CDC)
+    Logger::instance().begin();
+    BootTimeline::instance().mark("serial");
     
     // Print reset reason for diagnostics (brownout, WDT, panic, etc.)
     esp_reset_reason_t reset_reason = esp_reset_reason();
@@ -370,35 +327,12 @@ void setup() {
     Serial.println("[PANEL] Creating ESP_Panel object...");
     panel = new ESP_Panel();
 
-    // LVGL draw buffers - DOUBLE BUFFER in PSRAM for safety
-    Serial.println("[LVGL] Allocating double buffers in PSRAM...");
-    static lv_disp_draw_buf_t draw_buf;
-    const uint32_t buf_sz = ESP_PANEL_LCD_H_RES * 40;
-    const uint32_t buf_bytes = buf_sz * sizeof(lv_color_t);
-    
-    uint8_t* buf1 = static_cast<uint8_t*>(heap_caps_calloc(1, buf_bytes, MALLOC_CAP_SPIRAM));
-    if (!buf1) {
-        Serial.printf("[ERROR] Unable to allocate LVGL buffer 1 (%lu bytes)\n", buf_bytes);
-        Serial.printf("[ERROR] Free PSRAM: %lu bytes\n", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
-        while (true) delay(1000);
-    }
-    uint8_t* buf2 = static_cast<uint8_t*>(heap_caps_calloc(1, buf_bytes, MALLOC_CAP_SPIRAM));
-    if (!buf2) {
-        Serial.printf("[ERROR] Unable to allocate LVGL buffer 2 (%lu bytes)\n", buf_bytes);
-        Serial.printf("[ERROR] Free PSRAM: %lu bytes\n", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
-        while (true) delay(1000);
-    }
-    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, buf_sz);
-    Serial.printf("[LVGL] ✓ Allocated 2x %lu byte buffers in PSRAM\n", buf_bytes);
-    Serial.printf("[LVGL] Free PSRAM after allocation: %lu bytes\n", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
-
-    // Register display driver
+    // Register display driver; draw buffers and flush callbacks come from DisplayFlush
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = panelConfig.width;
     disp_drv.ver_res = panelConfig.height;
-    disp_drv.flush_cb = lvgl_port_disp_flush;
-    disp_drv.draw_buf = &draw_buf;
+    DisplayFlush::instance().begin(disp_drv, panelConfig.width);
     lv_disp_drv_register(&disp_drv);
 
 #if ESP_PANEL_USE_LCD_TOUCH
@@ -416,6 +350,8 @@ void setup() {
     Serial.println("[Boot] Calling panel->begin()...");
     panel->begin();
     Serial.println("[Boot] ✓ panel->begin() completed");
+    DisplayFlush::instance().start(panel);
+    BootTimeline::instance().mark("panel");
     
     // NOW create and configure expander AFTER panel owns I2C
     Serial.println("[EXPANDER] Creating CH422G expander...");
@@ -431,34 +367,49 @@ void setup() {
     } else {
         Serial.println("[EXPANDER] ✗ Failed to create expander");
     }
+    BootTimeline::instance().mark("expander");
     
-    // SAFE BOOT CHECK: Hold top-left corner during boot to factory reset
+    // SAFE BOOT CHECK: Hold top-left corner during boot to factory reset.
+    // Instead of a fixed settle delay the touch controller is polled for up
+    // to kSafeBootDetectMs; only a hold seen in that window is timed for the
+    // full kSafeBootHoldMs, so a normal boot leaves as soon as it can.
+    constexpr uint32_t kSafeBootDetectMs = 500;
+    constexpr uint32_t kSafeBootHoldMs = 3000;
     Serial.println("\n[SAFE BOOT] Checking for factory reset request (hold top-left)...");
-    delay(500);  // Give touch controller time to stabilize
-    
-    for (int i = 0; i < 30; i++) {  // Check for 3 seconds
+    const uint32_t safe_boot_start = millis();
+    uint32_t held_since = 0;
+    int last_reported = -1;
+    for (;;) {
+        const uint32_t now = millis();
         if (detect_safe_boot()) {
-            Serial.printf("[SAFE BOOT] Detected! Hold for %d more...\n", 30 - i);
-            g_safe_boot_requested = true;
-        } else if (g_safe_boot_requested) {
+            if (!held_since) {
+                held_since = now ? now : 1;
+            }
+            const uint32_t held = now - held_since;
+            if (held >= kSafeBootHoldMs) {
+                g_safe_boot_requested = true;
+                break;
+            }
+            const int remaining = static_cast<int>((kSafeBootHoldMs - held + 999) / 1000);
+            if (remaining != last_reported) {
+                Serial.printf("[SAFE BOOT] Detected! Hold for %d more second(s)...\n", remaining);
+                last_reported = remaining;
+            }
+        } else if (held_since) {
             // Released early
-            g_safe_boot_requested = false;
             Serial.println("[SAFE BOOT] Released - cancelled");
             break;
+        } else if (now - safe_boot_start >= kSafeBootDetectMs) {
+            break;
         }
-        delay(100);
+        delay(20);
     }
     
     if (g_safe_boot_requested) {
         factory_reset();  // This will reboot
     }
     Serial.println("[SAFE BOOT] Normal boot\n");
-
-    // Create CAN message queue
-    g_can_queue = xQueueCreate(CAN_QUEUE_SIZE, sizeof(CanFrame));
-    if (!g_can_queue) {
-        Serial.println("[ERROR] Failed to create CAN queue!");
-    }
+    BootTimeline::instance().mark("safe_boot");
 
     // Start mux watchdog to keep USB_SEL HIGH
     xTaskCreatePinnedToCore(mux_watchdog_task, "mux_wd", 4096, nullptr, 1, nullptr, 1);
@@ -468,6 +419,9 @@ void setup() {
     xTaskCreatePinnedToCore(suspension_tx_task, "susp_tx", 4096, nullptr, 2, nullptr, 1);
     Serial.println("[SUSPENSION] ✓ Suspension TX task started (300ms)");
     
+    // Main-loop consumer of the CAN RX bus (WebSocket monitor + canmon)
+    g_can_monitor_sub = CanManager::instance().rxBus().subscribe("ws_monitor");
+
     // Start CAN RX task on core 1 (separate from UI)
     xTaskCreatePinnedToCore(can_rx_task, "can_rx", 4096, nullptr, 3, nullptr, 1);
     Serial.println("[CAN-TASK] ✓ CAN RX task started on core 1");
@@ -475,10 +429,13 @@ void setup() {
     // Start health monitor
     xTaskCreatePinnedToCore(health_monitor_task, "health", 3072, nullptr, 1, nullptr, 1);
     Serial.println("[HEALTH] ✓ Health monitor started");
+    BootTimeline::instance().mark("tasks");
 
     // === CAN INITIALIZATION ===
     Serial.println("\n[CAN] Initializing CAN bus...");
+    CanTraceRecorder::instance().begin();  // Before the driver so no early frame is missed once enabled
     CanManager::instance().setExpander(g_expander);
+    CanManager::instance().setDriver(&espTwaiDriver());
     CanManager::instance().begin();
     
     if (CanManager::instance().isReady()) {
@@ -488,6 +445,7 @@ void setup() {
         Serial.println("[CAN] ✗ TWAI driver FAILED - CAN will not work");
     }
     Serial.println();
+    BootTimeline::instance().mark("can");
 
     // Enable backlight
     Serial.println("[Boot] Getting backlight...");
@@ -501,8 +459,11 @@ void setup() {
         Serial.println("[Boot] ✗ ERROR: Backlight is NULL!");
     }
 
-    // Start LVGL background task (note: lvgl_mux already created at top of setup())
-    xTaskCreate(lvgl_port_task, "lvgl", LVGL_TASK_STACK_SIZE, nullptr, LVGL_TASK_PRIORITY, nullptr);
+    // Start LVGL background task (note: lvgl_mux already created at top of setup()).
+    // Core 1: the display flush task copies on core 0 while LVGL renders here
+    xTaskCreatePinnedToCore(lvgl_port_task, "lvgl", LVGL_TASK_STACK_SIZE, nullptr, LVGL_TASK_PRIORITY, nullptr,
+                            LVGL_TASK_CORE);
+    BootTimeline::instance().mark("backlight");
 
     // Boot-safe config bypass: if reset was due to panic/WDT, offer recovery
     bool skip_config = false;
@@ -531,10 +492,14 @@ void setup() {
     } else if (!ConfigManager::instance().begin()) {
         Serial.println("[Config] Failed to mount LittleFS; factory defaults applied.");
     }
+    // CAN came up with the built-in filter; the health task adds these
+    CanManager::instance().setMonitorPgns(ConfigManager::instance().getConfig().can_monitor_pgns);
+    BootTimeline::instance().mark("config");
 
     if (!Ipm1CanSystem::instance().begin()) {
         Serial.println("[IPM1] Failed to load system JSON; default system retained");
     }
+    BootTimeline::instance().mark("ipm1");
 
     // Auto-detect firmware version if it differs from APP_VERSION (after OTA update)
     auto& config = ConfigManager::instance().getConfig();
@@ -551,15 +516,18 @@ void setup() {
     UIBuilder::instance().begin();
     UIBuilder::instance().applyConfig(ConfigManager::instance().getConfig());
     lvgl_port_unlock();
+    BootTimeline::instance().mark("ui");
 
     // Launch WiFi access point + web server
     WebServerManager::instance().begin();
     OTAUpdateManager::instance().begin();
+    BootTimeline::instance().mark("web");
 
     // Initialize Behavioral Output System first (provides behavior engine + CAN frame synthesis)
     Serial.println("[BEHAVIORAL] Initializing behavioral output control framework...");
     initBehavioralOutputSystem(&WebServerManager::instance().getServer());
     Serial.println("[BEHAVIORAL] ✓ Behavioral output system ready");
+    BootTimeline::instance().mark("behavioral");
 
     // Initialize Infinitybox control system with behavior engine linkage
     Serial.println("[IBOX] Initializing Infinitybox IPM1 control system...");
@@ -568,6 +536,8 @@ void setup() {
     } else {
         Serial.println("[IBOX] ✗ Failed to initialize Infinitybox system");
     }
+    BootTimeline::instance().mark("infinitybox");
+    BootTimeline::instance().printSummary();
 
     Serial.println("=================================" );
     Serial.println(" Touch the screen or open http://192.168.4.250 ");
@@ -657,7 +627,7 @@ void loop() {
                 frame.destination_address = 0xFF;
                 frame.data = {0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
                 
-                if (CanManager::instance().sendFrame(frame)) {
+                if (CanManager::instance().sendFrame(frame, CanTxLane::Diagnostic)) {
                     Serial.println("[CAN] ✓ Poll sent");
                 } else {
                     Serial.println("[CAN] ✗ Failed to send poll");
@@ -668,6 +638,7 @@ void loop() {
         } else if (cmd == "canmon") {
             // Start non-blocking CAN monitoring
             if (!canmon_active) {
+                CanManager::instance().noteMonitorActivity();
                 canmon_active = true;
                 canmon_start_ms = millis();
                 canmon_count = 0;
@@ -691,7 +662,7 @@ void loop() {
                 // Configuration: 0x99 confirmation, 0x01 (250kb/s, 10s, 250ms, 200Hz), all outputs maintain state, config rev 0
                 frame.data = {0x99, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
                 
-                if (CanManager::instance().sendFrame(frame)) {
+                if (CanManager::instance().sendFrame(frame, CanTxLane::Diagnostic)) {
                     Serial.println("[CAN] Configuration sent! Power cycle the Powercell to apply.");
                 } else {
                     Serial.println("[CAN] Failed to send configuration");
@@ -733,7 +704,7 @@ void loop() {
                 }
                 
                 Serial.printf("[CAN] Sending PGN 0x%04lX with %d bytes\n", pgn, byteCount);
-                if (CanManager::instance().sendFrame(frame)) {
+                if (CanManager::instance().sendFrame(frame, CanTxLane::Diagnostic)) {
                     Serial.println("[CAN] Message sent successfully");
                 } else {
                     Serial.println("[CAN] Failed to send message");
@@ -749,7 +720,104 @@ void loop() {
             Serial.printf("RX Pin: GPIO%u\n", (unsigned)CanManager::instance().rxPin());
             Serial.println("Bitrate: 250 kbps");
             Serial.println("Mode: NO_ACK (for testing without termination)");
+            {
+                const CanRxStats rx = CanManager::instance().getRxStats();
+                Serial.printf("RX frames: %lu (bus ring %lu)\n", rx.frames_received, rx.ring_capacity);
+                auto& bus = CanManager::instance().rxBus();
+                for (size_t i = 0; i < bus.subscriberCount(); ++i) {
+                    const auto sub = bus.subscriberStats(i);
+                    Serial.printf("  sub %-12s delivered=%lu dropped=%lu lag=%lu\n",
+                                  sub.name, sub.delivered, sub.dropped, sub.lag);
+                }
+                Serial.printf("TWAI RX: queue=%lu pending=%lu missed=%lu overrun=%lu\n",
+                              rx.hw_queue_len, rx.hw_pending, rx.hw_rx_missed, rx.hw_rx_overrun);
+                Serial.printf("Bus errors: %lu, Arb lost: %lu\n", rx.bus_errors, rx.arb_lost);
+                Serial.printf("RX filter: %s code=0x%08lX mask=0x%08lX sw-rejected=%lu%s\n", rx.filter_mode,
+                              rx.acceptance_code, rx.acceptance_mask, rx.sw_rejected,
+                              CanManager::instance().filterOverrideAll() ? " (override: all)" : "");
+                const CanBusHealth health = CanManager::instance().getBusHealth();
+                Serial.printf("Bus state: %s (TEC=%lu REC=%lu) bus-off=%lu recovered=%lu err-passive=%lu\n",
+                              CanManager::busStateName(health.state), health.tx_error_counter,
+                              health.rx_error_counter, health.bus_off_count, health.recovered_count,
+                              health.error_passive_count);
+                for (const auto& lane : CanManager::instance().getTxStats()) {
+                    Serial.printf("  tx %-10s depth=%lu/%lu sent=%lu expired=%lu shed=%lu failed=%lu full=%lu max=%luus\n",
+                                  lane.name, lane.depth, lane.capacity, lane.sent, lane.expired, lane.shed,
+                                  lane.failed, lane.queue_full, lane.max_latency_us);
+                }
+            }
             Serial.println("======================\n");
+        } else if (cmd == "canfilter" || cmd.startsWith("canfilter ")) {
+            String mode = cmd.substring(9);
+            mode.trim();
+            if (mode == "all") {
+                CanManager::instance().setFilterOverrideAll(true);
+            } else if (mode == "auto") {
+                CanManager::instance().setFilterOverrideAll(false);
+            } else if (mode.length() > 0) {
+                Serial.println("[CMD] Usage: canfilter auto|all");
+            }
+            Serial.printf("[CAN] RX filter override: %s (applied by the health task)\n",
+                          CanManager::instance().filterOverrideAll() ? "all" : "auto");
+        } else if (cmd == "trace" || cmd.startsWith("trace ")) {
+            auto& recorder = CanTraceRecorder::instance();
+            String arg = cmd.substring(5);
+            arg.trim();
+            if (arg == "on") {
+                recorder.setEnabled(true);
+            } else if (arg == "off") {
+                recorder.setEnabled(false);
+            } else if (arg == "clear") {
+                recorder.clear();
+            } else if (arg == "spill") {
+                if (!recorder.triggerNow()) {
+                    Serial.println("[Trace] Spill not started (no ring or spill in progress)");
+                }
+            } else if (arg.length() > 0) {
+                Serial.println("[CMD] Usage: trace [on|off|clear|spill]");
+            }
+            const CanTraceStats stats = recorder.getStats();
+            Serial.printf("[Trace] %s, %lu/%lu records, %lu spills (last %lu records, %lu lost)\n",
+                          stats.enabled ? "recording" : "stopped", static_cast<unsigned long>(stats.available),
+                          static_cast<unsigned long>(stats.capacity), static_cast<unsigned long>(stats.spills),
+                          static_cast<unsigned long>(stats.spill_records),
+                          static_cast<unsigned long>(stats.spill_gaps));
+        } else if (cmd == "replay" || cmd.startsWith("replay ")) {
+            // replay [stop | <speed> [loop] [path]]  (speed 0 = as fast as possible)
+            auto& replay = CanReplayManager::instance();
+            String arg = cmd.substring(6);
+            arg.trim();
+            if (arg == "stop") {
+                replay.stop();
+            } else if (arg.length() > 0) {
+                CanReplayOptions options;
+                String path;
+                int start = 0;
+                bool first = true;
+                while (start < static_cast<int>(arg.length())) {
+                    int end = arg.indexOf(' ', start);
+                    if (end < 0) end = arg.length();
+                    const String token = arg.substring(start, end);
+                    if (first) {
+                        options.speed_permille = static_cast<uint32_t>(token.toFloat() * 1000.0f + 0.5f);
+                        first = false;
+                    } else if (token == "loop") {
+                        options.loop = true;
+                    } else if (token.length() > 0) {
+                        path = token;
+                    }
+                    start = end + 1;
+                }
+                if (!replay.start(path.c_str(), options)) {
+                    Serial.println("[Replay] Not started (bad trace file or replay running)");
+                }
+            }
+            const CanReplayStatus status = replay.getStatus();
+            Serial.printf("[Replay] %s %s: %lu/%lu frames, %lu skipped, max %lu us late\n",
+                          status.running ? "playing" : "idle", status.path,
+                          static_cast<unsigned long>(status.stats.played), static_cast<unsigned long>(status.records),
+                          static_cast<unsigned long>(status.stats.skipped),
+                          static_cast<unsigned long>(status.stats.max_late_us));
         } else if (cmd.startsWith("canreinit ")) {
             // Reinitialize CAN with custom pins: canreinit <tx_pin> <rx_pin>
             String params = cmd.substring(9);
@@ -877,6 +945,22 @@ void loop() {
         } else if (cmd == "otaon") {
             g_disable_ota = false;
             Serial.println("[OTA] Auto-update enabled");
+        } else if (cmd == "loglevel" || cmd.startsWith("loglevel ")) {
+            Logger& logger = Logger::instance();
+            if (cmd.length() > 9) {
+                LogLevel level;
+                if (Logger::parseLevel(cmd.substring(9).c_str(), level)) {
+                    logger.setLevel(level);
+                } else {
+                    Serial.println("[CMD] Usage: loglevel none|error|warn|info|debug|verbose");
+                }
+            }
+            Serial.printf("[LOG] Level: %s (compiled up to %s), dropped: %lu, ring high water: %lu/%u\n",
+                          Logger::levelName(logger.level()),
+                          Logger::levelName(static_cast<LogLevel>(LOG_COMPILE_LEVEL)),
+                          static_cast<unsigned long>(logger.dropped()),
+                          static_cast<unsigned long>(logger.highWater()),
+                          static_cast<unsigned>(Logger::kRingSize));
         } else if (cmd == "help" || cmd == "?") {
             Serial.println("\n=== Serial Commands ===");
             Serial.println("BRIGHTNESS:");
@@ -886,9 +970,12 @@ void loop() {
             Serial.println("  btest            - Step brightness 100->0->100");
             Serial.println("CAN BUS (Powercell modules):");
             Serial.println("  canstatus        - Show CAN bus status");
+            Serial.println("  canfilter [mode] - RX acceptance filter: auto (planned) | all");
             Serial.println("  canpoll <1-16>   - Poll Powercell at address");
             Serial.println("  canconfig <1-16> - Configure Powercell (default settings)");
             Serial.println("  canmon           - Monitor CAN bus for 10 seconds");
+            Serial.println("  trace [on|off|clear|spill] - CAN trace recorder (export: /api/can/trace/export)");
+            Serial.println("  replay [stop|<speed> [loop] [path]] - Replay a binary trace into CAN RX");
             Serial.println("  cansend <pgn> <data> - Send raw CAN frame");
             Serial.println("                     Example: cansend FF41 11 00 00 00 00 00 00 00");
             Serial.println("INFINITYBOX (IPM1 System):");
@@ -899,6 +986,7 @@ void loop() {
             Serial.println("  security on|off  - Enable/disable security interlock");
             Serial.println("  ignition on|off  - Turn ignition on/off");
             Serial.println("GENERAL:");
+            Serial.println("  loglevel [level] - Show/set log level (none|error|warn|info|debug|verbose)");
             Serial.println("  help or ?        - Show this help");
             Serial.println("======================\n");
         } else if (cmd.length() > 0) {
@@ -906,24 +994,18 @@ void loop() {
         }
     }
     
-    // ===== CAN QUEUE PROCESSING (non-blocking, from dedicated task) =====
-    CanFrame frame;
-    while (xQueueReceive(g_can_queue, &frame, 0) == pdTRUE) {
+    // ===== CAN RX BUS PROCESSING (non-blocking, from dedicated task) =====
+    CanManager::instance().rxBus().drain(g_can_monitor_sub, [&](const CanRxMessage& frame) {
         can_frames_processed++;
         
         // Broadcast to WebSocket clients for CAN monitor
-        CanRxMessage ws_msg;
-        ws_msg.identifier = frame.id;
-        ws_msg.length = frame.dlc;
-        memcpy(ws_msg.data, frame.data, 8);
-        ws_msg.timestamp = frame.timestamp_ms;
-        WebServerManager::instance().broadcastCanFrame(ws_msg, false);
+        WebServerManager::instance().broadcastCanFrame(frame, false);
         
         // Only print if actively monitoring (not every frame!)
         if (canmon_active) {
             canmon_count++;
-            Serial.printf("[CAN] #%d ID: 0x%08lX, DLC: %d, Data: ", canmon_count, frame.id, frame.dlc);
-            for (uint8_t i = 0; i < frame.dlc; i++) {
+            Serial.printf("[CAN] #%d ID: 0x%08lX, DLC: %d, Data: ", canmon_count, frame.identifier, frame.length);
+            for (uint8_t i = 0; i < frame.length; i++) {
                 Serial.printf("%02X ", frame.data[i]);
             }
             Serial.println();
@@ -931,6 +1013,12 @@ void loop() {
         
         // TODO: Process CAN data and update UI model here
         // Do NOT call LVGL functions directly - set flags/state instead
+    });
+
+    // Frames we sent that the monitor should show (queued by the CAN TX task)
+    CanRxMessage tx_echo;
+    while (CanManager::instance().popTxEcho(tx_echo)) {
+        WebServerManager::instance().broadcastCanFrame(tx_echo, true);
     }
     
     // Print CAN stats periodically (not every frame)
@@ -944,6 +1032,9 @@ void loop() {
     }
     
     // Check if monitoring period ended
+    if (canmon_active) {
+        CanManager::instance().noteMonitorActivity();  // canmon sees every frame, not just the filtered set
+    }
     if (canmon_active && (now_ms - canmon_start_ms >= 10000)) {
         Serial.printf("[CAN] *** Monitoring complete. Displayed %d messages. ***\n", canmon_count);
         canmon_active = false;
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free bounded multi-producer / single-consumer queue.
+//
+// Any number of tasks may push concurrently (CAS on the head index, no mutex,
+// never blocks); exactly one task consumes. Each slot carries a sequence
+// number so the consumer only sees a slot once its producer has finished
+// writing it. The consumer may inspect the oldest item in place (front())
+// and decide whether to take it, which is what deadline-aware schedulers need.
+template <typename T, std::size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpscRing capacity must be a power of two");
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+
+    MpscRing() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            cells_[i].seq.store(static_cast<std::uint32_t>(i), std::memory_order_relaxed);
+        }
+    }
+
+    // Producer side (any task). Returns false (and counts a drop) when full.
+    bool push(const T& item) {
+        std::uint32_t pos = head_.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;) {
+            cell = &cells_[pos & kMask];
+            const std::uint32_t seq = cell->seq.load(std::memory_order_acquire);
+            const std::int32_t diff = static_cast<std::int32_t>(seq - pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                drops_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = item;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: oldest fully-written item, or nullptr when empty.
+    T* front() {
+        const std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+        Cell& cell = cells_[tail & kMask];
+        if (cell.seq.load(std::memory_order_acquire) != tail + 1) {
+            return nullptr;
+        }
+        return &cell.value;
+    }
+
+    // Consumer side: release the item returned by front().
+    void popFront() {
+        const std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+        cells_[tail & kMask].seq.store(tail + static_cast<std::uint32_t>(Capacity), std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    bool pop(T& out) {
+        T* item = front();
+        if (!item) {
+            return false;
+        }
+        out = *item;
+        popFront();
+        return true;
+    }
+
+    // Approximate while producers are active
+    std::size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    std::uint32_t drops() const { return drops_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::uint32_t kMask = static_cast<std::uint32_t>(Capacity - 1);
+
+    struct Cell {
+        std::atomic<std::uint32_t> seq{0};
+        T value{};
+    };
+
+    std::array<Cell, Capacity> cells_{};
+    std::atomic<std::uint32_t> head_{0};
+    std::atomic<std::uint32_t> tail_{0};
+    std::atomic<std::uint32_t> drops_{0};
+};
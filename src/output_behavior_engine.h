@@ -2,9 +2,17 @@
 
 #include <Arduino.h>
 #include <array>
+#include <atomic>
 #include <vector>
 #include <map>
+#include <memory>
 #include <functional>
+#include <mutex>
+#include <utility>
+
+#include "deadline_heap.h"
+#include "mpsc_ring.h"
+#include "seqlock.h"
 
 /**
  * ╔═══════════════════════════════════════════════════════════════════════════╗
@@ -27,6 +35,21 @@
 
 namespace BehavioralOutput {
 
+// Output slots are addressed by a small integer handle resolved from the
+// String ID at configuration time. 16 cells x 10 outputs.
+using OutputHandle = uint8_t;
+constexpr OutputHandle kInvalidOutputHandle = 0xFF;
+constexpr uint8_t kMaxCellAddress = 16;
+constexpr uint8_t kOutputsPerCell = 10;
+constexpr std::size_t kMaxOutputs = kMaxCellAddress * kOutputsPerCell;
+constexpr std::size_t kMaxPatterns = 16;
+
+// Scenes get a handle the same way, for the lock-free control path
+using SceneHandle = uint8_t;
+constexpr SceneHandle kInvalidSceneHandle = 0xFF;
+constexpr std::size_t kMaxScenes = 32;
+constexpr std::size_t kMaxPatternSteps = 32;
+
 // ═══════════════════════════════════════════════════════════════════════════
 // BEHAVIOR TYPES
 // ═══════════════════════════════════════════════════════════════════════════
@@ -110,19 +133,76 @@ struct OutputChannel {
     uint8_t cellAddress = 1;        // POWERCELL cell address
     uint8_t outputNumber = 1;       // Output 1-10 on that cell
     
-    // Current behavior
+    // Current behavior (configuration; runtime state lives in the OutputTable)
     BehaviorConfig behavior;
     
-    // Current state (generated by behavior engine)
-    bool currentState = false;      // Current ON/OFF state (for bitmap)
-    bool isActive = false;          // Is this output currently controlled?
-    bool softStart = false;         // Enable soft-start ramp (Byte 2 in CAN frame)
-    bool pwmEnable = false;         // Enable PWM for fade (Byte 3 in CAN frame)
+    // Slot in the engine's OutputTable, assigned by addOutput()
+    OutputHandle handle = kInvalidOutputHandle;
     
     // Scene membership
     std::vector<String> sceneIds;
 };
 
+// ═══════════════════════════════════════════════════════════════════════════
+// COMPILED RUNTIME TABLE
+// ═══════════════════════════════════════════════════════════════════════════
+
+// What update() evaluates for a slot. Every BehaviorType reduces to one of
+// these when the behavior is set, so the tick needs no String or map access.
+enum class OutputKind : uint8_t {
+    CONST,        // on = param_a != 0 (STEADY, HOLD_TIMED, FADE_IN, timed PULSE)
+    CYCLE,        // on = (elapsed % param_a) < param_b (FLASH, STROBE, PULSE)
+    WINDOW,       // on = elapsed < param_a (FADE_OUT)
+    AFTER,        // on = elapsed >= param_a (RAMP)
+    PATTERN       // param_a = index into the compiled pattern table
+};
+
+// Struct-of-arrays table of output slots indexed by OutputHandle. Written by
+// the engine; the synthesizer and UI read it directly.
+struct OutputTable {
+    static constexpr uint8_t kUsed = 0x01;
+    static constexpr uint8_t kActive = 0x02;          // Output is currently controlled
+    static constexpr uint8_t kOn = 0x04;              // Current ON/OFF state (for bitmap)
+    static constexpr uint8_t kSoftStart = 0x08;       // Soft-start ramp (Byte 2 in CAN frame)
+    static constexpr uint8_t kPwmEnable = 0x10;       // PWM for fade (Byte 3 in CAN frame)
+    static constexpr uint8_t kAutoOff = 0x20;
+    static constexpr uint8_t kAssertSoftStart = 0x40; // Behavior re-asserts kSoftStart each tick
+    static constexpr uint8_t kAssertPwm = 0x80;       // Behavior re-asserts kPwmEnable each tick
+
+    std::size_t count = 0;   // High-water mark: slots [0, count) may be in use
+
+    std::array<uint8_t, kMaxOutputs> flags{};
+    std::array<OutputKind, kMaxOutputs> kind{};
+    std::array<uint8_t, kMaxOutputs> cellAddress{};
+    std::array<uint8_t, kMaxOutputs> outputNumber{};
+    std::array<uint32_t, kMaxOutputs> activatedAt{};
+    std::array<uint32_t, kMaxOutputs> duration_ms{};
+    std::array<uint32_t, kMaxOutputs> param_a{};
+    std::array<uint32_t, kMaxOutputs> param_b{};
+
+    bool inUse(OutputHandle h) const { return h < count && (flags[h] & kUsed); }
+    bool active(OutputHandle h) const { return h < count && (flags[h] & kActive); }
+    bool on(OutputHandle h) const { return h < count && (flags[h] & kOn); }
+    bool softStart(OutputHandle h) const { return h < count && (flags[h] & kSoftStart); }
+    bool pwmEnable(OutputHandle h) const { return h < count && (flags[h] & kPwmEnable); }
+};
+
+// Per-cell view handed to the frame synthesizer for cells that changed.
+struct CellOutputs {
+    uint16_t onBitmap = 0;       // Bits 0-9 = outputs 1-10 ON
+    uint16_t activeBitmap = 0;   // Bits 0-9 = outputs 1-10 under engine control
+    uint32_t eventUs = 0;        // micros() of the first change not yet collected
+};
+
+// Pattern steps flattened to cumulative end times, one bit per step for ON.
+struct CompiledPattern {
+    bool loop = false;
+    uint8_t stepCount = 0;
+    uint32_t total_ms = 0;
+    uint32_t onBits = 0;
+    std::array<uint32_t, kMaxPatternSteps> stepEnd_ms{};
+};
+
 // ═══════════════════════════════════════════════════════════════════════════
 // SCENE DEFINITION
 // ═══════════════════════════════════════════════════════════════════════════
@@ -177,64 +257,220 @@ struct Scene {
     uint8_t priority = 100;
     bool exclusive = false;          // Deactivate other scenes when activated
     
-    // Activation state
+    // Activation state (engine-internal; other tasks use isSceneActive())
     bool isActive = false;
     unsigned long activatedAt = 0;
+
+    // Slot for the engine's control path, assigned by addScene()
+    SceneHandle handle = kInvalidSceneHandle;
+};
+
+// ═══════════════════════════════════════════════════════════════════════════
+// CROSS-TASK INTERFACE
+// ═══════════════════════════════════════════════════════════════════════════
+
+// Outcome of a control call. Converts to true only when the request was
+// accepted, so `if (engine.setBehavior(...))` reads as before; callers
+// that answer a client tell QueueFull (retry) from UnknownId.
+struct ControlResult {
+    enum Code : uint8_t { Accepted, UnknownId, QueueFull };
+
+    Code code = Accepted;
+
+    ControlResult(Code value = Accepted) : code(value) {}
+    operator bool() const { return code == Accepted; }
+};
+
+// Turn-on request posted by any task; the engine task applies it at the
+// start of its next update(). Turn-offs do not use the queue (see
+// BehaviorEngine), so a full queue can only refuse a turn-on.
+struct EngineCommand {
+    enum class Type : uint8_t { SetBehavior, ActivateScene };
+
+    Type type = Type::SetBehavior;
+    uint8_t target = kInvalidOutputHandle;  // OutputHandle or SceneHandle
+    BehaviorConfig behavior;                // SetBehavior only
+    int32_t sceneDuration_ms = -1;          // ActivateScene: new Scene::duration_ms, -1 = keep
+    uint32_t seq = 0;                       // Posting order across all control calls
+    uint32_t eventUs = 1;                   // micros() when posted; frame latency is measured from here
+};
+
+// What readers show for an output's current behavior; small and trivially
+// copyable so it can be published per output through a Seqlock
+struct LiveBehavior {
+    BehaviorType type = BehaviorType::STEADY;
+    uint8_t targetValue = 0;
+    uint8_t dutyCycle = 0;
+    uint8_t priority = 0;
+    uint16_t period_ms = 0;
+    uint16_t duration_ms = 0;
+};
+
+// Immutable copy of the configuration (outputs, scenes) for readers on
+// other tasks. Replaced as a whole on configuration changes only, never
+// modified once published; control calls do not touch it. Runtime state
+// comes from isOutputActive() / outputState() / outputBehavior() /
+// isSceneActive() instead of the copied behavior and isActive fields.
+struct EngineSnapshot {
+    std::map<String, OutputChannel> outputs;
+    std::map<String, Scene> scenes;
+    uint32_t version = 0;
+
+    const OutputChannel* findOutput(const String& id) const {
+        auto it = outputs.find(id);
+        return (it != outputs.end()) ? &it->second : nullptr;
+    }
+
+    const Scene* findScene(const String& id) const {
+        auto it = scenes.find(id);
+        return (it != scenes.end()) ? &it->second : nullptr;
+    }
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
 // BEHAVIOR ENGINE
 // ═══════════════════════════════════════════════════════════════════════════
 
+// Threading: the engine task (update(), takeDirtyCells(), outputTable()) owns
+// the runtime state. Other tasks
+//   - turn outputs and scenes on with setBehavior() / activateScene(), which
+//     post an EngineCommand to a lock-free queue and wake the engine task
+//     (never block on it); these fail with QueueFull when it is full;
+//   - turn them off with deactivateOutput() / deactivateAllOutputs() /
+//     deactivateScene(), which raise a per-target sequence number and a
+//     pending bit instead. Any number of offs coalesce into one, so they
+//     are never refused and a release can not leave an output stuck on;
+//   - read through snapshot() and the per-handle live state, which never
+//     touch the live maps;
+//   - change configuration (add/remove outputs, patterns, scenes) under the
+//     engine mutex. This is load- and API-time only and republishes the
+//     snapshot.
+// Every control call takes a sequence number; the engine applies a request
+// only if it is newer than the last opposite request for the same target,
+// so an off and an on posted from different tasks resolve in posting order.
+
 class BehaviorEngine {
 public:
-    BehaviorEngine() : _lastUpdate(0), _updateInterval(20) {}
+    static constexpr uint32_t kNoDeadline = UINT32_MAX;
+    static constexpr std::size_t kCommandQueueSize = 32;
+
+    BehaviorEngine() : _snapshot(std::make_shared<const EngineSnapshot>()) {}
 
     using SceneActionCallback = std::function<void(const Scene&)>;
+    using WakeCallback = std::function<void()>;
     
     // ───────────────────────────────────────────────────────────────────────
     // OUTPUT MANAGEMENT
     // ───────────────────────────────────────────────────────────────────────
     
-    void addOutput(const OutputChannel& output) {
-        _outputs[output.id] = output;
+    bool addOutput(const OutputChannel& output) {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto existing = _outputs.find(output.id);
+        OutputHandle handle = (existing != _outputs.end()) ? existing->second.handle : _allocateSlot();
+        if (handle == kInvalidOutputHandle) {
+            Serial.printf("[BehaviorEngine] addOutput failed: table full (%u outputs), '%s' not added\n",
+                          static_cast<unsigned>(kMaxOutputs), output.id.c_str());
+            return false;
+        }
+
+        OutputChannel& stored = _outputs[output.id];
+        stored = output;
+        stored.handle = handle;
+
+        // Replacing an output resets its runtime state, as before. Both the
+        // old and the new cell are re-synthesized.
+        const uint32_t eventUs = micros();
+        _markCellDirty(_table.cellAddress[handle], eventUs);
+        _table.flags[handle] = OutputTable::kUsed;
+        _table.cellAddress[handle] = stored.cellAddress;
+        _table.outputNumber[handle] = stored.outputNumber;
+        _compileSlot(handle, stored.behavior);
+        _deadlines.cancel(handle);
+        _slotEventUs[handle] = 0;
+        _slotOutputs[handle] = &stored;
+        _liveBehavior[handle].store(_liveFrom(stored.behavior));
+        _markCellDirty(stored.cellAddress, eventUs);
+        _publishLocked();
+        _wake();
+        return true;
     }
     
     void removeOutput(const String& id) {
-        _outputs.erase(id);
+        std::lock_guard<std::mutex> lock(_lock);
+        auto it = _outputs.find(id);
+        if (it == _outputs.end()) return;
+        _deadlines.cancel(it->second.handle);
+        _markCellDirty(_table.cellAddress[it->second.handle], micros());
+        _slotOutputs[it->second.handle] = nullptr;
+        _releaseSlot(it->second.handle);
+        _outputs.erase(it);
+        _publishLocked();
+        _wake();
     }
-    
-    OutputChannel* getOutput(const String& id) {
+
+    // String ID -> handle. Resolve once at configuration time, not per tick.
+    OutputHandle resolveOutput(const String& id) {
+        std::lock_guard<std::mutex> lock(_lock);
         auto it = _outputs.find(id);
-        return (it != _outputs.end()) ? &it->second : nullptr;
+        return (it != _outputs.end()) ? it->second.handle : kInvalidOutputHandle;
+    }
+
+    // Engine task only (the synthesizers run there)
+    const OutputTable& outputTable() const { return _table; }
+
+    // Live output state, any task: published by the engine task after every
+    // update(), so it may trail a just-posted command by one engine pass
+    bool isOutputActive(const OutputChannel& output) const { return _liveFlags(output.handle) & OutputTable::kActive; }
+    bool outputState(const OutputChannel& output) const { return _liveFlags(output.handle) & OutputTable::kOn; }
+    LiveBehavior outputBehavior(const OutputChannel& output) const {
+        return output.handle < kMaxOutputs ? _liveBehavior[output.handle].load() : LiveBehavior{};
     }
     
     // ───────────────────────────────────────────────────────────────────────
-    // BEHAVIOR CONTROL
+    // BEHAVIOR CONTROL (any task)
     // ───────────────────────────────────────────────────────────────────────
-    
-    bool setBehavior(const String& outputId, const BehaviorConfig& behavior) {
-        auto* output = getOutput(outputId);
+
+    // Control calls return without waiting for the engine task. They return
+    // UnknownId for an ID the current snapshot does not know; turn-ons also
+    // return QueueFull when the command queue is full. The handle overloads
+    // skip the ID lookup for callers that resolved once.
+
+    ControlResult setBehavior(const String& outputId, const BehaviorConfig& behavior) {
+        const auto current = snapshot();   // Keeps *output alive
+        const OutputChannel* output = current->findOutput(outputId);
         if (!output) {
             // Helpful debug: surface configuration problems early
             Serial.printf("[BehaviorEngine] setBehavior failed: unknown output '%s'\n", outputId.c_str());
-            return false;
+            return ControlResult::UnknownId;
         }
-        
-        output->behavior = behavior;
-        output->behavior.activatedAt = millis();
-        output->isActive = true;
-        
-        return true;
+        return setBehavior(output->handle, behavior);
+    }
+
+    ControlResult setBehavior(OutputHandle output, const BehaviorConfig& behavior) {
+        if (output >= kMaxOutputs) return ControlResult::UnknownId;
+        EngineCommand command;
+        command.type = EngineCommand::Type::SetBehavior;
+        command.target = output;
+        command.behavior = behavior;
+        return _post(command);
     }
     
-    bool deactivateOutput(const String& outputId) {
-        auto* output = getOutput(outputId);
-        if (!output) return false;
-        
-        output->isActive = false;
-        output->currentState = false;
-        return true;
+    ControlResult deactivateOutput(const String& outputId) {
+        const auto current = snapshot();   // Keeps *output alive
+        const OutputChannel* output = current->findOutput(outputId);
+        return output ? deactivateOutput(output->handle) : ControlResult::UnknownId;
+    }
+
+    ControlResult deactivateOutput(OutputHandle output) {
+        if (output >= kMaxOutputs) return ControlResult::UnknownId;
+        _postOff(_outputOff[output], _outputOffPending[output / 32], 1u << (output % 32));
+        return ControlResult::Accepted;
+    }
+
+    // One request for every output
+    ControlResult deactivateAllOutputs() {
+        _postOff(_allOff, _allOffPending, 1u);
+        return ControlResult::Accepted;
     }
     
     // ───────────────────────────────────────────────────────────────────────
@@ -242,12 +478,31 @@ public:
     // ───────────────────────────────────────────────────────────────────────
     
     void addPattern(const Pattern& pattern) {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto slot = _patternSlots.find(pattern.name);
+        uint8_t index = 0;
+        if (slot != _patternSlots.end()) {
+            index = slot->second;
+        } else if (_patternSlots.size() < kMaxPatterns) {
+            index = static_cast<uint8_t>(_patternSlots.size());
+            _patternSlots[pattern.name] = index;
+        } else {
+            Serial.printf("[BehaviorEngine] addPattern failed: table full, '%s' not added\n", pattern.name.c_str());
+            return;
+        }
         _patterns[pattern.name] = pattern;
-    }
-    
-    Pattern* getPattern(const String& name) {
-        auto it = _patterns.find(name);
-        return (it != _patterns.end()) ? &it->second : nullptr;
+        _compilePattern(_patternTable[index], pattern);
+
+        // Outputs that referenced the name before it existed now resolve
+        for (auto& [id, output] : _outputs) {
+            if (output.behavior.type == BehaviorType::PATTERN && output.behavior.patternName == pattern.name) {
+                _compileSlot(output.handle, output.behavior);
+                if (_table.active(output.handle)) {
+                    _deadlines.schedule(output.handle, millis());
+                }
+            }
+        }
+        _wake();
     }
     
     // ───────────────────────────────────────────────────────────────────────
@@ -255,75 +510,67 @@ public:
     // ───────────────────────────────────────────────────────────────────────
     
     void addScene(const Scene& scene) {
-        _scenes[scene.id] = scene;
+        std::lock_guard<std::mutex> lock(_lock);
+        auto existing = _scenes.find(scene.id);
+        SceneHandle handle = (existing != _scenes.end()) ? existing->second.handle : _allocateScene();
+        if (handle == kInvalidSceneHandle) {
+            Serial.printf("[BehaviorEngine] addScene failed: table full (%u scenes), '%s' not added\n",
+                          static_cast<unsigned>(kMaxScenes), scene.id.c_str());
+            return;
+        }
+
+        Scene& stored = _scenes[scene.id];
+        stored = scene;
+        stored.handle = handle;
+        _sceneSlots[handle] = &stored;
+        _sceneLive[handle].store(stored.isActive, std::memory_order_relaxed);
+        _updateSceneExpiry();
+        _publishLocked();
     }
     
     void removeScene(const String& id) {
-        _scenes.erase(id);
+        std::lock_guard<std::mutex> lock(_lock);
+        auto it = _scenes.find(id);
+        if (it == _scenes.end()) return;
+        _sceneSlots[it->second.handle] = nullptr;
+        _sceneLive[it->second.handle].store(false, std::memory_order_relaxed);
+        _scenes.erase(it);
+        _updateSceneExpiry();
+        _publishLocked();
     }
-    
-    bool activateScene(const String& sceneId) {
-        auto it = _scenes.find(sceneId);
-        if (it == _scenes.end()) return false;
-        
-        Scene& scene = it->second;
-        
-        // Handle exclusivity
-        if (scene.exclusive) {
-            for (auto& [id, s] : _scenes) {
-                if (id != sceneId) s.isActive = false;
-            }
-        }
-        
-        scene.isActive = true;
-        scene.activatedAt = millis();
-        
-        // Apply scene outputs
-        for (const auto& sceneOutput : scene.outputs) {
-            String action = sceneOutput.action;
-            action.toLowerCase();
-
-            if (action == "off") {
-                deactivateOutput(sceneOutput.outputId);
-                continue;
-            }
 
-            if (action == "on" || action == "dim") {
-                BehaviorConfig applied = sceneOutput.behavior;
-                applied.type = BehaviorType::STEADY;
-                applied.targetValue = (action == "on") ? 255 : applied.targetValue;
-                setBehavior(sceneOutput.outputId, applied);
-                continue;
-            }
-
-            setBehavior(sceneOutput.outputId, sceneOutput.behavior);
-        }
-
-        if (_sceneActivatedCallback) {
-            _sceneActivatedCallback(scene);
-        }
-        
-        return true;
+    // Live activation state, any task; trails a just-posted call by one
+    // engine pass like isOutputActive()
+    bool isSceneActive(const Scene& scene) const {
+        return scene.handle < kMaxScenes && _sceneLive[scene.handle].load(std::memory_order_relaxed);
     }
     
-    bool deactivateScene(const String& sceneId) {
-        auto it = _scenes.find(sceneId);
-        if (it == _scenes.end()) return false;
-        
-        Scene& scene = it->second;
-        scene.isActive = false;
-        
-        // Deactivate all outputs in this scene
-        for (const auto& sceneOutput : scene.outputs) {
-            deactivateOutput(sceneOutput.outputId);
-        }
-
-        if (_sceneDeactivatedCallback) {
-            _sceneDeactivatedCallback(scene);
-        }
-        
-        return true;
+    // Posted like setBehavior(). A duration >= 0 replaces the scene's
+    // duration_ms first. Scene callbacks run on the engine task after the
+    // engine lock is released (they reach into other subsystems that may
+    // post back into the engine).
+    ControlResult activateScene(const String& sceneId, int32_t duration_ms = -1) {
+        const auto current = snapshot();   // Keeps *scene alive
+        const Scene* scene = current->findScene(sceneId);
+        if (!scene || scene->handle >= kMaxScenes) return ControlResult::UnknownId;
+        EngineCommand command;
+        command.type = EngineCommand::Type::ActivateScene;
+        command.target = scene->handle;
+        command.sceneDuration_ms = duration_ms;
+        return _post(command);
     }
+    
+    // Never refused, like deactivateOutput()
+    ControlResult deactivateScene(const String& sceneId) {
+        const auto current = snapshot();   // Keeps *scene alive
+        const Scene* scene = current->findScene(sceneId);
+        if (!scene || scene->handle >= kMaxScenes) return ControlResult::UnknownId;
+        _postOff(_sceneOff[scene->handle], _sceneOffPending, 1u << scene->handle);
+        return ControlResult::Accepted;
+    }
+
+    // Turn-ons refused because the queue was full
+    uint32_t commandDrops() const { return _commands.drops(); }
 
     void setSceneActivatedCallback(SceneActionCallback callback) {
         _sceneActivatedCallback = callback;
@@ -332,60 +579,117 @@ public:
     void setSceneDeactivatedCallback(SceneActionCallback callback) {
         _sceneDeactivatedCallback = callback;
     }
+
+    // Called (from any task) when a configuration change moves the next
+    // deadline earlier; the owner of the engine task uses it to wake up.
+    void setWakeCallback(WakeCallback callback) {
+        _wakeCallback = callback;
+    }
     
     // ───────────────────────────────────────────────────────────────────────
     // CORE ENGINE LOOP
     // ───────────────────────────────────────────────────────────────────────
     
+    // Applies posted commands, then evaluates only the outputs (and timed
+    // scenes) whose next transition is due; each evaluation computes that
+    // output's following transition. Cheap to call at any rate: nothing
+    // posted and nothing due means nothing done. Engine task only.
     void update() {
-        unsigned long now = millis();
-        
-        // Throttle updates
-        if (now - _lastUpdate < _updateInterval) return;
-        _lastUpdate = now;
-        
-        // Update all active outputs
-        for (auto& [id, output] : _outputs) {
-            if (output.isActive) {
-                _updateOutput(output, now);
+        std::vector<std::pair<bool, Scene>> sceneEvents;   // (activated, scene), in order
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _applyCommandsLocked(sceneEvents);
+            const uint32_t now = millis();
+
+            while (!_deadlines.empty() && !DeadlineHeap<kMaxOutputs>::before(now, _deadlines.topDeadline())) {
+                const OutputHandle h = static_cast<OutputHandle>(_deadlines.topId());
+                const uint32_t due = _deadlines.topDeadline();
+                _deadlines.pop();
+                if (_table.flags[h] & OutputTable::kActive) {
+                    _tickSlot(h, now, due);
+                }
             }
-        }
-        
-        // Update scenes (check for duration expiry)
-        for (auto& [id, scene] : _scenes) {
-            if (scene.isActive && scene.duration_ms > 0) {
-                if (now - scene.activatedAt >= scene.duration_ms) {
-                    deactivateScene(id);
+
+            // Update scenes (check for duration expiry)
+            if (_sceneExpiryPending && !DeadlineHeap<kMaxOutputs>::before(now, _sceneExpiry)) {
+                for (auto& [id, scene] : _scenes) {
+                    if (scene.isActive && scene.duration_ms > 0 && now - scene.activatedAt >= scene.duration_ms) {
+                        _deactivateSceneLocked(scene, micros() | 1u, _nextSeq());
+                        if (_sceneDeactivatedCallback) sceneEvents.emplace_back(false, scene);
+                    }
                 }
             }
+
+            _publishLiveFlagsLocked();
+        }
+
+        for (const auto& [activated, scene] : sceneEvents) {
+            if (activated) {
+                if (_sceneActivatedCallback) _sceneActivatedCallback(scene);
+            } else if (_sceneDeactivatedCallback) {
+                _sceneDeactivatedCallback(scene);
+            }
         }
     }
-    
-    void setUpdateInterval(uint16_t interval_ms) {
-        _updateInterval = interval_ms;
+
+    // Milliseconds from now until update() has work, or kNoDeadline.
+    uint32_t msUntilNextDeadline(uint32_t now) {
+        if (_commands.size() != 0 || _offsPending()) return 0;
+        std::lock_guard<std::mutex> lock(_lock);
+        uint32_t next = kNoDeadline;
+        if (!_deadlines.empty()) {
+            next = _untilDeadline(now, _deadlines.topDeadline());
+        }
+        if (_sceneExpiryPending) {
+            const uint32_t scene = _untilDeadline(now, _sceneExpiry);
+            if (scene < next) next = scene;
+        }
+        return next;
+    }
+
+    // Cells (bit n = cell address n) whose outputs turned on/off or
+    // gained/lost engine control since the last call. Their current state is
+    // written to cells[address]; other entries are left untouched.
+    uint32_t takeDirtyCells(std::array<CellOutputs, kMaxCellAddress + 1>& cells) {
+        std::lock_guard<std::mutex> lock(_lock);
+        const uint32_t dirty = _dirtyCells;
+        if (!dirty) return 0;
+        _dirtyCells = 0;
+
+        for (uint8_t cell = 1; cell <= kMaxCellAddress; ++cell) {
+            if (dirty & (1u << cell)) {
+                cells[cell].onBitmap = 0;
+                cells[cell].activeBitmap = 0;
+                cells[cell].eventUs = _cellEventUs[cell];
+            }
+        }
+        for (std::size_t h = 0; h < _table.count; ++h) {
+            const uint8_t cell = _table.cellAddress[h];
+            const uint8_t out = _table.outputNumber[h];
+            if (!_table.inUse(h) || cell < 1 || cell > kMaxCellAddress || !(dirty & (1u << cell))) continue;
+            if (out < 1 || out > kOutputsPerCell) continue;
+            const uint16_t bit = static_cast<uint16_t>(1u << (out - 1));
+            if (_table.flags[h] & OutputTable::kOn) cells[cell].onBitmap |= bit;
+            if (_table.flags[h] & OutputTable::kActive) cells[cell].activeBitmap |= bit;
+        }
+        return dirty;
     }
     
     // ───────────────────────────────────────────────────────────────────────
-    // STATE RETRIEVAL
+    // STATE RETRIEVAL (any task)
     // ───────────────────────────────────────────────────────────────────────
-    
-    const std::map<String, OutputChannel>& getOutputs() const {
-        return _outputs;
-    }
-    
-    const std::map<String, Scene>& getScenes() const {
-        return _scenes;
-    }
 
-    Scene* getScene(const String& id) {
-        auto it = _scenes.find(id);
-        return (it != _scenes.end()) ? &it->second : nullptr;
+    // The current configuration snapshot. Holding the pointer keeps that
+    // version alive; it never changes underneath the reader.
+    std::shared_ptr<const EngineSnapshot> snapshot() const {
+        return std::atomic_load_explicit(&_snapshot, std::memory_order_acquire);
     }
     
     // Helper methods for checking if outputs/scenes exist
     std::vector<String> getAllOutputs() const {
         std::vector<String> ids;
-        for (const auto& [id, output] : _outputs) {
+        const auto current = snapshot();
+        for (const auto& [id, output] : current->outputs) {
             ids.push_back(id);
         }
         return ids;
@@ -393,166 +697,621 @@ public:
     
     std::vector<String> getAllScenes() const {
         std::vector<String> ids;
-        for (const auto& [id, scene] : _scenes) {
+        const auto current = snapshot();
+        for (const auto& [id, scene] : current->scenes) {
             ids.push_back(id);
         }
         return ids;
     }
 
 private:
+    // Configuration (String keyed, touched only by config/API calls)
     std::map<String, OutputChannel> _outputs;
     std::map<String, Pattern> _patterns;
+    std::map<String, uint8_t> _patternSlots;
     std::map<String, Scene> _scenes;
-    
-    unsigned long _lastUpdate;
-    uint16_t _updateInterval;
+
+    // Runtime (ticked by update())
+    OutputTable _table;
+    std::array<OutputChannel*, kMaxOutputs> _slotOutputs{};     // Into _outputs, by handle
+    std::array<Scene*, kMaxScenes> _sceneSlots{};               // Into _scenes, by handle
+    std::array<CompiledPattern, kMaxPatterns> _patternTable{};
+    DeadlineHeap<kMaxOutputs> _deadlines;       // Next transition per active output
+    uint32_t _sceneExpiry = 0;                  // Earliest timed-scene expiry
+    bool _sceneExpiryPending = false;
+    std::array<uint32_t, kMaxOutputs> _slotEventUs{};           // Pending input event (0 = none)
+    uint32_t _dirtyCells = 0;                                   // Bit n = cell address n
+    std::array<uint32_t, kMaxCellAddress + 1> _cellEventUs{};
+
+    // Sequence numbers of the last on/off applied per target (see _stale)
+    std::array<uint32_t, kMaxOutputs> _setSeq{};
+    std::array<uint32_t, kMaxOutputs> _offSeq{};
+    std::array<uint32_t, kMaxScenes> _sceneOnSeq{};
+    std::array<uint32_t, kMaxScenes> _sceneOffSeq{};
+
+    // Guards all of the above between the engine task and configuration
+    // calls. Control calls never take it.
+    std::mutex _lock;
+
+    // Newest turn-off request for one target. Posters raise seq and then set
+    // the target's pending bit; the engine takes the bits and reads seq.
+    struct OffRequest {
+        std::atomic<uint32_t> seq{0};
+        std::atomic<uint32_t> eventUs{0};
+    };
+
+    static constexpr std::size_t kOutputWords = (kMaxOutputs + 31) / 32;
+    static constexpr uint32_t kSeqHorizon = 1u << 30;
+
+    // Cross-task interface: turn-ons and off requests in, snapshot and live
+    // state out
+    std::atomic<uint32_t> _postSeq{0};
+    MpscRing<EngineCommand, kCommandQueueSize> _commands;
+    std::array<OffRequest, kMaxOutputs> _outputOff;
+    std::array<std::atomic<uint32_t>, kOutputWords> _outputOffPending{};
+    std::array<OffRequest, kMaxScenes> _sceneOff;
+    std::atomic<uint32_t> _sceneOffPending{0};
+    OffRequest _allOff;
+    std::atomic<uint32_t> _allOffPending{0};
+    std::shared_ptr<const EngineSnapshot> _snapshot;    // atomic_load / atomic_store only
+    std::array<std::atomic<uint8_t>, kMaxOutputs> _published{};
+    std::array<Seqlock<LiveBehavior>, kMaxOutputs> _liveBehavior;   // Stored under _lock only
+    std::array<std::atomic<bool>, kMaxScenes> _sceneLive{};
 
     SceneActionCallback _sceneActivatedCallback;
     SceneActionCallback _sceneDeactivatedCallback;
-    
+    WakeCallback _wakeCallback;
+
+    void _wake() {
+        if (_wakeCallback) _wakeCallback();
+    }
+
+    uint32_t _nextSeq() {
+        return _postSeq.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    ControlResult _post(EngineCommand& command) {
+        command.seq = _nextSeq();
+        command.eventUs = micros() | 1u;
+        if (!_commands.push(command)) return ControlResult::QueueFull;
+        _wake();
+        return ControlResult::Accepted;
+    }
+
+    void _postOff(OffRequest& request, std::atomic<uint32_t>& pending, uint32_t bit) {
+        const uint32_t seq = _nextSeq();
+        request.eventUs.store(micros() | 1u, std::memory_order_relaxed);
+        uint32_t current = request.seq.load(std::memory_order_relaxed);
+        while (static_cast<int32_t>(seq - current) > 0 &&
+               !request.seq.compare_exchange_weak(current, seq, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+        }
+        pending.fetch_or(bit, std::memory_order_release);
+        _wake();
+    }
+
+    bool _offsPending() const {
+        if (_allOffPending.load(std::memory_order_relaxed) || _sceneOffPending.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        for (const auto& word : _outputOffPending) {
+            if (word.load(std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    // True if a request numbered `seq` lost to the opposite request last
+    // applied to the same target (`applied`). Numbers wrap; a record more
+    // than kSeqHorizon posts old can no longer race anything and loses.
+    bool _stale(uint32_t seq, uint32_t applied) const {
+        if (_postSeq.load(std::memory_order_relaxed) - applied > kSeqHorizon) return false;
+        return static_cast<int32_t>(seq - applied) < 0;
+    }
+
+    static LiveBehavior _liveFrom(const BehaviorConfig& cfg) {
+        LiveBehavior live;
+        live.type = cfg.type;
+        live.targetValue = cfg.targetValue;
+        live.dutyCycle = cfg.dutyCycle;
+        live.priority = cfg.priority;
+        live.period_ms = cfg.period_ms;
+        live.duration_ms = cfg.duration_ms;
+        return live;
+    }
+
+    void _setSceneActive(Scene& scene, bool active) {
+        scene.isActive = active;
+        if (scene.handle < kMaxScenes) _sceneLive[scene.handle].store(active, std::memory_order_relaxed);
+    }
+
+    uint8_t _liveFlags(OutputHandle h) const {
+        return h < kMaxOutputs ? _published[h].load(std::memory_order_relaxed) : 0;
+    }
+
     // ───────────────────────────────────────────────────────────────────────
-    // BEHAVIOR COMPUTATION
+    // COMMANDS AND PUBLICATION (engine lock held)
     // ───────────────────────────────────────────────────────────────────────
-    
-    void _updateOutput(OutputChannel& output, unsigned long now) {
-        const BehaviorConfig& behavior = output.behavior;
-        unsigned long elapsed = now - behavior.activatedAt;
 
-        // Reset per-loop attributes so behaviors can re-assert as needed
-        output.softStart = false;
-        output.pwmEnable = false;
+    // Off requests first, then the queued turn-ons; sequence numbers keep
+    // the outcome in posting order either way
+    void _applyCommandsLocked(std::vector<std::pair<bool, Scene>>& sceneEvents) {
+        if (_allOffPending.exchange(0, std::memory_order_acquire)) {
+            const uint32_t seq = _allOff.seq.load(std::memory_order_acquire);
+            const uint32_t eventUs = _allOff.eventUs.load(std::memory_order_relaxed);
+            for (std::size_t h = 0; h < _table.count; ++h) {
+                _deactivateOutputLocked(static_cast<OutputHandle>(h), eventUs, seq);
+            }
+        }
+        for (std::size_t word = 0; word < kOutputWords; ++word) {
+            uint32_t bits = _outputOffPending[word].exchange(0, std::memory_order_acquire);
+            while (bits) {
+                const OutputHandle h = static_cast<OutputHandle>(word * 32 + __builtin_ctz(bits));
+                bits &= bits - 1;
+                _deactivateOutputLocked(h, _outputOff[h].eventUs.load(std::memory_order_relaxed),
+                                        _outputOff[h].seq.load(std::memory_order_acquire));
+            }
+        }
+        uint32_t scenes = _sceneOffPending.exchange(0, std::memory_order_acquire);
+        while (scenes) {
+            const SceneHandle s = static_cast<SceneHandle>(__builtin_ctz(scenes));
+            scenes &= scenes - 1;
+            Scene* scene = _sceneSlots[s];
+            if (scene && _deactivateSceneLocked(*scene, _sceneOff[s].eventUs.load(std::memory_order_relaxed),
+                                                _sceneOff[s].seq.load(std::memory_order_acquire))) {
+                if (_sceneDeactivatedCallback) sceneEvents.emplace_back(false, *scene);
+            }
+        }
+
+        EngineCommand command;
+        while (_commands.pop(command)) {
+            switch (command.type) {
+                case EngineCommand::Type::SetBehavior:
+                    _setBehaviorLocked(command.target, command.behavior, command.eventUs, command.seq);
+                    break;
+                case EngineCommand::Type::ActivateScene:
+                    if (Scene* scene = _activateSceneLocked(command.target, command.sceneDuration_ms,
+                                                            command.eventUs, command.seq)) {
+                        if (_sceneActivatedCallback) sceneEvents.emplace_back(true, *scene);
+                    }
+                    break;
+            }
+        }
+    }
+
+    // Replaces the snapshot with a copy of the current configuration
+    void _publishLocked() {
+        auto next = std::make_shared<EngineSnapshot>();
+        next->outputs = _outputs;
+        next->scenes = _scenes;
+        next->version = snapshot()->version + 1;
+        std::atomic_store_explicit(&_snapshot, std::shared_ptr<const EngineSnapshot>(std::move(next)),
+                                   std::memory_order_release);
+    }
+
+    void _publishLiveFlagsLocked() {
+        constexpr uint8_t kLiveBits = OutputTable::kUsed | OutputTable::kActive | OutputTable::kOn;
+        for (std::size_t h = 0; h < kMaxOutputs; ++h) {
+            const uint8_t live = h < _table.count ? (_table.flags[h] & kLiveBits) : 0;
+            if (_published[h].load(std::memory_order_relaxed) != live) {
+                _published[h].store(live, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool _setBehaviorLocked(OutputHandle h, const BehaviorConfig& behavior, uint32_t eventUs, uint32_t seq) {
+        if (h >= kMaxOutputs || !_slotOutputs[h] || _stale(seq, _offSeq[h])) return false;
+        OutputChannel& output = *_slotOutputs[h];
+        _setSeq[h] = seq;
+
+        const uint32_t now = millis();
+        const bool wasActive = _table.active(h);
+        output.behavior = behavior;
+        output.behavior.activatedAt = now;
+        _compileSlot(h, output.behavior);
+        _table.flags[h] |= OutputTable::kActive;
+        _liveBehavior[h].store(_liveFrom(behavior));
+
+        // First evaluation runs here so the state is never stale; it also
+        // schedules the next transition. The cell's frame carries the time
+        // the command was posted.
+        _slotEventUs[h] = eventUs;
+        _tickSlot(h, now, now);
+        if (!wasActive) {
+            _markCellDirty(_table.cellAddress[h], eventUs);
+        }
+        return true;
+    }
+
+    bool _deactivateOutputLocked(OutputHandle h, uint32_t eventUs, uint32_t seq) {
+        if (!_table.inUse(h) || _stale(seq, _setSeq[h])) return false;
+        if (!_stale(seq, _offSeq[h])) _offSeq[h] = seq;
+
+        const uint8_t before = _table.flags[h];
+        _table.flags[h] &= static_cast<uint8_t>(~(OutputTable::kActive | OutputTable::kOn));
+        _deadlines.cancel(h);
+        if (_table.flags[h] != before) {
+            // Final OFF frame goes out on this pass, not on the keepalive cadence
+            _markCellDirty(_table.cellAddress[h], eventUs);
+        }
+        return true;
+    }
+
+    // Scene members are named by ID; scenes are applied at human rates
+    OutputHandle _findOutputLocked(const String& outputId) const {
+        auto it = _outputs.find(outputId);
+        return (it != _outputs.end()) ? it->second.handle : kInvalidOutputHandle;
+    }
+
+    static uint32_t _untilDeadline(uint32_t now, uint32_t deadline) {
+        return DeadlineHeap<kMaxOutputs>::before(now, deadline) ? deadline - now : 0;
+    }
+
+    // ───────────────────────────────────────────────────────────────────────
+    // SCENES (engine lock held)
+    // ───────────────────────────────────────────────────────────────────────
+
+    Scene* _activateSceneLocked(SceneHandle s, int32_t duration_ms, uint32_t eventUs, uint32_t seq) {
+        Scene* found = s < kMaxScenes ? _sceneSlots[s] : nullptr;
+        if (!found || _stale(seq, _sceneOffSeq[s])) return nullptr;
+        _sceneOnSeq[s] = seq;
         
-        // Check duration expiry
-        if (behavior.duration_ms > 0 && elapsed >= behavior.duration_ms) {
-            if (behavior.autoOff) {
-                output.isActive = false;
-                output.currentState = false;
+        Scene& scene = *found;
+        if (duration_ms >= 0) {
+            scene.duration_ms = static_cast<uint16_t>(duration_ms);
+        }
+        
+        // Handle exclusivity
+        if (scene.exclusive) {
+            for (auto& [id, other] : _scenes) {
+                if (&other != &scene) _setSceneActive(other, false);
             }
-            return;
         }
         
-        // Compute current value based on behavior type
-        switch (behavior.type) {
+        _setSceneActive(scene, true);
+        scene.activatedAt = millis();
+        
+        // Apply scene outputs
+        for (const auto& sceneOutput : scene.outputs) {
+            const OutputHandle h = _findOutputLocked(sceneOutput.outputId);
+            if (h == kInvalidOutputHandle) {
+                Serial.printf("[BehaviorEngine] Scene '%s': unknown output '%s'\n", scene.id.c_str(),
+                              sceneOutput.outputId.c_str());
+                continue;
+            }
+
+            String action = sceneOutput.action;
+            action.toLowerCase();
+
+            if (action == "off") {
+                _deactivateOutputLocked(h, eventUs, seq);
+                continue;
+            }
+
+            if (action == "on" || action == "dim") {
+                BehaviorConfig applied = sceneOutput.behavior;
+                applied.type = BehaviorType::STEADY;
+                applied.targetValue = (action == "on") ? 255 : applied.targetValue;
+                _setBehaviorLocked(h, applied, eventUs, seq);
+                continue;
+            }
+
+            _setBehaviorLocked(h, sceneOutput.behavior, eventUs, seq);
+        }
+
+        _updateSceneExpiry();
+        return &scene;
+    }
+
+    bool _deactivateSceneLocked(Scene& scene, uint32_t eventUs, uint32_t seq) {
+        const SceneHandle s = scene.handle;
+        if (s >= kMaxScenes || _stale(seq, _sceneOnSeq[s])) return false;
+        if (!_stale(seq, _sceneOffSeq[s])) _sceneOffSeq[s] = seq;
+        _setSceneActive(scene, false);
+        
+        // Deactivate all outputs in this scene
+        for (const auto& sceneOutput : scene.outputs) {
+            const OutputHandle h = _findOutputLocked(sceneOutput.outputId);
+            if (h != kInvalidOutputHandle) _deactivateOutputLocked(h, eventUs, seq);
+        }
+        _updateSceneExpiry();
+        return true;
+    }
+
+    // Scene changes are configuration-time; a scan of the scene map is fine
+    void _updateSceneExpiry() {
+        const bool wasPending = _sceneExpiryPending;
+        const uint32_t previous = _sceneExpiry;
+        _sceneExpiryPending = false;
+        for (const auto& [id, scene] : _scenes) {
+            if (!scene.isActive || scene.duration_ms == 0) continue;
+            const uint32_t expiry = static_cast<uint32_t>(scene.activatedAt) + scene.duration_ms;
+            if (!_sceneExpiryPending || DeadlineHeap<kMaxOutputs>::before(expiry, _sceneExpiry)) {
+                _sceneExpiry = expiry;
+                _sceneExpiryPending = true;
+            }
+        }
+        if (_sceneExpiryPending && (!wasPending || DeadlineHeap<kMaxOutputs>::before(_sceneExpiry, previous))) {
+            _wake();
+        }
+    }
+    
+    // ───────────────────────────────────────────────────────────────────────
+    // SLOT ALLOCATION
+    // ───────────────────────────────────────────────────────────────────────
+
+    OutputHandle _allocateSlot() {
+        for (std::size_t h = 0; h < kMaxOutputs; ++h) {
+            if (!(_table.flags[h] & OutputTable::kUsed)) {
+                if (h >= _table.count) _table.count = h + 1;
+                return static_cast<OutputHandle>(h);
+            }
+        }
+        return kInvalidOutputHandle;
+    }
+
+    SceneHandle _allocateScene() const {
+        for (std::size_t s = 0; s < kMaxScenes; ++s) {
+            if (!_sceneSlots[s]) return static_cast<SceneHandle>(s);
+        }
+        return kInvalidSceneHandle;
+    }
+
+    void _releaseSlot(OutputHandle h) {
+        if (h >= _table.count) return;
+        _table.flags[h] = 0;
+        while (_table.count > 0 && !(_table.flags[_table.count - 1] & OutputTable::kUsed)) {
+            --_table.count;
+        }
+    }
+
+    // ───────────────────────────────────────────────────────────────────────
+    // BEHAVIOR COMPILATION (configuration time)
+    // ───────────────────────────────────────────────────────────────────────
+
+    static void _compilePattern(CompiledPattern& out, const Pattern& pattern) {
+        out = CompiledPattern{};
+        out.loop = pattern.loop;
+        if (pattern.steps.size() > kMaxPatternSteps) {
+            Serial.printf("[BehaviorEngine] Pattern '%s' truncated to %u steps\n", pattern.name.c_str(),
+                          static_cast<unsigned>(kMaxPatternSteps));
+        }
+        for (const auto& step : pattern.steps) {
+            if (out.stepCount >= kMaxPatternSteps) break;
+            out.total_ms += step.duration_ms;
+            out.stepEnd_ms[out.stepCount] = out.total_ms;
+            if (step.value > 0) out.onBits |= (1u << out.stepCount);
+            ++out.stepCount;
+        }
+    }
+
+    // Reduce a BehaviorConfig to the slot's kind/parameters. Keeps the
+    // slot's kActive bit; resets the per-tick outputs.
+    void _compileSlot(OutputHandle h, const BehaviorConfig& cfg) {
+        if (h >= kMaxOutputs) return;
+
+        uint8_t flags = _table.flags[h] & (OutputTable::kUsed | OutputTable::kActive | OutputTable::kOn);
+        if (cfg.autoOff) flags |= OutputTable::kAutoOff;
+
+        OutputKind kind = OutputKind::CONST;
+        uint32_t a = 0;
+        uint32_t b = 0;
+
+        switch (cfg.type) {
             case BehaviorType::STEADY:
-                output.currentState = (behavior.targetValue > 0);
-                output.softStart = behavior.softStart;
+                a = cfg.targetValue > 0;
+                if (cfg.softStart) flags |= OutputTable::kAssertSoftStart;
                 break;
-                
+
+            case BehaviorType::HOLD_TIMED:
+                a = cfg.targetValue > 0;
+                break;
+
             case BehaviorType::FLASH:
-                output.currentState = _computeFlash(behavior, elapsed);
+                kind = OutputKind::CYCLE;
+                a = cfg.period_ms;
+                b = (static_cast<uint32_t>(cfg.period_ms) * cfg.dutyCycle) / 100;
                 break;
-                
+
             case BehaviorType::PULSE:
-                output.currentState = _computePulse(behavior, elapsed);
+                if (cfg.duration_ms > 0) {
+                    a = 1;  // Timed one-shot: ON until the duration expires
+                } else {
+                    kind = OutputKind::CYCLE;
+                    a = (cfg.period_ms > 0) ? cfg.period_ms : 1000;
+                    b = a / 2;
+                }
                 break;
-                
+
             case BehaviorType::FADE_IN:
-                output.currentState = _computeFadeIn(behavior, elapsed);
-                output.softStart = true;  // Enable soft-start for fade
-                output.pwmEnable = true;
+                // POWERCELL NGX: ON with soft-start; the module does the ramp
+                a = 1;
+                flags |= OutputTable::kAssertSoftStart | OutputTable::kAssertPwm;
                 break;
-                
+
             case BehaviorType::FADE_OUT:
-                output.currentState = _computeFadeOut(behavior, elapsed);
-                output.pwmEnable = true;
+                // No native fade-out: stay ON for the fade time, then OFF
+                kind = OutputKind::WINDOW;
+                a = cfg.fadeTime_ms;
+                flags |= OutputTable::kAssertPwm;
                 break;
-                
-            case BehaviorType::STROBE:
-                output.currentState = _computeStrobe(behavior, elapsed);
-                break;
-                
-            case BehaviorType::PATTERN:
-                output.currentState = _computePattern(behavior, elapsed);
+
+            case BehaviorType::STROBE: {
+                const uint32_t onTime = cfg.onTime_ms > 0 ? cfg.onTime_ms : 50;
+                const uint32_t offTime = cfg.offTime_ms > 0 ? cfg.offTime_ms : 50;
+                kind = OutputKind::CYCLE;
+                a = onTime + offTime;
+                b = onTime;
                 break;
-                
-            case BehaviorType::HOLD_TIMED:
-                output.currentState = (behavior.targetValue > 0);
+            }
+
+            case BehaviorType::PATTERN: {
+                auto slot = _patternSlots.find(cfg.patternName);
+                if (slot != _patternSlots.end() && _patternTable[slot->second].stepCount > 0) {
+                    kind = OutputKind::PATTERN;
+                    a = slot->second;
+                }
                 break;
-                
+            }
+
             case BehaviorType::RAMP:
-                output.currentState = _computeRamp(behavior, elapsed);
-                output.softStart = true;  // Enable soft-start for ramp
-                output.pwmEnable = true;
+                // Level crosses 1/255 once target * elapsed >= fadeTime
+                kind = OutputKind::AFTER;
+                if (cfg.targetValue == 0) {
+                    kind = OutputKind::CONST;
+                } else if (cfg.fadeTime_ms > 0) {
+                    a = (cfg.fadeTime_ms + cfg.targetValue - 1) / cfg.targetValue;
+                }
+                flags |= OutputTable::kAssertSoftStart | OutputTable::kAssertPwm;
                 break;
-                
+
             default:
-                output.currentState = false;
                 break;
         }
+
+        _table.flags[h] = flags;
+        _table.kind[h] = kind;
+        _table.activatedAt[h] = static_cast<uint32_t>(cfg.activatedAt);
+        _table.duration_ms[h] = cfg.duration_ms;
+        _table.param_a[h] = a;
+        _table.param_b[h] = b;
     }
-    
-    bool _computeFlash(const BehaviorConfig& cfg, unsigned long elapsed) {
-        unsigned long cyclePos = elapsed % cfg.period_ms;
-        unsigned long onDuration = (cfg.period_ms * cfg.dutyCycle) / 100;
-        return (cyclePos < onDuration);
-    }
-    
-    bool _computePulse(const BehaviorConfig& cfg, unsigned long elapsed) {
-        // Two modes:
-        //  1) Timed pulse (duration_ms > 0): behave like HOLD_TIMED
-        //  2) Continuous pulse (duration_ms == 0): toggle ON/OFF over period_ms
 
-        // Timed one-shot pulse
-        if (cfg.duration_ms > 0) {
-            return (elapsed < cfg.duration_ms);
+    // ───────────────────────────────────────────────────────────────────────
+    // BEHAVIOR COMPUTATION (per tick)
+    // ───────────────────────────────────────────────────────────────────────
+
+    void _markCellDirty(uint8_t cell, uint32_t eventUs) {
+        if (cell < 1 || cell > kMaxCellAddress) return;
+        const uint32_t bit = 1u << cell;
+        if (!(_dirtyCells & bit)) {
+            _dirtyCells |= bit;
+            _cellEventUs[cell] = eventUs;
         }
+    }
 
-        // Continuous pulse using period_ms (fallback to 1000ms if misconfigured)
-        const unsigned long period = (cfg.period_ms > 0) ? cfg.period_ms : 1000;
-        const unsigned long cyclePos = elapsed % period;
+    // Evaluates one output at `now` (its deadline was `due`) and schedules
+    // its next transition. A changed ON/active state marks the cell dirty,
+    // stamped with the input event that caused it or else the deadline.
+    void _tickSlot(OutputHandle h, uint32_t now, uint32_t due) {
+        const uint8_t previous = _table.flags[h];
+        _evaluateSlot(h, now);
+        constexpr uint8_t kFrameBits = OutputTable::kActive | OutputTable::kOn;
+        if ((previous ^ _table.flags[h]) & kFrameBits) {
+            _markCellDirty(_table.cellAddress[h], _slotEventUs[h] ? _slotEventUs[h] : due * 1000u);
+        }
+        _slotEventUs[h] = 0;
 
-        // Simple 50% duty pulse: ON for first half, OFF for second half
-        return (cyclePos < (period / 2));
-    }
-    
-    bool _computeFadeIn(const BehaviorConfig& cfg, unsigned long elapsed) {
-        // For POWERCELL NGX: Set ON with soft-start enabled (handled in OutputChannel.softStart)
-        return true;
+        if (_table.flags[h] & OutputTable::kActive) {
+            const uint32_t next = _nextTransition(h, now - _table.activatedAt[h]);
+            if (next != kNoDeadline) {
+                _deadlines.schedule(h, _table.activatedAt[h] + next);
+            }
+        }
     }
-    
-    bool _computeFadeOut(const BehaviorConfig& cfg, unsigned long elapsed) {
-        // POWERCELL NGX doesn't support fade-out natively
-        // Turn OFF after fade time
-        return (elapsed < cfg.fadeTime_ms);
+
+    void _evaluateSlot(OutputHandle h, uint32_t now) {
+        uint8_t flags = _table.flags[h];
+        const uint32_t elapsed = now - _table.activatedAt[h];
+
+        // Reset per-loop attributes so behaviors can re-assert as needed
+        flags &= static_cast<uint8_t>(~(OutputTable::kSoftStart | OutputTable::kPwmEnable));
+
+        // Check duration expiry
+        const uint32_t duration = _table.duration_ms[h];
+        if (duration > 0 && elapsed >= duration) {
+            if (flags & OutputTable::kAutoOff) {
+                flags &= static_cast<uint8_t>(~(OutputTable::kActive | OutputTable::kOn));
+            }
+            _table.flags[h] = flags;
+            return;
+        }
+
+        const uint32_t a = _table.param_a[h];
+        bool on = false;
+        switch (_table.kind[h]) {
+            case OutputKind::CONST:
+                on = a != 0;
+                break;
+            case OutputKind::CYCLE:
+                on = a > 0 && (elapsed % a) < _table.param_b[h];
+                break;
+            case OutputKind::WINDOW:
+                on = elapsed < a;
+                break;
+            case OutputKind::AFTER:
+                on = elapsed >= a;
+                break;
+            case OutputKind::PATTERN:
+                on = _patternOn(_patternTable[a], elapsed);
+                break;
+        }
+
+        flags &= static_cast<uint8_t>(~OutputTable::kOn);
+        if (on) flags |= OutputTable::kOn;
+        if (flags & OutputTable::kAssertSoftStart) flags |= OutputTable::kSoftStart;
+        if (flags & OutputTable::kAssertPwm) flags |= OutputTable::kPwmEnable;
+        _table.flags[h] = flags;
     }
-    
-    bool _computeStrobe(const BehaviorConfig& cfg, unsigned long elapsed) {
-        // Fast flash: use configured on/off times
-        unsigned long onTime = cfg.onTime_ms > 0 ? cfg.onTime_ms : 50;
-        unsigned long offTime = cfg.offTime_ms > 0 ? cfg.offTime_ms : 50;
-        unsigned long period = onTime + offTime;
-        unsigned long cyclePos = elapsed % period;
-        return (cyclePos < onTime);
+
+    // Elapsed time (since activation) of the slot's next state change after
+    // `elapsed`, or kNoDeadline if its state can no longer change. Duration
+    // expiry counts as a change (auto-off or dropping soft-start/PWM).
+    uint32_t _nextTransition(OutputHandle h, uint32_t elapsed) const {
+        const uint32_t a = _table.param_a[h];
+        const uint32_t b = _table.param_b[h];
+        uint32_t next = kNoDeadline;
+
+        switch (_table.kind[h]) {
+            case OutputKind::CONST:
+                break;
+            case OutputKind::CYCLE:
+                // No edge when the on-time is 0 or covers the whole period
+                if (a > 0 && b > 0 && b < a) {
+                    const uint32_t pos = elapsed % a;
+                    next = elapsed + (pos < b ? b - pos : a - pos);
+                }
+                break;
+            case OutputKind::WINDOW:
+            case OutputKind::AFTER:
+                if (elapsed < a) next = a;
+                break;
+            case OutputKind::PATTERN:
+                next = _patternNextEdge(_patternTable[a], elapsed);
+                break;
+        }
+
+        const uint32_t duration = _table.duration_ms[h];
+        if (duration > 0 && duration > elapsed && (next == kNoDeadline || duration < next)) {
+            next = duration;
+        }
+        return next;
     }
-    
-    bool _computePattern(const BehaviorConfig& cfg, unsigned long elapsed) {
-        Pattern* pattern = const_cast<BehaviorEngine*>(this)->getPattern(cfg.patternName);
-        if (!pattern || pattern->steps.empty()) return false;
-        
-        unsigned long patternDuration = 0;
-        for (const auto& step : pattern->steps) {
-            patternDuration += step.duration_ms;
+
+    // End of the current step (steps with equal levels are not merged; the
+    // extra wakeup is harmless)
+    static uint32_t _patternNextEdge(const CompiledPattern& pattern, uint32_t elapsed) {
+        if (pattern.total_ms == 0) return kNoDeadline;
+        if (!pattern.loop && elapsed >= pattern.total_ms) return kNoDeadline;
+        const uint32_t cycleStart = pattern.loop ? elapsed - (elapsed % pattern.total_ms) : 0;
+        const uint32_t cyclePos = elapsed - cycleStart;
+        for (uint8_t i = 0; i < pattern.stepCount; ++i) {
+            if (cyclePos < pattern.stepEnd_ms[i]) {
+                return cycleStart + pattern.stepEnd_ms[i];
+            }
         }
-        
-        unsigned long cyclePos = pattern->loop ? (elapsed % patternDuration) : elapsed;
-        
-        unsigned long stepStart = 0;
-        for (size_t i = 0; i < pattern->steps.size(); i++) {
-            const auto& step = pattern->steps[i];
-            if (cyclePos < stepStart + step.duration_ms) {
-                return (step.value > 0);
+        return kNoDeadline;
+    }
+
+    static bool _patternOn(const CompiledPattern& pattern, uint32_t elapsed) {
+        if (pattern.total_ms == 0) return false;
+        const uint32_t cyclePos = pattern.loop ? (elapsed % pattern.total_ms) : elapsed;
+        for (uint8_t i = 0; i < pattern.stepCount; ++i) {
+            if (cyclePos < pattern.stepEnd_ms[i]) {
+                return (pattern.onBits >> i) & 1u;
             }
-            stepStart += step.duration_ms;
         }
-        
         return false;
     }
-    
-    bool _computeRamp(const BehaviorConfig& cfg, unsigned long elapsed) {
-        if (cfg.fadeTime_ms == 0) return cfg.targetValue;
-        if (elapsed >= cfg.fadeTime_ms) return cfg.targetValue;
-        return (uint8_t)((cfg.targetValue * elapsed) / cfg.fadeTime_ms);
-    }
 };
 
 } // namespace BehavioralOutput
@@ -37,33 +37,72 @@ inline bool g_lastMastercellValid = false;
 struct CellState {
     uint8_t address = 1;
     uint16_t outputBitmap = 0;         // Bits 0-9 for outputs 1-10 (ON/OFF) - Track mode
-    bool hasChanges = false;
+    uint16_t activeBitmap = 0;         // Outputs under engine control; non-zero = keepalive
+    bool known = false;                // Has been transmitted at least once
+    uint32_t lastTransmitMs = 0;
     // Note: softStart and PWM not implemented yet (Track-only mode)
+
+    // Instrumentation
+    uint32_t changeFrames = 0;         // Sent because an output changed
+    uint32_t keepaliveFrames = 0;      // Sent to hold state against the LOC timer
+    uint32_t windowFrames = 0;         // Frames in the current 1 s rate window
+    uint16_t framesPerSec = 0;         // Frames in the last complete window
+    uint32_t lastLatencyUs = 0;        // Event -> frame queued, last change
+    uint32_t maxLatencyUs = 0;
+};
+
+struct SynthesizerStats {
+    std::array<CellState, kMaxCellAddress> cells{};
+    uint16_t keepalive_ms = 0;
+    uint32_t latencySamples = 0;
+    uint32_t latencyAvgUs = 0;
+    uint32_t latencyMaxUs = 0;
 };
 
 // ═══════════════════════════════════════════════════════════════════════════
 // FRAME SYNTHESIZER
 // ═══════════════════════════════════════════════════════════════════════════
 
+// Incremental: the engine marks the cells whose outputs changed, and only
+// those cells are written, immediately. Cells with active outputs are
+// otherwise re-sent on the keepalive interval.
+//
+// Writes go to a shared per-cell shadow (CanManager::setPowercellOutputs),
+// which owns frame construction: the synthesizer only touches the outputs
+// the engine controls (plus those it just released), so outputs driven by
+// other producers on the same cell keep their state.
 class PowercellSynthesizer {
 public:
-    PowercellSynthesizer(BehaviorEngine* engine, std::function<void(uint32_t, uint8_t*)> sendFunc)
-        : _engine(engine), _sendFrame(sendFunc), _lastTransmit(0), _transmitInterval(50) {
-        // Initialize cell state cache
-        _cellStateCache.clear();
+    // LOC timer the cells are configured with (`canconfig`: 10 s). The
+    // keepalive is capped at a quarter of it so a lost frame or two never
+    // lets a cell time out.
+    static constexpr uint32_t kLocTimeoutMs = 10000;
+    static constexpr uint16_t kMinKeepaliveMs = 20;
+    static constexpr uint16_t kMaxKeepaliveMs = kLocTimeoutMs / 4;
+    static constexpr uint16_t kDefaultKeepaliveMs = 500;
+
+    // (cell address, mask, outputs): bit n-1 = OUTn; a zero mask re-sends
+    // the cell as it stands
+    using CellWriter = std::function<void(uint8_t, uint16_t, uint16_t)>;
+
+    PowercellSynthesizer(BehaviorEngine* engine, CellWriter writeCell)
+        : _engine(engine), _writeCell(writeCell) {
+        for (uint8_t i = 0; i < kMaxCellAddress; ++i) {
+            _cells[i].address = i + 1;
+        }
     }
     
     // ───────────────────────────────────────────────────────────────────────
     // CONFIGURATION
     // ───────────────────────────────────────────────────────────────────────
     
-    void setTransmitInterval(uint16_t interval_ms) {
-        _transmitInterval = interval_ms;
-    }
-    
-    void setForceTransmit(bool force) {
-        _forceTransmit = force;
+    void setKeepaliveInterval(uint16_t interval_ms) {
+        if (interval_ms < kMinKeepaliveMs) interval_ms = kMinKeepaliveMs;
+        if (interval_ms > kMaxKeepaliveMs) interval_ms = kMaxKeepaliveMs;
+        _keepaliveInterval = interval_ms;
     }
+
+    uint16_t keepaliveInterval() const { return _keepaliveInterval; }
     
     // ───────────────────────────────────────────────────────────────────────
     // FRAME SYNTHESIS & TRANSMISSION
@@ -72,56 +111,56 @@ public:
     void update() {
         if (!_engine) return;
         
-        unsigned long now = millis();
-        if (!_forceTransmit && (now - _lastTransmit < _transmitInterval)) {
-            return;
-        }
-        _lastTransmit = now;
-        
-        const auto& outputs = _engine->getOutputs();
-        std::map<uint8_t, uint16_t> nextBitmaps;
-        std::map<uint8_t, bool> cellHasActive;
-        
-        // Build complete desired state per cell
-        for (const auto& [id, output] : outputs) {
-            uint8_t cellAddr = output.cellAddress;
-            uint8_t outNum = output.outputNumber;
-            
-            // Validate cell address and output number
-            if (cellAddr < 1 || cellAddr > 16) continue;
-            if (outNum < 1 || outNum > 10) continue;
-            
-            // Ensure cell entry exists
-            uint16_t& bitmap = nextBitmaps[cellAddr];
-            if (output.isActive) {
-                cellHasActive[cellAddr] = true;
-            }
+        const uint32_t now = millis();
+        _rollRateWindow(now);
 
-            if (output.currentState) {
-                bitmap |= static_cast<uint16_t>(1u << (outNum - 1));
-            }
-        }
-        
-        // Transmit for cells with active outputs (continuous) or just-deactivated outputs (one final OFF)
-        for (const auto& [addr, bitmap] : nextBitmaps) {
-            CellState& state = _cellStateCache[addr];
-            state.address = addr;
+        // Changed cells: one complete frame each, right away
+        const uint32_t dirty = _engine->takeDirtyCells(_changes);
+        uint32_t sent = 0;
+        for (uint8_t addr = 1; addr <= kMaxCellAddress; ++addr) {
+            if (!(dirty & (1u << addr))) continue;
+            CellState& state = _cells[addr - 1];
+            const CellOutputs& change = _changes[addr];
+            const uint16_t released = state.activeBitmap & ~change.activeBitmap;
+            const bool hadActive = state.activeBitmap != 0;
+            state.outputBitmap = change.onBitmap;
+            state.activeBitmap = change.activeBitmap;
 
-            const uint16_t previous = state.outputBitmap;
-            state.outputBitmap = bitmap;
-            state.hasChanges = (state.outputBitmap != previous);
-
-            const bool hasActive = (cellHasActive.find(addr) != cellHasActive.end());
-            const bool hadActive = (_cellActiveCache.find(addr) != _cellActiveCache.end()) && _cellActiveCache[addr];
-            const bool shouldTransmit = _forceTransmit || hasActive || hadActive;
+            // Active cells, plus one final write for outputs that just went idle
+            if (state.activeBitmap == 0 && !hadActive && !_forceTransmit) continue;
+            _transmitCellState(state, now, state.activeBitmap | released);
+            sent |= 1u << addr;
+            ++state.changeFrames;
+            const int32_t latencyUs = static_cast<int32_t>(micros() - change.eventUs);
+            _recordLatency(state, latencyUs > 0 ? static_cast<uint32_t>(latencyUs) : 0);
+        }
 
-            if (shouldTransmit) {
-                _transmitCellState(state);
+        // Unchanged cells: keepalive (or everything, when forced)
+        _nextKeepaliveMs = BehaviorEngine::kNoDeadline;
+        for (auto& state : _cells) {
+            if (sent & (1u << state.address)) {
+                // Just sent as a change
+            } else if ((state.activeBitmap != 0 && now - state.lastTransmitMs >= _keepaliveInterval) ||
+                       (_forceTransmit && state.known)) {
+                _transmitCellState(state, now, 0);
+                ++state.keepaliveFrames;
+            }
+            if (state.activeBitmap != 0) {
+                const uint32_t next = state.lastTransmitMs + _keepaliveInterval;
+                if (_nextKeepaliveMs == BehaviorEngine::kNoDeadline ||
+                    DeadlineHeap<kMaxOutputs>::before(next, _nextKeepaliveMs)) {
+                    _nextKeepaliveMs = next;
+                }
             }
-
-            _cellActiveCache[addr] = hasActive;
         }
     }
+
+    // Milliseconds until the next keepalive is due, or
+    // BehaviorEngine::kNoDeadline when no cell is active.
+    uint32_t msUntilNextTransmit(uint32_t now) const {
+        if (_nextKeepaliveMs == BehaviorEngine::kNoDeadline) return BehaviorEngine::kNoDeadline;
+        return DeadlineHeap<kMaxOutputs>::before(now, _nextKeepaliveMs) ? _nextKeepaliveMs - now : 0;
+    }
     
     // ───────────────────────────────────────────────────────────────────────
     // MANUAL FRAME TRANSMISSION
@@ -133,51 +172,77 @@ public:
         _forceTransmit = false;
     }
 
+    // ───────────────────────────────────────────────────────────────────────
+    // INSTRUMENTATION
+    // ───────────────────────────────────────────────────────────────────────
+
+    // Copy taken on the caller's task; counters may be mid-update
+    SynthesizerStats getStats() const {
+        SynthesizerStats stats;
+        stats.cells = _cells;
+        const uint32_t now = millis();
+        if (now - _windowStartMs >= 2 * kRateWindowMs) {
+            for (auto& cell : stats.cells) cell.framesPerSec = 0;  // Idle: window not rolled
+        }
+        stats.keepalive_ms = _keepaliveInterval;
+        stats.latencySamples = _latencySamples;
+        stats.latencyAvgUs = _latencySamples ? static_cast<uint32_t>(_latencySumUs / _latencySamples) : 0;
+        stats.latencyMaxUs = _latencyMaxUs;
+        return stats;
+    }
+
 private:
+    static constexpr uint32_t kRateWindowMs = 1000;
+
     BehaviorEngine* _engine;
-    std::function<void(uint32_t, uint8_t*)> _sendFrame;
+    CellWriter _writeCell;
     
-    unsigned long _lastTransmit;
-    uint16_t _transmitInterval;
+    uint16_t _keepaliveInterval = kDefaultKeepaliveMs;
     bool _forceTransmit = false;
+    uint32_t _nextKeepaliveMs = BehaviorEngine::kNoDeadline;
     
-    // Cell state cache - preserves output values across updates
-    std::map<uint8_t, CellState> _cellStateCache;
-    std::map<uint8_t, bool> _cellActiveCache;
+    // Indexed by cell address - 1; preserves output values across updates
+    std::array<CellState, kMaxCellAddress> _cells{};
+    std::array<CellOutputs, kMaxCellAddress + 1> _changes{};
+
+    uint32_t _windowStartMs = 0;
+    uint32_t _latencySamples = 0;
+    uint64_t _latencySumUs = 0;
+    uint32_t _latencyMaxUs = 0;
+
+    void _recordLatency(CellState& state, uint32_t latencyUs) {
+        state.lastLatencyUs = latencyUs;
+        if (latencyUs > state.maxLatencyUs) state.maxLatencyUs = latencyUs;
+        if (latencyUs > _latencyMaxUs) _latencyMaxUs = latencyUs;
+        _latencySumUs += latencyUs;
+        ++_latencySamples;
+    }
+
+    void _rollRateWindow(uint32_t now) {
+        if (now - _windowStartMs < kRateWindowMs) return;
+        const bool contiguous = now - _windowStartMs < 2 * kRateWindowMs;
+        for (auto& state : _cells) {
+            state.framesPerSec = contiguous ? static_cast<uint16_t>(state.windowFrames) : 0;
+            state.windowFrames = 0;
+        }
+        _windowStartMs = now;
+    }
     
     // ───────────────────────────────────────────────────────────────────────
     // POWERCELL FRAME CONSTRUCTION
     // ───────────────────────────────────────────────────────────────────────
     
-    void _transmitCellState(const CellState& state) {
+    void _transmitCellState(CellState& state, uint32_t now, uint16_t mask) {
         // Guard against invalid address (prevents accidental FF00 PGN)
         if (state.address < 1 || state.address > 16) return;
-        
-        // POWERCELL NGX Track control PGN: 0xFF00 + cellAddress
-        // Cell 1 → 0xFF01, Cell 2 → 0xFF02, etc.
-        uint32_t pgn = 0xFF00 + state.address;
-        
-        // Track personality frame format:
-        // - First 10 bits control outputs 1-10 in order
-        // - Byte 0 uses MSB-first mapping: OUT1=bit7 ... OUT8=bit0
-        // - Byte 1 uses bits 7-6 for OUT9/OUT10
-        // - Bytes 2-7 must be 0x00 (Track supersedes Soft-Start and PWM)
-        uint8_t data[8] = {0};
-        for (uint8_t out = 1; out <= 8; ++out) {
-            if (state.outputBitmap & (1u << (out - 1))) {
-                data[0] |= static_cast<uint8_t>(1u << (8 - out));
-            }
-        }
-        if (state.outputBitmap & (1u << 8)) {
-            data[1] |= 0x80;  // OUT9
-        }
-        if (state.outputBitmap & (1u << 9)) {
-            data[1] |= 0x40;  // OUT10
-        }
-        // data[2..7] remain 0x00 for Track-only mode
-        
-        if (_sendFrame) {
-            _sendFrame(pgn, data);
+
+        state.lastTransmitMs = now;
+        state.known = true;
+        ++state.windowFrames;
+
+        // Track frame (Ipm1Can::powercellTrack) built from the merged shadow
+        if (_writeCell) {
+            _writeCell(state.address, mask, state.outputBitmap);
         }
     }
     
@@ -202,32 +267,39 @@ public:
      * CAN frame formats. The mapper function receives the current output
      * value (0-255) and returns the CAN ID and data bytes to transmit.
      */
-    void mapOutput(const String& outputId, 
-                   std::function<void(uint8_t value, uint32_t& canId, uint8_t* data, uint8_t& len)> mapper) {
-        _outputMappers[outputId] = mapper;
+    using Mapper = std::function<void(uint8_t value, uint32_t& canId, uint8_t* data, uint8_t& len)>;
+
+    // The output must already exist: its ID is resolved to a handle here.
+    bool mapOutput(const String& outputId, Mapper mapper) {
+        const OutputHandle handle = _engine ? _engine->resolveOutput(outputId) : kInvalidOutputHandle;
+        if (handle == kInvalidOutputHandle) return false;
+        for (auto& entry : _outputMappers) {
+            if (entry.first == handle) {
+                entry.second = mapper;
+                return true;
+            }
+        }
+        _outputMappers.emplace_back(handle, mapper);
+        return true;
     }
     
     void update() {
         if (!_engine) return;
         
-        const auto& outputs = _engine->getOutputs();
-        for (const auto& [id, output] : outputs) {
-            if (!output.isActive) continue;
+        const OutputTable& table = _engine->outputTable();
+        for (const auto& [handle, mapper] : _outputMappers) {
+            if (!table.active(handle)) continue;
             
-            // Check if this output has a custom mapper
-            auto it = _outputMappers.find(id);
-            if (it != _outputMappers.end()) {
-                uint32_t canId = 0;
-                uint8_t data[8] = {0};
-                uint8_t len = 8;
-                
-                // Call the mapper
-                it->second(output.currentState ? 255 : 0, canId, data, len);
-                
-                // Send the frame
-                if (_sendFrame && canId > 0) {
-                    _sendFrame(canId, data, len);
-                }
+            uint32_t canId = 0;
+            uint8_t data[8] = {0};
+            uint8_t len = 8;
+            
+            // Call the mapper
+            mapper(table.on(handle) ? 255 : 0, canId, data, len);
+            
+            // Send the frame
+            if (_sendFrame && canId > 0) {
+                _sendFrame(canId, data, len);
             }
         }
     }
@@ -235,7 +307,7 @@ public:
 private:
     BehaviorEngine* _engine;
     std::function<void(uint32_t, uint8_t*, uint8_t)> _sendFrame;
-    std::map<String, std::function<void(uint8_t, uint32_t&, uint8_t*, uint8_t&)>> _outputMappers;
+    std::vector<std::pair<OutputHandle, Mapper>> _outputMappers;
 };
 
 } // namespace BehavioralOutput
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Page switch timing for the UI page cache.
+//
+// The LVGL task records how long each navigation took from the tap to a
+// laid-out page, split by whether the page came from the cache or had to
+// be built (a build is what every switch cost before the cache). The last
+// kSamples of each kind are kept; summary() reports percentiles over them.
+// Samples are relaxed atomics, so the web server can read while the UI
+// records (a summary may mix a sample from an in-flight switch).
+class PageSwitchStats {
+public:
+    static constexpr std::size_t kSamples = 64;
+
+    struct Summary {
+        uint32_t count = 0;   // Switches of this kind since boot
+        uint32_t p50_us = 0;
+        uint32_t p99_us = 0;
+        uint32_t max_us = 0;
+    };
+
+    void record(bool cached, uint32_t us) {
+        Series& series = cached ? cached_ : built_;
+        const uint32_t n = series.count.load(std::memory_order_relaxed);
+        series.samples[n % kSamples].store(us, std::memory_order_relaxed);
+        series.count.store(n + 1, std::memory_order_release);
+    }
+
+    void recordEviction() { evictions_.fetch_add(1, std::memory_order_relaxed); }
+    void setResident(uint32_t pages) { resident_.store(pages, std::memory_order_relaxed); }
+
+    Summary summary(bool cached) const {
+        const Series& series = cached ? cached_ : built_;
+        Summary result;
+        result.count = series.count.load(std::memory_order_acquire);
+        const std::size_t n = std::min<std::size_t>(result.count, kSamples);
+        if (n == 0) {
+            return result;
+        }
+        std::array<uint32_t, kSamples> sorted{};
+        for (std::size_t i = 0; i < n; ++i) {
+            sorted[i] = series.samples[i].load(std::memory_order_relaxed);
+        }
+        std::sort(sorted.begin(), sorted.begin() + n);
+        result.p50_us = sorted[(n - 1) / 2];
+        result.p99_us = sorted[(n - 1) * 99 / 100];
+        result.max_us = sorted[n - 1];
+        return result;
+    }
+
+    uint32_t evictions() const { return evictions_.load(std::memory_order_relaxed); }
+    uint32_t resident() const { return resident_.load(std::memory_order_relaxed); }
+
+private:
+    struct Series {
+        std::array<std::atomic<uint32_t>, kSamples> samples{};
+        std::atomic<uint32_t> count{0};
+    };
+
+    Series cached_;
+    Series built_;
+    std::atomic<uint32_t> evictions_{0};
+    std::atomic<uint32_t> resident_{0};
+};
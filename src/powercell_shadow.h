@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Desired Track state of every Powercell, shared by all producers.
+//
+// write() changes only the masked outputs of one cell (bit n-1 = OUTn) and
+// marks the cell dirty; it is lock-free and safe from any task. A single
+// flusher calls collect() to take the dirty set and emit one complete
+// frame per cell. Writes are held from the first write of a batch so that
+// changes from several producers in the same tick share a frame.
+//
+// OUT4+OUT8 with everything else off encodes as Track byte 0 = 0x11, byte
+// 1 = 0: the status poll (Ipm1Can::powercellPoll). A cell cannot tell the
+// two apart, so collect() never emits that state; the cell keeps the last
+// state it was sent until the desired state changes again.
+//
+// A frame collect() queued can still be lost (deadline, bus-off); the
+// flusher then calls write() with a zero mask, or resendAll() once the bus
+// is back, so the cell converges on its desired state.
+class PowercellShadow {
+public:
+    static constexpr uint8_t kMaxAddress = 16;
+    static constexpr uint16_t kOutputMask = 0x03FF;
+    static constexpr uint16_t kPollAliasOutputs = (1u << 3) | (1u << 7);   // OUT4 + OUT8
+
+    // Returns true when this write opened a new batch (wake the flusher)
+    bool write(uint8_t cell, uint16_t mask, uint16_t outputs, bool urgent, uint32_t now_us) {
+        if (cell < 1 || cell > kMaxAddress) {
+            return false;
+        }
+        mask &= kOutputMask;
+        std::atomic<uint16_t>& desired = desired_[cell];
+        uint16_t current = desired.load(std::memory_order_relaxed);
+        while (!desired.compare_exchange_weak(current, static_cast<uint16_t>((current & ~mask) | (outputs & mask)),
+                                              std::memory_order_release, std::memory_order_relaxed)) {
+        }
+
+        const uint32_t bit = 1u << cell;
+        written_.fetch_or(bit, std::memory_order_relaxed);
+        return markDirty(bit, urgent, now_us);
+    }
+
+    // Re-sends every cell written so far, e.g. once the bus is back after
+    // frames may have been lost. Returns true when this opened a new batch.
+    bool resendAll(bool urgent, uint32_t now_us) {
+        const uint32_t cells = written_.load(std::memory_order_relaxed);
+        return cells != 0 && markDirty(cells, urgent, now_us);
+    }
+
+    uint16_t desired(uint8_t cell) const {
+        return (cell >= 1 && cell <= kMaxAddress) ? desired_[cell].load(std::memory_order_acquire) : 0;
+    }
+
+    bool pending() const { return dirty_.load(std::memory_order_acquire) != 0; }
+
+    // Microseconds the open batch must still be held (0 = flush now)
+    uint32_t holdUs(uint32_t now_us, uint32_t coalesce_us) const {
+        const uint32_t held = now_us - batch_start_us_.load(std::memory_order_relaxed);
+        return held < coalesce_us ? coalesce_us - held : 0;
+    }
+
+    static bool aliasesPoll(uint16_t outputs) { return (outputs & kOutputMask) == kPollAliasOutputs; }
+
+    // Takes the dirty set; fn(cell, outputs, urgent) once per dirty cell.
+    // fn returns false when the frame could not be queued: the cell (and
+    // its urgency) is marked dirty again and retried on the next flush.
+    // Returns the cells whose frame was queued.
+    template <typename Fn>
+    uint32_t collect(Fn&& fn) {
+        const uint32_t cells = dirty_.exchange(0, std::memory_order_acq_rel);
+        const uint32_t urgent = urgent_.exchange(0, std::memory_order_relaxed);
+        uint32_t sent = 0;
+        uint32_t retry = 0;
+        for (uint8_t cell = 1; cell <= kMaxAddress; ++cell) {
+            const uint32_t bit = 1u << cell;
+            if (!(cells & bit)) {
+                continue;
+            }
+            const uint16_t outputs = desired_[cell].load(std::memory_order_acquire);
+            if (aliasesPoll(outputs)) {
+                poll_alias_held_.fetch_add(1, std::memory_order_relaxed);
+            } else if (fn(cell, outputs, (urgent & bit) != 0)) {
+                sent |= bit;
+            } else {
+                retry |= bit;
+            }
+        }
+        if (retry) {
+            urgent_.fetch_or(urgent & retry, std::memory_order_relaxed);
+            dirty_.fetch_or(retry, std::memory_order_acq_rel);
+        }
+        return sent;
+    }
+
+    // Flushes that held a cell back because its state aliased the poll
+    uint32_t pollAliasHeld() const { return poll_alias_held_.load(std::memory_order_relaxed); }
+
+private:
+    bool markDirty(uint32_t cells, bool urgent, uint32_t now_us) {
+        if (urgent) {
+            urgent_.fetch_or(cells, std::memory_order_relaxed);
+        }
+        if (dirty_.fetch_or(cells, std::memory_order_acq_rel) == 0) {
+            batch_start_us_.store(now_us, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // Indexed by cell address; dirty/urgent bit n = cell n
+    std::array<std::atomic<uint16_t>, kMaxAddress + 1> desired_{};
+    std::atomic<uint32_t> dirty_{0};
+    std::atomic<uint32_t> urgent_{0};
+    std::atomic<uint32_t> written_{0};   // Cells any producer has written
+    std::atomic<uint32_t> batch_start_us_{0};
+    std::atomic<uint32_t> poll_alias_held_{0};
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+// Single-writer sequence lock around a small trivially copyable value.
+//
+// The writer never blocks: store() bumps the sequence to odd, rewrites the
+// payload and bumps it back to even. Readers copy the payload and retry if
+// the sequence was odd or changed underneath them, so a reader can only
+// ever return a value the writer published in full. The payload lives in
+// atomic words so the racing copy is well defined; word stores are release
+// and word loads acquire, so a reader that sees any new word also sees the
+// odd sequence before it (no standalone fences). Exactly one task may call
+// store(); any number may call load().
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock payload must be trivially copyable");
+
+public:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    // Writer side (one task)
+    void store(const T& value) {
+        std::array<uint32_t, kWords> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_release);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Reader side (any task, not an ISR). A writer is only ever mid-store
+    // for a few dozen word stores, so readers spin briefly and then back
+    // off. On FreeRTOS a yield only reaches tasks of equal or higher
+    // priority, so a reader above the writer would spin forever; it sleeps
+    // a tick instead.
+    T load() const {
+        std::array<uint32_t, kWords> words;
+        for (uint32_t attempt = 0;; ++attempt) {
+            const uint32_t before = seq_.load(std::memory_order_acquire);
+            if ((before & 1u) == 0) {
+                for (std::size_t i = 0; i < kWords; ++i) {
+                    words[i] = words_[i].load(std::memory_order_acquire);
+                }
+                if (seq_.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            if (attempt >= kSpinAttempts) {
+#ifdef ESP_PLATFORM
+                vTaskDelay(1);
+#else
+                std::this_thread::yield();
+#endif
+            }
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    // Completed store() calls (even sequence / 2); 0 until the first store
+    uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+private:
+    static constexpr uint32_t kSpinAttempts = 8;
+
+    std::atomic<uint32_t> seq_{0};
+    std::array<std::atomic<uint32_t>, kWords> words_{};
+};
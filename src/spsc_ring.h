@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer ring buffer.
+//
+// One task pushes, one task pops; neither side ever blocks or takes a mutex.
+// Capacity must be a power of two so index wrap is a mask, and the indices
+// are free-running 32-bit counters (size = head - tail even across wrap).
+// Storage is inline, so a ring declared as a static/member never allocates.
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    static constexpr std::size_t kCapacity = Capacity;
+
+    // Producer side. Returns false (and counts a drop) when the ring is full.
+    bool push(const T& item) {
+        const std::uint32_t head = head_.load(std::memory_order_relaxed);
+        const std::uint32_t tail = tail_.load(std::memory_order_acquire);
+        if (head - tail >= Capacity) {
+            drops_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots_[head & kMask] = item;
+        head_.store(head + 1, std::memory_order_release);
+
+        const std::uint32_t depth = head + 1 - tail;
+        if (depth > high_water_.load(std::memory_order_relaxed)) {
+            high_water_.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& out) {
+        const std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+        const std::uint32_t head = head_.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+        out = slots_[tail & kMask];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+    std::uint32_t drops() const { return drops_.load(std::memory_order_relaxed); }
+    std::uint32_t highWater() const { return high_water_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::uint32_t kMask = static_cast<std::uint32_t>(Capacity - 1);
+
+    std::array<T, Capacity> slots_{};
+    std::atomic<std::uint32_t> head_{0};
+    std::atomic<std::uint32_t> tail_{0};
+    std::atomic<std::uint32_t> drops_{0};
+    std::atomic<std::uint32_t> high_water_{0};
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Hashed timer wheel over a fixed set of ids, no allocation.
+//
+// Each id in [0, Capacity) has at most one pending expiry, kept on an
+// intrusive doubly linked list in bucket (expiry tick % Buckets).
+// schedule(), cancel() and re-schedule are O(1); advance() moves time
+// forward one tick and visits only that tick's bucket. Delays longer than
+// one revolution simply stay in their bucket until their tick comes round.
+template <std::size_t Capacity, std::size_t Buckets>
+class TimerWheel {
+    static_assert(Buckets >= 2 && (Buckets & (Buckets - 1)) == 0, "TimerWheel bucket count must be a power of two");
+    static_assert(Capacity + Buckets < 0xFFFF, "TimerWheel ids must fit a uint16_t link");
+
+public:
+    TimerWheel() { clear(); }
+
+    void clear() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            next_[i] = prev_[i] = kUnlinked;
+        }
+        for (std::size_t b = 0; b < Buckets; ++b) {
+            const std::uint16_t head = static_cast<std::uint16_t>(Capacity + b);
+            next_[head] = prev_[head] = head;
+        }
+        size_ = 0;
+    }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+    std::uint32_t tick() const { return tick_; }
+    bool scheduled(std::size_t id) const { return id < Capacity && next_[id] != kUnlinked; }
+
+    // Expire `id` after `delay_ticks` calls to advance() (minimum 1).
+    // Re-scheduling a pending id moves it.
+    void schedule(std::size_t id, std::uint32_t delay_ticks) {
+        if (id >= Capacity) return;
+        cancel(id);
+        if (delay_ticks == 0) delay_ticks = 1;
+        expires_[id] = tick_ + delay_ticks;
+        const std::uint16_t head = static_cast<std::uint16_t>(Capacity + (expires_[id] & kMask));
+        const std::uint16_t node = static_cast<std::uint16_t>(id);
+        prev_[node] = prev_[head];
+        next_[node] = head;
+        next_[prev_[head]] = node;
+        prev_[head] = node;
+        ++size_;
+    }
+
+    void cancel(std::size_t id) {
+        if (!scheduled(id)) return;
+        next_[prev_[id]] = next_[id];
+        prev_[next_[id]] = prev_[id];
+        next_[id] = prev_[id] = kUnlinked;
+        --size_;
+    }
+
+    // Advance one tick and call fn(id) for every id that expires on it. fn may
+    // schedule or cancel the id it is given, but no other id.
+    template <typename Fn>
+    void advance(Fn&& fn) {
+        ++tick_;
+        const std::uint16_t head = static_cast<std::uint16_t>(Capacity + (tick_ & kMask));
+        std::uint16_t node = next_[head];
+        while (node != head) {
+            const std::uint16_t following = next_[node];
+            if (static_cast<std::int32_t>(expires_[node] - tick_) <= 0) {
+                cancel(node);
+                fn(static_cast<std::size_t>(node));
+            }
+            node = following;
+        }
+    }
+
+private:
+    static constexpr std::uint32_t kMask = static_cast<std::uint32_t>(Buckets - 1);
+    static constexpr std::uint16_t kUnlinked = 0xFFFF;
+
+    // Links for ids [0, Capacity) followed by one list head per bucket
+    std::array<std::uint16_t, Capacity + Buckets> next_{};
+    std::array<std::uint16_t, Capacity + Buckets> prev_{};
+    std::array<std::uint32_t, Capacity> expires_{};
+    std::uint32_t tick_ = 0;
+    std::size_t size_ = 0;
+};
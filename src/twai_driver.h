@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The CAN controller as CanManager sees it. The firmware runs on the
+// ESP-IDF TWAI driver (twai_driver_esp32.cpp); the native build plugs in
+// VirtualTwaiDriver (native/virtual_twai_driver.h) over VirtualCanBus, so
+// the RX, TX and bus-health tasks run unmodified on the host.
+//
+// The calls mirror twai_* one for one, with the same threading contract:
+// receive, transmit and readAlerts may block for `wait_ticks` and are each
+// called from one task; install/uninstall only while no task is inside
+// (see CanManager::quiesceDriver).
+
+struct TwaiFrame {
+    uint32_t identifier = 0;
+    bool extended = false;
+    uint8_t length = 0;
+    uint8_t data[8] = {0};
+};
+
+enum class TwaiResult : uint8_t { Ok, Timeout, Fail };
+
+enum class TwaiState : uint8_t { Stopped, Running, BusOff, Recovering };
+
+struct TwaiStatus {
+    TwaiState state = TwaiState::Stopped;
+    uint32_t msgs_to_tx = 0;  // Queued or in flight; stop() discards them
+    uint32_t msgs_to_rx = 0;
+    uint32_t rx_missed_count = 0;
+    uint32_t rx_overrun_count = 0;
+    uint32_t bus_error_count = 0;
+    uint32_t arb_lost_count = 0;
+    uint32_t tx_error_counter = 0;
+    uint32_t rx_error_counter = 0;
+};
+
+// Alert bits returned by readAlerts() (the subset CanManager enables)
+namespace TwaiAlert {
+constexpr uint32_t kTxFailed = 1u << 0;
+constexpr uint32_t kBusError = 1u << 1;
+constexpr uint32_t kBusOff = 1u << 2;
+constexpr uint32_t kErrPassive = 1u << 3;
+constexpr uint32_t kErrActive = 1u << 4;
+constexpr uint32_t kAboveErrWarn = 1u << 5;
+constexpr uint32_t kBelowErrWarn = 1u << 6;
+constexpr uint32_t kRecoveryInProgress = 1u << 7;
+constexpr uint32_t kBusRecovered = 1u << 8;
+}  // namespace TwaiAlert
+
+struct TwaiConfig {
+    int tx_pin = -1;
+    int rx_pin = -1;
+    uint32_t bitrate = 250000;     // Only 250 kbps is supported
+    std::size_t tx_queue_len = 0;
+    std::size_t rx_queue_len = 0;
+    uint32_t alerts = 0;           // TwaiAlert bits
+    // Acceptance filter, TWAI register layout (mask bit 1 = don't care);
+    // see CanFilterPlanner
+    bool accept_all = true;
+    uint32_t acceptance_code = 0;
+    uint32_t acceptance_mask = 0xFFFFFFFF;
+    bool single_filter = true;
+};
+
+class TwaiDriver {
+public:
+    virtual ~TwaiDriver() = default;
+
+    virtual bool install(const TwaiConfig& config) = 0;
+    virtual void uninstall() = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+
+    // Timeout: the driver TX queue stayed full for wait_ticks
+    virtual TwaiResult transmit(const TwaiFrame& frame, uint32_t wait_ticks) = 0;
+    virtual bool receive(TwaiFrame& frame, uint32_t wait_ticks) = 0;
+    // False when no alert was raised within wait_ticks
+    virtual bool readAlerts(uint32_t& alerts, uint32_t wait_ticks) = 0;
+    virtual bool status(TwaiStatus& out) const = 0;
+    virtual bool initiateRecovery() = 0;
+
+    // Driver-specific reason for the last Fail, for logging
+    virtual const char* lastError() const = 0;
+};
+
+// ESP-IDF TWAI driver (twai_driver_esp32.cpp); device builds only
+TwaiDriver& espTwaiDriver();
@@ -0,0 +1,156 @@
+#include "twai_driver.h"
+
+#include <driver/twai.h>
+#include <esp_err.h>
+
+#include <cstring>
+
+// TwaiDriver over the ESP-IDF TWAI driver. Thin on purpose: every call is
+// the twai_* function of the same name, plus the frame/alert/status
+// translation.
+
+namespace {
+
+struct AlertBit {
+    uint32_t ours;
+    uint32_t twai;
+};
+
+constexpr AlertBit kAlertMap[] = {
+    {TwaiAlert::kTxFailed, TWAI_ALERT_TX_FAILED},
+    {TwaiAlert::kBusError, TWAI_ALERT_BUS_ERROR},
+    {TwaiAlert::kBusOff, TWAI_ALERT_BUS_OFF},
+    {TwaiAlert::kErrPassive, TWAI_ALERT_ERR_PASS},
+    {TwaiAlert::kErrActive, TWAI_ALERT_ERR_ACTIVE},
+    {TwaiAlert::kAboveErrWarn, TWAI_ALERT_ABOVE_ERR_WARN},
+    {TwaiAlert::kBelowErrWarn, TWAI_ALERT_BELOW_ERR_WARN},
+    {TwaiAlert::kRecoveryInProgress, TWAI_ALERT_RECOVERY_IN_PROGRESS},
+    {TwaiAlert::kBusRecovered, TWAI_ALERT_BUS_RECOVERED},
+};
+
+uint32_t toTwaiAlerts(uint32_t alerts) {
+    uint32_t out = 0;
+    for (const AlertBit& bit : kAlertMap) {
+        if (alerts & bit.ours) {
+            out |= bit.twai;
+        }
+    }
+    return out;
+}
+
+uint32_t fromTwaiAlerts(uint32_t alerts) {
+    uint32_t out = 0;
+    for (const AlertBit& bit : kAlertMap) {
+        if (alerts & bit.twai) {
+            out |= bit.ours;
+        }
+    }
+    return out;
+}
+
+TwaiState fromTwaiState(twai_state_t state) {
+    switch (state) {
+        case TWAI_STATE_RUNNING: return TwaiState::Running;
+        case TWAI_STATE_BUS_OFF: return TwaiState::BusOff;
+        case TWAI_STATE_RECOVERING: return TwaiState::Recovering;
+        default: return TwaiState::Stopped;
+    }
+}
+
+class EspTwaiDriver : public TwaiDriver {
+public:
+    bool install(const TwaiConfig& config) override {
+        twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(
+            static_cast<gpio_num_t>(config.tx_pin), static_cast<gpio_num_t>(config.rx_pin), TWAI_MODE_NORMAL);
+        g_config.tx_queue_len = config.tx_queue_len;
+        g_config.rx_queue_len = config.rx_queue_len;
+        g_config.alerts_enabled = toTwaiAlerts(config.alerts);
+
+        const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_250KBITS();
+
+        twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        if (!config.accept_all) {
+            f_config.acceptance_code = config.acceptance_code;
+            f_config.acceptance_mask = config.acceptance_mask;
+            f_config.single_filter = config.single_filter;
+        }
+        return check(twai_driver_install(&g_config, &t_config, &f_config));
+    }
+
+    void uninstall() override { twai_driver_uninstall(); }
+    bool start() override { return check(twai_start()); }
+    void stop() override { twai_stop(); }
+
+    TwaiResult transmit(const TwaiFrame& frame, uint32_t wait_ticks) override {
+        twai_message_t msg = {};
+        msg.identifier = frame.identifier;
+        msg.extd = frame.extended ? 1 : 0;
+        msg.data_length_code = frame.length;
+        memcpy(msg.data, frame.data, 8);
+
+        const esp_err_t result = twai_transmit(&msg, wait_ticks);
+        if (result == ESP_ERR_TIMEOUT) {
+            return TwaiResult::Timeout;
+        }
+        return check(result) ? TwaiResult::Ok : TwaiResult::Fail;
+    }
+
+    bool receive(TwaiFrame& frame, uint32_t wait_ticks) override {
+        twai_message_t msg;
+        if (twai_receive(&msg, wait_ticks) != ESP_OK) {
+            return false;
+        }
+        frame.identifier = msg.identifier;
+        frame.extended = msg.extd != 0;
+        frame.length = msg.data_length_code > 8 ? 8 : msg.data_length_code;
+        memcpy(frame.data, msg.data, frame.length);
+        return true;
+    }
+
+    bool readAlerts(uint32_t& alerts, uint32_t wait_ticks) override {
+        uint32_t raw = 0;
+        if (twai_read_alerts(&raw, wait_ticks) != ESP_OK) {
+            return false;
+        }
+        alerts = fromTwaiAlerts(raw);
+        return true;
+    }
+
+    bool status(TwaiStatus& out) const override {
+        twai_status_info_t info;
+        if (twai_get_status_info(&info) != ESP_OK) {
+            return false;
+        }
+        out.state = fromTwaiState(info.state);
+        out.msgs_to_tx = info.msgs_to_tx;
+        out.msgs_to_rx = info.msgs_to_rx;
+        out.rx_missed_count = info.rx_missed_count;
+        out.rx_overrun_count = info.rx_overrun_count;
+        out.bus_error_count = info.bus_error_count;
+        out.arb_lost_count = info.arb_lost_count;
+        out.tx_error_counter = info.tx_error_counter;
+        out.rx_error_counter = info.rx_error_counter;
+        return true;
+    }
+
+    bool initiateRecovery() override { return check(twai_initiate_recovery()); }
+
+    const char* lastError() const override { return esp_err_to_name(last_error_); }
+
+private:
+    bool check(esp_err_t result) {
+        if (result != ESP_OK) {
+            last_error_ = result;
+        }
+        return result == ESP_OK;
+    }
+
+    esp_err_t last_error_ = ESP_OK;
+};
+
+}  // namespace
+
+TwaiDriver& espTwaiDriver() {
+    static EspTwaiDriver driver;
+    return driver;
+}
@@ -13,6 +13,7 @@
 
 #include "can_manager.h"
 #include "config_manager.h"
+#include "config_snapshot.h"
 #include "ota_manager.h"
 #include "icon_library.h"
 #include "ui_theme.h"
@@ -54,6 +55,8 @@ void UIBuilder::begin() {
     }
     createInfoModal();
 
+    resolveThemeColors();
+    refreshPageFingerprints();
     if (config_ && !config_->pages.empty()) {
         buildNavigation();
         buildPage(0);
@@ -72,6 +75,8 @@ void UIBuilder::applyConfig(const DeviceConfig& config) {
     setBrightness(config.display.brightness);
 
     buildNavigation();
+    resolveThemeColors();
+    refreshPageFingerprints();
     if (config_->pages.empty()) {
         buildEmptyState();
     } else {
@@ -254,9 +259,11 @@ void UIBuilder::createBaseScreen() {
     lv_obj_set_style_bg_opa(content_root_, LV_OPA_COVER, 0);
     lv_obj_set_style_radius(content_root_, 0, 0);
     lv_obj_set_style_shadow_width(content_root_, 0, 0);
-    lv_obj_set_style_pad_all(content_root_, UITheme::SPACE_MD, 0);
-    lv_obj_set_style_pad_gap(content_root_, UITheme::SPACE_SM, 0);
+    lv_obj_set_style_pad_all(content_root_, 0, 0);
     lv_obj_clear_flag(content_root_, LV_OBJ_FLAG_SCROLLABLE);
+    // Holds one root per cached page; hidden roots take no space
+    lv_obj_set_layout(content_root_, LV_LAYOUT_FLEX);
+    lv_obj_set_flex_flow(content_root_, LV_FLEX_FLOW_COLUMN);
 
     // Status panel (kept hidden but retained for future use) - on base_screen not content_root
     status_panel_ = lv_obj_create(base_screen_);
@@ -303,9 +310,6 @@ void UIBuilder::createBaseScreen() {
     lv_obj_add_event_cb(header_overlay_, settingsButtonEvent, LV_EVENT_CLICKED, nullptr);
     lv_obj_move_foreground(header_overlay_);
 
-    // Use content_root directly as page container
-    page_container_ = content_root_;
-
     applyHeaderNavSpacing();
 }
 
@@ -408,11 +412,15 @@ void UIBuilder::buildNavigation() {
 }
 
 void UIBuilder::buildEmptyState() {
-    if (!page_container_) {
+    if (!content_root_) {
         return;
     }
 
-    lv_obj_clean(page_container_);
+    while (!page_cache_.empty()) {
+        evictCachedPage(page_cache_.size() - 1);
+    }
+    CachedPage& cached = createCachedPage(kEmptyStatePage, 0);
+    page_container_ = cached.root;
     lv_obj_remove_style_all(page_container_);
     lv_color_t bg = config_ ? colorFromHex(config_->theme.page_bg_color, UITheme::COLOR_SURFACE) : UITheme::COLOR_SURFACE;
     lv_obj_set_width(page_container_, lv_pct(100));
@@ -433,33 +441,36 @@ void UIBuilder::buildEmptyState() {
     lv_obj_set_style_text_font(label, UITheme::FONT_BODY, 0);
     lv_obj_set_style_text_color(label, config_ ? colorFromHex(config_->theme.text_primary, UITheme::COLOR_TEXT_PRIMARY) : UITheme::COLOR_TEXT_PRIMARY, 0);
     lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
+    showCachedPage(cached);
 }
 
 void UIBuilder::buildPage(std::size_t index) {
+    const uint32_t start_us = micros();
+
     // Calculate config page count
     std::size_t config_page_count = (config_ && !config_->pages.empty()) ? config_->pages.size() : 0;
     
     // Check if this is an Infinitybox page
-    if (index >= config_page_count && index < config_page_count + 6) {
-        buildInfinityboxPage(index - config_page_count);
-        return;
-    }
+    const bool infinitybox = index >= config_page_count && index < config_page_count + 6;
 
     // Original config-driven page logic
-    if (!config_ || index >= config_->pages.size()) {
+    if (!infinitybox && (!config_ || index >= config_->pages.size())) {
         buildEmptyState();
         return;
     }
 
-    if (!page_container_) {
+    if (!content_root_) {
         return;
     }
 
-    active_page_ = index;
-    const PageConfig& page = config_->pages[index];
+    const PageConfig* page = infinitybox ? nullptr : &config_->pages[index];
+    const bool suspension = page && page->type == "custom_html" && page->custom_content == "suspension_interface";
+    if (page) {
+        active_page_ = index;
+    }
     
     // Check if this is a custom suspension interface page
-    if (page.type == "custom_html" && page.custom_content == "suspension_interface") {
+    if (suspension) {
         // Save the current page as the last page before suspension (unless already on suspension)
         if (active_page_ > 0 && active_page_ < config_->pages.size()) {
             // Find a non-suspension page to go back to
@@ -470,20 +481,184 @@ void UIBuilder::buildPage(std::size_t index) {
                 }
             }
         }
-        buildSuspensionInterfacePage(page);
+    }
+
+    const uint32_t fingerprint = pageFingerprint(index);
+    CachedPage* cached = findCachedPage(index);
+    const bool hit = cached && cached->fingerprint == fingerprint;
+    if (!hit) {
+        if (cached) {
+            evictCachedPage(static_cast<std::size_t>(cached - page_cache_.data()));
+        }
+        cached = &createCachedPage(index, fingerprint);
+        cached->suspension = suspension;
+        page_container_ = cached->root;
+        building_page_ = cached;
+        if (infinitybox) {
+            buildInfinityboxPage(index - config_page_count);
+        } else if (suspension) {
+            buildSuspensionInterfacePage(*page);
+        } else {
+            buildGridPage(*page, *cached);
+        }
+        building_page_ = nullptr;
+    } else if (suspension) {
+        updateSuspensionUI();
+    }
+    showCachedPage(*cached);
+    if (page) {
         updateNavSelection();
+    }
+
+    // Measured to a laid-out page; drawing costs the same either way
+    lv_obj_update_layout(cached->root);
+    const uint32_t elapsed_us = micros() - start_us;
+    page_switch_stats_.record(hit, elapsed_us);
+    Serial.printf("[UI] Page %u %s in %lu us\n", static_cast<unsigned>(index),
+                  hit ? "shown from cache" : "built", static_cast<unsigned long>(elapsed_us));
+}
+
+// ─── Page cache ─────────────────────────────────────────────────────────────
+
+void UIBuilder::refreshPageFingerprints() {
+    const std::size_t page_count = config_ ? config_->pages.size() : 0;
+    const uint32_t theme_crc = config_ ? configSectionCrc(config_->theme) : 0;
+    page_fingerprints_.resize(page_count);
+    for (std::size_t i = 0; i < page_count; ++i) {
+        page_fingerprints_[i] = configSectionCrc(config_->pages[i]) ^ (theme_crc * 0x9E3779B1u);
+    }
+
+    // Drop what the new config no longer matches; rebuilt on next visit
+    std::size_t invalidated = 0;
+    for (std::size_t slot = page_cache_.size(); slot-- > 0;) {
+        const CachedPage& cached = page_cache_[slot];
+        if (cached.index >= page_count + 6 || cached.fingerprint != pageFingerprint(cached.index)) {
+            evictCachedPage(slot);
+            ++invalidated;
+        }
+    }
+    if (invalidated > 0) {
+        Serial.printf("[UI] Page cache: %u page(s) invalidated by config change\n", static_cast<unsigned>(invalidated));
+    }
+}
+
+uint32_t UIBuilder::pageFingerprint(std::size_t index) const {
+    if (index < page_fingerprints_.size()) {
+        return page_fingerprints_[index];
+    }
+    // Infinitybox pages are built from code, not config
+    return 0x1B0C0000u | static_cast<uint32_t>(index - page_fingerprints_.size());
+}
+
+UIBuilder::CachedPage* UIBuilder::findCachedPage(std::size_t index) {
+    for (auto& cached : page_cache_) {
+        if (cached.index == index) {
+            return &cached;
+        }
+    }
+    return nullptr;
+}
+
+UIBuilder::CachedPage& UIBuilder::createCachedPage(std::size_t index, uint32_t fingerprint) {
+    if (page_cache_.size() >= kPageCacheSize) {
+        std::size_t oldest = 0;
+        for (std::size_t slot = 1; slot < page_cache_.size(); ++slot) {
+            if (page_cache_[slot].last_used < page_cache_[oldest].last_used) {
+                oldest = slot;
+            }
+        }
+        evictCachedPage(oldest);
+        page_switch_stats_.recordEviction();
+    }
+
+    CachedPage cached;
+    cached.index = index;
+    cached.fingerprint = fingerprint;
+    cached.root = lv_obj_create(content_root_);
+    lv_obj_remove_style_all(cached.root);
+    lv_obj_set_width(cached.root, lv_pct(100));
+    lv_obj_set_flex_grow(cached.root, 1);
+    lv_obj_add_flag(cached.root, LV_OBJ_FLAG_HIDDEN);
+    page_cache_.push_back(std::move(cached));
+    page_switch_stats_.setResident(static_cast<uint32_t>(page_cache_.size()));
+    return page_cache_.back();
+}
+
+void UIBuilder::evictCachedPage(std::size_t slot) {
+    CachedPage& cached = page_cache_[slot];
+    if (cached.suspension) {
+        suspension_ui_ = {};
+    }
+    if (page_container_ == cached.root) {
+        page_container_ = nullptr;
+    }
+    lv_obj_del(cached.root);
+    for (lv_style_t* style : cached.styles) {
+        style_pool_.release(style);
+    }
+    page_cache_.erase(page_cache_.begin() + static_cast<std::ptrdiff_t>(slot));
+    page_switch_stats_.setResident(static_cast<uint32_t>(page_cache_.size()));
+}
+
+void UIBuilder::showCachedPage(CachedPage& page) {
+    for (auto& cached : page_cache_) {
+        if (&cached != &page && !lv_obj_has_flag(cached.root, LV_OBJ_FLAG_HIDDEN)) {
+            lv_obj_add_flag(cached.root, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+    lv_obj_clear_flag(page.root, LV_OBJ_FLAG_HIDDEN);
+    page.last_used = ++page_cache_clock_;
+    page_container_ = page.root;
+
+    // The suspension interface is full screen
+    for (lv_obj_t* chrome : {header_bar_, nav_bar_, header_overlay_}) {
+        if (!chrome) {
+            continue;
+        }
+        if (page.suspension) {
+            lv_obj_add_flag(chrome, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_clear_flag(chrome, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
+void UIBuilder::addPooledStyle(lv_obj_t* obj, const UIStyleProps& props, lv_style_selector_t selector) {
+    // The page being built holds one reference per distinct style
+    lv_style_t* style = style_pool_.acquire(props);
+    std::vector<lv_style_t*>& held = building_page_->styles;
+    if (std::find(held.begin(), held.end(), style) == held.end()) {
+        held.push_back(style);
+    } else {
+        style_pool_.release(style);
+    }
+    lv_obj_add_style(obj, style, selector);
+}
+
+// ─── Grid pages ─────────────────────────────────────────────────────────────
+
+void UIBuilder::resolveThemeColors() {
+    theme_colors_ = ThemeColors{};
+    if (!config_) {
         return;
     }
+    const ThemeConfig& theme = config_->theme;
+    theme_colors_.accent = colorFromHex(theme.accent_color, UITheme::COLOR_ACCENT);
+    theme_colors_.border = colorFromHex(theme.border_color, UITheme::COLOR_BORDER);
+    theme_colors_.text_primary = colorFromHex(theme.text_primary, UITheme::COLOR_TEXT_PRIMARY);
+    theme_colors_.text_secondary = colorFromHex(theme.text_secondary, UITheme::COLOR_TEXT_SECONDARY);
+    theme_colors_.page_bg = colorFromHex(theme.page_bg_color, UITheme::COLOR_SURFACE);
+}
 
-    const std::string page_bg_hex = !page.bg_color.empty()
-        ? page.bg_color
-        : (config_ ? config_->theme.page_bg_color : "#0F0F0F");
+void UIBuilder::buildGridPage(const PageConfig& page, CachedPage& cached) {
+    const lv_color_t page_bg = !page.bg_color.empty()
+        ? colorFromHex(page.bg_color, UITheme::COLOR_SURFACE)
+        : theme_colors_.page_bg;
 
-    lv_obj_clean(page_container_);
     lv_obj_remove_style_all(page_container_);
     lv_obj_set_width(page_container_, lv_pct(100));
     lv_obj_set_flex_grow(page_container_, 1);
-    lv_obj_set_style_bg_color(page_container_, colorFromHex(page_bg_hex, UITheme::COLOR_SURFACE), 0);
+    lv_obj_set_style_bg_color(page_container_, page_bg, 0);
     lv_obj_set_style_bg_opa(page_container_, LV_OPA_COVER, 0);
     lv_obj_set_style_radius(page_container_, 0, 0);
     lv_obj_set_style_pad_all(page_container_, UITheme::SPACE_MD, 0);
@@ -491,16 +666,16 @@ void UIBuilder::buildPage(std::size_t index) {
     lv_obj_set_style_shadow_width(page_container_, 0, 0);
     lv_obj_clear_flag(page_container_, LV_OBJ_FLAG_SCROLLABLE);
 
-    grid_cols_.assign(page.cols + 1, LV_GRID_TEMPLATE_LAST);
-    grid_rows_.assign(page.rows + 1, LV_GRID_TEMPLATE_LAST);
+    cached.grid_cols.assign(page.cols + 1, LV_GRID_TEMPLATE_LAST);
+    cached.grid_rows.assign(page.rows + 1, LV_GRID_TEMPLATE_LAST);
     for (std::size_t i = 0; i < page.cols; ++i) {
-        grid_cols_[i] = LV_GRID_FR(1);
+        cached.grid_cols[i] = LV_GRID_FR(1);
     }
-    grid_cols_.back() = LV_GRID_TEMPLATE_LAST;
+    cached.grid_cols.back() = LV_GRID_TEMPLATE_LAST;
     for (std::size_t i = 0; i < page.rows; ++i) {
-        grid_rows_[i] = LV_GRID_FR(1);
+        cached.grid_rows[i] = LV_GRID_FR(1);
     }
-    grid_rows_.back() = LV_GRID_TEMPLATE_LAST;
+    cached.grid_rows.back() = LV_GRID_TEMPLATE_LAST;
 
     if (page.buttons.empty()) {
         // No grid layout - just center the message
@@ -511,50 +686,53 @@ void UIBuilder::buildPage(std::size_t index) {
         lv_obj_t* label = lv_label_create(page_container_);
         lv_label_set_text(label, "This page has no buttons yet.");
         lv_obj_set_style_text_font(label, UITheme::FONT_BODY, 0);
-        lv_color_t secondary = config_ ? colorFromHex(config_->theme.text_secondary, UITheme::COLOR_TEXT_SECONDARY) : UITheme::COLOR_TEXT_SECONDARY;
-        lv_obj_set_style_text_color(label, secondary, 0);
-        updateNavSelection();
+        lv_obj_set_style_text_color(label, theme_colors_.text_secondary, 0);
         return;
     }
 
     // Set up grid layout for buttons
     lv_obj_set_layout(page_container_, LV_LAYOUT_GRID);
     lv_obj_set_style_pad_gap(page_container_, UITheme::SPACE_SM, 0);
-    lv_obj_set_grid_dsc_array(page_container_, grid_cols_.data(), grid_rows_.data());
+    lv_obj_set_grid_dsc_array(page_container_, cached.grid_cols.data(), cached.grid_rows.data());
+
+    // Button text color priority: per-button > page override > theme default
+    const lv_color_t page_text_color = !page.text_color.empty()
+        ? colorFromHex(page.text_color, theme_colors_.text_primary)
+        : theme_colors_.text_primary;
 
-    for (const auto& button : page.buttons) {
+    // Events point at the page's own copy, which lives as long as the buttons
+    cached.buttons = page.buttons;
+    for (const auto& button : cached.buttons) {
         lv_obj_t* btn = lv_btn_create(page_container_);
         lv_obj_remove_style_all(btn);
 
-        // Apply per-button styling; fall back to theme only when button fields are empty
-        lv_obj_set_style_radius(btn, button.corner_radius, 0);
-        lv_obj_set_style_border_width(btn, button.border_width, 0);
+        // Per-button look, falling back to the theme only when button fields
+        // are empty; buttons that resolve alike share one pooled style
         const lv_color_t border_color = !button.border_color.empty()
             ? colorFromHex(button.border_color, UITheme::COLOR_BORDER)
-            : (config_ ? colorFromHex(config_->theme.border_color, UITheme::COLOR_BORDER) : UITheme::COLOR_BORDER);
-        lv_obj_set_style_border_color(btn, border_color, 0);
-        lv_obj_set_style_border_opa(btn, button.border_width > 0 ? LV_OPA_COVER : LV_OPA_TRANSP, 0);
-
-        const std::string button_color_hex = !button.color.empty()
-            ? button.color
-            : (config_ ? config_->theme.accent_color : "#FFA500");
-        lv_color_t btn_color = colorFromHex(button_color_hex, UITheme::COLOR_ACCENT);
-        lv_obj_set_style_bg_color(btn, btn_color, 0);
-        lv_obj_set_style_bg_opa(btn, LV_OPA_COVER, 0);
+            : theme_colors_.border;
+        const lv_color_t btn_color = !button.color.empty()
+            ? colorFromHex(button.color, UITheme::COLOR_ACCENT)
+            : theme_colors_.accent;
+        addPooledStyle(btn, UIStyleProps()
+            .radiusPx(button.corner_radius)
+            .borderWidth(button.border_width)
+            .borderColor(border_color)
+            .borderOpa(button.border_width > 0 ? LV_OPA_COVER : LV_OPA_TRANSP)
+            .bgColor(btn_color)
+            .bgOpa(LV_OPA_COVER)
+            .padAll(UITheme::SPACE_MD)
+            .minHeight(88)
+            .shadowWidth(14)
+            .shadowColor(lv_color_hex(0x000000))
+            .shadowOpa(LV_OPA_20));
 
         // Pressed state color - use button override or derive from base color
-        const std::string pressed_hex = !button.pressed_color.empty() ? button.pressed_color : "";
-        lv_color_t pressed_color = pressed_hex.empty()
+        const lv_color_t pressed_color = button.pressed_color.empty()
             ? lv_color_darken(btn_color, LV_OPA_40)
-            : colorFromHex(pressed_hex, lv_color_darken(btn_color, LV_OPA_40));
-        lv_obj_set_style_bg_color(btn, pressed_color, LV_STATE_PRESSED);
-        lv_obj_set_style_bg_opa(btn, LV_OPA_COVER, LV_STATE_PRESSED);
-
-        lv_obj_set_style_pad_all(btn, UITheme::SPACE_MD, 0);
-        lv_obj_set_style_min_height(btn, 88, 0);
-        lv_obj_set_style_shadow_width(btn, 14, 0);
-        lv_obj_set_style_shadow_color(btn, lv_color_hex(0x000000), 0);
-        lv_obj_set_style_shadow_opa(btn, LV_OPA_20, 0);
+            : colorFromHex(button.pressed_color, lv_color_darken(btn_color, LV_OPA_40));
+        addPooledStyle(btn, UIStyleProps().bgColor(pressed_color).bgOpa(LV_OPA_COVER), LV_STATE_PRESSED);
+
         lv_obj_set_grid_cell(btn,
                      LV_GRID_ALIGN_STRETCH, button.col, button.col_span,
                      LV_GRID_ALIGN_STRETCH, button.row, button.row_span);
@@ -577,18 +755,9 @@ void UIBuilder::buildPage(std::size_t index) {
 
         lv_obj_t* title = lv_label_create(btn);
         lv_label_set_text(title, button.label.c_str());
-        // Button text color priority: per-button > page override > theme default
-        const lv_color_t theme_text_fallback = config_
-            ? colorFromHex(config_->theme.text_primary, UITheme::COLOR_TEXT_PRIMARY)
-            : UITheme::COLOR_TEXT_PRIMARY;
-        const lv_color_t page_text_fallback = !page.text_color.empty()
-            ? colorFromHex(page.text_color, theme_text_fallback)
-            : theme_text_fallback;
-        lv_color_t label_color = page_text_fallback;
-        if (!button.text_color.empty()) {
-            label_color = colorFromHex(button.text_color, page_text_fallback);
-        }
-        lv_obj_set_style_text_color(title, label_color, 0);
+        const lv_color_t label_color = !button.text_color.empty()
+            ? colorFromHex(button.text_color, page_text_color)
+            : page_text_color;
 
         // Use font_name if specified, otherwise use font_family + font_size
         const lv_font_t* font;
@@ -612,10 +781,8 @@ void UIBuilder::buildPage(std::size_t index) {
             else if (button.font_size <= 31) font = &lv_font_montserrat_30;
             else font = &lv_font_montserrat_32;
         }
-        lv_obj_set_style_text_font(title, font, 0);
 
-        // Apply text alignment - set label to full button width for text alignment to work
-        lv_obj_set_width(title, lv_pct(100));
+        // Apply text alignment - the label style spans the full button width for text alignment to work
         lv_label_set_long_mode(title, LV_LABEL_LONG_WRAP);
         
         lv_align_t align = LV_ALIGN_CENTER;
@@ -627,11 +794,13 @@ void UIBuilder::buildPage(std::size_t index) {
         else if (button.text_align == "bottom-left") { align = LV_ALIGN_BOTTOM_LEFT; text_align = LV_TEXT_ALIGN_LEFT; }
         else if (button.text_align == "bottom-center") { align = LV_ALIGN_BOTTOM_MID; text_align = LV_TEXT_ALIGN_CENTER; }
         else if (button.text_align == "bottom-right") { align = LV_ALIGN_BOTTOM_RIGHT; text_align = LV_TEXT_ALIGN_RIGHT; }
+        addPooledStyle(title, UIStyleProps()
+            .textColor(label_color)
+            .textFont(font)
+            .textAlign(text_align)
+            .widthPx(lv_pct(100)));
         lv_obj_align(title, align, 0, 0);
-        lv_obj_set_style_text_align(title, text_align, 0);
     }
-
-    updateNavSelection();
 }
 
 void UIBuilder::updateNavSelection() {
@@ -695,20 +864,21 @@ void UIBuilder::actionButtonEvent(lv_event_t* e) {
                 }
 
                 if (action == "toggle") {
-                    auto* scene = behaviorEngine.getScene(config->scene_id.c_str());
-                    if (scene && scene->isActive) {
+                    const auto snapshot = behaviorEngine.snapshot();
+                    const auto* scene = snapshot->findScene(config->scene_id.c_str());
+                    if (scene && behaviorEngine.isSceneActive(*scene)) {
                         Serial.printf("[UI] Scene %s → TOGGLE OFF\n", config->scene_id.c_str());
                         behaviorEngine.deactivateScene(config->scene_id.c_str());
                         return;
                     }
                 }
 
-                if (auto* scene = behaviorEngine.getScene(config->scene_id.c_str())) {
-                    scene->duration_ms = config->scene_duration_ms;
-                }
-
                 Serial.printf("[UI] Scene %s → ON\n", config->scene_id.c_str());
-                behaviorEngine.activateScene(config->scene_id.c_str());
+                if (!behaviorEngine.activateScene(config->scene_id.c_str(),
+                                                  static_cast<int32_t>(config->scene_duration_ms))) {
+                    Serial.printf("[UI] ✗ Scene %s not activated (unknown or engine busy)\n",
+                                  config->scene_id.c_str());
+                }
             }
 
             if (code == LV_EVENT_RELEASED || code == LV_EVENT_PRESS_LOST || code == LV_EVENT_CANCEL) {
@@ -739,8 +909,9 @@ void UIBuilder::actionButtonEvent(lv_event_t* e) {
                 }
 
                 if (action == "toggle") {
-                    auto* out = behaviorEngine.getOutput(output_id.c_str());
-                    if (out && out->isActive) {
+                    const auto snapshot = behaviorEngine.snapshot();
+                    const auto* out = snapshot->findOutput(output_id.c_str());
+                    if (out && behaviorEngine.isOutputActive(*out)) {
                         Serial.printf("[UI] Output %s → TOGGLE OFF\n", output_id.c_str());
                         behaviorEngine.deactivateOutput(output_id.c_str());
                         return;
@@ -792,8 +963,11 @@ void UIBuilder::actionButtonEvent(lv_event_t* e) {
                     behavior.fadeTime_ms = config->output_behavior.fade_time_ms;
                 }
                 
-                // Activate the behavior on the output
-                behaviorEngine.setBehavior(output_id.c_str(), behavior);
+                // Activate the behavior on the output. Only a turn-on can be
+                // refused; the release path below always gets through.
+                if (!behaviorEngine.setBehavior(output_id.c_str(), behavior)) {
+                    Serial.printf("[UI] ✗ Output %s not set (unknown or engine busy)\n", output_id.c_str());
+                }
             }
             
             // Handle release - check auto_off regardless of momentary mode
@@ -2430,7 +2604,7 @@ uint32_t UIBuilder::nextUtf8Codepoint(const std::string& text, std::size_t& inde
 // ============================================================================
 
 void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
-    if (!base_screen_) return;
+    if (!base_screen_ || !page_container_) return;
 
     suspension_ui_ = {};
 
@@ -2438,29 +2612,23 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
         ? page.bg_color
         : (config_ ? config_->theme.page_bg_color : "#0F0F0F");
 
-    // Hide the header and nav for full-screen experience
-    if (header_bar_) lv_obj_add_flag(header_bar_, LV_OBJ_FLAG_HIDDEN);
-    if (nav_bar_) lv_obj_add_flag(nav_bar_, LV_OBJ_FLAG_HIDDEN);
-    if (header_overlay_) lv_obj_add_flag(header_overlay_, LV_OBJ_FLAG_HIDDEN);
-    
-    // Use content_root_ for the full-screen suspension interface
-    lv_obj_clean(content_root_);
-    lv_obj_remove_style_all(content_root_);
-    lv_obj_set_width(content_root_, lv_pct(100));
-    lv_obj_set_height(content_root_, lv_pct(100));
-    lv_obj_set_style_bg_color(content_root_, colorFromHex(page_bg_hex, UITheme::COLOR_SURFACE), 0);
-    lv_obj_set_style_bg_opa(content_root_, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(content_root_, 0, 0);
-    lv_obj_set_style_pad_all(content_root_, 8, 0);
-    lv_obj_set_style_border_width(content_root_, 0, 0);
-    lv_obj_set_layout(content_root_, LV_LAYOUT_FLEX);
-    lv_obj_set_flex_flow(content_root_, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(content_root_, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_pad_gap(content_root_, 8, 0);
-    lv_obj_clear_flag(content_root_, LV_OBJ_FLAG_SCROLLABLE);
+    // Full screen: showCachedPage() hides the header and nav for this page
+    lv_obj_remove_style_all(page_container_);
+    lv_obj_set_width(page_container_, lv_pct(100));
+    lv_obj_set_height(page_container_, lv_pct(100));
+    lv_obj_set_style_bg_color(page_container_, colorFromHex(page_bg_hex, UITheme::COLOR_SURFACE), 0);
+    lv_obj_set_style_bg_opa(page_container_, LV_OPA_COVER, 0);
+    lv_obj_set_style_radius(page_container_, 0, 0);
+    lv_obj_set_style_pad_all(page_container_, 8, 0);
+    lv_obj_set_style_border_width(page_container_, 0, 0);
+    lv_obj_set_layout(page_container_, LV_LAYOUT_FLEX);
+    lv_obj_set_flex_flow(page_container_, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_flex_align(page_container_, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER);
+    lv_obj_set_style_pad_gap(page_container_, 8, 0);
+    lv_obj_clear_flag(page_container_, LV_OBJ_FLAG_SCROLLABLE);
 
     // Create compact title row with back button, title, and calibrate button
-    lv_obj_t* title_row = lv_obj_create(content_root_);
+    lv_obj_t* title_row = lv_obj_create(page_container_);
     lv_obj_remove_style_all(title_row);
     lv_obj_set_size(title_row, lv_pct(100), LV_SIZE_CONTENT);
     lv_obj_set_layout(title_row, LV_LAYOUT_FLEX);
@@ -2501,7 +2669,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     suspension_ui_.calibrate_label = cal_lbl;
 
     // Front Dampers Section
-    lv_obj_t* front_label = lv_label_create(content_root_);
+    lv_obj_t* front_label = lv_label_create(page_container_);
     lv_label_set_text(front_label, "FRONT DAMPER SETTINGS");
     lv_obj_set_style_text_font(front_label, &lv_font_montserrat_12, 0);
     lv_obj_set_style_text_color(front_label, lv_color_hex(0x8d92a3), 0);
@@ -2509,7 +2677,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     lv_obj_set_style_text_align(front_label, LV_TEXT_ALIGN_CENTER, 0);
     
     // Front preset buttons
-    lv_obj_t* front_presets = lv_obj_create(content_root_);
+    lv_obj_t* front_presets = lv_obj_create(page_container_);
     lv_obj_remove_style_all(front_presets);
     lv_obj_set_size(front_presets, lv_pct(100), LV_SIZE_CONTENT);
     lv_obj_set_layout(front_presets, LV_LAYOUT_FLEX);
@@ -2537,7 +2705,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     }
 
     // Front dampers container
-    lv_obj_t* front_cont = lv_obj_create(content_root_);
+    lv_obj_t* front_cont = lv_obj_create(page_container_);
     lv_obj_remove_style_all(front_cont);
     lv_obj_set_size(front_cont, lv_pct(100), LV_SIZE_CONTENT);
     lv_obj_set_layout(front_cont, LV_LAYOUT_FLEX);
@@ -2551,7 +2719,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     createDamperCard(front_cont, "Front Right", "FR");
 
     // Rear Dampers Section
-    lv_obj_t* rear_label = lv_label_create(content_root_);
+    lv_obj_t* rear_label = lv_label_create(page_container_);
     lv_label_set_text(rear_label, "REAR DAMPER SETTINGS");
     lv_obj_set_style_text_font(rear_label, &lv_font_montserrat_12, 0);
     lv_obj_set_style_text_color(rear_label, lv_color_hex(0x8d92a3), 0);
@@ -2559,7 +2727,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     lv_obj_set_style_text_align(rear_label, LV_TEXT_ALIGN_CENTER, 0);
     
     // Rear preset buttons
-    lv_obj_t* rear_presets = lv_obj_create(content_root_);
+    lv_obj_t* rear_presets = lv_obj_create(page_container_);
     lv_obj_remove_style_all(rear_presets);
     lv_obj_set_size(rear_presets, lv_pct(100), LV_SIZE_CONTENT);
     lv_obj_set_layout(rear_presets, LV_LAYOUT_FLEX);
@@ -2587,7 +2755,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     }
 
     // Rear dampers container
-    lv_obj_t* rear_cont = lv_obj_create(content_root_);
+    lv_obj_t* rear_cont = lv_obj_create(page_container_);
     lv_obj_remove_style_all(rear_cont);
     lv_obj_set_size(rear_cont, lv_pct(100), LV_SIZE_CONTENT);
     lv_obj_set_layout(rear_cont, LV_LAYOUT_FLEX);
@@ -2601,7 +2769,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     createDamperCard(rear_cont, "Rear Right", "RR");
 
     // Anti-Roll & Anti-Pitch Section
-    lv_obj_t* control_label = lv_label_create(content_root_);
+    lv_obj_t* control_label = lv_label_create(page_container_);
     lv_label_set_text(control_label, "ANTI-ROLL & PITCH");
     lv_obj_set_style_text_font(control_label, &lv_font_montserrat_12, 0);
     lv_obj_set_style_text_color(control_label, lv_color_hex(0x8d92a3), 0);
@@ -2609,7 +2777,7 @@ void UIBuilder::buildSuspensionInterfacePage(const PageConfig& page) {
     lv_obj_set_style_text_align(control_label, LV_TEXT_ALIGN_CENTER, 0);
 
     // Control buttons container
-    lv_obj_t* control_cont = lv_obj_create(content_root_);
+    lv_obj_t* control_cont = lv_obj_create(page_container_);
     lv_obj_remove_style_all(control_cont);
     lv_obj_set_size(control_cont, lv_pct(100), LV_SIZE_CONTENT);
     lv_obj_set_layout(control_cont, LV_LAYOUT_FLEX);
@@ -2794,7 +2962,6 @@ void UIBuilder::buildInfinityboxPage(std::size_t category_index) {
 void UIBuilder::buildInfinityboxDrivingPage() {
     if (!page_container_) return;
 
-    lv_obj_clean(page_container_);
     lv_obj_remove_style_all(page_container_);
     lv_obj_set_width(page_container_, lv_pct(100));
     lv_obj_set_flex_grow(page_container_, 1);
@@ -2823,7 +2990,6 @@ void UIBuilder::buildInfinityboxDrivingPage() {
 void UIBuilder::buildInfinityboxExteriorPage() {
     if (!page_container_) return;
 
-    lv_obj_clean(page_container_);
     lv_obj_remove_style_all(page_container_);
     lv_obj_set_width(page_container_, lv_pct(100));
     lv_obj_set_flex_grow(page_container_, 1);
@@ -2847,7 +3013,6 @@ void UIBuilder::buildInfinityboxExteriorPage() {
 void UIBuilder::buildInfinityboxInteriorPage() {
     if (!page_container_) return;
 
-    lv_obj_clean(page_container_);
     lv_obj_remove_style_all(page_container_);
     lv_obj_set_width(page_container_, lv_pct(100));
     lv_obj_set_flex_grow(page_container_, 1);
@@ -2867,7 +3032,6 @@ void UIBuilder::buildInfinityboxInteriorPage() {
 void UIBuilder::buildInfinityboxBodyPage() {
     if (!page_container_) return;
 
-    lv_obj_clean(page_container_);
     lv_obj_remove_style_all(page_container_);
     lv_obj_set_width(page_container_, lv_pct(100));
     lv_obj_set_flex_grow(page_container_, 1);
@@ -2895,7 +3059,6 @@ void UIBuilder::buildInfinityboxBodyPage() {
 void UIBuilder::buildInfinityboxPowertrainPage() {
     if (!page_container_) return;
 
-    lv_obj_clean(page_container_);
     lv_obj_remove_style_all(page_container_);
     lv_obj_set_width(page_container_, lv_pct(100));
     lv_obj_set_flex_grow(page_container_, 1);
@@ -2918,7 +3081,6 @@ void UIBuilder::buildInfinityboxPowertrainPage() {
 void UIBuilder::buildInfinityboxAuxPage() {
     if (!page_container_) return;
 
-    lv_obj_clean(page_container_);
     lv_obj_remove_style_all(page_container_);
     lv_obj_set_width(page_container_, lv_pct(100));
     lv_obj_set_flex_grow(page_container_, 1);
@@ -2944,78 +3106,50 @@ void UIBuilder::buildInfinityboxAuxPage() {
 }
 
 // Widget creation helpers
-lv_obj_t* UIBuilder::createFunctionToggle(lv_obj_t* parent, const char* label, const char* function_name) {
+lv_obj_t* UIBuilder::createFunctionButton(lv_obj_t* parent, const char* label, lv_color_t active_color, lv_state_t active_state) {
     lv_obj_t* btn = lv_btn_create(parent);
     lv_obj_remove_style_all(btn);
-    lv_obj_set_size(btn, 180, 90);
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x333333), 0);
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0xFF6600), LV_STATE_CHECKED);
-    lv_obj_set_style_bg_opa(btn, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(btn, 12, 0);
-    lv_obj_set_style_border_width(btn, 2, 0);
-    lv_obj_set_style_border_color(btn, lv_color_hex(0x555555), 0);
-    lv_obj_set_style_pad_all(btn, UITheme::SPACE_SM, 0);
-    lv_obj_add_flag(btn, LV_OBJ_FLAG_CHECKABLE);
-    lv_obj_add_event_cb(btn, infinityboxToggleEvent, LV_EVENT_VALUE_CHANGED, (void*)function_name);
+    addPooledStyle(btn, UIStyleProps()
+        .widthPx(180)
+        .heightPx(90)
+        .bgColor(lv_color_hex(0x333333))
+        .bgOpa(LV_OPA_COVER)
+        .radiusPx(12)
+        .borderWidth(2)
+        .borderColor(lv_color_hex(0x555555))
+        .padAll(UITheme::SPACE_SM));
+    addPooledStyle(btn, UIStyleProps().bgColor(active_color), active_state);
 
     lv_obj_t* lbl = lv_label_create(btn);
     lv_label_set_text(lbl, label);
-    lv_obj_set_style_text_color(lbl, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_font(lbl, UITheme::FONT_BODY, 0);
+    addPooledStyle(lbl, UIStyleProps()
+        .textColor(lv_color_hex(0xFFFFFF))
+        .textFont(UITheme::FONT_BODY)
+        .widthPx(lv_pct(100)));
     lv_label_set_long_mode(lbl, LV_LABEL_LONG_WRAP);
-    lv_obj_set_width(lbl, lv_pct(100));
     lv_obj_center(lbl);
 
     return btn;
 }
 
+lv_obj_t* UIBuilder::createFunctionToggle(lv_obj_t* parent, const char* label, const char* function_name) {
+    lv_obj_t* btn = createFunctionButton(parent, label, lv_color_hex(0xFF6600), LV_STATE_CHECKED);
+    lv_obj_add_flag(btn, LV_OBJ_FLAG_CHECKABLE);
+    lv_obj_add_event_cb(btn, infinityboxToggleEvent, LV_EVENT_VALUE_CHANGED, (void*)function_name);
+    return btn;
+}
+
 lv_obj_t* UIBuilder::createFunctionMomentary(lv_obj_t* parent, const char* label, const char* function_name) {
-    lv_obj_t* btn = lv_btn_create(parent);
-    lv_obj_remove_style_all(btn);
-    lv_obj_set_size(btn, 180, 90);
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x333333), 0);
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x00AA00), LV_STATE_PRESSED);
-    lv_obj_set_style_bg_opa(btn, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(btn, 12, 0);
-    lv_obj_set_style_border_width(btn, 2, 0);
-    lv_obj_set_style_border_color(btn, lv_color_hex(0x555555), 0);
-    lv_obj_set_style_pad_all(btn, UITheme::SPACE_SM, 0);
+    lv_obj_t* btn = createFunctionButton(parent, label, lv_color_hex(0x00AA00), LV_STATE_PRESSED);
     lv_obj_add_event_cb(btn, infinityboxMomentaryEvent, LV_EVENT_PRESSED, (void*)function_name);
     lv_obj_add_event_cb(btn, infinityboxMomentaryEvent, LV_EVENT_RELEASED, (void*)function_name);
-
-    lv_obj_t* lbl = lv_label_create(btn);
-    lv_label_set_text(lbl, label);
-    lv_obj_set_style_text_color(lbl, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_font(lbl, UITheme::FONT_BODY, 0);
-    lv_label_set_long_mode(lbl, LV_LABEL_LONG_WRAP);
-    lv_obj_set_width(lbl, lv_pct(100));
-    lv_obj_center(lbl);
-
     return btn;
 }
 
 lv_obj_t* UIBuilder::createFunctionFlash(lv_obj_t* parent, const char* label, const char* function_name) {
-    lv_obj_t* btn = lv_btn_create(parent);
-    lv_obj_remove_style_all(btn);
-    lv_obj_set_size(btn, 180, 90);
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0x333333), 0);
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0xFFAA00), LV_STATE_CHECKED);
-    lv_obj_set_style_bg_opa(btn, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(btn, 12, 0);
-    lv_obj_set_style_border_width(btn, 2, 0);
-    lv_obj_set_style_border_color(btn, lv_color_hex(0x555555), 0);
-    lv_obj_set_style_pad_all(btn, UITheme::SPACE_SM, 0);
+    lv_obj_t* btn = createFunctionButton(parent, label, lv_color_hex(0xFFAA00), LV_STATE_CHECKED);
     lv_obj_add_flag(btn, LV_OBJ_FLAG_CHECKABLE);
     lv_obj_add_event_cb(btn, infinityboxFlashEvent, LV_EVENT_VALUE_CHANGED, (void*)function_name);
-
-    lv_obj_t* lbl = lv_label_create(btn);
-    lv_label_set_text(lbl, label);
-    lv_obj_set_style_text_color(lbl, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_font(lbl, UITheme::FONT_BODY, 0);
-    lv_label_set_long_mode(lbl, LV_LABEL_LONG_WRAP);
-    lv_obj_set_width(lbl, lv_pct(100));
-    lv_obj_center(lbl);
-
     return btn;
 }
 
@@ -3151,12 +3285,7 @@ void UIBuilder::suspensionControlEvent(lv_event_t* e) {
 void UIBuilder::suspensionBackEvent(lv_event_t* e) {
     UIBuilder& builder = UIBuilder::instance();
     
-    // Restore header and nav visibility
-    if (builder.header_bar_) lv_obj_clear_flag(builder.header_bar_, LV_OBJ_FLAG_HIDDEN);
-    if (builder.nav_bar_) lv_obj_clear_flag(builder.nav_bar_, LV_OBJ_FLAG_HIDDEN);
-    if (builder.header_overlay_) lv_obj_clear_flag(builder.header_overlay_, LV_OBJ_FLAG_HIDDEN);
-    
-    // Go back to the last page before suspension
+    // Go back to the last page before suspension (restores header and nav)
     builder.buildPage(builder.last_page_before_suspension_);
     
     Serial.printf("[Suspension] Back to page %zu\n", builder.last_page_before_suspension_);
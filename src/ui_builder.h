@@ -8,6 +8,8 @@
 #include <vector>
 
 #include "config_types.h"
+#include "page_switch_stats.h"
+#include "ui_style_pool.h"
 #include "ui_theme.h"
 
 class UIBuilder {
@@ -25,6 +27,10 @@ public:
                              bool sta_connected,
                              const std::string& sta_ssid);
     void setBrightness(uint8_t percent);
+    // Built pages kept for navigation (see CachedPage)
+    static constexpr std::size_t kPageCacheSize = 6;
+    const PageSwitchStats& pageSwitchStats() const { return page_switch_stats_; }
+    const UIStylePool& stylePool() const { return style_pool_; }
 
 private:
     UIBuilder() = default;
@@ -38,6 +44,42 @@ private:
     void buildEmptyState();
     void buildPage(std::size_t index);
     void updateNavSelection();
+
+    // Page cache: each built page is a subtree of content_root_, hidden
+    // while another page is shown. Entries are reused until applyConfig()
+    // changes that page's content (or the theme), or until evicted as
+    // least recently used.
+    struct CachedPage {
+        std::size_t index = 0;        // buildPage() index
+        lv_obj_t* root = nullptr;
+        uint32_t fingerprint = 0;     // Content the subtree was built from
+        uint32_t last_used = 0;
+        bool suspension = false;      // Full screen: header and nav hidden
+        std::vector<lv_coord_t> grid_cols;  // Referenced by LVGL, must outlive root
+        std::vector<lv_coord_t> grid_rows;
+        std::vector<ButtonConfig> buttons;  // Event user data, independent of config reloads
+        std::vector<lv_style_t*> styles;    // Pool references, released after root is deleted
+    };
+    static constexpr std::size_t kEmptyStatePage = static_cast<std::size_t>(-1);
+    void refreshPageFingerprints();
+    uint32_t pageFingerprint(std::size_t index) const;
+    CachedPage* findCachedPage(std::size_t index);
+    CachedPage& createCachedPage(std::size_t index, uint32_t fingerprint);
+    void evictCachedPage(std::size_t slot);
+    void showCachedPage(CachedPage& page);
+    // Attach a shared style owned by the page being built (building_page_)
+    void addPooledStyle(lv_obj_t* obj, const UIStyleProps& props, lv_style_selector_t selector = 0);
+
+    // Theme colors parsed once per config instead of once per widget
+    struct ThemeColors {
+        lv_color_t accent = UITheme::COLOR_ACCENT;
+        lv_color_t border = UITheme::COLOR_BORDER;
+        lv_color_t text_primary = UITheme::COLOR_TEXT_PRIMARY;
+        lv_color_t text_secondary = UITheme::COLOR_TEXT_SECONDARY;
+        lv_color_t page_bg = lv_color_hex(0x0F0F0F);
+    };
+    void resolveThemeColors();
+    void buildGridPage(const PageConfig& page, CachedPage& cached);
     
     // Suspension interface UI
     void buildSuspensionInterfacePage(const PageConfig& page);
@@ -58,6 +100,7 @@ private:
     void buildInfinityboxBodyPage();
     void buildInfinityboxPowertrainPage();
     void buildInfinityboxAuxPage();
+    lv_obj_t* createFunctionButton(lv_obj_t* parent, const char* label, lv_color_t active_color, lv_state_t active_state);
     lv_obj_t* createFunctionToggle(lv_obj_t* parent, const char* label, const char* function_name);
     lv_obj_t* createFunctionMomentary(lv_obj_t* parent, const char* label, const char* function_name);
     lv_obj_t* createFunctionFlash(lv_obj_t* parent, const char* label, const char* function_name);
@@ -154,10 +197,15 @@ private:
     lv_obj_t* status_sta_chip_ = nullptr;
     lv_obj_t* status_ap_label_ = nullptr;
     lv_obj_t* status_sta_label_ = nullptr;
-    lv_obj_t* page_container_ = nullptr;
+    lv_obj_t* page_container_ = nullptr;  // Root of the page being built or shown
     std::vector<lv_obj_t*> nav_buttons_;
-    std::vector<lv_coord_t> grid_cols_;
-    std::vector<lv_coord_t> grid_rows_;
+    std::vector<CachedPage> page_cache_;
+    std::vector<uint32_t> page_fingerprints_;  // Per config page, from applyConfig()
+    uint32_t page_cache_clock_ = 0;
+    CachedPage* building_page_ = nullptr;  // Set while buildPage() fills a new entry
+    PageSwitchStats page_switch_stats_;
+    UIStylePool style_pool_;
+    ThemeColors theme_colors_;
     std::size_t active_page_ = 0;
     std::size_t last_page_before_suspension_ = 0;  // Track page before entering suspension
     bool dirty_ = false;
@@ -0,0 +1,130 @@
+/**
+ * @file ui_style_pool.cpp
+ * Shared, deduplicated LVGL styles implementation
+ */
+
+#include "ui_style_pool.h"
+
+#include <Arduino.h>
+
+#include <algorithm>
+
+namespace {
+
+// FNV-1a over the set property bits and each set value
+struct PropHasher {
+    uint32_t value = 2166136261u;
+
+    void add(uint32_t word) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            value ^= (word >> shift) & 0xFFu;
+            value *= 16777619u;
+        }
+    }
+};
+
+bool sameColor(lv_color_t a, lv_color_t b) { return lv_color_to32(a) == lv_color_to32(b); }
+
+}  // namespace
+
+// ========== PROPERTIES ==========
+
+uint32_t UIStyleProps::hash() const {
+    PropHasher hasher;
+    hasher.add(set);
+    if (set & BG_COLOR) hasher.add(lv_color_to32(bg_color));
+    if (set & BG_OPA) hasher.add(bg_opa);
+    if (set & RADIUS) hasher.add(static_cast<uint32_t>(radius));
+    if (set & BORDER_WIDTH) hasher.add(static_cast<uint32_t>(border_width));
+    if (set & BORDER_COLOR) hasher.add(lv_color_to32(border_color));
+    if (set & BORDER_OPA) hasher.add(border_opa);
+    if (set & PAD_ALL) hasher.add(static_cast<uint32_t>(pad_all));
+    if (set & WIDTH) hasher.add(static_cast<uint32_t>(width));
+    if (set & HEIGHT) hasher.add(static_cast<uint32_t>(height));
+    if (set & MIN_HEIGHT) hasher.add(static_cast<uint32_t>(min_height));
+    if (set & SHADOW_WIDTH) hasher.add(static_cast<uint32_t>(shadow_width));
+    if (set & SHADOW_COLOR) hasher.add(lv_color_to32(shadow_color));
+    if (set & SHADOW_OPA) hasher.add(shadow_opa);
+    if (set & TEXT_COLOR) hasher.add(lv_color_to32(text_color));
+    if (set & TEXT_FONT) hasher.add(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(text_font)));
+    if (set & TEXT_ALIGN) hasher.add(text_align);
+    return hasher.value;
+}
+
+bool UIStyleProps::operator==(const UIStyleProps& other) const {
+    return set == other.set &&
+           (!(set & BG_COLOR) || sameColor(bg_color, other.bg_color)) &&
+           (!(set & BG_OPA) || bg_opa == other.bg_opa) &&
+           (!(set & RADIUS) || radius == other.radius) &&
+           (!(set & BORDER_WIDTH) || border_width == other.border_width) &&
+           (!(set & BORDER_COLOR) || sameColor(border_color, other.border_color)) &&
+           (!(set & BORDER_OPA) || border_opa == other.border_opa) &&
+           (!(set & PAD_ALL) || pad_all == other.pad_all) &&
+           (!(set & WIDTH) || width == other.width) &&
+           (!(set & HEIGHT) || height == other.height) &&
+           (!(set & MIN_HEIGHT) || min_height == other.min_height) &&
+           (!(set & SHADOW_WIDTH) || shadow_width == other.shadow_width) &&
+           (!(set & SHADOW_COLOR) || sameColor(shadow_color, other.shadow_color)) &&
+           (!(set & SHADOW_OPA) || shadow_opa == other.shadow_opa) &&
+           (!(set & TEXT_COLOR) || sameColor(text_color, other.text_color)) &&
+           (!(set & TEXT_FONT) || text_font == other.text_font) &&
+           (!(set & TEXT_ALIGN) || text_align == other.text_align);
+}
+
+// ========== POOL ==========
+
+lv_style_t* UIStylePool::acquire(const UIStyleProps& props) {
+    const uint32_t hash = props.hash();
+    for (auto& entry : entries_) {
+        if (entry->hash == hash && entry->props == props) {
+            ++entry->refs;
+            reference_count_.fetch_add(1, std::memory_order_relaxed);
+            return &entry->style;
+        }
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->props = props;
+    entry->hash = hash;
+    entry->refs = 1;
+
+    lv_style_t* style = &entry->style;
+    lv_style_init(style);
+    if (props.set & UIStyleProps::BG_COLOR) lv_style_set_bg_color(style, props.bg_color);
+    if (props.set & UIStyleProps::BG_OPA) lv_style_set_bg_opa(style, props.bg_opa);
+    if (props.set & UIStyleProps::RADIUS) lv_style_set_radius(style, props.radius);
+    if (props.set & UIStyleProps::BORDER_WIDTH) lv_style_set_border_width(style, props.border_width);
+    if (props.set & UIStyleProps::BORDER_COLOR) lv_style_set_border_color(style, props.border_color);
+    if (props.set & UIStyleProps::BORDER_OPA) lv_style_set_border_opa(style, props.border_opa);
+    if (props.set & UIStyleProps::PAD_ALL) lv_style_set_pad_all(style, props.pad_all);
+    if (props.set & UIStyleProps::WIDTH) lv_style_set_width(style, props.width);
+    if (props.set & UIStyleProps::HEIGHT) lv_style_set_height(style, props.height);
+    if (props.set & UIStyleProps::MIN_HEIGHT) lv_style_set_min_height(style, props.min_height);
+    if (props.set & UIStyleProps::SHADOW_WIDTH) lv_style_set_shadow_width(style, props.shadow_width);
+    if (props.set & UIStyleProps::SHADOW_COLOR) lv_style_set_shadow_color(style, props.shadow_color);
+    if (props.set & UIStyleProps::SHADOW_OPA) lv_style_set_shadow_opa(style, props.shadow_opa);
+    if (props.set & UIStyleProps::TEXT_COLOR) lv_style_set_text_color(style, props.text_color);
+    if (props.set & UIStyleProps::TEXT_FONT) lv_style_set_text_font(style, props.text_font);
+    if (props.set & UIStyleProps::TEXT_ALIGN) lv_style_set_text_align(style, props.text_align);
+
+    entries_.push_back(std::move(entry));
+    style_count_.store(static_cast<uint32_t>(entries_.size()), std::memory_order_relaxed);
+    reference_count_.fetch_add(1, std::memory_order_relaxed);
+    return style;
+}
+
+void UIStylePool::release(lv_style_t* style) {
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [style](const std::unique_ptr<Entry>& entry) { return &entry->style == style; });
+    if (it == entries_.end()) {
+        Serial.println("[UI] ✗ Style pool: release of unknown style");
+        return;
+    }
+    reference_count_.fetch_sub(1, std::memory_order_relaxed);
+    if (--(*it)->refs > 0) {
+        return;
+    }
+    lv_style_reset(&(*it)->style);
+    entries_.erase(it);
+    style_count_.store(static_cast<uint32_t>(entries_.size()), std::memory_order_relaxed);
+}
@@ -0,0 +1,127 @@
+/**
+ * @file ui_style_pool.h
+ * Shared, deduplicated LVGL styles for config-driven widgets
+ *
+ * Setting a style property on an object (lv_obj_set_style_*) gives that
+ * object its own local style, allocated in the LVGL heap and searched on
+ * every style lookup while rendering. Widgets built from the config share
+ * a handful of looks, so the builder describes each look as UIStyleProps
+ * and takes a shared lv_style_t for it from the pool instead. Identical
+ * props (same hash, same values) resolve to the same style.
+ *
+ * Styles are reference counted: every acquire() is paired with a
+ * release() once the objects using the style have been deleted, and the
+ * style is reset when the last reference goes. Only the LVGL task may
+ * acquire or release; the counters may be read from any task.
+ */
+
+#ifndef UI_STYLE_POOL_H
+#define UI_STYLE_POOL_H
+
+#include <lvgl.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Resolved style properties; only the properties that were set are applied
+struct UIStyleProps {
+    enum Prop : uint32_t {
+        BG_COLOR = 1u << 0,
+        BG_OPA = 1u << 1,
+        RADIUS = 1u << 2,
+        BORDER_WIDTH = 1u << 3,
+        BORDER_COLOR = 1u << 4,
+        BORDER_OPA = 1u << 5,
+        PAD_ALL = 1u << 6,
+        WIDTH = 1u << 7,
+        HEIGHT = 1u << 8,
+        MIN_HEIGHT = 1u << 9,
+        SHADOW_WIDTH = 1u << 10,
+        SHADOW_COLOR = 1u << 11,
+        SHADOW_OPA = 1u << 12,
+        TEXT_COLOR = 1u << 13,
+        TEXT_FONT = 1u << 14,
+        TEXT_ALIGN = 1u << 15,
+    };
+
+    uint32_t set = 0;  // Prop bits
+    lv_color_t bg_color = lv_color_black();
+    lv_color_t border_color = lv_color_black();
+    lv_color_t shadow_color = lv_color_black();
+    lv_color_t text_color = lv_color_black();
+    const lv_font_t* text_font = nullptr;
+    lv_coord_t radius = 0;
+    lv_coord_t border_width = 0;
+    lv_coord_t pad_all = 0;
+    lv_coord_t width = 0;
+    lv_coord_t height = 0;
+    lv_coord_t min_height = 0;
+    lv_coord_t shadow_width = 0;
+    lv_opa_t bg_opa = LV_OPA_TRANSP;
+    lv_opa_t border_opa = LV_OPA_TRANSP;
+    lv_opa_t shadow_opa = LV_OPA_TRANSP;
+    lv_text_align_t text_align = LV_TEXT_ALIGN_AUTO;
+
+    UIStyleProps& bgColor(lv_color_t color) { bg_color = color; set |= BG_COLOR; return *this; }
+    UIStyleProps& bgOpa(lv_opa_t opa) { bg_opa = opa; set |= BG_OPA; return *this; }
+    UIStyleProps& radiusPx(lv_coord_t value) { radius = value; set |= RADIUS; return *this; }
+    UIStyleProps& borderWidth(lv_coord_t value) { border_width = value; set |= BORDER_WIDTH; return *this; }
+    UIStyleProps& borderColor(lv_color_t color) { border_color = color; set |= BORDER_COLOR; return *this; }
+    UIStyleProps& borderOpa(lv_opa_t opa) { border_opa = opa; set |= BORDER_OPA; return *this; }
+    UIStyleProps& padAll(lv_coord_t value) { pad_all = value; set |= PAD_ALL; return *this; }
+    UIStyleProps& widthPx(lv_coord_t value) { width = value; set |= WIDTH; return *this; }
+    UIStyleProps& heightPx(lv_coord_t value) { height = value; set |= HEIGHT; return *this; }
+    UIStyleProps& minHeight(lv_coord_t value) { min_height = value; set |= MIN_HEIGHT; return *this; }
+    UIStyleProps& shadowWidth(lv_coord_t value) { shadow_width = value; set |= SHADOW_WIDTH; return *this; }
+    UIStyleProps& shadowColor(lv_color_t color) { shadow_color = color; set |= SHADOW_COLOR; return *this; }
+    UIStyleProps& shadowOpa(lv_opa_t opa) { shadow_opa = opa; set |= SHADOW_OPA; return *this; }
+    UIStyleProps& textColor(lv_color_t color) { text_color = color; set |= TEXT_COLOR; return *this; }
+    UIStyleProps& textFont(const lv_font_t* font) { text_font = font; set |= TEXT_FONT; return *this; }
+    UIStyleProps& textAlign(lv_text_align_t align) { text_align = align; set |= TEXT_ALIGN; return *this; }
+
+    uint32_t hash() const;
+    bool operator==(const UIStyleProps& other) const;
+    bool operator!=(const UIStyleProps& other) const { return !(*this == other); }
+};
+
+class UIStylePool {
+public:
+    UIStylePool() = default;
+    UIStylePool(const UIStylePool&) = delete;
+    UIStylePool& operator=(const UIStylePool&) = delete;
+
+    /**
+     * @brief Shared style for these props, created on first use
+     * The pointer stays valid until the matching release()
+     */
+    lv_style_t* acquire(const UIStyleProps& props);
+
+    /**
+     * @brief Drop one reference taken by acquire()
+     * Call only after every object using the style has been deleted
+     */
+    void release(lv_style_t* style);
+
+    // Distinct styles alive / references held (readable from any task)
+    uint32_t styleCount() const { return style_count_.load(std::memory_order_relaxed); }
+    uint32_t referenceCount() const { return reference_count_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        lv_style_t style;
+        UIStyleProps props;
+        uint32_t hash = 0;
+        uint32_t refs = 0;
+    };
+
+    // A config resolves to a few dozen looks at most, so a flat scan on
+    // the hash is cheaper than a map and keeps entries at fixed addresses
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::atomic<uint32_t> style_count_{0};
+    std::atomic<uint32_t> reference_count_{0};
+};
+
+#endif // UI_STYLE_POOL_H
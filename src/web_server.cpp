@@ -3,10 +3,19 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <AsyncJson.h>
+#include <esp_heap_caps.h>
+
+#include <algorithm>
 #include <cstddef>
+#include <memory>
 
+#include "boot_timeline.h"
 #include "can_manager.h"
+#include "can_replay_manager.h"
+#include "can_trace_recorder.h"
 #include "config_manager.h"
+#include "display_flush.h"
+#include "ipm1_can_library.h"
 #include "ipm1_can_system.h"
 #include "ota_manager.h"
 #include "ui_builder.h"
@@ -26,6 +35,9 @@ constexpr std::size_t kWifiConnectJsonLimit = 1024;
 constexpr std::size_t kImageUploadJsonLimit = 2097152;  // 2MB limit for header/base64 payloads
 constexpr std::size_t kImageUploadContentLimit = 2097152;
 constexpr std::uint32_t kWifiReconfigureDelayMs = 750;  // Allow HTTP responses to finish before toggling radios
+constexpr std::size_t kCanReceiveMaxFrames = 64;  // Per /api/can/receive poll
+// JSON pool per /api/can/receive frame: {id, ext, timestamp, data[8]} plus the copied id string
+constexpr std::size_t kCanReceiveFrameJsonSize = JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(8) + sizeof("1FFFFFFF");
 
 const char* AuthModeToString(wifi_auth_mode_t mode) {
     switch (mode) {
@@ -48,6 +60,58 @@ bool WifiConfigEquals(const WifiConfig& lhs, const WifiConfig& rhs) {
     };
     return creds_equal(lhs.ap, rhs.ap) && creds_equal(lhs.sta, rhs.sta);
 }
+
+// Identifiers arrive as numbers or hex strings ("18FF0163", "0x737")
+uint32_t CanIdFromJson(JsonVariantConst value, uint32_t fallback) {
+    if (value.is<const char*>()) {
+        return strtoul(value.as<const char*>(), nullptr, 16);
+    }
+    return value.is<uint32_t>() ? value.as<uint32_t>() : fallback;
+}
+
+void WriteCanTraceStatus(JsonObject out) {
+    auto& recorder = CanTraceRecorder::instance();
+    const CanTraceStats stats = recorder.getStats();
+    out["allocated"] = stats.allocated;
+    out["enabled"] = stats.enabled;
+    out["capture_all"] = stats.capture_all;
+    out["capacity"] = stats.capacity;
+    out["recorded"] = stats.recorded;
+    out["available"] = stats.available;
+    out["export_gaps"] = stats.export_gaps;
+
+    JsonObject trigger = out.createNestedObject("trigger");
+    const CanTraceTrigger config = recorder.trigger();
+    char hex[11];
+    trigger["armed"] = stats.trigger_armed;
+    snprintf(hex, sizeof(hex), "0x%08lX", static_cast<unsigned long>(config.identifier));
+    trigger["id"] = hex;
+    snprintf(hex, sizeof(hex), "0x%08lX", static_cast<unsigned long>(config.mask));
+    trigger["mask"] = hex;
+    trigger["pre"] = config.pre_records;
+    trigger["post"] = config.post_records;
+
+    JsonObject spill = out.createNestedObject("spill");
+    spill["active"] = stats.spilling;
+    spill["count"] = stats.spills;
+    spill["records"] = stats.spill_records;
+    spill["gaps"] = stats.spill_gaps;
+    spill["path"] = CanTraceRecorder::kSpillPath;
+}
+
+void WriteCanReplayStatus(JsonObject out) {
+    const CanReplayStatus status = CanReplayManager::instance().getStatus();
+    out["running"] = status.running;
+    out["path"] = status.path;
+    out["speed"] = status.speed_permille / 1000.0f;
+    out["loop"] = status.loop;
+    out["records"] = status.records;
+    out["played"] = status.stats.played;
+    out["skipped"] = status.stats.skipped;
+    out["retried"] = status.stats.rejected;
+    out["loops"] = status.stats.loops;
+    out["max_late_us"] = status.stats.max_late_us;
+}
 }
 
 WebServerManager& WebServerManager::instance() {
@@ -56,7 +120,9 @@ WebServerManager& WebServerManager::instance() {
 }
 
 WebServerManager::WebServerManager()
-    : server_(80), can_monitor_ws_("/ws/can") {}
+    : server_(80), can_monitor_ws_("/ws/can") {
+    can_batch_mutex_ = xSemaphoreCreateMutex();
+}
 
 void WebServerManager::begin() {
     static bool dns_configured = false;
@@ -99,6 +165,7 @@ void WebServerManager::loop() {
     
     // Clean up WebSocket connections
     can_monitor_ws_.cleanupClients();
+    flushCanMonitor();
 
     if (wifi_reconfigure_pending_) {
         const std::uint32_t now = millis();
@@ -182,24 +249,9 @@ void WebServerManager::configureWifi() {
 
 void WebServerManager::setupRoutes() {
     // Set up CAN monitoring WebSocket
-    can_monitor_ws_.onEvent([](AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type,
-                                void* arg, uint8_t* data, size_t len) {
-        if (type == WS_EVT_CONNECT) {
-            Serial.printf("[WebSocket] CAN monitor client connected: %u from %s\n", 
-                         client->id(), client->remoteIP().toString().c_str());
-            // Send initial status
-            DynamicJsonDocument doc(256);
-            doc["type"] = "status";
-            doc["message"] = "CAN monitor connected";
-            doc["bus_ready"] = CanManager::instance().isReady();
-            String msg;
-            serializeJson(doc, msg);
-            client->text(msg);
-        } else if (type == WS_EVT_DISCONNECT) {
-            Serial.printf("[WebSocket] CAN monitor client disconnected: %u\n", client->id());
-        } else if (type == WS_EVT_ERROR) {
-            Serial.printf("[WebSocket] Error from client %u\n", client->id());
-        }
+    can_monitor_ws_.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type,
+                                   void* arg, uint8_t* data, size_t len) {
+        onCanMonitorEvent(client, type, arg, data, len);
     });
     server_.addHandler(&can_monitor_ws_);
     
@@ -306,37 +358,113 @@ void WebServerManager::setupRoutes() {
         request->send(200, "application/json", payload);
     });
 
+    // Boot phase timeline recorded by setup(); ui_ready_ms is time to first touch
+    server_.on("/api/boot", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const BootTimeline& timeline = BootTimeline::instance();
+        DynamicJsonDocument doc(2048);
+        doc["total_ms"] = timeline.totalUs() / 1000;
+        doc["ui_ready_ms"] = timeline.phaseEndUs("ui") / 1000;
+        doc["can_bus_alive"] = CanManager::instance().isBusAlive();
+        JsonArray phases = doc.createNestedArray("phases");
+        for (std::size_t i = 0, count = timeline.count(); i < count; ++i) {
+            const BootTimeline::Phase& phase = timeline.phase(i);
+            JsonObject entry = phases.createNestedObject();
+            entry["name"] = phase.name;
+            entry["end_ms"] = phase.end_us / 1000;
+            entry["duration_us"] = phase.duration_us;
+        }
+        String payload;
+        serializeJson(doc, payload);
+        request->send(200, "application/json", payload);
+    });
+
+    // UI page cache and navigation timing (built = full rebuild, cached = show)
+    server_.on("/api/ui/pages", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const PageSwitchStats& stats = UIBuilder::instance().pageSwitchStats();
+        DynamicJsonDocument doc(512);
+        doc["cache_capacity"] = UIBuilder::kPageCacheSize;
+        doc["cached_pages"] = stats.resident();
+        doc["evictions"] = stats.evictions();
+        const UIStylePool& styles = UIBuilder::instance().stylePool();
+        doc["shared_styles"] = styles.styleCount();
+        doc["shared_style_refs"] = styles.referenceCount();
+        for (const bool cached : {true, false}) {
+            const PageSwitchStats::Summary summary = stats.summary(cached);
+            JsonObject entry = doc.createNestedObject(cached ? "cached" : "built");
+            entry["switches"] = summary.count;
+            entry["p50_us"] = summary.p50_us;
+            entry["p99_us"] = summary.p99_us;
+            entry["max_us"] = summary.max_us;
+        }
+        String payload;
+        serializeJson(doc, payload);
+        request->send(200, "application/json", payload);
+    });
+
+    server_.on("/api/display", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const DisplayFlush& display = DisplayFlush::instance();
+        const DisplayStats::Window window = display.stats().lastWindow();
+        DynamicJsonDocument doc(768);
+        doc["async_flush"] = display.asyncFlush();
+        doc["internal_buffers"] = display.internalBuffers();
+        doc["buffer_lines"] = display.bufferLines();
+        doc["overlay"] = display.overlayEnabled();
+        JsonObject last = doc.createNestedObject("last_window");
+        last["window_ms"] = window.window_ms;
+        last["frames"] = window.frames;
+        last["fps"] = window.fpsTenths() / 10.0f;
+        last["render_us_avg"] = window.render_us_avg;
+        last["render_us_max"] = window.render_us_max;
+        last["wait_us_avg"] = window.wait_us_avg;
+        last["flushes"] = window.flushes;
+        last["flush_us_avg"] = window.flush_us_avg;
+        last["flush_us_max"] = window.flush_us_max;
+        last["px_avg"] = window.px_avg;
+        last["px_max"] = window.px_max;
+        String payload;
+        serializeJson(doc, payload);
+        request->send(200, "application/json", payload);
+    });
+
+    // {"overlay":true} draws FPS, render/flush time and invalidated area on screen
+    server_.on("/api/display", HTTP_POST, [](AsyncWebServerRequest* request) {}, nullptr,
+        [](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            DynamicJsonDocument doc(128);
+            if (deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+            if (doc["overlay"].isNull()) {
+                request->send(400, "application/json", "{\"error\":\"Missing overlay\"}");
+                return;
+            }
+            DisplayFlush::instance().setOverlayEnabled(doc["overlay"].as<bool>());
+            request->send(200, "application/json", "{\"success\":true}");
+        });
+
     // Behavioral output/scene lists for button configuration
     server_.on("/api/behavioral/options", HTTP_GET, [](AsyncWebServerRequest* request) {
         DynamicJsonDocument doc(4096);
         
         // Get available outputs
+        const auto snapshot = behaviorEngine.snapshot();
         JsonArray outputs = doc.createNestedArray("outputs");
-        auto outputList = behaviorEngine.getAllOutputs();
-        for (const auto& id : outputList) {
-            auto* output = behaviorEngine.getOutput(id);
-            if (output) {
-                JsonObject obj = outputs.createNestedObject();
-                obj["id"] = output->id;
-                obj["name"] = output->name;
-                obj["description"] = output->description;
-                obj["cellAddress"] = output->cellAddress;
-                obj["outputNumber"] = output->outputNumber;
-            }
+        for (const auto& [id, output] : snapshot->outputs) {
+            JsonObject obj = outputs.createNestedObject();
+            obj["id"] = output.id;
+            obj["name"] = output.name;
+            obj["description"] = output.description;
+            obj["cellAddress"] = output.cellAddress;
+            obj["outputNumber"] = output.outputNumber;
         }
         
         // Get available scenes  
         JsonArray scenes = doc.createNestedArray("scenes");
-        auto sceneList = behaviorEngine.getAllScenes();
-        for (const auto& id : sceneList) {
-            auto& allScenes = behaviorEngine.getScenes();
-            auto it = allScenes.find(id);
-            if (it != allScenes.end()) {
-                JsonObject obj = scenes.createNestedObject();
-                obj["id"] = it->second.id;
-                obj["name"] = it->second.name;
-                obj["description"] = it->second.description;
-            }
+        for (const auto& [id, scene] : snapshot->scenes) {
+            JsonObject obj = scenes.createNestedObject();
+            obj["id"] = scene.id;
+            obj["name"] = scene.name;
+            obj["description"] = scene.description;
         }
         
         // Behavior types for output mode
@@ -390,7 +518,8 @@ void WebServerManager::setupRoutes() {
         }
 
         String matchedId;
-        for (const auto& [id, output] : behaviorEngine.getOutputs()) {
+        const auto snapshot = behaviorEngine.snapshot();
+        for (const auto& [id, output] : snapshot->outputs) {
             if (output.cellAddress == 0 && output.outputNumber == outNum) {
                 matchedId = id;
                 break;
@@ -402,8 +531,9 @@ void WebServerManager::setupRoutes() {
             BehavioralOutput::BehaviorConfig cfg;
             cfg.type = BehavioralOutput::BehaviorType::STEADY;
             cfg.targetValue = 255;
-            behaviorEngine.setBehavior(matchedId, cfg);
-            doc["success"] = true;
+            const bool accepted = behaviorEngine.setBehavior(matchedId, cfg);
+            doc["success"] = accepted;
+            if (!accepted) doc["error"] = "behavior engine busy";
             doc["outputId"] = matchedId;
             doc["cell"] = 0;
             doc["out"] = outNum;
@@ -426,7 +556,8 @@ void WebServerManager::setupRoutes() {
         }
 
         String matchedId;
-        for (const auto& [id, output] : behaviorEngine.getOutputs()) {
+        const auto snapshot = behaviorEngine.snapshot();
+        for (const auto& [id, output] : snapshot->outputs) {
             if (output.cellAddress == 0 && output.outputNumber == outNum) {
                 matchedId = id;
                 break;
@@ -456,7 +587,8 @@ void WebServerManager::setupRoutes() {
         DynamicJsonDocument doc(1024);
         doc["endpoint"] = "outputs";
         JsonArray outputs = doc.createNestedArray("outputs");
-        for (const auto& [id, output] : behaviorEngine.getOutputs()) {
+        const auto snapshot = behaviorEngine.snapshot();
+        for (const auto& [id, output] : snapshot->outputs) {
             if (output.cellAddress != 0) continue;
             JsonObject obj = outputs.createNestedObject();
             obj["id"] = output.id;
@@ -475,7 +607,8 @@ void WebServerManager::setupRoutes() {
         }
 
         String matchedId;
-        for (const auto& [id, output] : behaviorEngine.getOutputs()) {
+        const auto snapshot = behaviorEngine.snapshot();
+        for (const auto& [id, output] : snapshot->outputs) {
             if (output.cellAddress == 0 && output.outputNumber == outNum) {
                 matchedId = id;
                 break;
@@ -487,11 +620,10 @@ void WebServerManager::setupRoutes() {
             BehavioralOutput::BehaviorConfig cfg;
             cfg.type = BehavioralOutput::BehaviorType::STEADY;
             cfg.targetValue = 255;
-            behaviorEngine.setBehavior(matchedId, cfg);
-            if (powercellSynthesizer) {
-                powercellSynthesizer->transmitImmediate();
-            }
-            doc["success"] = true;
+            // Wakes the behavior task; frame goes out on this edge
+            const bool accepted = behaviorEngine.setBehavior(matchedId, cfg);
+            doc["success"] = accepted;
+            if (!accepted) doc["error"] = "behavior engine busy";
             doc["outputId"] = matchedId;
         } else {
             doc["success"] = false;
@@ -553,6 +685,7 @@ void WebServerManager::setupRoutes() {
             }
 
             UIBuilder::instance().markDirty();
+            CanManager::instance().setMonitorPgns(config_mgr.getConfig().can_monitor_pgns);
 
             if (wifi_changed) {
                 request->onDisconnect([this]() {
@@ -862,10 +995,26 @@ void WebServerManager::setupRoutes() {
             }
             frame.length = static_cast<uint8_t>(idx);  // Set actual data length
 
-            bool success = CanManager::instance().sendFrame(frame);
+            // Track-only Powercell control frames are merged into the cell's
+            // output shadow so they agree with the other producers; anything
+            // else (polls, soft-start/PWM bytes, other PGNs) is sent raw.
+            const std::uint32_t pc_pgn = frame.pgn & 0x3FFFF;
+            const bool track_frame = pc_pgn >= 0xFF01 && pc_pgn <= 0xFF10 && frame.length == 8 &&
+                                     (frame.data[1] & 0x3F) == 0 && frame.data[0] != 0x11 &&
+                                     std::all_of(frame.data.begin() + 2, frame.data.end(),
+                                                 [](std::uint8_t b) { return b == 0; });
+            bool success = false;
+            if (track_frame) {
+                success = CanManager::instance().setPowercellOutputs(
+                    static_cast<std::uint8_t>(pc_pgn - 0xFF00), Ipm1Can::kPowercellOutputMask,
+                    Ipm1Can::powercellTrackOutputs(frame.data.data()), CanTxLane::Diagnostic);
+            } else {
+                success = CanManager::instance().sendFrame(frame, CanTxLane::Diagnostic);
+            }
             
             DynamicJsonDocument response(256);
             response["success"] = success;
+            response["shadow"] = track_frame;
             response["pgn"] = String(frame.pgn, HEX);
             response["bytes"] = idx;
             
@@ -904,7 +1053,8 @@ void WebServerManager::setupRoutes() {
                 payload_data[idx++] = v.as<uint8_t>();
             }
 
-            bool success = CanManager::instance().sendStandardFrame(id, payload_data, static_cast<uint8_t>(idx));
+            bool success = CanManager::instance().sendStandardFrame(id, payload_data, static_cast<uint8_t>(idx),
+                                                                   CanTxLane::Diagnostic);
 
             DynamicJsonDocument response(128);
             response["success"] = success;
@@ -983,36 +1133,302 @@ void WebServerManager::setupRoutes() {
             request->send(success ? 200 : 500, "application/json", payload);
         });
 
-    // Receive CAN messages endpoint
+    // Receive CAN messages endpoint: frames published since the previous poll.
+    // Reads this endpoint's own RX bus cursor, so it never takes frames away
+    // from the RX task or other consumers.
+    static CanManager::CanFrameBus::Subscriber* rest_sub = CanManager::instance().rxBus().subscribe("rest_receive");
     server_.on("/api/can/receive", HTTP_GET, [](AsyncWebServerRequest* request) {
-        uint32_t timeout = 500;
-        if (request->hasParam("timeout")) {
-            timeout = request->getParam("timeout")->value().toInt();
+        std::size_t max_frames = kCanReceiveMaxFrames;
+        if (request->hasParam("max")) {
+            const long requested = request->getParam("max")->value().toInt();
+            if (requested > 0 && static_cast<std::size_t>(requested) < max_frames) {
+                max_frames = static_cast<std::size_t>(requested);
+            }
         }
 
-        std::vector<CanRxMessage> messages = CanManager::instance().receiveAll(timeout);
-        
-        DynamicJsonDocument doc(4096);
+        CanManager::instance().noteMonitorActivity();
+        auto& bus = CanManager::instance().rxBus();
+        const uint32_t dropped_before = rest_sub ? rest_sub->dropped.load() : 0;
+
+        DynamicJsonDocument doc(JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(max_frames) +
+                                max_frames * kCanReceiveFrameJsonSize);
         JsonArray array = doc.createNestedArray("messages");
-        
-        for (const auto& msg : messages) {
+        doc["count"] = 0;  // Keys claimed up front so a full pool can't lose them
+        doc["dropped"] = 0;
+        doc["pending"] = 0;
+        // A frame that doesn't fit ends the drain and stays in the ring for
+        // the next poll, so nothing is consumed without being sent
+        const std::size_t count = bus.drain(rest_sub, [&](const CanRxMessage& msg) {
             JsonObject msgObj = array.createNestedObject();
+            if (msgObj.isNull()) {
+                return false;
+            }
             msgObj["id"] = String(msg.identifier, HEX);
+            msgObj["ext"] = msg.extended;
             msgObj["timestamp"] = msg.timestamp;
             
             JsonArray dataArray = msgObj.createNestedArray("data");
             for (uint8_t i = 0; i < msg.length; i++) {
                 dataArray.add(msg.data[i]);
             }
-        }
+            if (doc.overflowed()) {
+                array.remove(array.size() - 1);
+                return false;
+            }
+            return true;
+        }, max_frames);
         
-        doc["count"] = messages.size();
+        doc["count"] = count;
+        doc["dropped"] = rest_sub ? rest_sub->dropped.load() - dropped_before : 0;
+        doc["pending"] = rest_sub ? static_cast<uint32_t>(bus.published() - rest_sub->cursor.load()) : 0;
         
         String payload;
         serializeJson(doc, payload);
         request->send(200, "application/json", payload);
     });
 
+    // CAN RX pipeline counters (ring + TWAI driver)
+    // TX scheduler lanes: depth, outcome counters and enqueue->driver latency histogram
+    server_.on("/api/can/tx", HTTP_GET, [](AsyncWebServerRequest* request) {
+        DynamicJsonDocument doc(3072);
+        doc["ready"] = CanManager::instance().isReady();
+        doc["bus_state"] = CanManager::busStateName(CanManager::instance().busState());
+        doc["monitor_echo_drops"] = CanManager::instance().txEchoDrops();
+        doc["powercell_poll_alias_held"] = CanManager::instance().powercellPollAliasHeld();
+        JsonArray lanes = doc.createNestedArray("lanes");
+        for (const auto& lane : CanManager::instance().getTxStats()) {
+            JsonObject laneObj = lanes.createNestedObject();
+            laneObj["name"] = lane.name;
+            laneObj["depth"] = lane.depth;
+            laneObj["capacity"] = lane.capacity;
+            laneObj["deadline_ms"] = lane.deadline_ms;
+            laneObj["enqueued"] = lane.enqueued;
+            laneObj["queue_full"] = lane.queue_full;
+            laneObj["sent"] = lane.sent;
+            laneObj["expired"] = lane.expired;
+            laneObj["shed"] = lane.shed;
+            laneObj["failed"] = lane.failed;
+            laneObj["max_latency_us"] = lane.max_latency_us;
+            JsonArray hist = laneObj.createNestedArray("latency_us");
+            for (std::size_t i = 0; i < lane.latency_hist.size(); ++i) {
+                JsonObject bucket = hist.createNestedObject();
+                if (i < kCanTxLatencyBucketUs.size()) {
+                    bucket["le"] = kCanTxLatencyBucketUs[i];
+                } else {
+                    bucket["le"] = nullptr;  // Overflow bucket
+                }
+                bucket["count"] = lane.latency_hist[i];
+            }
+        }
+
+        String payload;
+        serializeJson(doc, payload);
+        request->send(200, "application/json", payload);
+    });
+
+    server_.on("/api/can/stats", HTTP_GET, [](AsyncWebServerRequest* request) {
+        const CanRxStats rx = CanManager::instance().getRxStats();
+
+        DynamicJsonDocument doc(3072);
+        doc["ready"] = CanManager::instance().isReady();
+        doc["bus_alive"] = CanManager::instance().isBusAlive();
+
+        const CanBusHealth health = CanManager::instance().getBusHealth();
+        JsonObject healthObj = doc.createNestedObject("health");
+        healthObj["state"] = CanManager::busStateName(health.state);
+        healthObj["state_age_ms"] = millis() - health.state_since_ms;
+        healthObj["tec"] = health.tx_error_counter;
+        healthObj["rec"] = health.rx_error_counter;
+        healthObj["bus_off_count"] = health.bus_off_count;
+        healthObj["recovered_count"] = health.recovered_count;
+        healthObj["error_passive_count"] = health.error_passive_count;
+        JsonObject rxObj = doc.createNestedObject("rx");
+        rxObj["frames"] = rx.frames_received;
+        rxObj["ring_capacity"] = rx.ring_capacity;
+        rxObj["hw_queue_len"] = rx.hw_queue_len;
+        rxObj["hw_pending"] = rx.hw_pending;
+        rxObj["hw_rx_missed"] = rx.hw_rx_missed;
+        rxObj["hw_rx_overrun"] = rx.hw_rx_overrun;
+        rxObj["bus_errors"] = rx.bus_errors;
+        rxObj["arb_lost"] = rx.arb_lost;
+        rxObj["injected"] = rx.injected;
+        rxObj["inject_drops"] = rx.inject_drops;
+
+        JsonObject filterObj = rxObj.createNestedObject("filter");
+        char hex[11];
+        filterObj["mode"] = rx.filter_mode;
+        snprintf(hex, sizeof(hex), "0x%08lX", static_cast<unsigned long>(rx.acceptance_code));
+        filterObj["acceptance_code"] = hex;
+        snprintf(hex, sizeof(hex), "0x%08lX", static_cast<unsigned long>(rx.acceptance_mask));
+        filterObj["acceptance_mask"] = hex;
+        filterObj["sw_rejected"] = rx.sw_rejected;
+        filterObj["override_all"] = CanManager::instance().filterOverrideAll();
+
+        auto& bus = CanManager::instance().rxBus();
+        JsonArray subs = doc.createNestedArray("subscribers");
+        for (std::size_t i = 0; i < bus.subscriberCount(); ++i) {
+            const auto sub = bus.subscriberStats(i);
+            JsonObject subObj = subs.createNestedObject();
+            subObj["name"] = sub.name;
+            subObj["delivered"] = sub.delivered;
+            subObj["dropped"] = sub.dropped;
+            subObj["lag"] = sub.lag;
+        }
+
+        JsonArray wsClients = doc.createNestedArray("ws_clients");
+        for (const auto& client : WebServerManager::instance().getCanMonitorStats()) {
+            JsonObject clientObj = wsClients.createNestedObject();
+            clientObj["id"] = client.id;
+            clientObj["format"] = client.json ? "json" : "binary";
+            clientObj["policy"] = client.sample_latest ? "sample_latest" : "drop_oldest";
+            clientObj["filters"] = client.filters;
+            clientObj["pgns"] = client.pgns;
+            clientObj["max_rate"] = client.max_rate;
+            clientObj["queued"] = client.queued;
+            clientObj["sent"] = client.sent;
+            clientObj["dropped"] = client.dropped;
+        }
+
+        String payload;
+        serializeJson(doc, payload);
+        request->send(200, "application/json", payload);
+    });
+
+    // CAN trace recorder. Export is registered first: the status route would
+    // otherwise also claim /api/can/trace/export as a sub-path.
+    //   GET /api/can/trace/export?format=candump|asc|bin&source=ram|spill&max=N
+    server_.on("/api/can/trace/export", HTTP_GET, [](AsyncWebServerRequest* request) {
+        auto& recorder = CanTraceRecorder::instance();
+        CanTraceFormat format = CanTraceFormat::Candump;
+        if (request->hasParam("format") &&
+            !CanTraceRecorder::parseFormat(request->getParam("format")->value().c_str(), format)) {
+            request->send(400, "application/json", "{\"error\":\"format must be candump, asc or bin\"}");
+            return;
+        }
+
+        auto state = std::make_shared<CanTraceRecorder::Export>();
+        const bool from_spill = request->hasParam("source") && request->getParam("source")->value() == "spill";
+        if (from_spill) {
+            if (!recorder.beginSpillExport(*state, format)) {
+                request->send(404, "application/json", "{\"error\":\"No spill file\"}");
+                return;
+            }
+        } else {
+            const long max_records = request->hasParam("max") ? request->getParam("max")->value().toInt() : 0;
+            recorder.beginExport(*state, format, max_records > 0 ? static_cast<uint32_t>(max_records) : 0);
+        }
+
+        // Streamed straight from the ring (or file) in TCP-sized chunks
+        AsyncWebServerResponse* response = request->beginChunkedResponse(
+            CanTraceRecorder::contentType(format), [state](uint8_t* buffer, size_t max_len, size_t) -> size_t {
+                return CanTraceRecorder::instance().nextExport(*state, buffer, max_len);
+            });
+        response->addHeader("Content-Disposition", String("attachment; filename=\"can_trace.") +
+                                                       CanTraceRecorder::fileExtension(format) + "\"");
+        request->send(response);
+    });
+
+    server_.on("/api/can/trace", HTTP_GET, [](AsyncWebServerRequest* request) {
+        DynamicJsonDocument doc(1024);
+        WriteCanTraceStatus(doc.to<JsonObject>());
+        String payload;
+        serializeJson(doc, payload);
+        request->send(200, "application/json", payload);
+    });
+
+    // {"enabled":true, "capture_all":true, "clear":true,
+    //  "trigger":"now" | "off" | {"id":"18FF0163", "mask":"1FFFFFFF", "pre":1024, "post":4096}}
+    server_.on("/api/can/trace", HTTP_POST, [](AsyncWebServerRequest* request) {}, nullptr,
+        [](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            DynamicJsonDocument doc(512);
+            if (deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+
+            auto& recorder = CanTraceRecorder::instance();
+            if (!doc["capture_all"].isNull()) {
+                recorder.setCaptureAll(doc["capture_all"].as<bool>());
+            }
+            if (doc["clear"] | false) {
+                recorder.clear();
+            }
+            if (!doc["enabled"].isNull()) {
+                recorder.setEnabled(doc["enabled"].as<bool>());
+            }
+
+            bool ok = true;
+            JsonVariantConst trigger = doc["trigger"];
+            if (trigger.is<const char*>()) {
+                const String mode = trigger.as<const char*>();
+                if (mode == "now") {
+                    ok = recorder.triggerNow();
+                } else if (mode == "off") {
+                    recorder.disarmTrigger();
+                }
+            } else if (trigger.is<JsonObjectConst>()) {
+                CanTraceTrigger config;
+                config.identifier = CanIdFromJson(trigger["id"], 0);
+                config.mask = CanIdFromJson(trigger["mask"], 0x1FFFFFFF);
+                config.pre_records = trigger["pre"] | config.pre_records;
+                config.post_records = trigger["post"] | config.post_records;
+                ok = recorder.armTrigger(config);
+            }
+
+            DynamicJsonDocument response(1024);
+            response["success"] = ok;
+            if (!ok) {
+                response["error"] = "Recorder not allocated or a spill is in progress";
+            }
+            WriteCanTraceStatus(response.createNestedObject("status"));
+            String payload;
+            serializeJson(response, payload);
+            request->send(ok ? 200 : 409, "application/json", payload);
+        });
+
+    server_.on("/api/can/replay", HTTP_GET, [](AsyncWebServerRequest* request) {
+        DynamicJsonDocument doc(512);
+        WriteCanReplayStatus(doc.to<JsonObject>());
+        String payload;
+        serializeJson(doc, payload);
+        request->send(200, "application/json", payload);
+    });
+
+    // {"action":"start", "path":"/can_trace.bin", "speed":1.0 (0 = max), "loop":false, "include_tx":false}
+    // {"action":"stop"}
+    server_.on("/api/can/replay", HTTP_POST, [](AsyncWebServerRequest* request) {}, nullptr,
+        [](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            DynamicJsonDocument doc(256);
+            if (deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+
+            auto& replay = CanReplayManager::instance();
+            const String action = doc["action"] | "start";
+            bool ok = true;
+            if (action == "stop") {
+                replay.stop();
+            } else {
+                CanReplayOptions options;
+                const float speed = doc["speed"] | 1.0f;
+                options.speed_permille = speed > 0.0f ? static_cast<uint32_t>(speed * 1000.0f + 0.5f) : 0;
+                options.loop = doc["loop"] | false;
+                options.include_tx = doc["include_tx"] | false;
+                ok = replay.start(doc["path"] | "", options);
+            }
+
+            DynamicJsonDocument response(512);
+            response["success"] = ok;
+            if (!ok) {
+                response["error"] = "Trace file missing/invalid or a replay is already running";
+            }
+            WriteCanReplayStatus(response.createNestedObject("status"));
+            String payload;
+            serializeJson(response, payload);
+            request->send(ok ? 200 : 409, "application/json", payload);
+        });
+
     // IPM1 system definition (UI contract)
     server_.on("/api/ipm1/system", HTTP_GET, [](AsyncWebServerRequest* request) {
         String payload = Ipm1CanSystem::instance().getSystemJson();
@@ -1239,6 +1655,10 @@ void WebServerManager::setupRoutes() {
             <div class="status-label">Frame Rate</div>
             <div class="status-value" id="frame-rate">0 /s</div>
         </div>
+        <div class="status-card">
+            <div class="status-label">Dropped</div>
+            <div class="status-value" id="frame-dropped">0</div>
+        </div>
     </div>
     
     <div class="controls">
@@ -1249,6 +1669,11 @@ void WebServerManager::setupRoutes() {
             <input type="checkbox" id="auto-scroll" checked>
             Auto-scroll
         </label>
+        <label>
+            PGNs
+            <input type="text" id="pgn-filter" placeholder="FF01, FF10 (blank = all)" style="width:160px">
+        </label>
+        <button onclick="applyFilter()">🔍 Filter</button>
         <label>
             <input type="checkbox" id="decode-frames" checked>
             Decode POWERCELL
@@ -1287,19 +1712,31 @@ void WebServerManager::setupRoutes() {
             const wsUrl = protocol + '//' + window.location.host + '/ws/can';
             
             ws = new WebSocket(wsUrl);
+            ws.binaryType = 'arraybuffer';
             
             ws.onopen = () => {
                 document.getElementById('ws-status').innerHTML = '<span class="connected">✓ Connected</span>';
                 console.log('[WS] Connected to CAN monitor');
+                if (document.getElementById('pgn-filter').value.trim()) applyFilter();
             };
             
             ws.onmessage = (event) => {
                 if (paused) return;
                 
+                if (event.data instanceof ArrayBuffer) {
+                    decodeBatch(event.data);
+                    updateStats();
+                    return;
+                }
+                
                 try {
                     const data = JSON.parse(event.data);
                     
-                    if (data.type === 'can_frame') {
+                    if (data.type === 'can_frames') {
+                        document.getElementById('frame-dropped').textContent = data.dropped;
+                        data.frames.forEach(addFrame);
+                        updateStats();
+                    } else if (data.type === 'can_frame') {
                         addFrame(data);
                         updateStats();
                     } else if (data.type === 'status') {
@@ -1322,6 +1759,30 @@ void WebServerManager::setupRoutes() {
             };
         }
         
+        // Binary batch: 8-byte header (0xCB, version, count, dropped) then
+        // 18-byte records (id, ts_us, flags, dlc, data[8]), little-endian
+        function decodeBatch(buffer) {
+            const view = new DataView(buffer);
+            if (buffer.byteLength < 8 || view.getUint8(0) !== 0xCB) return;
+            const count = view.getUint16(2, true);
+            document.getElementById('frame-dropped').textContent = view.getUint32(4, true);
+            for (let i = 0; i < count; i++) {
+                const off = 8 + i * 18;
+                if (off + 18 > buffer.byteLength) break;
+                const id = view.getUint32(off, true);
+                const flags = view.getUint8(off + 8);
+                const dlc = Math.min(view.getUint8(off + 9), 8);
+                const data = [];
+                for (let b = 0; b < dlc; b++) data.push(view.getUint8(off + 10 + b));
+                addFrame({
+                    id: id.toString(16).toUpperCase().padStart((flags & 0x01) ? 8 : 3, '0'),
+                    ts_us: view.getUint32(off + 4, true),
+                    dir: (flags & 0x02) ? 'TX' : 'RX',
+                    data: data
+                });
+            }
+        }
+        
         function addFrame(frame) {
             const tbody = document.getElementById('frame-table');
             const noFrames = tbody.querySelector('.no-frames');
@@ -1409,6 +1870,15 @@ void WebServerManager::setupRoutes() {
             document.getElementById('frame-rate').textContent = '0 /s';
         }
         
+        // Server-side subscription: only the listed PGNs are queued for this page
+        function applyFilter() {
+            if (!ws || ws.readyState !== WebSocket.OPEN) return;
+            const pgns = document.getElementById('pgn-filter').value
+                .split(',').map(v => v.trim()).filter(v => v.length)
+                .map(v => parseInt(v, 16)).filter(v => !isNaN(v));
+            ws.send(JSON.stringify({ type: 'subscribe', pgns: pgns, filters: [] }));
+        }
+        
         function pauseToggle() {
             paused = !paused;
             const btn = document.getElementById('pause-btn');
@@ -1446,24 +1916,380 @@ void WebServerManager::disableAP() {
     ap_ip_ = IPAddress(0, 0, 0, 0);
 }
 
+namespace {
+
+// Accepts 0x18FF0000 as a JSON number or as a hex string ("18FF0000" / "0x18FF0000")
+std::uint32_t parseCanNumber(JsonVariantConst value) {
+    if (value.is<const char*>()) {
+        return static_cast<std::uint32_t>(strtoul(value.as<const char*>(), nullptr, 16));
+    }
+    return value.as<std::uint32_t>();
+}
+
+std::uint32_t j1939Pgn(std::uint32_t identifier) {
+    std::uint32_t pgn = (identifier >> 8) & 0x3FFFF;
+    if (((pgn >> 8) & 0xFF) < 0xF0) {
+        pgn &= 0x3FF00;  // PDU1: low byte is the destination address
+    }
+    return pgn;
+}
+
+}  // namespace
+
+void WebServerManager::onCanMonitorEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg,
+                                         uint8_t* data, size_t len) {
+    if (type == WS_EVT_CONNECT) {
+        Serial.printf("[WebSocket] CAN monitor client connected: %u from %s\n", 
+                     client->id(), client->remoteIP().toString().c_str());
+        bool registered = false;
+        if (xSemaphoreTake(can_batch_mutex_, portMAX_DELAY) == pdTRUE) {
+            if (CanMonitorClient* slot = findCanMonitorClient(0)) {
+                const std::size_t queue_bytes = kCanClientQueueFrames * CanMonitorProtocol::kRecordSize;
+                const std::size_t bytes = queue_bytes + kCanClientIndexSlots * sizeof(std::uint16_t);
+                auto* queue = static_cast<std::uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM));
+                if (!queue) {
+                    queue = static_cast<std::uint8_t*>(malloc(bytes));
+                }
+                if (queue) {
+                    *slot = CanMonitorClient{};
+                    slot->id = client->id();
+                    slot->queue = queue;
+                    slot->latest = reinterpret_cast<std::uint16_t*>(queue + queue_bytes);
+                    registered = true;
+                }
+            }
+            xSemaphoreGive(can_batch_mutex_);
+        }
+        if (!registered) {
+            Serial.printf("[WebSocket] CAN monitor full, closing client %u\n", client->id());
+            client->close();
+            return;
+        }
+        // Send initial status (always JSON text) describing the binary batch format
+        DynamicJsonDocument doc(256);
+        doc["type"] = "status";
+        doc["message"] = "CAN monitor connected";
+        doc["bus_ready"] = CanManager::instance().isReady();
+        doc["format"] = "binary";
+        doc["protocol"] = CanMonitorProtocol::kVersion;
+        doc["record_size"] = CanMonitorProtocol::kRecordSize;
+        doc["queue_frames"] = kCanClientQueueFrames;
+        String msg;
+        serializeJson(doc, msg);
+        client->text(msg);
+    } else if (type == WS_EVT_DISCONNECT) {
+        Serial.printf("[WebSocket] CAN monitor client disconnected: %u\n", client->id());
+        if (xSemaphoreTake(can_batch_mutex_, portMAX_DELAY) == pdTRUE) {
+            if (CanMonitorClient* slot = findCanMonitorClient(client->id())) {
+                free(slot->queue);
+                *slot = CanMonitorClient{};
+            }
+            xSemaphoreGive(can_batch_mutex_);
+        }
+    } else if (type == WS_EVT_DATA) {
+        // Subscription / format negotiation (single unfragmented text frame)
+        const AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+        if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) {
+            return;
+        }
+        DynamicJsonDocument request(1024);
+        if (deserializeJson(request, data, len) != DeserializationError::Ok) {
+            return;
+        }
+
+        DynamicJsonDocument reply(512);
+        reply["type"] = "status";
+        if (xSemaphoreTake(can_batch_mutex_, portMAX_DELAY) == pdTRUE) {
+            if (CanMonitorClient* slot = findCanMonitorClient(client->id())) {
+                applyCanMonitorSubscription(*slot, request.as<JsonVariantConst>());
+                reply["format"] = slot->json ? "json" : "binary";
+                reply["policy"] = slot->policy == CanMonitorPolicy::SampleLatest ? "sample_latest" : "drop_oldest";
+                reply["filters"] = slot->filter_count;
+                reply["pgns"] = slot->pgn_count;
+                reply["max_rate"] = slot->max_rate;
+                reply["dropped"] = slot->dropped;
+            }
+            xSemaphoreGive(can_batch_mutex_);
+        }
+        String msg;
+        serializeJson(reply, msg);
+        client->text(msg);
+    } else if (type == WS_EVT_ERROR) {
+        Serial.printf("[WebSocket] Error from client %u\n", client->id());
+    }
+}
+
+WebServerManager::CanMonitorClient* WebServerManager::findCanMonitorClient(std::uint32_t id) {
+    for (auto& slot : can_clients_) {
+        if (slot.id == id) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+// {"format":"json|binary", "filters":[{"id":..,"mask":..,"ext":..}], "pgns":[..],
+//  "max_rate":N, "policy":"drop_oldest|sample_latest"}; absent keys are kept
+void WebServerManager::applyCanMonitorSubscription(CanMonitorClient& slot, JsonVariantConst request) {
+    const char* format = request["format"] | "";
+    if (strcmp(format, "json") == 0) {
+        slot.json = true;
+    } else if (strcmp(format, "binary") == 0) {
+        slot.json = false;
+    }
+
+    const char* policy = request["policy"] | "";
+    if (strcmp(policy, "sample_latest") == 0) {
+        if (slot.policy != CanMonitorPolicy::SampleLatest) {
+            slot.policy = CanMonitorPolicy::SampleLatest;
+            rebuildLatestLocked(slot);
+        }
+    } else if (strcmp(policy, "drop_oldest") == 0) {
+        slot.policy = CanMonitorPolicy::DropOldest;
+    }
+
+    if (request.containsKey("filters")) {
+        slot.filter_count = 0;
+        for (JsonVariantConst filter : request["filters"].as<JsonArrayConst>()) {
+            if (slot.filter_count >= kCanClientMaxFilters) break;
+            CanIdFilter& entry = slot.filters[slot.filter_count++];
+            // Frame format from "ext", else an ID or mask wider than 11 bits
+            // means extended; a missing mask compares the whole ID
+            const std::uint32_t id = parseCanNumber(filter["id"]);
+            const bool has_mask = filter.containsKey("mask");
+            const std::uint32_t mask = has_mask ? parseCanNumber(filter["mask"]) : 0;
+            entry.extended = filter["ext"] | (id > 0x7FF || mask > 0x7FF);
+            entry.mask = has_mask ? mask : (entry.extended ? 0x1FFFFFFF : 0x7FF);
+            entry.id = id & entry.mask;
+        }
+    }
+
+    if (request.containsKey("pgns")) {
+        slot.pgn_count = 0;
+        for (JsonVariantConst pgn : request["pgns"].as<JsonArrayConst>()) {
+            if (slot.pgn_count >= kCanClientMaxPgns) break;
+            slot.pgns[slot.pgn_count++] = parseCanNumber(pgn);
+        }
+    }
+
+    if (request.containsKey("max_rate")) {
+        slot.max_rate = std::min<std::uint32_t>(request["max_rate"].as<std::uint32_t>(), kCanClientMaxRate);
+        slot.rate_budget = slot.max_rate * kCanBatchWindowMs;  // One window's worth to start
+        slot.rate_refill_ms = millis();
+    }
+}
+
+namespace {
+
+constexpr std::uint16_t kLatestEmpty = 0xFFFF;
+
+std::size_t latestHome(std::uint32_t identifier, std::uint8_t flags, std::size_t slots) {
+    const std::uint32_t key = identifier ^ (static_cast<std::uint32_t>(flags) << 29);
+    return (key * 0x9E3779B1u >> 16) & (slots - 1);
+}
+
+}  // namespace
+
+// Index entry holding the queued record with this ID/direction, or the
+// empty entry where it belongs. Entries name queue positions; the key is
+// read back from the record itself.
+std::uint16_t* WebServerManager::findLatestLocked(CanMonitorClient& slot, std::uint32_t identifier,
+                                                  std::uint8_t flags) {
+    using namespace CanMonitorProtocol;
+    static_assert((kCanClientIndexSlots & (kCanClientIndexSlots - 1)) == 0, "index size must be a power of two");
+
+    for (std::size_t i = latestHome(identifier, flags, kCanClientIndexSlots);; i = (i + 1) & (kCanClientIndexSlots - 1)) {
+        std::uint16_t& entry = slot.latest[i];
+        if (entry == kLatestEmpty) return &entry;
+        const std::uint8_t* rec = slot.queue + entry * kRecordSize;
+        if (getU32(rec) == identifier && rec[8] == flags) return &entry;
+    }
+}
+
+// The record at `position` is leaving the queue. Backward-shift deletion,
+// so lookups never need tombstones.
+void WebServerManager::forgetLatestLocked(CanMonitorClient& slot, std::uint16_t position) {
+    using namespace CanMonitorProtocol;
+
+    const std::uint8_t* rec = slot.queue + position * kRecordSize;
+    std::uint16_t* entry = findLatestLocked(slot, getU32(rec), rec[8]);
+    if (*entry != position) return;  // A newer duplicate from before the index was built
+
+    constexpr std::size_t mask = kCanClientIndexSlots - 1;
+    std::size_t hole = static_cast<std::size_t>(entry - slot.latest);
+    for (std::size_t next = (hole + 1) & mask; slot.latest[next] != kLatestEmpty; next = (next + 1) & mask) {
+        const std::uint8_t* moved = slot.queue + slot.latest[next] * kRecordSize;
+        const std::size_t home = latestHome(getU32(moved), moved[8], kCanClientIndexSlots);
+        // Move it into the hole unless its home lies cyclically in (hole, next]
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slot.latest[hole] = slot.latest[next];
+            hole = next;
+        }
+    }
+    slot.latest[hole] = kLatestEmpty;
+}
+
+// Indexes what is already queued (oldest first, so the newest duplicate wins)
+void WebServerManager::rebuildLatestLocked(CanMonitorClient& slot) {
+    using namespace CanMonitorProtocol;
+
+    std::fill(slot.latest, slot.latest + kCanClientIndexSlots, kLatestEmpty);
+    for (std::uint16_t i = 0; i < slot.queue_count; ++i) {
+        const std::uint16_t position = static_cast<std::uint16_t>((slot.queue_head + i) % kCanClientQueueFrames);
+        const std::uint8_t* rec = slot.queue + position * kRecordSize;
+        *findLatestLocked(slot, getU32(rec), rec[8]) = position;
+    }
+}
+
+void WebServerManager::enqueueCanRecordLocked(CanMonitorClient& slot, const CanRxMessage& msg, bool is_tx) {
+    using namespace CanMonitorProtocol;
+
+    if (slot.filter_count > 0 || slot.pgn_count > 0) {
+        bool match = false;
+        for (std::uint8_t i = 0; i < slot.filter_count && !match; ++i) {
+            const CanIdFilter& filter = slot.filters[i];
+            match = msg.extended == filter.extended && (msg.identifier & filter.mask) == filter.id;
+        }
+        if (!match && msg.extended) {
+            const std::uint32_t pgn = j1939Pgn(msg.identifier);
+            for (std::uint8_t i = 0; i < slot.pgn_count && !match; ++i) {
+                match = slot.pgns[i] == pgn;
+            }
+        }
+        if (!match) {
+            return;  // Filtered, not a drop
+        }
+    }
+
+    // Sample-latest: overwrite the queued frame with the same ID/direction
+    const bool sample_latest = slot.policy == CanMonitorPolicy::SampleLatest;
+    if (sample_latest) {
+        const std::uint8_t flags = static_cast<std::uint8_t>((msg.extended ? kFlagExtended : 0) | (is_tx ? kFlagTx : 0));
+        const std::uint16_t queued = *findLatestLocked(slot, msg.identifier, flags);
+        if (queued != kLatestEmpty) {
+            writeRecord(slot.queue + queued * kRecordSize, msg, is_tx);
+            ++slot.dropped;
+            return;
+        }
+    }
+
+    if (slot.queue_count >= kCanClientQueueFrames) {
+        if (sample_latest) forgetLatestLocked(slot, slot.queue_head);
+        slot.queue_head = static_cast<std::uint16_t>((slot.queue_head + 1) % kCanClientQueueFrames);
+        --slot.queue_count;
+        ++slot.dropped;
+    }
+    const std::uint16_t tail = static_cast<std::uint16_t>((slot.queue_head + slot.queue_count) % kCanClientQueueFrames);
+    writeRecord(slot.queue + tail * kRecordSize, msg, is_tx);
+    ++slot.queue_count;
+    if (sample_latest) {
+        *findLatestLocked(slot, msg.identifier, slot.queue[tail * kRecordSize + 8]) = tail;
+    }
+}
+
 void WebServerManager::broadcastCanFrame(const CanRxMessage& msg, bool is_tx) {
     if (can_monitor_ws_.count() == 0) return;  // No clients connected
-    
-    DynamicJsonDocument doc(512);
-    doc["type"] = "can_frame";
-    
-    char id_hex[12];
-    snprintf(id_hex, sizeof(id_hex), "%08lX", static_cast<unsigned long>(msg.identifier));
-    doc["id"] = id_hex;
-    doc["timestamp"] = msg.timestamp;
-    doc["dir"] = is_tx ? "TX" : "RX";
-    
-    JsonArray dataArray = doc.createNestedArray("data");
-    for (uint8_t i = 0; i < msg.length && i < 8; i++) {
-        dataArray.add(msg.data[i]);
+
+    // Called from the loop task only (RX bus and CanManager TX echo); the
+    // short wait covers a concurrent stats read or client event
+    if (xSemaphoreTake(can_batch_mutex_, pdMS_TO_TICKS(5)) != pdTRUE) {
+        can_lock_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
     }
-    
-    String payload;
-    serializeJson(doc, payload);
-    can_monitor_ws_.textAll(payload);
+
+    for (auto& slot : can_clients_) {
+        if (slot.id != 0) {
+            enqueueCanRecordLocked(slot, msg, is_tx);
+        }
+    }
+    if (millis() - can_last_flush_ms_ >= kCanBatchWindowMs) {
+        flushCanClientsLocked();
+    }
+    xSemaphoreGive(can_batch_mutex_);
+}
+
+void WebServerManager::flushCanMonitor() {
+    if (can_monitor_ws_.count() > 0) {
+        CanManager::instance().noteMonitorActivity();  // Keeps the RX filter at accept-all
+    }
+    if (millis() - can_last_flush_ms_ < kCanBatchWindowMs) return;
+    if (xSemaphoreTake(can_batch_mutex_, 0) != pdTRUE) return;  // A sender is mid-append; it will flush
+
+    flushCanClientsLocked();
+    xSemaphoreGive(can_batch_mutex_);
+}
+
+// One batch per client per window. A client whose AsyncTCP queue is full, or
+// that has used its rate budget, is skipped; its frames wait in its own queue
+// (where the policy bounds them) so it never holds up the other clients.
+void WebServerManager::flushCanClientsLocked() {
+    using namespace CanMonitorProtocol;
+
+    const std::uint32_t now = millis();
+    can_last_flush_ms_ = now;
+    const std::uint32_t lock_dropped = can_lock_dropped_.load(std::memory_order_relaxed);
+
+    for (auto& slot : can_clients_) {
+        if (slot.id == 0 || slot.queue_count == 0) continue;
+
+        AsyncWebSocketClient* client = can_monitor_ws_.client(slot.id);
+        if (!client || client->status() != WS_CONNECTED || !client->canSend()) {
+            continue;  // Backpressure: leave it queued
+        }
+
+        std::size_t count = slot.queue_count < kCanBatchMaxFrames ? slot.queue_count : kCanBatchMaxFrames;
+        if (slot.max_rate > 0) {
+            // Budget is capped at one second of burst, so a longer gap adds
+            // nothing; clamping it keeps max_rate * elapsed inside 32 bits
+            const std::uint32_t elapsed = std::min<std::uint32_t>(now - slot.rate_refill_ms, 1000);
+            slot.rate_budget += slot.max_rate * elapsed;
+            const std::uint32_t budget_cap = slot.max_rate * 1000;
+            if (slot.rate_budget > budget_cap) slot.rate_budget = budget_cap;
+            slot.rate_refill_ms = now;
+            const std::size_t allowed = slot.rate_budget / 1000;
+            if (allowed < count) count = allowed;
+            if (count == 0) continue;
+            slot.rate_budget -= static_cast<std::uint32_t>(count * 1000);
+        }
+
+        std::uint8_t* records = can_batch_.data() + kHeaderSize;
+        for (std::size_t i = 0; i < count; ++i) {
+            memcpy(records + i * kRecordSize, slot.queue + slot.queue_head * kRecordSize, kRecordSize);
+            if (slot.policy == CanMonitorPolicy::SampleLatest) forgetLatestLocked(slot, slot.queue_head);
+            slot.queue_head = static_cast<std::uint16_t>((slot.queue_head + 1) % kCanClientQueueFrames);
+        }
+        slot.queue_count = static_cast<std::uint16_t>(slot.queue_count - count);
+        slot.sent += count;
+
+        const std::uint32_t dropped = slot.dropped + lock_dropped;
+        if (slot.json) {
+            client->text(buildJsonBatch(records, static_cast<std::uint16_t>(count), dropped));
+        } else {
+            writeHeader(can_batch_.data(), static_cast<std::uint16_t>(count), dropped);
+            client->binary(can_batch_.data(), kHeaderSize + count * kRecordSize);
+        }
+    }
+}
+
+std::vector<WebServerManager::CanMonitorClientStats> WebServerManager::getCanMonitorStats() {
+    std::vector<CanMonitorClientStats> stats;
+    if (xSemaphoreTake(can_batch_mutex_, pdMS_TO_TICKS(20)) != pdTRUE) {
+        return stats;
+    }
+    for (const auto& slot : can_clients_) {
+        if (slot.id == 0) continue;
+        CanMonitorClientStats entry;
+        entry.id = slot.id;
+        entry.json = slot.json;
+        entry.sample_latest = slot.policy == CanMonitorPolicy::SampleLatest;
+        entry.filters = slot.filter_count;
+        entry.pgns = slot.pgn_count;
+        entry.max_rate = slot.max_rate;
+        entry.queued = slot.queue_count;
+        entry.sent = slot.sent;
+        entry.dropped = slot.dropped;
+        stats.push_back(entry);
+    }
+    xSemaphoreGive(can_batch_mutex_);
+    return stats;
 }
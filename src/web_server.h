@@ -3,9 +3,18 @@
 #include <ESPAsyncWebServer.h>
 #include <WiFi.h>
 #include <DNSServer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+#include "can_monitor_protocol.h"
 
 struct WifiStatusSnapshot {
     IPAddress ap_ip;
@@ -27,8 +36,27 @@ public:
     // Access to web server for plugin registration
     AsyncWebServer& getServer() { return server_; }
     
-    // CAN monitoring WebSocket broadcast
+    // CAN monitoring WebSocket broadcast. Each frame is filtered against every
+    // client's subscription and queued per client; queues are sent as one
+    // batch per client per window, subject to that client's rate limit and
+    // to AsyncTCP backpressure. Loop task only (it drains the RX bus and the
+    // CanManager TX echo); client events and stats reads on other tasks only
+    // take the batch lock.
     void broadcastCanFrame(const struct CanRxMessage& msg, bool is_tx);
+    void flushCanMonitor();
+
+    struct CanMonitorClientStats {
+        std::uint32_t id = 0;
+        bool json = false;
+        bool sample_latest = false;
+        std::uint8_t filters = 0;
+        std::uint8_t pgns = 0;
+        std::uint32_t max_rate = 0;
+        std::uint32_t queued = 0;
+        std::uint32_t sent = 0;
+        std::uint32_t dropped = 0;
+    };
+    std::vector<CanMonitorClientStats> getCanMonitorStats();
     AsyncWebSocket& getCanMonitorSocket() { return can_monitor_ws_; }
 
 private:
@@ -37,6 +65,62 @@ private:
     void setupRoutes();
     void configureWifi();
 
+    static constexpr std::size_t kCanBatchMaxFrames = 64;
+    static constexpr std::uint32_t kCanBatchWindowMs = 20;
+    static constexpr std::size_t kCanMonitorMaxClients = 8;
+    static constexpr std::size_t kCanClientQueueFrames = 256;
+    static constexpr std::size_t kCanClientMaxFilters = 8;
+    static constexpr std::size_t kCanClientMaxPgns = 16;
+    static constexpr std::uint32_t kCanClientMaxRate = 10000;  // Frames/s; keeps the milli-frame budget in 32 bits
+    static constexpr std::size_t kCanClientIndexSlots = 2 * kCanClientQueueFrames;  // Power of two, at most half full
+
+    enum class CanMonitorPolicy : std::uint8_t {
+        DropOldest,     // Full queue discards the oldest frame
+        SampleLatest,   // Queue keeps only the newest frame per ID/direction
+    };
+
+    struct CanIdFilter {
+        std::uint32_t id = 0;
+        std::uint32_t mask = 0;
+        bool extended = true;  // Frame format must match too
+    };
+
+    struct CanMonitorClient {
+        std::uint32_t id = 0;           // 0 = free slot
+        bool json = false;              // Negotiated JSON fallback
+        CanMonitorPolicy policy = CanMonitorPolicy::DropOldest;
+
+        // Subscription: a frame passes if it matches any ID/mask or any PGN;
+        // with neither configured, every frame passes
+        std::uint8_t filter_count = 0;
+        std::array<CanIdFilter, kCanClientMaxFilters> filters{};
+        std::uint8_t pgn_count = 0;
+        std::array<std::uint32_t, kCanClientMaxPgns> pgns{};
+        std::uint32_t max_rate = 0;     // Frames/s, 0 = unlimited
+        std::uint32_t rate_budget = 0;  // Milli-frames available to send
+        std::uint32_t rate_refill_ms = 0;
+
+        // Bounded queue of encoded records (kCanClientQueueFrames, PSRAM)
+        std::uint8_t* queue = nullptr;
+        // Sample-latest index in the same block: queue position of the
+        // queued record per ID/direction, linear probing over
+        // kCanClientIndexSlots; kept only while the policy is SampleLatest
+        std::uint16_t* latest = nullptr;
+        std::uint16_t queue_head = 0;
+        std::uint16_t queue_count = 0;
+        std::uint32_t sent = 0;
+        std::uint32_t dropped = 0;
+    };
+
+    void onCanMonitorEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    CanMonitorClient* findCanMonitorClient(std::uint32_t id);
+    void applyCanMonitorSubscription(CanMonitorClient& slot, JsonVariantConst request);
+    void enqueueCanRecordLocked(CanMonitorClient& slot, const CanRxMessage& msg, bool is_tx);
+    std::uint16_t* findLatestLocked(CanMonitorClient& slot, std::uint32_t identifier, std::uint8_t flags);
+    void forgetLatestLocked(CanMonitorClient& slot, std::uint16_t position);
+    void rebuildLatestLocked(CanMonitorClient& slot);
+    void flushCanClientsLocked();
+
     AsyncWebServer server_;
     AsyncWebSocket can_monitor_ws_;
     DNSServer dns_server_;
@@ -49,4 +133,11 @@ private:
     std::uint32_t wifi_reconfigure_request_ms_ = 0;
     bool ap_suppressed_ = false;
     bool dns_active_ = false;
+
+    // CAN monitor clients and batching (guarded by can_batch_mutex_)
+    SemaphoreHandle_t can_batch_mutex_ = nullptr;
+    std::array<std::uint8_t, CanMonitorProtocol::kHeaderSize + kCanBatchMaxFrames * CanMonitorProtocol::kRecordSize> can_batch_{};
+    std::uint32_t can_last_flush_ms_ = 0;
+    std::atomic<std::uint32_t> can_lock_dropped_{0};
+    std::array<CanMonitorClient, kCanMonitorMaxClients> can_clients_{};
 };